@@ -0,0 +1,75 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// One read from each of N devices answering after 200 us, issued from single
+// thread: blocking TCP::Connection per device one after another versus
+// Async::TcpClient with all devices in flight at once. Argument is N.
+
+#include <memory>
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+#include "MB/Async/tcpClient.hpp"
+#include "loopback.hpp"
+
+using namespace MB;
+
+namespace {
+constexpr auto DeviceLatency = std::chrono::microseconds(200);
+
+std::vector<std::unique_ptr<bench::TcpLoopback>> devices(std::size_t count) {
+    std::vector<std::unique_ptr<bench::TcpLoopback>> loopbacks;
+    for (std::size_t i = 0; i < count; i++)
+        loopbacks.push_back(std::make_unique<bench::TcpLoopback>(DeviceLatency));
+    return loopbacks;
+}
+
+const ModbusRequest &pollRequest() {
+    static const ModbusRequest request(1, utils::ReadAnalogOutputHoldingRegisters, 0, 16);
+    return request;
+}
+
+void reportCycles(benchmark::State &state) {
+    const auto transactions = static_cast<double>(state.iterations() * state.range(0));
+    state.counters["tx/s"] =
+        benchmark::Counter(transactions, benchmark::Counter::kIsRate);
+}
+} // namespace
+
+static void BM_DevicesBlocking(benchmark::State &state) {
+    auto loopbacks = devices(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state)
+        for (auto &loopback : loopbacks)
+            benchmark::DoNotOptimize(loopback->transact(pollRequest()));
+    reportCycles(state);
+}
+BENCHMARK(BM_DevicesBlocking)->Arg(1)->Arg(16)->Arg(128)->UseRealTime();
+
+static void BM_DevicesAsync(benchmark::State &state) {
+    auto loopbacks = devices(static_cast<std::size_t>(state.range(0)));
+    Async::TcpClient client(0);
+    std::vector<Async::TcpSession *> sessions;
+    for (auto &loopback : loopbacks)
+        sessions.push_back(&client.adopt(::dup(loopback->client().getSockfd())));
+
+    std::size_t completed = 0;
+    bool failed           = false;
+    const auto onResponse = [&](Result<ModbusResponse> response) {
+        failed |= !response;
+        completed++;
+    };
+
+    for (auto _ : state) {
+        completed = 0;
+        for (auto *session : sessions)
+            session->submit(pollRequest(), onResponse);
+        while (completed < sessions.size())
+            client.loop().runOnce();
+    }
+    if (failed)
+        state.SkipWithError("transaction failed");
+    reportCycles(state);
+}
+BENCHMARK(BM_DevicesAsync)->Arg(1)->Arg(16)->Arg(128)->Arg(1024)->UseRealTime();
@@ -0,0 +1,91 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Client side read cache. BM_ReadCacheHit is the cost of a read served from a
+// cached superset range, BM_ReadCacheShared has several threads reading the
+// same registers of one device over TCP socketpair, directly (cached:0) or
+// through a cache with 1 ms TTL (cached:1). "tx/read" is the fraction of
+// reads that cost a transaction.
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "MB/modbusReadCache.hpp"
+#include "allocCounter.hpp"
+#include "loopback.hpp"
+
+using namespace MB;
+using MB::bench::AllocationScope;
+
+static void BM_ReadCacheHit(benchmark::State &state) {
+    ReadCache cache(std::chrono::hours(1));
+    const auto transact = [](const ModbusRequest &request) {
+        ModbusResponse response(request.slaveID(), request.functionCode(), 0,
+                                request.numberOfRegisters());
+        response.setRegisters(RegisterBlock(request.numberOfRegisters(), 7));
+        return Result<ModbusResponse>(response);
+    };
+    const std::string endpoint = "10.0.0.5:502";
+    const ModbusRequest range(1, utils::ReadAnalogOutputHoldingRegisters, 0, 100);
+    const ModbusRequest subrange(1, utils::ReadAnalogOutputHoldingRegisters, 40, 4);
+    benchmark::DoNotOptimize(cache.read(endpoint, range, transact));
+
+    {
+        AllocationScope allocs(state);
+        for (auto _ : state)
+            benchmark::DoNotOptimize(cache.read(endpoint, subrange, transact));
+    }
+    state.counters["hits"] = static_cast<double>(cache.stats().hits);
+}
+BENCHMARK(BM_ReadCacheHit);
+
+namespace {
+//! Device shared by all threads of BM_ReadCacheShared, one transaction at a time
+struct SharedDevice {
+    bench::TcpLoopback loopback;
+    std::mutex bus;
+    std::atomic<uint64_t> transactions{0};
+    ReadCache cache{std::chrono::milliseconds(1)};
+
+    Result<ModbusResponse> transact(const ModbusRequest &request) {
+        std::lock_guard lock(bus);
+        transactions++;
+        return loopback.transact(request);
+    }
+};
+
+std::unique_ptr<SharedDevice> shared;
+} // namespace
+
+static void BM_ReadCacheShared(benchmark::State &state) {
+    if (state.thread_index() == 0)
+        shared = std::make_unique<SharedDevice>();
+    const bool cached   = state.range(0) != 0;
+    const auto transact = [](const ModbusRequest &request) {
+        return shared->transact(request);
+    };
+    const ModbusRequest request(1, utils::ReadAnalogOutputHoldingRegisters, 0, 20);
+
+    for (auto _ : state) {
+        if (cached)
+            benchmark::DoNotOptimize(shared->cache.read("device", request, transact));
+        else
+            benchmark::DoNotOptimize(shared->transact(request));
+    }
+
+    if (state.thread_index() == 0) {
+        const auto reads = static_cast<double>(state.iterations() * state.threads());
+        state.counters["tx/read"] = static_cast<double>(shared->transactions) / reads;
+        shared.reset();
+    }
+}
+BENCHMARK(BM_ReadCacheShared)
+    ->ArgName("cached")
+    ->Arg(0)
+    ->Arg(1)
+    ->Threads(4)
+    ->UseRealTime();
@@ -0,0 +1,239 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Construction, encoding and parsing of every supported function code over
+// the interesting payload sizes. Arguments are function code and number of
+// registers (or coils).
+
+#include "allocCounter.hpp"
+
+#include <vector>
+
+#include "MB/modbusException.hpp"
+#include "MB/modbusRequest.hpp"
+#include "MB/modbusResponse.hpp"
+#include "MB/modbusUtils.hpp"
+
+using namespace MB;
+using MB::bench::AllocationScope;
+
+namespace {
+constexpr uint8_t SlaveID = 0x11;
+
+RegisterBlock registerValues(uint16_t count) {
+    RegisterBlock values;
+    values.resize(count);
+    for (uint16_t i = 0; i < count; i++)
+        values[i] = static_cast<uint16_t>(i * 3);
+    return values;
+}
+
+CoilBitset coilValues(uint16_t count) {
+    CoilBitset values(count);
+    for (uint16_t i = 0; i < count; i += 3)
+        values.set(i, true);
+    return values;
+}
+
+ModbusRequest makeRequest(utils::MBFunctionCode code, uint16_t count) {
+    switch (code) {
+    case utils::ReadFileRecord:
+        return ModbusRequest::readFileRecord(SlaveID, 1, 0, count);
+    case utils::WriteFileRecord:
+        return ModbusRequest::writeFileRecord(SlaveID, 1, 0, registerValues(count));
+    case utils::MaskWriteRegister:
+        return ModbusRequest::maskWrite(SlaveID, 7, 0xFFF0, 0x0004);
+    case utils::ReadWriteMultipleRegisters:
+        return ModbusRequest::readWriteMultiple(SlaveID, 0, count, 0,
+                                                registerValues(count));
+    default:
+        break;
+    }
+
+    ModbusRequest request(SlaveID, code, 0, count);
+    if (utils::functionType(code) != utils::Read) {
+        if (utils::functionRegister(code) == utils::OutputCoils)
+            request.setCoils(coilValues(count));
+        else
+            request.setRegisters(registerValues(count));
+    }
+    return request;
+}
+
+ModbusResponse makeResponse(utils::MBFunctionCode code, uint16_t count) {
+    ModbusResponse response(SlaveID, code, 0, count);
+    switch (code) {
+    case utils::ReadDiscreteOutputCoils:
+    case utils::ReadDiscreteInputContacts:
+        response.setCoils(coilValues(count));
+        break;
+    case utils::ReadAnalogOutputHoldingRegisters:
+    case utils::ReadAnalogInputRegisters:
+    case utils::ReadWriteMultipleRegisters:
+    case utils::ReadFileRecord:
+        response.setRegisters(registerValues(count));
+        break;
+    default:
+        response.from(makeRequest(code, count));
+        break;
+    }
+    return response;
+}
+
+utils::MBFunctionCode functionCode(const benchmark::State &state) {
+    return static_cast<utils::MBFunctionCode>(state.range(0));
+}
+
+uint16_t valueCount(const benchmark::State &state) {
+    return static_cast<uint16_t>(state.range(1));
+}
+
+// Smallest, typical and largest payload of every function code
+void codecArgs(benchmark::internal::Benchmark *bench) {
+    const std::vector<std::pair<utils::MBFunctionCode, std::vector<int64_t>>> codes = {
+        {utils::ReadDiscreteOutputCoils, {1, 256, 2000}},
+        {utils::ReadDiscreteInputContacts, {1, 256, 2000}},
+        {utils::ReadAnalogOutputHoldingRegisters, {1, 16, 125}},
+        {utils::ReadAnalogInputRegisters, {1, 16, 125}},
+        {utils::WriteSingleDiscreteOutputCoil, {1}},
+        {utils::WriteSingleAnalogOutputRegister, {1}},
+        {utils::WriteMultipleDiscreteOutputCoils, {1, 256, 1968}},
+        {utils::WriteMultipleAnalogOutputHoldingRegisters, {1, 16, 123}},
+        {utils::ReadFileRecord, {1, 16, 124}},
+        {utils::WriteFileRecord, {1, 16, 122}},
+        {utils::MaskWriteRegister, {1}},
+        {utils::ReadWriteMultipleRegisters, {1, 16, 121}},
+    };
+    bench->ArgNames({"fc", "count"});
+    for (const auto &[code, counts] : codes)
+        for (const auto count : counts)
+            bench->Args({code, count});
+}
+
+//! Marks benchmark as failed if message does not survive encode / parse
+template <typename Message>
+bool roundTrips(benchmark::State &state, const Message &message) {
+    if (!Message::tryFromRaw(message.toRaw())) {
+        state.SkipWithError("message does not round trip");
+        return false;
+    }
+    return true;
+}
+
+std::vector<uint8_t> withCRC(std::vector<uint8_t> raw) {
+    const auto crc = utils::calculateCRC(raw);
+    raw.push_back(static_cast<uint8_t>(crc & 0xFF));
+    raw.push_back(static_cast<uint8_t>(crc >> 8));
+    return raw;
+}
+} // namespace
+
+static void BM_CodecRequestConstruct(benchmark::State &state) {
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto request = makeRequest(functionCode(state), valueCount(state));
+        benchmark::DoNotOptimize(request);
+    }
+}
+BENCHMARK(BM_CodecRequestConstruct)->Apply(codecArgs);
+
+static void BM_CodecRequestToRaw(benchmark::State &state) {
+    const auto request = makeRequest(functionCode(state), valueCount(state));
+    if (!roundTrips(state, request))
+        return;
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto raw = request.toRaw();
+        benchmark::DoNotOptimize(raw);
+    }
+}
+BENCHMARK(BM_CodecRequestToRaw)->Apply(codecArgs);
+
+static void BM_CodecRequestFromRaw(benchmark::State &state) {
+    const auto request = makeRequest(functionCode(state), valueCount(state));
+    if (!roundTrips(state, request))
+        return;
+    const auto raw = request.toRaw();
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto parsed = ModbusRequest::fromRaw(raw);
+        benchmark::DoNotOptimize(parsed);
+    }
+}
+BENCHMARK(BM_CodecRequestFromRaw)->Apply(codecArgs);
+
+static void BM_CodecRequestFromRawCRC(benchmark::State &state) {
+    const auto request = makeRequest(functionCode(state), valueCount(state));
+    if (!roundTrips(state, request))
+        return;
+    const auto raw = withCRC(request.toRaw());
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto parsed = ModbusRequest::fromRawCRC(raw);
+        benchmark::DoNotOptimize(parsed);
+    }
+}
+BENCHMARK(BM_CodecRequestFromRawCRC)->Apply(codecArgs);
+
+static void BM_CodecResponseConstruct(benchmark::State &state) {
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto response = makeResponse(functionCode(state), valueCount(state));
+        benchmark::DoNotOptimize(response);
+    }
+}
+BENCHMARK(BM_CodecResponseConstruct)->Apply(codecArgs);
+
+static void BM_CodecResponseToRaw(benchmark::State &state) {
+    const auto response = makeResponse(functionCode(state), valueCount(state));
+    if (!roundTrips(state, response))
+        return;
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto raw = response.toRaw();
+        benchmark::DoNotOptimize(raw);
+    }
+}
+BENCHMARK(BM_CodecResponseToRaw)->Apply(codecArgs);
+
+static void BM_CodecResponseFromRaw(benchmark::State &state) {
+    const auto response = makeResponse(functionCode(state), valueCount(state));
+    if (!roundTrips(state, response))
+        return;
+    const auto raw = response.toRaw();
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto parsed = ModbusResponse::fromRaw(raw);
+        benchmark::DoNotOptimize(parsed);
+    }
+}
+BENCHMARK(BM_CodecResponseFromRaw)->Apply(codecArgs);
+
+static void BM_CodecResponseFromRawCRC(benchmark::State &state) {
+    const auto response = makeResponse(functionCode(state), valueCount(state));
+    if (!roundTrips(state, response))
+        return;
+    const auto raw = withCRC(response.toRaw());
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto parsed = ModbusResponse::fromRawCRC(raw);
+        benchmark::DoNotOptimize(parsed);
+    }
+}
+BENCHMARK(BM_CodecResponseFromRawCRC)->Apply(codecArgs);
+
+// Argument selects exception frame (1) or regular response (0)
+static void BM_CodecExceptionExist(benchmark::State &state) {
+    const auto code = utils::ReadAnalogOutputHoldingRegisters;
+    const auto raw =
+        state.range(0)
+            ? ModbusException(utils::IllegalDataAddress, SlaveID, code).toRaw()
+            : makeResponse(code, 16).toRaw();
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto exists = ModbusException::exist(raw);
+        benchmark::DoNotOptimize(exists);
+    }
+}
+BENCHMARK(BM_CodecExceptionExist)->Arg(0)->Arg(1);
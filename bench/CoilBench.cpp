@@ -0,0 +1,132 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Pack / unpack of full 2000 coil read.
+
+#include <benchmark/benchmark.h>
+
+#include "MB/modbusCellView.hpp"
+#include "MB/modbusCoilPack.hpp"
+
+using namespace MB;
+
+namespace {
+constexpr std::size_t Coils = CoilBitset::Capacity;
+
+CoilBitset benchCoils() {
+    CoilBitset coils(Coils);
+    for (std::size_t i = 0; i < Coils; i++)
+        coils.set(i, (i * 7) % 3 == 0);
+    return coils;
+}
+
+void runUnpack(benchmark::State &state, utils::CoilKernel kernel) {
+    if (!utils::isCoilKernelSupported(kernel)) {
+        state.SkipWithError("Kernel not supported on this CPU");
+        return;
+    }
+    const auto coils = benchCoils();
+    uint8_t values[Coils];
+    for (auto _ : state) {
+        utils::unpackCoils(coils.data(), Coils, values, kernel);
+        benchmark::DoNotOptimize(values);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * Coils);
+}
+
+void runPack(benchmark::State &state, utils::CoilKernel kernel) {
+    if (!utils::isCoilKernelSupported(kernel)) {
+        state.SkipWithError("Kernel not supported on this CPU");
+        return;
+    }
+    uint8_t values[Coils];
+    benchCoils().copyTo(reinterpret_cast<bool *>(values));
+    uint8_t packed[CoilBitset::ByteCapacity];
+    for (auto _ : state) {
+        utils::packCoils(values, Coils, packed, kernel);
+        benchmark::DoNotOptimize(packed);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * Coils);
+}
+} // namespace
+
+// Baseline: CoilBitset::test per coil
+static void BM_CoilUnpackPerBit(benchmark::State &state) {
+    const auto coils = benchCoils();
+    bool values[Coils];
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < Coils; i++)
+            values[i] = coils.test(i);
+        benchmark::DoNotOptimize(values);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * Coils);
+}
+BENCHMARK(BM_CoilUnpackPerBit);
+
+static void BM_CoilUnpackScalar(benchmark::State &state) {
+    runUnpack(state, utils::CoilScalar);
+}
+BENCHMARK(BM_CoilUnpackScalar);
+
+static void BM_CoilUnpackSse2(benchmark::State &state) {
+    runUnpack(state, utils::CoilSse2);
+}
+BENCHMARK(BM_CoilUnpackSse2);
+
+static void BM_CoilUnpackBmi2(benchmark::State &state) {
+    runUnpack(state, utils::CoilBmi2);
+}
+BENCHMARK(BM_CoilUnpackBmi2);
+
+// Baseline: CoilBitset::set per coil
+static void BM_CoilPackPerBit(benchmark::State &state) {
+    bool values[Coils];
+    benchCoils().copyTo(values);
+    CoilBitset coils(Coils);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < Coils; i++)
+            coils.set(i, values[i]);
+        benchmark::DoNotOptimize(coils.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * Coils);
+}
+BENCHMARK(BM_CoilPackPerBit);
+
+static void BM_CoilPackScalar(benchmark::State &state) {
+    runPack(state, utils::CoilScalar);
+}
+BENCHMARK(BM_CoilPackScalar);
+
+static void BM_CoilPackSse2(benchmark::State &state) { runPack(state, utils::CoilSse2); }
+BENCHMARK(BM_CoilPackSse2);
+
+static void BM_CoilPackBmi2(benchmark::State &state) { runPack(state, utils::CoilBmi2); }
+BENCHMARK(BM_CoilPackBmi2);
+
+// Materializing ModbusCell vector, element by element vs through copyTo
+static void BM_CoilCellsIterate(benchmark::State &state) {
+    const auto coils = benchCoils();
+    const ModbusCellView view(coils);
+    for (auto _ : state) {
+        std::vector<ModbusCell> cells(view.begin(), view.end());
+        benchmark::DoNotOptimize(cells.data());
+    }
+    state.SetItemsProcessed(state.iterations() * Coils);
+}
+BENCHMARK(BM_CoilCellsIterate);
+
+static void BM_CoilCellsToVector(benchmark::State &state) {
+    const auto coils = benchCoils();
+    const ModbusCellView view(coils);
+    for (auto _ : state) {
+        auto cells = view.toVector();
+        benchmark::DoNotOptimize(cells.data());
+    }
+    state.SetItemsProcessed(state.iterations() * Coils);
+}
+BENCHMARK(BM_CoilCellsToVector);
@@ -0,0 +1,91 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Conversion of full 125 register payload into native values.
+
+#include <benchmark/benchmark.h>
+
+#include "MB/modbusConvert.hpp"
+
+using namespace MB;
+
+namespace {
+constexpr std::size_t PayloadSize = 250;
+
+std::vector<uint8_t> payload() {
+    std::vector<uint8_t> data(PayloadSize);
+    for (std::size_t i = 0; i < data.size(); i++)
+        data[i] = static_cast<uint8_t>(i * 31 + 7);
+    return data;
+}
+
+template <typename T>
+void runKernel(benchmark::State &state, utils::ConvertKernel kernel) {
+    if (!utils::isConvertKernelSupported(kernel)) {
+        state.SkipWithError("Kernel not supported on this CPU");
+        return;
+    }
+    const auto wire  = payload();
+    const auto count = PayloadSize / sizeof(T);
+    const auto order = static_cast<utils::WordOrder>(state.range(0));
+    std::vector<T> values(count);
+    for (auto _ : state) {
+        auto *dst = reinterpret_cast<uint8_t *>(values.data());
+        utils::convertOrder(wire.data(), dst, count, sizeof(T), order, kernel);
+        benchmark::DoNotOptimize(values.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * count * sizeof(T));
+}
+} // namespace
+
+// Baseline: one combineFloat32 call per value
+static void BM_ConvertCombineFloat32(benchmark::State &state) {
+    const auto wire  = payload();
+    const auto order = static_cast<utils::WordOrder>(state.range(0));
+    std::vector<float> values(PayloadSize / 4);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < values.size(); i++)
+            values[i] = utils::combineFloat32(&wire[4 * i], order);
+        benchmark::DoNotOptimize(values.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * PayloadSize);
+}
+BENCHMARK(BM_ConvertCombineFloat32)->DenseRange(utils::ABCD, utils::DCBA);
+
+static void BM_ConvertFloatScalar(benchmark::State &state) {
+    runKernel<float>(state, utils::ConvertScalar);
+}
+BENCHMARK(BM_ConvertFloatScalar)->DenseRange(utils::ABCD, utils::DCBA);
+
+static void BM_ConvertFloatSsse3(benchmark::State &state) {
+    runKernel<float>(state, utils::ConvertSsse3);
+}
+BENCHMARK(BM_ConvertFloatSsse3)->DenseRange(utils::ABCD, utils::DCBA);
+
+static void BM_ConvertFloatAvx2(benchmark::State &state) {
+    runKernel<float>(state, utils::ConvertAvx2);
+}
+BENCHMARK(BM_ConvertFloatAvx2)->DenseRange(utils::ABCD, utils::DCBA);
+
+static void BM_ConvertUint16Scalar(benchmark::State &state) {
+    runKernel<uint16_t>(state, utils::ConvertScalar);
+}
+BENCHMARK(BM_ConvertUint16Scalar)->Arg(utils::ABCD);
+
+static void BM_ConvertUint16Avx2(benchmark::State &state) {
+    runKernel<uint16_t>(state, utils::ConvertAvx2);
+}
+BENCHMARK(BM_ConvertUint16Avx2)->Arg(utils::ABCD);
+
+static void BM_ConvertDoubleScalar(benchmark::State &state) {
+    runKernel<double>(state, utils::ConvertScalar);
+}
+BENCHMARK(BM_ConvertDoubleScalar)->Arg(utils::CDAB);
+
+static void BM_ConvertDoubleAvx2(benchmark::State &state) {
+    runKernel<double>(state, utils::ConvertAvx2);
+}
+BENCHMARK(BM_ConvertDoubleAvx2)->Arg(utils::CDAB);
@@ -0,0 +1,76 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Coroutine master and slave sessions over socketpair(), all on one thread.
+// Every iteration each of N master sessions completes one transaction, N is
+// the argument. Coroutine frames come from FramePool, so steady state should
+// not allocate.
+
+#include <sys/socket.h>
+
+#include <benchmark/benchmark.h>
+
+#include "MB/Async/connections.hpp"
+#include "allocCounter.hpp"
+#include "loopback.hpp"
+
+using namespace MB;
+
+namespace {
+Async::Task<> serve(Async::TcpStream stream, bench::SimulatedDevice &device) {
+    while (true) {
+        auto request = co_await stream.awaitRequest();
+        if (!request)
+            co_return;
+        co_await stream.sendResponse(device.handle(request.value()));
+    }
+}
+} // namespace
+
+static void BM_CoroutineSessions(benchmark::State &state) {
+    const auto sessions = static_cast<std::size_t>(state.range(0));
+    const ModbusRequest request(1, utils::ReadAnalogOutputHoldingRegisters, 0, 16);
+    bench::SimulatedDevice device;
+    Async::EventLoop loop;
+
+    std::vector<Async::TcpStream> masters;
+    for (std::size_t i = 0; i < sessions; i++) {
+        int fds[2];
+        ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+        masters.emplace_back(loop, fds[0]);
+        Async::spawn(serve(Async::TcpStream(loop, fds[1]), device));
+    }
+
+    std::size_t completed = 0;
+    bool failed           = false;
+    const auto transact   = [&](Async::TcpStream &master) -> Async::Task<> {
+        const auto response = co_await master.transact(request);
+        failed |= !response;
+        completed++;
+    };
+    const auto cycle = [&] {
+        completed = 0;
+        for (auto &master : masters)
+            Async::spawn(transact(master));
+        while (completed < sessions)
+            loop.runOnce();
+    };
+
+    cycle(); // Warms up frame pool and buffers
+    {
+        bench::AllocationScope allocations(state);
+        for (auto _ : state)
+            cycle();
+    }
+    if (failed)
+        state.SkipWithError("transaction failed");
+    state.counters["tx/s"] = benchmark::Counter(
+        static_cast<double>(state.iterations() * sessions), benchmark::Counter::kIsRate);
+
+    // Slave sessions finish once they see their connection closed
+    masters.clear();
+    for (int i = 0; i < 3; i++)
+        loop.runOnce(10);
+}
+BENCHMARK(BM_CoroutineSessions)->Arg(1)->Arg(64)->Arg(1024)->UseRealTime();
@@ -0,0 +1,68 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include <benchmark/benchmark.h>
+
+#include "MB/modbusCrc.hpp"
+#include "MB/modbusUtils.hpp"
+
+using namespace MB;
+
+namespace {
+std::vector<uint8_t> benchData(std::size_t size) {
+    std::vector<uint8_t> data(size);
+    for (std::size_t i = 0; i < size; i++)
+        data[i] = static_cast<uint8_t>(i * 31 + 7);
+    return data;
+}
+
+void runKernel(benchmark::State &state, utils::CrcKernel kernel) {
+    if (!utils::isCrcKernelSupported(kernel)) {
+        state.SkipWithError("Kernel not supported on this CPU");
+        return;
+    }
+    const auto data = benchData(state.range(0));
+    for (auto _ : state) {
+        auto crc = utils::crc16(data.data(), data.size(), utils::CrcInit, kernel);
+        benchmark::DoNotOptimize(crc);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+} // namespace
+
+static void BM_CrcCalculateCRC(benchmark::State &state) {
+    const auto data = benchData(state.range(0));
+    for (auto _ : state) {
+        auto crc = utils::calculateCRC(data);
+        benchmark::DoNotOptimize(crc);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CrcCalculateCRC)->Arg(8)->Arg(256)->Arg(64 << 10);
+
+static void BM_CrcReference(benchmark::State &state) {
+    runKernel(state, utils::CrcReference);
+}
+BENCHMARK(BM_CrcReference)->Arg(8)->Arg(256)->Arg(64 << 10);
+
+static void BM_CrcSlicing8(benchmark::State &state) { runKernel(state, utils::CrcSlicing8); }
+BENCHMARK(BM_CrcSlicing8)->Arg(8)->Arg(256)->Arg(64 << 10);
+
+static void BM_CrcSlicing16(benchmark::State &state) {
+    runKernel(state, utils::CrcSlicing16);
+}
+BENCHMARK(BM_CrcSlicing16)->Arg(8)->Arg(256)->Arg(64 << 10);
+
+static void BM_CrcClmul(benchmark::State &state) { runKernel(state, utils::CrcClmul); }
+BENCHMARK(BM_CrcClmul)->Arg(8)->Arg(256)->Arg(64 << 10);
+
+static void BM_CrcDispatch(benchmark::State &state) {
+    const auto data = benchData(state.range(0));
+    for (auto _ : state) {
+        auto crc = utils::crc16(data.data(), data.size());
+        benchmark::DoNotOptimize(crc);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CrcDispatch)->Arg(8)->Arg(256)->Arg(64 << 10);
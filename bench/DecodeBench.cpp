@@ -0,0 +1,77 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "allocCounter.hpp"
+
+#include "MB/modbusRequest.hpp"
+#include "MB/modbusResponse.hpp"
+#include "MB/modbusResponseView.hpp"
+#include "MB/modbusUtils.hpp"
+
+using namespace MB;
+using MB::bench::AllocationScope;
+
+namespace {
+std::vector<uint8_t> readRegistersResponse(uint16_t count) {
+    std::vector<uint8_t> raw = {0x11, utils::ReadAnalogOutputHoldingRegisters,
+                                static_cast<uint8_t>(count * 2)};
+    for (uint16_t i = 0; i < count; i++)
+        utils::pushUint16(raw, i * 3);
+    return raw;
+}
+
+std::vector<uint8_t> readCoilsResponse(uint16_t count) {
+    const auto bytes         = static_cast<uint8_t>((count + 7) / 8);
+    std::vector<uint8_t> raw = {0x11, utils::ReadDiscreteOutputCoils, bytes};
+    for (uint8_t i = 0; i < bytes; i++)
+        raw.push_back(static_cast<uint8_t>(i * 37));
+    return raw;
+}
+} // namespace
+
+static void BM_DecodeReadRegisters(benchmark::State &state) {
+    const auto raw = readRegistersResponse(state.range(0));
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto response = ModbusResponse::fromRaw(raw);
+        benchmark::DoNotOptimize(response);
+    }
+}
+BENCHMARK(BM_DecodeReadRegisters)->Arg(1)->Arg(16)->Arg(125);
+
+static void BM_ViewReadRegisters(benchmark::State &state) {
+    const auto raw = readRegistersResponse(state.range(0));
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto view   = ModbusResponseView::fromRaw(raw.data(), raw.size());
+        uint32_t sum = 0;
+        for (std::size_t i = 0; i < view.numberOfRegisters(); i++)
+            sum += view.registerAt(i);
+        benchmark::DoNotOptimize(sum);
+    }
+}
+BENCHMARK(BM_ViewReadRegisters)->Arg(1)->Arg(16)->Arg(125);
+
+static void BM_DecodeReadCoils(benchmark::State &state) {
+    const auto raw = readCoilsResponse(state.range(0));
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto response = ModbusResponse::fromRaw(raw);
+        benchmark::DoNotOptimize(response);
+    }
+}
+BENCHMARK(BM_DecodeReadCoils)->Arg(8)->Arg(256)->Arg(2000);
+
+static void BM_DecodeWriteMultipleRequest(benchmark::State &state) {
+    const auto count = static_cast<uint16_t>(state.range(0));
+    ModbusRequest source(0x11, utils::WriteMultipleAnalogOutputHoldingRegisters, 0, count,
+                         std::vector<ModbusCell>(count, ModbusCell::initReg(7)));
+    const auto raw = source.toRaw();
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto request = ModbusRequest::fromRaw(raw);
+        benchmark::DoNotOptimize(request);
+    }
+}
+BENCHMARK(BM_DecodeWriteMultipleRequest)->Arg(1)->Arg(16)->Arg(123);
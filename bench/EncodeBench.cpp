@@ -0,0 +1,79 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "allocCounter.hpp"
+
+#include <cstring>
+
+#include "MB/modbusFrames.hpp"
+#include "MB/modbusFraming.hpp"
+#include "MB/modbusRequest.hpp"
+
+using namespace MB;
+using MB::bench::AllocationScope;
+
+namespace {
+ModbusRequest writeRegistersRequest(uint16_t count) {
+    return ModbusRequest(0x11, utils::WriteMultipleAnalogOutputHoldingRegisters, 0, count,
+                         std::vector<ModbusCell>(count, ModbusCell::initReg(7)));
+}
+} // namespace
+
+static void BM_EncodeToRaw(benchmark::State &state) {
+    const auto request = writeRegistersRequest(state.range(0));
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto raw = request.toRaw();
+        benchmark::DoNotOptimize(raw);
+    }
+}
+BENCHMARK(BM_EncodeToRaw)->Arg(1)->Arg(16)->Arg(123);
+
+static void BM_EncodeAppendTCP(benchmark::State &state) {
+    const auto request = writeRegistersRequest(state.range(0));
+    std::vector<uint8_t> buffer;
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        buffer.clear();
+        appendTCP(request, 1, buffer);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+}
+BENCHMARK(BM_EncodeAppendTCP)->Arg(1)->Arg(16)->Arg(123);
+
+static void BM_EncodeRTUInto(benchmark::State &state) {
+    const auto request = writeRegistersRequest(state.range(0));
+    uint8_t buffer[256];
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto size = encodeRTU(request, buffer, sizeof(buffer));
+        benchmark::DoNotOptimize(size);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_EncodeRTUInto)->Arg(1)->Arg(16)->Arg(123);
+
+static void BM_EncodeReadRTU(benchmark::State &state) {
+    const ModbusRequest request(0x11, utils::ReadAnalogOutputHoldingRegisters, 0x6B, 3);
+    uint8_t buffer[frames::RequestFrameSize];
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto size = encodeRTU(request, buffer, sizeof(buffer));
+        benchmark::DoNotOptimize(size);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_EncodeReadRTU);
+
+static void BM_EncodeReadConstexprFrame(benchmark::State &state) {
+    uint8_t buffer[frames::RequestFrameSize];
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        constexpr auto frame = frames::ReadHolding<0x11, 0x6B, 3>;
+        std::memcpy(buffer, frame.data(), frame.size());
+        benchmark::DoNotOptimize(buffer);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_EncodeReadConstexprFrame);
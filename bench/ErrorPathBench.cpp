@@ -0,0 +1,87 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "allocCounter.hpp"
+
+#include "MB/modbusCrc.hpp"
+#include "MB/modbusResponse.hpp"
+#include "MB/modbusUtils.hpp"
+
+using namespace MB;
+using MB::bench::AllocationScope;
+
+namespace {
+std::vector<uint8_t> readRegistersFrame(uint16_t count) {
+    std::vector<uint8_t> raw = {0x11, utils::ReadAnalogOutputHoldingRegisters,
+                                static_cast<uint8_t>(count * 2)};
+    for (uint16_t i = 0; i < count; i++)
+        utils::pushUint16(raw, i * 3);
+    const auto crc = utils::crc16(raw);
+    raw.push_back(static_cast<uint8_t>(crc & 0xFF));
+    raw.push_back(static_cast<uint8_t>(crc >> 8));
+    return raw;
+}
+} // namespace
+
+// Single failed parse of truncated frame
+static void BM_ErrorPathThrow(benchmark::State &state) {
+    const auto raw = readRegistersFrame(16);
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        try {
+            auto response = ModbusResponse::fromRawCRC(raw.data(), raw.size() - 1);
+            benchmark::DoNotOptimize(response);
+        } catch (const ModbusException &ex) {
+            benchmark::DoNotOptimize(ex.getErrorCode());
+        }
+    }
+}
+BENCHMARK(BM_ErrorPathThrow);
+
+static void BM_ErrorPathResult(benchmark::State &state) {
+    const auto raw = readRegistersFrame(16);
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto response = ModbusResponse::tryFromRawCRC(raw.data(), raw.size() - 1);
+        benchmark::DoNotOptimize(response);
+    }
+}
+BENCHMARK(BM_ErrorPathResult);
+
+/*
+ * RTU frame arriving in chunks of range(1) bytes, parse is retried after
+ * every chunk like Serial::Connection::awaitResponse does.
+ */
+static void BM_PartialFrameThrow(benchmark::State &state) {
+    const auto raw   = readRegistersFrame(state.range(0));
+    const auto chunk = static_cast<std::size_t>(state.range(1));
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        for (std::size_t size = chunk;; size = std::min(size + chunk, raw.size())) {
+            try {
+                auto response = ModbusResponse::fromRawCRC(raw.data(), size);
+                benchmark::DoNotOptimize(response);
+                break;
+            } catch (const ModbusException &) {
+            }
+        }
+    }
+}
+BENCHMARK(BM_PartialFrameThrow)->Args({16, 1})->Args({125, 1})->Args({125, 16});
+
+static void BM_PartialFrameResult(benchmark::State &state) {
+    const auto raw   = readRegistersFrame(state.range(0));
+    const auto chunk = static_cast<std::size_t>(state.range(1));
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        for (std::size_t size = chunk;; size = std::min(size + chunk, raw.size())) {
+            auto response = ModbusResponse::tryFromRawCRC(raw.data(), size);
+            if (response) {
+                benchmark::DoNotOptimize(response);
+                break;
+            }
+        }
+    }
+}
+BENCHMARK(BM_PartialFrameResult)->Args({16, 1})->Args({125, 1})->Args({125, 16});
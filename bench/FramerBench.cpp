@@ -0,0 +1,112 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "allocCounter.hpp"
+
+#include "MB/modbusCrc.hpp"
+#include "MB/modbusFraming.hpp"
+#include "MB/modbusMbapFramer.hpp"
+#include "MB/modbusResponse.hpp"
+#include "MB/modbusRtuFramer.hpp"
+#include "MB/modbusUtils.hpp"
+
+using namespace MB;
+using MB::bench::AllocationScope;
+
+namespace {
+std::vector<uint8_t> readRegistersFrame(uint16_t count) {
+    std::vector<uint8_t> raw = {0x11, utils::ReadAnalogOutputHoldingRegisters,
+                                static_cast<uint8_t>(count * 2)};
+    for (uint16_t i = 0; i < count; i++)
+        utils::pushUint16(raw, i * 7);
+    const auto crc = utils::crc16(raw);
+    raw.push_back(static_cast<uint8_t>(crc & 0xFF));
+    raw.push_back(static_cast<uint8_t>(crc >> 8));
+    return raw;
+}
+} // namespace
+
+/*
+ * RTU response arriving in chunks of range(1) bytes. Baseline retries whole
+ * parse after every chunk, framer looks at every byte once.
+ */
+static void BM_RtuReparse(benchmark::State &state) {
+    const auto raw   = readRegistersFrame(state.range(0));
+    const auto chunk = static_cast<std::size_t>(state.range(1));
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        for (std::size_t size = chunk;; size = std::min(size + chunk, raw.size())) {
+            auto view = ModbusResponseView::tryFromRawCRC(raw.data(), size);
+            if (view) {
+                benchmark::DoNotOptimize(view);
+                break;
+            }
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * raw.size());
+}
+BENCHMARK(BM_RtuReparse)->Args({16, 1})->Args({125, 1})->Args({125, 16});
+
+static void BM_RtuFramer(benchmark::State &state) {
+    const auto raw   = readRegistersFrame(state.range(0));
+    const auto chunk = static_cast<std::size_t>(state.range(1));
+    RtuFramer framer(RtuFramer::Responses);
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        for (std::size_t pos = 0; pos < raw.size(); pos += chunk) {
+            framer.feed(raw.data() + pos, std::min(chunk, raw.size() - pos),
+                        [](const uint8_t *frame, std::size_t size) {
+                            auto view = ModbusResponseView::tryFromRaw(frame, size - 2);
+                            benchmark::DoNotOptimize(view);
+                        });
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * raw.size());
+}
+BENCHMARK(BM_RtuFramer)->Args({16, 1})->Args({125, 1})->Args({125, 16});
+
+// Many back to back frames delivered by single read
+static void BM_RtuFramerBurst(benchmark::State &state) {
+    std::vector<uint8_t> stream;
+    for (int i = 0; i < state.range(0); i++) {
+        const auto raw = readRegistersFrame(10);
+        stream.insert(stream.end(), raw.begin(), raw.end());
+    }
+    RtuFramer framer(RtuFramer::Responses);
+    std::size_t frames = 0;
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        framer.feed(stream.data(), stream.size(),
+                    [&](const uint8_t *, std::size_t) { frames++; });
+    }
+    benchmark::DoNotOptimize(frames);
+    state.SetBytesProcessed(state.iterations() * stream.size());
+}
+BENCHMARK(BM_RtuFramerBurst)->Arg(16);
+
+/*
+ * range(0) MBAP responses delivered by single recv(), each frame is cut out
+ * and parsed in place.
+ */
+static void BM_MbapFramerBurst(benchmark::State &state) {
+    std::vector<uint8_t> stream;
+    for (int i = 0; i < state.range(0); i++) {
+        const auto rtu = readRegistersFrame(10);
+        const auto pdu = ModbusResponseView::tryFromRawCRC(rtu.data(), rtu.size());
+        ModbusResponse response(pdu.value());
+        appendTCP(response, static_cast<uint16_t>(i), stream);
+    }
+    MbapFramer framer;
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        framer.feed(stream.data(), stream.size());
+        while (auto frame = framer.next()) {
+            auto view = ModbusResponseView::tryFromRaw(frame->pdu(), frame->pduSize());
+            benchmark::DoNotOptimize(view);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * stream.size());
+}
+BENCHMARK(BM_MbapFramerBurst)->Arg(1)->Arg(16);
@@ -0,0 +1,150 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// End to end transport benchmarks against simulated slave, see loopback.hpp.
+// Arguments are function code and number of registers (or coils), open loop
+// benchmarks also take the offered load in transactions per second.
+//
+// Closed loop sends next request as soon as previous response arrives.
+// Open loop schedules requests at fixed rate and measures latency from the
+// scheduled send time, so a slow transaction also delays (and is charged to)
+// the requests queued behind it, as it would be with a real poller.
+
+#include <benchmark/benchmark.h>
+
+#include <thread>
+
+#include "loopback.hpp"
+
+using namespace MB;
+using namespace MB::bench;
+
+namespace {
+constexpr uint8_t SlaveID = 0x11;
+
+ModbusRequest makeRequest(utils::MBFunctionCode code, uint16_t count) {
+    switch (code) {
+    case utils::MaskWriteRegister:
+        return ModbusRequest::maskWrite(SlaveID, 7, 0xFFF0, 0x0004);
+    case utils::ReadWriteMultipleRegisters:
+        return ModbusRequest::readWriteMultiple(SlaveID, 0, count, 200,
+                                                RegisterBlock(count, 7));
+    default:
+        break;
+    }
+
+    ModbusRequest request(SlaveID, code, 0, count);
+    if (code == utils::WriteSingleDiscreteOutputCoil ||
+        code == utils::WriteMultipleDiscreteOutputCoils)
+        request.setCoils(CoilBitset(count, true));
+    else if (utils::functionType(code) != utils::Read)
+        request.setRegisters(RegisterBlock(count, 7));
+    return request;
+}
+
+ModbusRequest requestFromArgs(const benchmark::State &state) {
+    return makeRequest(static_cast<utils::MBFunctionCode>(state.range(0)),
+                       static_cast<uint16_t>(state.range(1)));
+}
+
+void transportArgs(benchmark::internal::Benchmark *bench) {
+    bench->ArgNames({"fc", "count"});
+    bench->Args({utils::ReadDiscreteOutputCoils, 2000});
+    for (int count : {1, 16, 125})
+        bench->Args({utils::ReadAnalogOutputHoldingRegisters, count});
+    bench->Args({utils::WriteSingleAnalogOutputRegister, 1});
+    bench->Args({utils::WriteMultipleDiscreteOutputCoils, 1968});
+    bench->Args({utils::WriteMultipleAnalogOutputHoldingRegisters, 123});
+    bench->Args({utils::MaskWriteRegister, 1});
+    bench->Args({utils::ReadWriteMultipleRegisters, 121});
+    bench->UseRealTime();
+}
+
+// Serial transactions take tens of milliseconds, fewer cases and iterations
+void serialArgs(benchmark::internal::Benchmark *bench) {
+    bench->ArgNames({"fc", "count"});
+    bench->Args({utils::ReadAnalogOutputHoldingRegisters, 1});
+    bench->Args({utils::ReadAnalogOutputHoldingRegisters, 125});
+    bench->Args({utils::WriteMultipleAnalogOutputHoldingRegisters, 123});
+    bench->Iterations(100)->UseRealTime();
+}
+
+void openLoopArgs(benchmark::internal::Benchmark *bench) {
+    bench->ArgNames({"fc", "count", "rate"});
+    for (int rate : {1000, 10000}) {
+        bench->Args({utils::ReadAnalogOutputHoldingRegisters, 16, rate});
+        bench->Args({utils::WriteMultipleAnalogOutputHoldingRegisters, 123, rate});
+    }
+    bench->UseRealTime();
+}
+
+template <typename Transport, typename... Options>
+void closedLoop(benchmark::State &state, Options... options) {
+    Transport loopback(options...);
+    const auto request = requestFromArgs(state);
+    LatencyRecorder latency;
+    for (auto _ : state) {
+        const auto start = std::chrono::steady_clock::now();
+        auto response    = loopback.transact(request);
+        latency.add(std::chrono::steady_clock::now() - start);
+        benchmark::DoNotOptimize(response);
+    }
+    latency.report(state);
+}
+
+// Sleeps most of the time, spins the rest, timer wake up is late by tens of us
+void waitUntil(std::chrono::steady_clock::time_point time) {
+    std::this_thread::sleep_until(time - std::chrono::microseconds(200));
+    while (std::chrono::steady_clock::now() < time) {
+    }
+}
+
+template <typename Transport>
+void openLoop(benchmark::State &state) {
+    Transport loopback;
+    const auto request = requestFromArgs(state);
+    const auto interval =
+        std::chrono::nanoseconds(std::chrono::seconds(1)) / state.range(2);
+    LatencyRecorder latency;
+
+    auto scheduled = std::chrono::steady_clock::now();
+    for (auto _ : state) {
+        waitUntil(scheduled);
+        auto response = loopback.transact(request);
+        latency.add(std::chrono::steady_clock::now() - scheduled);
+        benchmark::DoNotOptimize(response);
+        scheduled += interval;
+    }
+    latency.report(state);
+}
+} // namespace
+
+static void BM_LoopbackTcpClosed(benchmark::State &state) {
+    closedLoop<TcpLoopback>(state);
+}
+BENCHMARK(BM_LoopbackTcpClosed)->Apply(transportArgs);
+
+static void BM_LoopbackTcpServerClosed(benchmark::State &state) {
+    closedLoop<TcpServerLoopback>(state);
+}
+BENCHMARK(BM_LoopbackTcpServerClosed)->Apply(transportArgs);
+
+static void BM_LoopbackRtuClosed(benchmark::State &state) {
+    closedLoop<RtuLoopback>(state, RtuLoopback::Framed);
+}
+BENCHMARK(BM_LoopbackRtuClosed)->Apply(serialArgs);
+
+// sendRequest with expected length, goes through readRawMessage
+static void BM_LoopbackRtuLegacyClosed(benchmark::State &state) {
+    closedLoop<RtuLoopback>(state, RtuLoopback::Legacy);
+}
+BENCHMARK(BM_LoopbackRtuLegacyClosed)->Apply(serialArgs);
+
+static void BM_LoopbackTcpOpen(benchmark::State &state) { openLoop<TcpLoopback>(state); }
+BENCHMARK(BM_LoopbackTcpOpen)->Apply(openLoopArgs);
+
+static void BM_LoopbackTcpServerOpen(benchmark::State &state) {
+    openLoop<TcpServerLoopback>(state);
+}
+BENCHMARK(BM_LoopbackTcpServerOpen)->Apply(openLoopArgs);
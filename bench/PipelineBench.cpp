@@ -0,0 +1,107 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Polling cycle of 64 registers reads through gateway that takes 200 us to
+// answer each request, one request at a time versus pipelined with growing
+// window. Argument is the window, 0 means plain TCP::Connection.
+//
+// BM_PipelineSyscalls runs cycle of 50 reads over 127.0.0.1 with one write
+// per request versus batched writes, counting socket syscalls of the polling
+// thread.
+
+#include <benchmark/benchmark.h>
+
+#include "MB/TCP/pipelinedClient.hpp"
+#include "loopback.hpp"
+#include "syscallCounter.hpp"
+
+using namespace MB;
+
+namespace {
+constexpr std::size_t CycleRequests = 64;
+constexpr auto GatewayLatency       = std::chrono::microseconds(200);
+
+std::vector<ModbusRequest> pollingCycle(std::size_t size = CycleRequests) {
+    std::vector<ModbusRequest> requests;
+    for (uint16_t i = 0; i < size; i++)
+        requests.emplace_back(1, utils::ReadAnalogOutputHoldingRegisters, i * 16, 16);
+    return requests;
+}
+
+//! Pipelined cycle with one write per request, as before batched sends
+Status transactUnbatched(TCP::PipelinedClient &client,
+                         const std::vector<ModbusRequest> &requests) {
+    std::size_t sent = 0, completed = 0;
+    while (completed < requests.size()) {
+        while (sent < requests.size() && client.send(requests[sent]))
+            sent++;
+        const auto completion = client.receive();
+        if (!completion)
+            return completion.error();
+        benchmark::DoNotOptimize(completion);
+        completed++;
+    }
+    return {};
+}
+
+void reportCycles(benchmark::State &state, std::size_t cycleRequests = CycleRequests) {
+    const auto transactions = static_cast<double>(state.iterations() * cycleRequests);
+    state.counters["tx/s"] =
+        benchmark::Counter(transactions, benchmark::Counter::kIsRate);
+}
+} // namespace
+
+static void BM_PipelineCycle(benchmark::State &state) {
+    const auto window   = static_cast<std::size_t>(state.range(0));
+    const auto requests = pollingCycle();
+    bench::TcpLoopback loopback(GatewayLatency);
+
+    if (window == 0) {
+        for (auto _ : state)
+            for (const auto &request : requests)
+                benchmark::DoNotOptimize(loopback.transact(request));
+    } else {
+        TCP::PipelinedClient client(std::move(loopback.client()), window);
+        for (auto _ : state) {
+            const auto status =
+                client.transact(requests.data(), requests.size(),
+                                [](std::size_t, Result<ModbusResponse> response) {
+                                    benchmark::DoNotOptimize(response);
+                                });
+            if (!status)
+                state.SkipWithError("connection failed");
+        }
+    }
+    reportCycles(state);
+}
+BENCHMARK(BM_PipelineCycle)->Arg(0)->Arg(1)->Arg(4)->Arg(8)->Arg(16)->UseRealTime();
+
+static void BM_PipelineSyscalls(benchmark::State &state) {
+    const bool batched  = state.range(0) != 0;
+    const auto window   = static_cast<std::size_t>(state.range(1));
+    const auto requests = pollingCycle(50);
+    bench::TcpServerLoopback loopback(TCP::SocketOptions::lowLatency());
+    TCP::PipelinedClient client(std::move(loopback.client()), window);
+    const auto onResponse = [](std::size_t, Result<ModbusResponse> response) {
+        benchmark::DoNotOptimize(response);
+    };
+
+    {
+        bench::SyscallScope syscalls(state, requests.size());
+        for (auto _ : state) {
+            const auto status =
+                batched ? client.transact(requests.data(), requests.size(), onResponse)
+                        : transactUnbatched(client, requests);
+            if (!status) {
+                state.SkipWithError("connection failed");
+                break;
+            }
+        }
+    }
+    reportCycles(state, requests.size());
+}
+BENCHMARK(BM_PipelineSyscalls)
+    ->ArgNames({"batched", "window"})
+    ->ArgsProduct({{0, 1}, {16, 50}})
+    ->UseRealTime();
@@ -0,0 +1,102 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Read coalescing on the parameter table of Voegtlin GSC flow controllers
+// (MB::Params) and on large scattered point maps. "reads" is the number of
+// requests of the plan, "saved" the requests saved against one read per
+// point.
+
+#include <benchmark/benchmark.h>
+
+#include "MB/modbusReadPlanner.hpp"
+#include "MB/modbusVoegtlin.hpp"
+#include "allocCounter.hpp"
+#include "loopback.hpp"
+
+using namespace MB;
+using MB::bench::AllocationScope;
+
+namespace {
+//! Every parameter of the table as one range of holding registers
+std::vector<ReadPoint> voegtlinPoints() {
+    std::vector<ReadPoint> points;
+    for (const auto &[address, param] : Params) {
+        const auto bytes = getNumBytesFromDataType(param.type);
+        points.push_back({247, utils::ReadAnalogOutputHoldingRegisters, address,
+                          static_cast<uint16_t>((bytes + 1) / 2)});
+    }
+    return points;
+}
+
+//! `count` points of 1 - 4 registers over 4 units, in 4000 registers each
+std::vector<ReadPoint> scatteredPoints(std::size_t count) {
+    std::vector<ReadPoint> points;
+    uint32_t seed = 12345;
+    const auto next = [&seed] {
+        seed = seed * 1103515245 + 12345;
+        return seed >> 8;
+    };
+    for (std::size_t i = 0; i < count; i++)
+        points.push_back({static_cast<uint8_t>(1 + next() % 4),
+                          utils::ReadAnalogOutputHoldingRegisters,
+                          static_cast<uint16_t>(next() % 4000),
+                          static_cast<uint16_t>(1 + next() % 4)});
+    return points;
+}
+
+ReadPlanner planner(int64_t gap) {
+    ReadLimits limits;
+    limits.registerGap = static_cast<uint16_t>(gap);
+    return ReadPlanner(limits);
+}
+
+void reportPlan(benchmark::State &state, const ReadPlan &plan) {
+    state.counters["points"] = static_cast<double>(plan.points());
+    state.counters["reads"]  = static_cast<double>(plan.reads().size());
+    state.counters["saved"]  = static_cast<double>(plan.points() - plan.reads().size());
+}
+} // namespace
+
+static void BM_ReadPlanVoegtlin(benchmark::State &state) {
+    const auto points  = voegtlinPoints();
+    const auto planner = ::planner(state.range(0));
+    AllocationScope allocs(state);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(planner.plan(points));
+    reportPlan(state, planner.plan(points));
+}
+BENCHMARK(BM_ReadPlanVoegtlin)->ArgName("gap")->Arg(0)->Arg(4)->Arg(16)->Arg(64);
+
+static void BM_ReadPlanScattered(benchmark::State &state) {
+    const auto points  = scatteredPoints(static_cast<std::size_t>(state.range(0)));
+    const auto planner = ::planner(16);
+    AllocationScope allocs(state);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(planner.plan(points));
+    reportPlan(state, planner.plan(points));
+}
+BENCHMARK(BM_ReadPlanScattered)->ArgName("points")->Arg(100)->Arg(1000);
+
+// One scan of the whole table over TCP socketpair, one read per parameter
+// (planned:0) versus planned reads with default limits (planned:1)
+static void BM_ReadPlanScan(benchmark::State &state) {
+    const auto points = voegtlinPoints();
+    const auto plan   = ReadPlanner().plan(points);
+    std::vector<ModbusRequest> requests;
+    if (state.range(0) != 0)
+        requests = plan.requests();
+    else
+        for (const auto &point : points)
+            requests.emplace_back(point.unit, point.table, point.address, point.count);
+
+    bench::TcpLoopback loopback;
+    for (auto _ : state)
+        for (const auto &request : requests)
+            benchmark::DoNotOptimize(loopback.transact(request));
+
+    state.counters["tx/scan"] = static_cast<double>(requests.size());
+    state.counters["scans/s"] = benchmark::Counter(
+        static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_ReadPlanScan)->ArgName("planned")->Arg(0)->Arg(1)->UseRealTime();
@@ -0,0 +1,94 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// PollEngine with typical rate groups over TCP (TcpServerLoopback) and RTU
+// (RtuLoopback) connections. Every iteration polls for 200 ms of real time.
+//
+// Argument 0 drives the engine from the benchmark thread (runUntil), so
+// transactions of both connections are serialized and RTU transactions hold
+// back the fast TCP group. Argument 1 starts worker per connection.
+
+#include <benchmark/benchmark.h>
+
+#include "MB/Poll/pollEngine.hpp"
+#include "allocCounter.hpp"
+#include "loopback.hpp"
+
+using namespace MB;
+using namespace std::chrono_literals;
+using MB::bench::AllocationScope;
+
+namespace {
+constexpr auto Window = 200ms;
+
+std::vector<Poll::Point> points(std::size_t count, uint16_t address,
+                                Poll::PointType type = Poll::U16) {
+    std::vector<Poll::Point> points(count);
+    for (auto &point : points) {
+        point.name    = "p" + std::to_string(address);
+        point.address = address;
+        point.type    = type;
+        address += Poll::pointSize(type);
+    }
+    return points;
+}
+
+double microseconds(Poll::Clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+} // namespace
+
+static void BM_PollEngine(benchmark::State &state) {
+    const bool workers = state.range(0) != 0;
+    bench::TcpServerLoopback tcp(TCP::SocketOptions::lowLatency());
+    bench::RtuLoopback rtu;
+
+    Poll::PollEngine engine;
+    const auto tcpConnection = engine.addConnection(tcp.client());
+    const auto rtuConnection = engine.addConnection(rtu.client());
+    const Poll::PollEngine::GroupId groups[] = {
+        engine.addGroup(tcpConnection, 1ms, points(4, 0)),
+        engine.addGroup(tcpConnection, 10ms, points(16, 100, Poll::F32)),
+        engine.addGroup(tcpConnection, 100ms, points(64, 200)),
+        engine.addGroup(rtuConnection, 100ms, points(4, 0, Poll::U32))};
+
+    // Warm up, buffers and heaps grow to their final size
+    engine.runUntil(Poll::Clock::now() + 20ms);
+
+    if (workers)
+        engine.start();
+    {
+        AllocationScope allocs(state);
+        for (auto _ : state) {
+            if (workers)
+                std::this_thread::sleep_for(Window);
+            else
+                engine.runUntil(Poll::Clock::now() + Window);
+        }
+    }
+    engine.stop();
+
+    uint64_t transactions = 0;
+    uint64_t misses       = 0;
+    for (const auto group : groups) {
+        const auto stats = engine.stats(group);
+        transactions += stats.transactions;
+        misses += stats.deadlineMisses;
+    }
+    const auto fast = engine.stats(groups[0]);
+
+    state.counters["tx/s"] = benchmark::Counter(static_cast<double>(transactions),
+                                                benchmark::Counter::kIsRate);
+    state.counters["misses/op"] = benchmark::Counter(static_cast<double>(misses),
+                                                     benchmark::Counter::kAvgIterations);
+    state.counters["1ms_jitter_max_us"]  = microseconds(fast.maxJitter);
+    state.counters["1ms_jitter_mean_us"] = microseconds(fast.meanJitter);
+    state.SetLabel(workers ? "workers" : "caller");
+}
+BENCHMARK(BM_PollEngine)
+    ->ArgName("workers")
+    ->Arg(0)
+    ->Arg(1)
+    ->UseRealTime()
+    ->Iterations(5);
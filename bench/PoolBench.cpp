@@ -0,0 +1,42 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Per transaction frame buffers: heap allocated vectors versus pooled
+// frame buffers.
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "MB/modbusBufferPool.hpp"
+#include "allocCounter.hpp"
+
+using namespace MB;
+using MB::bench::AllocationScope;
+
+namespace {
+constexpr uint8_t Frame[] = {0x11, 0x03, 0x06, 0xAE, 0x41, 0x56,
+                             0x52, 0x43, 0x40, 0x49, 0xAD};
+} // namespace
+
+static void BM_FrameVector(benchmark::State &state) {
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        std::vector<uint8_t> raw(Frame, Frame + sizeof(Frame));
+        benchmark::DoNotOptimize(raw.data());
+    }
+}
+BENCHMARK(BM_FrameVector);
+
+static void BM_FramePooled(benchmark::State &state) {
+    FrameBufferPool pool;
+    pool.reserve(1);
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto raw = pool.acquire();
+        raw.assign(Frame, sizeof(Frame));
+        benchmark::DoNotOptimize(raw.data());
+    }
+}
+BENCHMARK(BM_FramePooled);
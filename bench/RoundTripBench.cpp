@@ -0,0 +1,117 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Read-modify-write sequences against simulated device over local socket.
+// Besides wall time every benchmark reports number of transactions, bytes on
+// the wire and time the same RTU frames would occupy 9600 baud bus.
+
+#include <benchmark/benchmark.h>
+
+#include "loopback.hpp"
+
+using namespace MB;
+
+namespace {
+constexpr uint8_t SlaveID = 0x11;
+
+// 8N1 plus 1 stop bit, 3.5 character silence between frames
+double rtuBusMilliseconds(std::size_t frameSize) {
+    return (static_cast<double>(frameSize) + 3.5) * 11 * 1000 / 9600;
+}
+
+//! Client connected to simulated device, counts what went over the wire
+class Loopback {
+  private:
+    bench::TcpLoopback _transport;
+
+    std::size_t _transactions = 0;
+    std::size_t _wireBytes    = 0;
+    double _busMilliseconds   = 0;
+
+  public:
+    ModbusResponse transact(const ModbusRequest &request) {
+        auto response = _transport.transact(request);
+
+        const auto requestSize  = request.encodedSize() + 2;
+        const auto responseSize = response.encodedSize() + 2;
+        _transactions++;
+        _wireBytes += requestSize + responseSize;
+        _busMilliseconds +=
+            rtuBusMilliseconds(requestSize) + rtuBusMilliseconds(responseSize);
+        return response;
+    }
+
+    void report(benchmark::State &state) const {
+        const auto avg = benchmark::Counter::kAvgIterations;
+        state.counters["transactions/op"] =
+            benchmark::Counter(static_cast<double>(_transactions), avg);
+        state.counters["wire_bytes/op"] =
+            benchmark::Counter(static_cast<double>(_wireBytes), avg);
+        state.counters["bus_ms_9600/op"] = benchmark::Counter(_busMilliseconds, avg);
+    }
+};
+
+RegisterBlock incremented(const RegisterBlock &values) {
+    RegisterBlock result = values;
+    for (std::size_t i = 0; i < result.size(); i++)
+        result[i]++;
+    return result;
+}
+} // namespace
+
+// Read range(0) registers, write them back modified: FC3 followed by FC16
+static void BM_ReadModifyWriteFC3FC16(benchmark::State &state) {
+    const auto count = static_cast<uint16_t>(state.range(0));
+    Loopback loopback;
+    for (auto _ : state) {
+        const auto read = loopback.transact(
+            ModbusRequest(SlaveID, utils::ReadAnalogOutputHoldingRegisters, 0, count));
+
+        ModbusRequest write(SlaveID, utils::WriteMultipleAnalogOutputHoldingRegisters, 0,
+                            count);
+        write.setRegisters(incremented(read.registers()));
+        loopback.transact(write);
+    }
+    loopback.report(state);
+}
+BENCHMARK(BM_ReadModifyWriteFC3FC16)->Arg(4)->Arg(60);
+
+// Same data flow in single transaction: write of the previous values is
+// combined with the next read (FC23)
+static void BM_ReadModifyWriteFC23(benchmark::State &state) {
+    const auto count = static_cast<uint16_t>(state.range(0));
+    Loopback loopback;
+    RegisterBlock values;
+    values.resize(count);
+    for (auto _ : state) {
+        const auto response = loopback.transact(
+            ModbusRequest::readWriteMultiple(SlaveID, 0, count, 0, incremented(values)));
+        values = response.registers();
+    }
+    loopback.report(state);
+}
+BENCHMARK(BM_ReadModifyWriteFC23)->Arg(4)->Arg(60);
+
+// Set single bit in a register: FC3 + FC6
+static void BM_SetBitFC3FC6(benchmark::State &state) {
+    Loopback loopback;
+    for (auto _ : state) {
+        const auto read = loopback.transact(
+            ModbusRequest(SlaveID, utils::ReadAnalogOutputHoldingRegisters, 7, 1));
+
+        ModbusRequest write(SlaveID, utils::WriteSingleAnalogOutputRegister, 7, 1);
+        write.setRegisters({static_cast<uint16_t>(read.registers()[0] | 0x0004)});
+        loopback.transact(write);
+    }
+    loopback.report(state);
+}
+BENCHMARK(BM_SetBitFC3FC6);
+
+static void BM_SetBitFC22(benchmark::State &state) {
+    Loopback loopback;
+    for (auto _ : state)
+        loopback.transact(ModbusRequest::maskWrite(SlaveID, 7, 0xFFFF, 0x0004));
+    loopback.report(state);
+}
+BENCHMARK(BM_SetBitFC22);
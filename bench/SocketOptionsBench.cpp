@@ -0,0 +1,101 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Latency of TCP socket options over 127.0.0.1 (TcpServerLoopback, options
+// are applied on both sides). Argument selects the options, see Profiles.
+//
+// Closed loop sends one request at a time, where Nagle has nothing to hold
+// back. Pipelined keeps 4 requests in flight, so requests and responses
+// queue behind unacknowledged ones, which is where Nagle and delayed acks
+// cost the most.
+
+#include <benchmark/benchmark.h>
+
+#include "MB/TCP/pipelinedClient.hpp"
+#include "loopback.hpp"
+
+using namespace MB;
+using namespace MB::bench;
+
+namespace {
+constexpr std::size_t Window = 4;
+constexpr std::size_t Batch  = 16;
+
+const char *const Profiles[] = {"plain",    "noDelay",    "quickAck",  "keepAlive",
+                                "busyPoll", "lowLatency", "throughput"};
+
+TCP::SocketOptions profile(int64_t index) {
+    TCP::SocketOptions options;
+    switch (index) {
+    case 1:
+        options.noDelay = true;
+        break;
+    case 2:
+        options.quickAck = true;
+        break;
+    case 3:
+        options.keepAlive = true;
+        break;
+    case 4:
+        options.busyPoll = std::chrono::microseconds(50);
+        break;
+    case 5:
+        return TCP::SocketOptions::lowLatency();
+    case 6:
+        return TCP::SocketOptions::throughput();
+    default:
+        break;
+    }
+    return options;
+}
+
+void profileArgs(benchmark::internal::Benchmark *bench) {
+    bench->ArgName("profile");
+    for (int64_t index = 0; index < static_cast<int64_t>(std::size(Profiles)); index++)
+        bench->Arg(index);
+    bench->UseRealTime();
+}
+
+const ModbusRequest Request(1, utils::ReadAnalogOutputHoldingRegisters, 0, 16);
+} // namespace
+
+static void BM_SocketOptionsClosed(benchmark::State &state) {
+    TcpServerLoopback loopback(profile(state.range(0)));
+    LatencyRecorder latency;
+
+    for (auto _ : state) {
+        const auto start = std::chrono::steady_clock::now();
+        benchmark::DoNotOptimize(loopback.transact(Request));
+        latency.add(std::chrono::steady_clock::now() - start);
+    }
+    latency.report(state);
+    state.SetLabel(Profiles[state.range(0)]);
+}
+BENCHMARK(BM_SocketOptionsClosed)->Apply(profileArgs);
+
+// Latency percentiles are per batch of 16 requests, tx/s counts requests
+static void BM_SocketOptionsPipelined(benchmark::State &state) {
+    TcpServerLoopback loopback(profile(state.range(0)));
+    TCP::PipelinedClient client(std::move(loopback.client()), Window);
+    const std::vector<ModbusRequest> requests(Batch, Request);
+    LatencyRecorder latency;
+    const auto onResponse = [](std::size_t, Result<ModbusResponse> response) {
+        benchmark::DoNotOptimize(response);
+    };
+
+    for (auto _ : state) {
+        const auto start  = std::chrono::steady_clock::now();
+        const auto status = client.transact(requests.data(), requests.size(), onResponse);
+        if (!status) {
+            state.SkipWithError("connection failed");
+            break;
+        }
+        latency.add(std::chrono::steady_clock::now() - start);
+    }
+    latency.report(state);
+    state.counters["tx/s"] = benchmark::Counter(
+        static_cast<double>(state.iterations() * Batch), benchmark::Counter::kIsRate);
+    state.SetLabel(Profiles[state.range(0)]);
+}
+BENCHMARK(BM_SocketOptionsPipelined)->Apply(profileArgs);
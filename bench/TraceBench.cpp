@@ -0,0 +1,106 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Cost of tracing single frame: text formatting versus binary record.
+
+#include <benchmark/benchmark.h>
+
+#include "MB/modbusRequest.hpp"
+#include "MB/modbusTrace.hpp"
+#include "allocCounter.hpp"
+
+using namespace MB;
+using MB::bench::AllocationScope;
+
+namespace {
+ModbusRequest writeRequest() {
+    ModbusRequest request(0x11, utils::WriteMultipleAnalogOutputHoldingRegisters, 0, 16);
+    RegisterBlock values;
+    values.resize(16);
+    request.setRegisters(values);
+    return request;
+}
+} // namespace
+
+static void BM_TraceToString(benchmark::State &state) {
+    const auto request = writeRequest();
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto text = request.toString();
+        benchmark::DoNotOptimize(text);
+    }
+}
+BENCHMARK(BM_TraceToString);
+
+static void BM_TraceFormatTo(benchmark::State &state) {
+    const auto request = writeRequest();
+    char buffer[ModbusRequest::MaxStringSize + 1];
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto size = request.formatTo(buffer, sizeof(buffer));
+        benchmark::DoNotOptimize(size);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_TraceFormatTo);
+
+// Recording thread only, ring is drained outside of measured time
+static void BM_TraceRecord(benchmark::State &state) {
+    const auto raw = writeRequest().toRaw();
+    TraceSink sink(4096);
+    std::size_t pending = 0;
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        sink.record(TraceDirection::Tx, raw.data(), raw.size());
+        if (++pending == 4096) {
+            state.PauseTiming();
+            sink.drain([](const TraceRecord &) {});
+            pending = 0;
+            state.ResumeTiming();
+        }
+    }
+    state.counters["dropped"] = static_cast<double>(sink.dropped());
+}
+BENCHMARK(BM_TraceRecord);
+
+// Thread alternating between two sinks, e.g. TCP and Serial connection
+static void BM_TraceRecordTwoSinks(benchmark::State &state) {
+    const auto raw = writeRequest().toRaw();
+    TraceSink first(4096);
+    TraceSink second(4096);
+    std::size_t pending = 0;
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto &sink = pending % 2 ? second : first;
+        sink.record(TraceDirection::Tx, raw.data(), raw.size());
+        if (++pending == 4096) {
+            state.PauseTiming();
+            first.drain([](const TraceRecord &) {});
+            second.drain([](const TraceRecord &) {});
+            pending = 0;
+            state.ResumeTiming();
+        }
+    }
+    state.counters["dropped"] =
+        static_cast<double>(first.dropped() + second.dropped());
+}
+BENCHMARK(BM_TraceRecordTwoSinks);
+
+// Reader side rendering of one record
+static void BM_TraceFormatRecord(benchmark::State &state) {
+    const auto raw = writeRequest().toRaw();
+    TraceSink sink;
+    sink.record(TraceDirection::Tx, raw.data(), raw.size());
+    TraceRecord record{};
+    sink.drain([&](const TraceRecord &r) { record = r; });
+
+    char buffer[MaxTraceStringSize + 1];
+    AllocationScope allocs(state);
+    for (auto _ : state) {
+        auto size = formatTo(record, buffer, sizeof(buffer));
+        benchmark::DoNotOptimize(size);
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_TraceFormatRecord);
@@ -0,0 +1,82 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Modbus/UDP against Modbus/TCP over 127.0.0.1, both served by the library
+// server with simulated slave. Argument udp:0 is TCP, udp:1 is UDP.
+//
+// BM_TransportRoundTrip reads 16 registers one transaction at a time.
+// BM_TransportCycle runs polling cycle of 50 reads of 16 registers, all in
+// flight at once: TCP pipelined with batched writes, UDP batched by
+// sendmmsg / recvmmsg on both sides. Syscalls of the polling thread are
+// counted per transaction.
+
+#include <benchmark/benchmark.h>
+
+#include "MB/TCP/pipelinedClient.hpp"
+#include "loopback.hpp"
+#include "syscallCounter.hpp"
+
+using namespace MB;
+
+namespace {
+constexpr std::size_t CycleRequests = 50;
+
+const ModbusRequest Read16(1, utils::ReadAnalogOutputHoldingRegisters, 0, 16);
+
+template <typename Transport> void roundTrip(benchmark::State &state) {
+    Transport loopback;
+    bench::LatencyRecorder latency;
+    for (auto _ : state) {
+        const auto start = std::chrono::steady_clock::now();
+        auto response    = loopback.transact(Read16);
+        latency.add(std::chrono::steady_clock::now() - start);
+        benchmark::DoNotOptimize(response);
+    }
+    latency.report(state);
+}
+
+template <typename Client>
+void cycle(benchmark::State &state, Client &client,
+           const std::vector<ModbusRequest> &requests) {
+    const auto onResponse = [](std::size_t, Result<ModbusResponse> response) {
+        benchmark::DoNotOptimize(response);
+    };
+
+    bench::SyscallScope syscalls(state, requests.size());
+    for (auto _ : state) {
+        if (!client.transact(requests.data(), requests.size(), onResponse)) {
+            state.SkipWithError("transport failed");
+            break;
+        }
+    }
+}
+} // namespace
+
+static void BM_TransportRoundTrip(benchmark::State &state) {
+    if (state.range(0) != 0)
+        roundTrip<bench::UdpLoopback>(state);
+    else
+        roundTrip<bench::TcpServerLoopback>(state);
+}
+BENCHMARK(BM_TransportRoundTrip)->ArgName("udp")->Arg(0)->Arg(1)->UseRealTime();
+
+static void BM_TransportCycle(benchmark::State &state) {
+    std::vector<ModbusRequest> requests;
+    for (uint16_t i = 0; i < CycleRequests; i++)
+        requests.emplace_back(1, utils::ReadAnalogOutputHoldingRegisters, i * 16, 16);
+
+    if (state.range(0) != 0) {
+        bench::UdpLoopback loopback(CycleRequests);
+        cycle(state, loopback.client(), requests);
+    } else {
+        bench::TcpServerLoopback loopback(TCP::SocketOptions::lowLatency());
+        TCP::PipelinedClient client(std::move(loopback.client()), CycleRequests);
+        cycle(state, client, requests);
+    }
+
+    state.counters["tx/s"] =
+        benchmark::Counter(static_cast<double>(state.iterations() * CycleRequests),
+                           benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_TransportCycle)->ArgName("udp")->Arg(0)->Arg(1)->UseRealTime();
@@ -0,0 +1,38 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Global operator new instrumentation, used to report heap allocations per
+// benchmark iteration.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include <benchmark/benchmark.h>
+
+namespace MB::bench {
+//! Number of calls to global operator new since program start
+uint64_t allocationCount() noexcept;
+
+/**
+ * Counts allocations made between construction and report(), and publishes
+ * them as "allocs/op" counter of the benchmark.
+ */
+class AllocationScope {
+  private:
+    benchmark::State &_state;
+    uint64_t _start;
+
+  public:
+    explicit AllocationScope(benchmark::State &state)
+        : _state(state), _start(allocationCount()) {}
+
+    ~AllocationScope() {
+        const auto allocs = allocationCount() - _start;
+        _state.counters["allocs/op"] =
+            benchmark::Counter(static_cast<double>(allocs), benchmark::Counter::kAvgIterations);
+    }
+};
+} // namespace MB::bench
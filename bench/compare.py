@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+# Modbus for c++ <https://github.com/Mazurel/Modbus>
+# Copyright (c) 2020 Mateusz Mazur aka Mazurel
+# Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+"""Compares two Modbus_Bench JSON reports and flags regressions.
+
+Usage: compare.py [--threshold PERCENT] [--filter REGEX] baseline.json current.json
+
+Benchmarks are matched by name. When reports were produced with repetitions,
+the median aggregate is compared, otherwise the single run. A benchmark
+regresses when its time grows by more than the threshold, or when it makes
+more allocations per operation than before. CPU time is compared, except
+for benchmarks measuring real time (transports), where it is wall time.
+Exit status is 1 if any benchmark regressed.
+"""
+
+import argparse
+import json
+import re
+import sys
+
+
+def load(path):
+    """Returns {name: (time in ns, allocs/op or None)} of the report."""
+    with open(path) as report:
+        benchmarks = json.load(report)["benchmarks"]
+
+    scale = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+    singles, medians = {}, {}
+    for bench in benchmarks:
+        if bench.get("error_occurred"):
+            continue
+        name = bench.get("run_name", bench["name"])
+        time = bench["real_time"] if "/real_time" in name else bench["cpu_time"]
+        value = (time * scale[bench.get("time_unit", "ns")], bench.get("allocs/op"))
+        if bench.get("run_type") == "aggregate":
+            if bench.get("aggregate_name") == "median":
+                medians[name] = value
+        else:
+            singles.setdefault(name, value)
+    singles.update(medians)
+    return singles
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed time growth in percent (default 10)")
+    parser.add_argument("--filter", default="",
+                        help="only compare benchmarks matching regex")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+    pattern = re.compile(args.filter)
+
+    regressions = 0
+    width = max((len(name) for name in current), default=10)
+    print(f"{'Benchmark':<{width}} {'Base ns':>10} {'Now ns':>10} {'Change':>8} "
+          f"{'Allocs':>9}")
+    for name, (time, allocs) in current.items():
+        if not pattern.search(name) or name not in baseline:
+            continue
+        baseTime, baseAllocs = baseline[name]
+        change = (time - baseTime) / baseTime * 100 if baseTime else 0.0
+
+        flags = []
+        if change > args.threshold:
+            flags.append("SLOWER")
+        allocText = "-"
+        if allocs is not None and baseAllocs is not None:
+            allocText = f"{baseAllocs:g}->{allocs:g}"
+            if allocs > baseAllocs + 1e-6:
+                flags.append("ALLOCS")
+        if flags:
+            regressions += 1
+
+        print(f"{name:<{width}} {baseTime:>10.1f} {time:>10.1f} {change:>+7.1f}% "
+              f"{allocText:>9} {' '.join(flags)}")
+
+    missing = [name for name in baseline if pattern.search(name) and name not in current]
+    print(f"\n{regressions} regression(s), threshold {args.threshold:g}%, "
+          f"{len(missing)} baseline benchmark(s) not in current report")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
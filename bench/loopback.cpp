@@ -0,0 +1,321 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "loopback.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <fcntl.h>
+#include <poll.h>
+
+#include "MB/modbusFraming.hpp"
+#include "MB/modbusMbapFramer.hpp"
+#include "MB/modbusRtuFramer.hpp"
+
+using namespace MB;
+using namespace MB::bench;
+
+namespace {
+//! Serves requests of TCP connection until it is closed
+void serveTcp(TCP::Connection &connection) {
+    SimulatedDevice device;
+    while (true) {
+        auto request = connection.tryAwaitRequest();
+        if (!request) {
+            if (request.error() == utils::Timeout)
+                continue;
+            break;
+        }
+        connection.sendResponse(device.handle(request.value()));
+    }
+}
+
+//! Answers every request `latency` after it arrived, until the socket is closed
+void serveDelayed(int fd, std::chrono::microseconds latency) {
+    struct Pending {
+        std::chrono::steady_clock::time_point due;
+        std::array<uint8_t, MbapFramer::MaxFrameSize> frame;
+        std::size_t size;
+    };
+
+    SimulatedDevice device;
+    MbapFramer framer;
+    std::deque<Pending> pending; // Same latency for all, so ordered by due time
+
+    while (true) {
+        while (auto frame = framer.next()) {
+            auto request = ModbusRequest::tryFromRaw(frame->pdu(), frame->pduSize());
+            if (!request)
+                continue;
+            auto &reply = pending.emplace_back();
+            reply.due   = std::chrono::steady_clock::now() + latency;
+            reply.size  = encodeTCP(device.handle(request.value()),
+                                    frame->header.transactionID, reply.frame.data(),
+                                    reply.frame.size());
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        while (!pending.empty() && pending.front().due <= now) {
+            ::send(fd, pending.front().frame.data(), pending.front().size, 0);
+            pending.pop_front();
+        }
+
+        timespec timeout{};
+        if (!pending.empty()) {
+            const auto wait = pending.front().due - now;
+            timeout.tv_nsec = std::chrono::nanoseconds(wait).count();
+        }
+        pollfd waiting = {.fd = fd, .events = POLLIN, .revents = 0};
+        if (::ppoll(&waiting, 1, pending.empty() ? nullptr : &timeout, nullptr) <= 0)
+            continue;
+
+        auto *buffer    = framer.writable();
+        const auto size = ::recv(fd, buffer, framer.writableSize(), 0);
+        if (size <= 0)
+            return;
+        framer.commit(static_cast<std::size_t>(size));
+    }
+}
+
+ModbusResponse checked(Result<ModbusResponse> response) {
+    if (!response)
+        MB_THROW(ModbusException(response.error()));
+    return std::move(response).value();
+}
+} // namespace
+
+RegisterBlock SimulatedDevice::readRegisters(uint16_t address, uint16_t count) const {
+    RegisterBlock block;
+    block.resize(count);
+    for (uint16_t i = 0; i < count; i++)
+        block[i] = _registers[(address + i) % _registers.size()];
+    return block;
+}
+
+CoilBitset SimulatedDevice::readCoils(uint16_t address, uint16_t count) const {
+    CoilBitset coils(count);
+    for (uint16_t i = 0; i < count; i++)
+        coils.set(i, _coils[(address + i) % _coils.size()]);
+    return coils;
+}
+
+void SimulatedDevice::writeRegisters(uint16_t address, const RegisterBlock &values) {
+    for (std::size_t i = 0; i < values.size(); i++)
+        _registers[(address + i) % _registers.size()] = values[i];
+}
+
+void SimulatedDevice::writeCoils(uint16_t address, const CoilBitset &values) {
+    for (std::size_t i = 0; i < values.size(); i++)
+        _coils[(address + i) % _coils.size()] = values[i];
+}
+
+ModbusResponse SimulatedDevice::handle(const ModbusRequest &request) {
+    const auto address = request.registerAddress();
+    const auto count   = request.numberOfRegisters();
+    ModbusResponse response(request.slaveID(), request.functionCode(), address, count);
+
+    switch (request.functionCode()) {
+    case utils::ReadDiscreteOutputCoils:
+    case utils::ReadDiscreteInputContacts:
+        response.setCoils(readCoils(address, count));
+        break;
+    case utils::ReadAnalogOutputHoldingRegisters:
+    case utils::ReadAnalogInputRegisters:
+        response.setRegisters(readRegisters(address, count));
+        break;
+    case utils::WriteSingleDiscreteOutputCoil:
+    case utils::WriteMultipleDiscreteOutputCoils:
+        writeCoils(address, request.coils());
+        response.setCoils(request.coils());
+        break;
+    case utils::WriteSingleAnalogOutputRegister:
+    case utils::WriteMultipleAnalogOutputHoldingRegisters:
+        writeRegisters(address, request.registers());
+        response.setRegisters(request.registers());
+        break;
+    case utils::MaskWriteRegister: {
+        auto &value = _registers[address % _registers.size()];
+        value       = utils::applyMask(value, request.andMask(), request.orMask());
+        response.from(request);
+        break;
+    }
+    case utils::ReadWriteMultipleRegisters:
+        writeRegisters(request.writeAddress(), request.registers());
+        response.setRegisters(readRegisters(address, count));
+        break;
+    // Files are mapped over holding registers, record number is the address
+    case utils::ReadFileRecord:
+        response.setRegisters(readRegisters(address, count));
+        break;
+    case utils::WriteFileRecord:
+        writeRegisters(address, request.registers());
+        response.from(request);
+        break;
+    default:
+        break;
+    }
+    return response;
+}
+
+double LatencyRecorder::percentile(double fraction) {
+    if (_samples.empty())
+        return 0;
+    const auto rank  = static_cast<std::size_t>(fraction * _samples.size());
+    const auto index = std::min(_samples.size() - 1, rank);
+    std::nth_element(_samples.begin(), _samples.begin() + index, _samples.end());
+    return static_cast<double>(_samples[index]);
+}
+
+void LatencyRecorder::report(benchmark::State &state) {
+    const auto count = static_cast<double>(_samples.size());
+
+    state.counters["tx/s"]    = benchmark::Counter(count, benchmark::Counter::kIsRate);
+    state.counters["p50_us"]  = percentile(0.50) / 1000;
+    state.counters["p99_us"]  = percentile(0.99) / 1000;
+    state.counters["p999_us"] = percentile(0.999) / 1000;
+}
+
+TcpLoopback::TcpLoopback(std::chrono::microseconds latency) {
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+        MB_THROW(std::runtime_error("Cannot create socketpair"));
+
+    _client = TCP::Connection(fds[0]);
+    _device = std::thread([fd = fds[1], latency] {
+        TCP::Connection server(fd);
+        if (latency.count() > 0)
+            serveDelayed(server.getSockfd(), latency);
+        else
+            serveTcp(server);
+    });
+}
+
+TcpLoopback::~TcpLoopback() {
+    if (_client.getSockfd() != -1)
+        ::shutdown(_client.getSockfd(), SHUT_RDWR);
+    _device.join();
+}
+
+ModbusResponse TcpLoopback::transact(const ModbusRequest &request) {
+    _client.sendRequest(request);
+    return checked(_client.tryAwaitResponse());
+}
+
+// Port 0 lets the kernel pick free port
+TcpServerLoopback::TcpServerLoopback(const TCP::SocketOptions &options)
+    : _server(0, options) {
+    sockaddr_in address{};
+    socklen_t size = sizeof(address);
+    ::getsockname(_server.nativeHandle(), reinterpret_cast<sockaddr *>(&address), &size);
+
+    _device = std::thread([this] {
+        auto connection = _server.awaitConnection();
+        if (connection)
+            serveTcp(*connection);
+    });
+    _client = TCP::Connection::with("127.0.0.1", ntohs(address.sin_port), options);
+}
+
+TcpServerLoopback::~TcpServerLoopback() {
+    if (_client.getSockfd() != -1)
+        ::shutdown(_client.getSockfd(), SHUT_RDWR);
+    _device.join();
+}
+
+ModbusResponse TcpServerLoopback::transact(const ModbusRequest &request) {
+    _client.sendRequest(request);
+    return checked(_client.tryAwaitResponse());
+}
+
+UdpLoopback::UdpLoopback(std::size_t window)
+    : _server(0, window),
+      _client(UDP::Client::with("127.0.0.1", _server.port(), window)) {
+    _device = std::thread([this] {
+        SimulatedDevice device;
+        const auto handle = [&](const ModbusRequest &request) {
+            return device.handle(request);
+        };
+        while (!_stop)
+            std::ignore = _server.serve(handle, 50);
+    });
+}
+
+UdpLoopback::~UdpLoopback() {
+    _stop = true;
+    _device.join();
+}
+
+ModbusResponse UdpLoopback::transact(const ModbusRequest &request) {
+    return checked(_client.transact(request));
+}
+
+RtuLoopback::RtuLoopback(Mode mode) : _mode(mode) {
+    _master = ::posix_openpt(O_RDWR | O_NOCTTY);
+    if (_master < 0 || ::grantpt(_master) != 0 || ::unlockpt(_master) != 0)
+        MB_THROW(std::runtime_error("Cannot create pseudo-terminal"));
+
+    _client.open(::ptsname(_master));
+    _client.connect();
+
+    _device = std::thread([this] {
+        SimulatedDevice device;
+        RtuFramer framer(RtuFramer::Requests);
+        std::array<uint8_t, RtuFramer::MaxFrameSize> chunk;
+        std::array<uint8_t, 2 * RtuFramer::MaxFrameSize> reply;
+
+        auto onFrame = [&](const uint8_t *frame, std::size_t size) {
+            auto request = ModbusRequest::tryFromRaw(frame, size - 2);
+            if (!request)
+                return true;
+
+            // Two wire bus: master reads back its own request first
+            std::size_t replySize = 0;
+            if (_mode == Legacy) {
+                std::copy(frame, frame + size, reply.begin());
+                replySize = size;
+            }
+            replySize += encodeRTU(device.handle(request.value()),
+                                   reply.data() + replySize, reply.size() - replySize);
+            std::ignore = ::write(_master, reply.data(), replySize);
+            return true;
+        };
+
+        while (!_stop) {
+            pollfd waiting = {.fd = _master, .events = POLLIN, .revents = 0};
+            if (::poll(&waiting, 1, 50) <= 0)
+                continue;
+
+            const auto size = ::read(_master, chunk.data(), chunk.size());
+            if (size <= 0)
+                break;
+            framer.feed(chunk.data(), static_cast<std::size_t>(size), onFrame);
+        }
+    });
+}
+
+RtuLoopback::~RtuLoopback() {
+    _stop = true;
+    _device.join();
+    _client.close();
+    ::close(_master);
+}
+
+ModbusResponse RtuLoopback::transact(const ModbusRequest &request) {
+    if (_mode == Framed) {
+        _client.sendRequest(request);
+        auto response = _client.tryAwaitResponse();
+        if (!response)
+            MB_THROW(ModbusException(response.error()));
+        return std::get<0>(std::move(response).value());
+    }
+
+    // Response size has to be known up front, device content does not change it
+    const int requestSize  = static_cast<int>(request.encodedSize() + 2);
+    const int responseSize = static_cast<int>(
+        SimulatedDevice().handle(request).encodedSize() + 2);
+    const auto raw =
+        _client.sendRequest(request, requestSize + responseSize, requestSize);
+    return ModbusResponse::fromRawCRC(raw);
+}
@@ -0,0 +1,167 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// In-process transports for end to end benchmarks: client connection wired to
+// a simulated slave served by background thread, over socketpair() (TCP),
+// loopback TCP socket accepted by TCP::Server, loopback UDP socket served by
+// UDP::Server, or pseudo-terminal pair (RTU).
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "MB/Serial/connection.hpp"
+#include "MB/TCP/connection.hpp"
+#include "MB/TCP/server.hpp"
+#include "MB/UDP/client.hpp"
+#include "MB/UDP/server.hpp"
+
+namespace MB::bench {
+//! Registers, coils and files of simulated slave, answers every supported function code
+class SimulatedDevice {
+  private:
+    std::array<uint16_t, 2048> _registers{};
+    std::array<bool, 4096> _coils{};
+
+    RegisterBlock readRegisters(uint16_t address, uint16_t count) const;
+    CoilBitset readCoils(uint16_t address, uint16_t count) const;
+    void writeRegisters(uint16_t address, const RegisterBlock &values);
+    void writeCoils(uint16_t address, const CoilBitset &values);
+
+  public:
+    ModbusResponse handle(const ModbusRequest &request);
+};
+
+/**
+ * @brief Collects round trip times and publishes throughput and latency
+ * percentiles as benchmark counters.
+ *
+ * Counters: "tx/s" (transactions per second of real time) and "p50_us",
+ * "p99_us", "p999_us".
+ */
+class LatencyRecorder {
+  private:
+    std::vector<uint64_t> _samples;
+
+  public:
+    //! Storage for `expected` samples is allocated up front
+    explicit LatencyRecorder(std::size_t expected = 1 << 20) {
+        _samples.reserve(expected);
+    }
+
+    void add(std::chrono::nanoseconds latency) {
+        _samples.push_back(static_cast<uint64_t>(latency.count()));
+    }
+
+    //! Returns latency in nanoseconds below which `fraction` of samples are
+    [[nodiscard]] double percentile(double fraction);
+
+    void report(benchmark::State &state);
+};
+
+//! Client side of in-process connection to SimulatedDevice
+class Loopback {
+  public:
+    virtual ~Loopback() = default;
+
+    //! Sends request and waits for its response, throws on error
+    virtual ModbusResponse transact(const ModbusRequest &request) = 0;
+};
+
+/**
+ * @brief TCP::Connection pair over socketpair().
+ *
+ * With non zero latency the device behaves as gateway serving many
+ * transactions concurrently: every request is answered `latency` after it
+ * arrived, regardless of requests still being processed.
+ */
+class TcpLoopback : public Loopback {
+  private:
+    TCP::Connection _client;
+    std::thread _device;
+
+  public:
+    explicit TcpLoopback(std::chrono::microseconds latency = {});
+    ~TcpLoopback() override;
+
+    //! Client connection, may be moved out (closing it stops the device)
+    [[nodiscard]] TCP::Connection &client() noexcept { return _client; }
+
+    ModbusResponse transact(const ModbusRequest &request) override;
+};
+
+/**
+ * @brief Client connected through 127.0.0.1 to device accepted by
+ * TCP::Server, both sides use the same socket options.
+ */
+class TcpServerLoopback : public Loopback {
+  private:
+    TCP::Server _server;
+    TCP::Connection _client;
+    std::thread _device;
+
+  public:
+    explicit TcpServerLoopback(const TCP::SocketOptions &options = {});
+    ~TcpServerLoopback() override;
+
+    //! Client connection, may be moved out (closing it stops the device)
+    [[nodiscard]] TCP::Connection &client() noexcept { return _client; }
+
+    ModbusResponse transact(const ModbusRequest &request) override;
+};
+
+//! UDP::Client sending to UDP::Server over 127.0.0.1
+class UdpLoopback : public Loopback {
+  private:
+    UDP::Server _server;
+    UDP::Client _client;
+    std::atomic<bool> _stop{false};
+    std::thread _device;
+
+  public:
+    explicit UdpLoopback(std::size_t window = UDP::Client::DefaultWindow);
+    ~UdpLoopback() override;
+
+    [[nodiscard]] UDP::Client &client() noexcept { return _client; }
+
+    ModbusResponse transact(const ModbusRequest &request) override;
+};
+
+/**
+ * @brief Serial::Connection on slave side of pseudo-terminal, device serves
+ * the master side.
+ *
+ * Framed mode uses sendRequest followed by tryAwaitResponse. Legacy mode
+ * uses sendRequest with expected response length (readRawMessage), which
+ * expects the request to be echoed as on 2 wire RS485 bus, so device echoes
+ * requests in this mode.
+ */
+class RtuLoopback : public Loopback {
+  public:
+    enum Mode { Framed, Legacy };
+
+  private:
+    Mode _mode;
+    int _master = -1;
+    Serial::Connection _client;
+    std::atomic<bool> _stop{false};
+    std::thread _device;
+
+  public:
+    explicit RtuLoopback(Mode mode = Framed);
+    ~RtuLoopback() override;
+
+    //! Client connection, serves both modes
+    [[nodiscard]] Serial::Connection &client() noexcept { return _client; }
+
+    ModbusResponse transact(const ModbusRequest &request) override;
+};
+} // namespace MB::bench
@@ -0,0 +1,52 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "syscallCounter.hpp"
+
+#include <ctime>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+thread_local MB::bench::SyscallCounts counts;
+}
+
+MB::bench::SyscallCounts MB::bench::syscallCounts() noexcept { return counts; }
+
+// Definitions in the executable take precedence over libc, also for calls
+// made from the (static) Modbus libraries
+extern "C" ssize_t send(int fd, const void *buffer, size_t size, int flags) {
+    counts.sends++;
+    return ::syscall(SYS_sendto, fd, buffer, size, flags, nullptr, 0);
+}
+
+extern "C" ssize_t recv(int fd, void *buffer, size_t size, int flags) {
+    counts.receives++;
+    return ::syscall(SYS_recvfrom, fd, buffer, size, flags, nullptr, nullptr);
+}
+
+// One batch of datagrams is one syscall
+extern "C" int sendmmsg(int fd, struct mmsghdr *messages, unsigned int count, int flags) {
+    counts.sends++;
+    return static_cast<int>(::syscall(SYS_sendmmsg, fd, messages, count, flags));
+}
+
+extern "C" int recvmmsg(int fd, struct mmsghdr *messages, unsigned int count, int flags,
+                        struct timespec *timeout) {
+    counts.receives++;
+    return static_cast<int>(::syscall(SYS_recvmmsg, fd, messages, count, flags, timeout));
+}
+
+extern "C" int poll(struct pollfd *fds, nfds_t count, int timeout) {
+    counts.polls++;
+    if (timeout < 0)
+        return ::ppoll(fds, count, nullptr, nullptr);
+
+    const timespec limit = {.tv_sec  = timeout / 1000,
+                            .tv_nsec = static_cast<long>(timeout % 1000) * 1000000};
+    return ::ppoll(fds, count, &limit, nullptr);
+}
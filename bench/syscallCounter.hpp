@@ -0,0 +1,58 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Socket syscall instrumentation: send, recv, poll and their batched datagram
+// variants (sendmmsg, recvmmsg) are interposed in front of libc and counted
+// per thread, used to report syscalls per transaction.
+
+#pragma once
+
+#include <cstdint>
+
+#include <benchmark/benchmark.h>
+
+namespace MB::bench {
+struct SyscallCounts {
+    uint64_t sends    = 0;
+    uint64_t receives = 0;
+    uint64_t polls    = 0;
+};
+
+//! Calls made by the calling thread since its start
+SyscallCounts syscallCounts() noexcept;
+
+/**
+ * Counts syscalls of the calling thread between construction and
+ * destruction, and publishes them per transaction as "send/tx", "recv/tx",
+ * "poll/tx" and "syscalls/tx" counters.
+ */
+class SyscallScope {
+  private:
+    benchmark::State &_state;
+    uint64_t _transactionsPerIteration;
+    SyscallCounts _start;
+
+  public:
+    SyscallScope(benchmark::State &state, uint64_t transactionsPerIteration)
+        : _state(state), _transactionsPerIteration(transactionsPerIteration),
+          _start(syscallCounts()) {}
+
+    ~SyscallScope() {
+        const auto end          = syscallCounts();
+        const auto transactions = static_cast<double>(_state.iterations()) *
+                                  static_cast<double>(_transactionsPerIteration);
+        const auto perTransaction = [&](uint64_t count) {
+            return transactions > 0 ? static_cast<double>(count) / transactions : 0.0;
+        };
+
+        const auto sends    = end.sends - _start.sends;
+        const auto receives = end.receives - _start.receives;
+        const auto polls    = end.polls - _start.polls;
+        _state.counters["send/tx"]     = perTransaction(sends);
+        _state.counters["recv/tx"]     = perTransaction(receives);
+        _state.counters["poll/tx"]     = perTransaction(polls);
+        _state.counters["syscalls/tx"] = perTransaction(sends + receives + polls);
+    }
+};
+} // namespace MB::bench
@@ -0,0 +1,219 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Awaitable Modbus TCP and RTU connections, requires MODBUS_COROUTINES.
+//
+// Example (session of a master, run on the loop thread):
+//   MB::Async::Task<> poll(MB::Async::TcpStream &device) {
+//       auto response = co_await device.transact(request);
+//       ...
+//   }
+//   MB::Async::spawn(poll(device));
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "MB/Serial/connection.hpp"
+#include "MB/modbusException.hpp"
+#include "MB/modbusMbapFramer.hpp"
+#include "MB/modbusRequest.hpp"
+#include "MB/modbusResponse.hpp"
+#include "MB/modbusResult.hpp"
+#include "MB/modbusRtuFramer.hpp"
+#include "eventLoop.hpp"
+#include "task.hpp"
+
+namespace MB::Async {
+/**
+ * @brief Suspends coroutines until fd becomes ready or deadline passes.
+ *
+ * Only one coroutine may wait at a time. Fd is watched in one shot mode, so
+ * it does not wake the loop while nobody waits.
+ */
+class IoWatcher : private EventLoop::Handler {
+  private:
+    EventLoop &_loop;
+    int _fd;
+    bool _added = false;
+    bool _ready = false;
+    std::coroutine_handle<> _waiting;
+    EventLoop::TimerId _timer;
+
+    void onEvents(uint32_t events) override;
+    void arm(uint32_t events, EventLoop::Clock::time_point deadline);
+
+  public:
+    class Wait {
+      private:
+        IoWatcher &_watcher;
+        uint32_t _events;
+        EventLoop::Clock::time_point _deadline;
+
+      public:
+        Wait(IoWatcher &watcher, uint32_t events,
+             EventLoop::Clock::time_point deadline) noexcept
+            : _watcher(watcher), _events(events), _deadline(deadline) {}
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) {
+            _watcher._waiting = handle;
+            _watcher.arm(_events, _deadline);
+        }
+        //! False if deadline passed first
+        bool await_resume() const noexcept { return _watcher._ready; }
+    };
+
+    IoWatcher(EventLoop &loop, int fd) noexcept : _loop(loop), _fd(fd) {}
+    IoWatcher(const IoWatcher &)            = delete;
+    IoWatcher &operator=(const IoWatcher &) = delete;
+    //! Stops watching the fd, waiting coroutine is never resumed
+    ~IoWatcher();
+
+    //! Awaitable resumed when any of `events` (EPOLLIN, EPOLLOUT) is ready
+    Wait wait(uint32_t events, EventLoop::Clock::time_point deadline =
+                                   EventLoop::Clock::time_point::max()) noexcept {
+        return {*this, events, deadline};
+    }
+};
+
+/**
+ * @brief Modbus TCP connection with awaitable operations.
+ *
+ * Operations must be awaited one at a time, on the thread running the
+ * loop. Every operation returns error instead of throwing: Timeout when
+ * the peer does not answer in time, ConnectionClosed when connection was
+ * lost, or exception code reported by the device.
+ */
+class TcpStream {
+  public:
+    static constexpr std::chrono::milliseconds DefaultTimeout{500};
+
+  private:
+    EventLoop *_loop = nullptr;
+    int _fd          = -1;
+    //! Heap allocated once, so that the stream can move while watched
+    std::unique_ptr<IoWatcher> _io;
+    uint16_t _messageID                = 0;
+    std::chrono::milliseconds _timeout = DefaultTimeout;
+
+    std::vector<uint8_t> _txBuffer;
+    MB::MbapFramer _rxFramer;
+    MB::MbapFrame _rxFrame;
+
+    Task<MB::Status> write();
+    //! Receives single ADU into _rxFrame
+    Task<MB::Status> receive(EventLoop::Clock::time_point deadline);
+    void close() noexcept;
+
+  public:
+    TcpStream() noexcept = default;
+    //! Takes ownership of connected socket, which is made non blocking
+    TcpStream(EventLoop &loop, int sockfd);
+    TcpStream(TcpStream &&other) noexcept;
+    TcpStream &operator=(TcpStream &&other) noexcept;
+    ~TcpStream() { close(); }
+
+    //! Connects to IPv4 address, fails with Timeout or ConnectionClosed
+    static Task<MB::Result<TcpStream>> connect(EventLoop &loop, std::string address,
+                                               int port,
+                                               std::chrono::milliseconds timeout =
+                                                   std::chrono::milliseconds(3000));
+
+    [[nodiscard]] bool isOpen() const noexcept { return _fd != -1; }
+    [[nodiscard]] int getSockfd() const noexcept { return _fd; }
+
+    //! Time for the device to answer transact()
+    void setTimeout(std::chrono::milliseconds timeout) noexcept { _timeout = timeout; }
+
+    //! Sends request and awaits its response, other transactions are skipped
+    Task<MB::Result<MB::ModbusResponse>> transact(MB::ModbusRequest request);
+
+    //! Awaits request of the master (slave side), without timeout
+    Task<MB::Result<MB::ModbusRequest>> awaitRequest();
+    //! Answers the last awaited request
+    Task<MB::Status> sendResponse(MB::ModbusResponse response);
+    Task<MB::Status> sendException(MB::ModbusException exception);
+};
+
+//! Listening socket producing TcpStream for every accepted connection
+class TcpListener {
+  private:
+    EventLoop *_loop = nullptr;
+    int _fd          = -1;
+    int _port        = 0;
+    std::unique_ptr<IoWatcher> _io;
+
+    TcpListener(EventLoop &loop, int fd, int port);
+
+  public:
+    TcpListener(TcpListener &&other) noexcept;
+    TcpListener &operator=(TcpListener &&other) noexcept;
+    ~TcpListener();
+
+    /**
+     * @brief Listens on all interfaces, port 0 picks free port (see port()).
+     * Throws std::runtime_error if socket can not be bound.
+     */
+    static TcpListener listen(EventLoop &loop, int port);
+
+    [[nodiscard]] int port() const noexcept { return _port; }
+
+    Task<MB::Result<TcpStream>> accept();
+};
+
+/**
+ * @brief Awaitable RTU operations over serial port opened and configured by
+ * Serial::Connection.
+ *
+ * Port borrows descriptor of the connection, which must outlive the port
+ * and must not be used for blocking I/O meanwhile. Frames are cut by
+ * RtuFramer, as in Serial::Connection::tryAwaitResponse.
+ */
+class RtuPort {
+  public:
+    static constexpr std::size_t RawChunkSize = 1024;
+
+  private:
+    EventLoop &_loop;
+    int _fd;
+    IoWatcher _io;
+    std::chrono::milliseconds _timeout{MB::Serial::Connection::DefaultSerialTimeout};
+
+    std::vector<uint8_t> _txBuffer;
+    MB::RtuFramer _requestFramer{MB::RtuFramer::Requests};
+    MB::RtuFramer _responseFramer{MB::RtuFramer::Responses};
+    std::array<uint8_t, RawChunkSize> _rxChunk{};
+    std::size_t _rxBegin = 0;
+    std::size_t _rxEnd   = 0;
+    //! Last received frame, including CRC
+    std::array<uint8_t, MB::RtuFramer::MaxFrameSize> _frame{};
+
+    Task<MB::Status> write();
+    //! Receives single frame into _frame, returns its size
+    Task<MB::Result<std::size_t>> receive(MB::RtuFramer &framer,
+                                          EventLoop::Clock::time_point deadline);
+
+  public:
+    RtuPort(EventLoop &loop, MB::Serial::Connection &connection);
+    RtuPort(const RtuPort &)            = delete;
+    RtuPort &operator=(const RtuPort &) = delete;
+
+    void setTimeout(std::chrono::milliseconds timeout) noexcept { _timeout = timeout; }
+
+    //! Sends request and awaits its response
+    Task<MB::Result<MB::ModbusResponse>> transact(MB::ModbusRequest request);
+
+    //! Awaits request of the master (slave side), without timeout
+    Task<MB::Result<MB::ModbusRequest>> awaitRequest();
+    Task<MB::Status> sendResponse(MB::ModbusResponse response);
+    Task<MB::Status> sendException(MB::ModbusException exception);
+};
+} // namespace MB::Async
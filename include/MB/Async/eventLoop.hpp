@@ -0,0 +1,128 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/epoll.h>
+
+namespace MB::Async {
+/**
+ * @brief Single threaded reactor over epoll, with timers and task queue.
+ *
+ * File descriptors are watched by Handler objects that are not owned by the
+ * loop. Everything registered with the loop runs on the thread calling
+ * run() / runOnce(), only post(), stop() and the fd registration functions
+ * may be called from other threads.
+ */
+class EventLoop {
+  public:
+    using Clock = std::chrono::steady_clock;
+    using Task  = std::function<void()>;
+
+    //! Receives readiness events (EPOLLIN, EPOLLOUT, ...) of watched fd
+    class Handler {
+      public:
+        virtual void onEvents(uint32_t events) = 0;
+
+      protected:
+        ~Handler() = default;
+    };
+
+    //! Identifies scheduled timer, default constructed id refers to none
+    struct TimerId {
+        Clock::time_point deadline;
+        uint64_t sequence = 0;
+
+        explicit operator bool() const noexcept { return sequence != 0; }
+    };
+
+  private:
+    //! Number of events fetched by single epoll_wait
+    static constexpr std::size_t EventBatch = 256;
+
+    int _epoll  = -1;
+    int _wakeup = -1;
+    std::atomic<bool> _stopped{false};
+    std::atomic<std::thread::id> _thread{};
+
+    using Timers = std::map<std::pair<Clock::time_point, uint64_t>, Task>;
+    //! Number of nodes of fired or cancelled timers kept for reuse
+    static constexpr std::size_t SpareTimers = 1024;
+
+    Timers _timers;
+    //! Timer nodes are recycled, so steady state scheduling does not allocate
+    std::vector<Timers::node_type> _spareTimers;
+    uint64_t _timerSequence = 0;
+
+    std::mutex _tasksMutex;
+    std::vector<Task> _tasks;
+    //! Tasks being run, swapped with _tasks to keep both capacities
+    std::vector<Task> _running;
+
+    std::vector<epoll_event> _events;
+
+    int waitTimeout(int timeout) const noexcept;
+    void recycle(Timers::node_type &&node) noexcept;
+    std::size_t runTasks();
+    std::size_t runTimers();
+    void wake() noexcept;
+
+  public:
+    //! Throws std::runtime_error if epoll or eventfd can not be created
+    EventLoop();
+    EventLoop(const EventLoop &) = delete;
+    EventLoop &operator=(const EventLoop &) = delete;
+    ~EventLoop();
+
+    //! Starts watching `fd`, throws std::runtime_error on failure
+    void add(int fd, uint32_t events, Handler *handler);
+    //! Changes watched events of `fd`, throws std::runtime_error on failure
+    void modify(int fd, uint32_t events, Handler *handler);
+    //! Stops watching `fd`, must be called before the fd is closed
+    void remove(int fd) noexcept;
+
+    /**
+     * @brief Runs task at (or shortly after) deadline on the loop thread.
+     * Timers with the same deadline run in order of scheduling.
+     */
+    TimerId schedule(Clock::time_point deadline, Task task);
+    TimerId scheduleAfter(Clock::duration delay, Task task) {
+        return schedule(Clock::now() + delay, std::move(task));
+    }
+    //! Removes timer that did not run yet, no-op otherwise
+    void cancel(TimerId id) noexcept;
+
+    //! Queues task to run on the loop thread, may be called from any thread
+    void post(Task task);
+    //! Runs task immediately if called on the loop thread, posts it otherwise
+    void dispatch(Task task);
+
+    //! True when called from thread currently running the loop
+    [[nodiscard]] bool inLoopThread() const noexcept {
+        return _thread.load(std::memory_order_relaxed) == std::this_thread::get_id();
+    }
+
+    /**
+     * @brief Waits up to `timeout` ms (-1 means until something happens)
+     * and handles ready fds, expired timers and posted tasks.
+     * @return Number of handled events, timers and tasks
+     */
+    std::size_t runOnce(int timeout = -1);
+    //! Runs until stop() is called
+    void run();
+    //! Makes run() return, may be called from any thread
+    void stop() noexcept;
+};
+} // namespace MB::Async
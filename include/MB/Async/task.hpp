@@ -0,0 +1,208 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// C++20 coroutine task type, requires MODBUS_COROUTINES.
+
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <utility>
+
+#include "eventLoop.hpp"
+
+namespace MB::Async {
+/**
+ * @brief Per thread free lists of coroutine frames.
+ *
+ * Frames are rounded up to multiple of Granularity and kept after the
+ * coroutine finishes, so sessions that repeatedly call the same operations
+ * stop touching the heap once warmed up. Frames larger than MaxPooledSize
+ * go directly to the heap. Frame freed on other thread than it was
+ * allocated on joins free list of that thread.
+ */
+class FramePool {
+  public:
+    static constexpr std::size_t Granularity   = 64;
+    static constexpr std::size_t MaxPooledSize = 4096;
+
+    static void *allocate(std::size_t size);
+    static void deallocate(void *frame, std::size_t size) noexcept;
+
+    //! Number of frames this thread took from the heap (pooled or not)
+    [[nodiscard]] static std::size_t heapAllocations() noexcept;
+};
+
+template <typename T> class Task;
+void spawn(Task<void> task);
+
+namespace detail {
+class PromiseBase {
+  private:
+    //! Awaiting coroutine, resumed when this one finishes
+    std::coroutine_handle<> _continuation;
+    std::exception_ptr _exception;
+    //! Started by spawn(), destroys itself when finished
+    bool _detached = false;
+
+    template <typename T> friend class MB::Async::Task;
+    friend void MB::Async::spawn(Task<void> task);
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        template <typename Promise>
+        std::coroutine_handle<>
+        await_suspend(std::coroutine_handle<Promise> self) noexcept {
+            auto &promise = self.promise();
+            if (promise._detached) {
+                if (promise._exception)
+                    std::terminate();
+                self.destroy();
+                return std::noop_coroutine();
+            }
+            if (promise._continuation)
+                return promise._continuation;
+            return std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+    };
+
+  public:
+    static void *operator new(std::size_t size) { return FramePool::allocate(size); }
+    static void operator delete(void *frame, std::size_t size) noexcept {
+        FramePool::deallocate(frame, size);
+    }
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { _exception = std::current_exception(); }
+
+    void rethrowIfFailed() const {
+        if (_exception)
+            std::rethrow_exception(_exception);
+    }
+};
+
+template <typename T> class Promise : public PromiseBase {
+  private:
+    std::optional<T> _value;
+
+  public:
+    Task<T> get_return_object() noexcept;
+    template <typename U> void return_value(U &&value) {
+        _value.emplace(std::forward<U>(value));
+    }
+
+    T take() {
+        rethrowIfFailed();
+        return std::move(*_value);
+    }
+};
+
+template <> class Promise<void> : public PromiseBase {
+  public:
+    Task<void> get_return_object() noexcept;
+    void return_void() const noexcept {}
+
+    void take() const { rethrowIfFailed(); }
+};
+} // namespace detail
+
+/**
+ * @brief Lazily started coroutine returning T.
+ *
+ * Task starts when awaited (or passed to spawn / syncWait) and resumes
+ * its awaiter directly when finished. Frames come from FramePool.
+ * Exceptions escaping the coroutine are rethrown to the awaiter.
+ */
+template <typename T = void> class [[nodiscard]] Task {
+  public:
+    using promise_type = detail::Promise<T>;
+
+  private:
+    std::coroutine_handle<promise_type> _handle;
+
+    friend promise_type;
+    friend void spawn(Task<void> task);
+    template <typename U> friend U syncWait(EventLoop &loop, Task<U> task);
+
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept
+        : _handle(handle) {}
+
+  public:
+    Task(Task &&other) noexcept : _handle(std::exchange(other._handle, {})) {}
+    Task &operator=(Task &&other) noexcept {
+        if (this != &other) {
+            if (_handle)
+                _handle.destroy();
+            _handle = std::exchange(other._handle, {});
+        }
+        return *this;
+    }
+    Task(const Task &)            = delete;
+    Task &operator=(const Task &) = delete;
+
+    ~Task() {
+        if (_handle)
+            _handle.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        _handle.promise()._continuation = awaiter;
+        return _handle;
+    }
+    T await_resume() { return _handle.promise().take(); }
+};
+
+template <typename T> Task<T> detail::Promise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<Promise>::from_promise(*this));
+}
+
+inline Task<void> detail::Promise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<Promise>::from_promise(*this));
+}
+
+/**
+ * @brief Starts task that runs on its own, its frame is freed when it
+ * finishes. Exception escaping the task terminates the program.
+ */
+inline void spawn(Task<void> task) {
+    auto handle                = std::exchange(task._handle, {});
+    handle.promise()._detached = true;
+    handle.resume();
+}
+
+/**
+ * @brief Runs the loop on calling thread until task finishes and returns
+ * its result. This is how blocking code calls coroutine operations.
+ */
+template <typename T> T syncWait(EventLoop &loop, Task<T> task) {
+    task._handle.resume();
+    while (!task._handle.done())
+        loop.runOnce();
+    return task._handle.promise().take();
+}
+
+//! Awaitable that resumes the coroutine on the loop after `delay`
+class Sleep {
+  private:
+    EventLoop &_loop;
+    EventLoop::Clock::time_point _deadline;
+
+  public:
+    Sleep(EventLoop &loop, EventLoop::Clock::time_point deadline) noexcept
+        : _loop(loop), _deadline(deadline) {}
+    Sleep(EventLoop &loop, EventLoop::Clock::duration delay) noexcept
+        : Sleep(loop, EventLoop::Clock::now() + delay) {}
+
+    bool await_ready() const noexcept { return _deadline <= EventLoop::Clock::now(); }
+    void await_suspend(std::coroutine_handle<> handle) {
+        _loop.schedule(_deadline, [handle] { handle.resume(); });
+    }
+    void await_resume() const noexcept {}
+};
+} // namespace MB::Async
@@ -0,0 +1,179 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MB/modbusMbapFramer.hpp"
+#include "MB/modbusRequest.hpp"
+#include "MB/modbusResponse.hpp"
+#include "MB/modbusResult.hpp"
+#include "eventLoop.hpp"
+
+namespace MB::Async {
+/**
+ * @brief Non blocking Modbus TCP connection driven by EventLoop.
+ *
+ * Requests are queued and sent as soon as the window allows, responses are
+ * matched by transaction ID (unknown ones are dropped) and completed through
+ * callbacks invoked on the loop thread. Requests still queued or in flight
+ * when the connection fails complete with the error. Sessions are created
+ * and owned by TcpClient.
+ */
+class TcpSession : private EventLoop::Handler {
+  public:
+    using Callback = std::function<void(MB::Result<MB::ModbusResponse>)>;
+
+    struct Options {
+        //! Maximal number of transactions in flight, 1 waits for each response
+        std::size_t window = 1;
+        //! Time for response, measured from sending the request
+        std::chrono::milliseconds timeout{500};
+        std::chrono::milliseconds connectTimeout{3000};
+    };
+
+    enum class State { Connecting, Connected, Closed };
+
+  private:
+    struct Transaction {
+        uint16_t transactionID;
+        EventLoop::Clock::time_point deadline;
+        Callback callback;
+    };
+
+    struct Queued {
+        MB::ModbusRequest request;
+        Callback callback;
+    };
+
+    EventLoop &_loop;
+    int _fd;
+    Options _options;
+    std::atomic<State> _state;
+    uint16_t _nextID = 0;
+
+    //! Requests waiting for free window slot
+    std::deque<Queued> _queue;
+    //! Sent transactions, in order of sending so deadlines are ascending
+    std::deque<Transaction> _inFlight;
+    //! Single timer, armed for the oldest transaction (or connect deadline)
+    EventLoop::TimerId _timer;
+
+    //! Encoded requests not accepted by the socket yet
+    std::vector<uint8_t> _txBuffer;
+    std::size_t _txOffset = 0;
+    bool _watchWritable   = false;
+    MB::MbapFramer _rxFramer;
+
+    friend class TcpClient;
+    TcpSession(EventLoop &loop, int fd, State state, const Options &options);
+
+    void start();
+    void onEvents(uint32_t events) override;
+    void onConnected();
+    void onTimer();
+    void arm(EventLoop::Clock::time_point deadline);
+
+    void enqueue(const MB::ModbusRequest &request, Callback &&callback);
+    //! Encodes queued requests while window allows and sends them
+    void pump();
+    void flush();
+    void receive();
+    void complete(const MB::MbapFrame &frame);
+    void watch(bool writable);
+
+    //! Closes socket and completes every request with `error`
+    void fail(MB::utils::MBErrorCode error);
+
+  public:
+    TcpSession(const TcpSession &) = delete;
+    TcpSession &operator=(const TcpSession &) = delete;
+    ~TcpSession();
+
+    [[nodiscard]] EventLoop &loop() noexcept { return _loop; }
+    [[nodiscard]] State state() const noexcept { return _state.load(); }
+
+    //! Number of requests waiting for window, only meaningful on loop thread
+    [[nodiscard]] std::size_t queued() const noexcept { return _queue.size(); }
+    //! Number of requests awaiting response, only meaningful on loop thread
+    [[nodiscard]] std::size_t inFlight() const noexcept { return _inFlight.size(); }
+
+    /**
+     * @brief Submits request, `callback` is invoked on the loop thread with
+     * response, exception code reported by the device or transport error
+     * (Timeout, ConnectionClosed, ...). May be called from any thread.
+     */
+    void submit(const MB::ModbusRequest &request, Callback callback);
+
+    /**
+     * @brief Submits request, result is delivered through the future.
+     * @warning Waiting for the future on the loop thread deadlocks.
+     */
+    std::future<MB::Result<MB::ModbusResponse>> submit(const MB::ModbusRequest &request);
+};
+
+/**
+ * @brief Asynchronous Modbus TCP client owning many sessions served by a few
+ * event loop threads.
+ *
+ * Sessions are distributed round robin between loops. Client with 0
+ * threads has single loop that is not run by the client, the caller drives
+ * it through loop().run() or runOnce().
+ */
+class TcpClient {
+  private:
+    std::vector<std::unique_ptr<EventLoop>> _loops;
+    std::vector<std::thread> _threads;
+
+    std::mutex _sessionsMutex;
+    std::vector<std::unique_ptr<TcpSession>> _sessions;
+    std::size_t _nextLoop = 0;
+
+    TcpSession &add(int fd, TcpSession::State state, const TcpSession::Options &options);
+
+  public:
+    explicit TcpClient(std::size_t threads = 1);
+    TcpClient(const TcpClient &) = delete;
+    TcpClient &operator=(const TcpClient &) = delete;
+    //! Stops the loops, requests not completed yet fail with ConnectionClosed
+    ~TcpClient();
+
+    [[nodiscard]] EventLoop &loop(std::size_t index = 0) { return *_loops[index]; }
+    [[nodiscard]] std::size_t loops() const noexcept { return _loops.size(); }
+
+    /**
+     * @brief Starts non blocking connect to IPv4 address.
+     *
+     * Requests may be submitted right away, they are sent once connected.
+     * Throws std::runtime_error if socket can not be created or connect
+     * fails immediately.
+     */
+    TcpSession &connect(const std::string &address, int port,
+                        const TcpSession::Options &options = {});
+
+    //! Takes ownership of already connected socket
+    TcpSession &adopt(int sockfd, const TcpSession::Options &options = {});
+
+    /**
+     * @brief Closes the session, its pending requests fail with
+     * ConnectionClosed. Session is destroyed later on its loop thread.
+     */
+    void close(TcpSession &session);
+
+    //! Number of sessions not destroyed yet
+    [[nodiscard]] std::size_t sessions();
+};
+} // namespace MB::Async
@@ -0,0 +1,254 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "MB/Serial/connection.hpp"
+#include "MB/TCP/connection.hpp"
+#include "MB/modbusReadPlanner.hpp"
+#include "MB/modbusRequest.hpp"
+#include "MB/modbusResponse.hpp"
+#include "MB/modbusResult.hpp"
+#include "MB/modbusUtils.hpp"
+
+namespace MB::Poll {
+using Clock = std::chrono::steady_clock;
+
+//! Type of value held by a point, decides how many registers are read
+enum PointType : uint8_t {
+    Bit, //!< Single coil or discrete input (FC1 / FC2)
+    U16,
+    S16,
+    U32,
+    S32,
+    F32,
+    F64
+};
+
+//! Number of registers (coils for Bit) occupied by value of given type
+[[nodiscard]] uint16_t pointSize(PointType type) noexcept;
+
+//! Single value read from a device
+struct Point {
+    std::string name;
+    uint8_t unit = 1;
+    //! One of reading functions, FC1 - FC4
+    utils::MBFunctionCode functionCode = utils::ReadAnalogOutputHoldingRegisters;
+    uint16_t address = 0;
+    PointType type   = U16;
+    //! Order of registers of 32 and 64 bit values
+    utils::WordOrder order = utils::ABCD;
+};
+
+//! Last published state of a point
+struct Sample {
+    //! Last successfully read value, kept when following reads fail
+    double value = 0;
+    //! Completion time of the last successful read
+    Clock::time_point time;
+    //! Error of the last read, empty if it succeeded
+    std::optional<utils::MBErrorCode> error;
+    //! Number of successful reads
+    uint64_t updates = 0;
+
+    //! True if value was read at least once and the last read succeeded
+    [[nodiscard]] bool valid() const noexcept { return updates > 0 && !error; }
+};
+
+//! Samples of all points, indexed by PointId
+struct Snapshot {
+    std::vector<Sample> samples;
+    //! Incremented with every published sample
+    uint64_t version = 0;
+};
+
+struct GroupStats {
+    Clock::duration period{};
+    //! Cycles whose every transaction completed
+    uint64_t cycles = 0;
+    /**
+     * Cycles that completed after their deadline (next release), did not
+     * complete before it, or were skipped because the engine fell behind by
+     * more than a period.
+     */
+    uint64_t deadlineMisses = 0;
+    uint64_t transactions   = 0;
+    //! Transactions that failed, see Sample::error of their points
+    uint64_t errors = 0;
+
+    //! Jitter is delay of the first transaction of a cycle after its release
+    Clock::duration maxJitter{};
+    Clock::duration meanJitter{};
+    //! Time from release until the last transaction of a cycle completed
+    Clock::duration lastCycleTime{};
+    Clock::duration maxCycleTime{};
+};
+
+/**
+ * @brief Polls lists of points, grouped by period, over TCP and serial
+ * connections and publishes decoded values into a snapshot.
+ *
+ * Every period a group is released: its points, coalesced into as few reads
+ * as possible by ReadPlanner, become read transactions whose deadline is
+ * the next release. Transactions are executed
+ * earliest deadline first, so points of fast groups overtake slow groups
+ * that were released together with them. Every connection executes one
+ * transaction at a time.
+ *
+ * If a group is released again before its previous cycle completed, the
+ * cycle counts as missed and its remaining transactions are dropped, so the
+ * engine never works on stale cycles while it is overloaded.
+ *
+ * The engine is driven either from the calling thread (runOnce / runUntil,
+ * which execute transactions of all connections one by one), or by one
+ * worker thread per connection (start / stop). The two must not be mixed.
+ * Connections must outlive the engine and must not be used by anything else
+ * while it runs. Snapshot, sample and stats are thread safe.
+ */
+class PollEngine {
+  public:
+    using ConnectionId = std::size_t;
+    using GroupId      = std::size_t;
+    //! Points get consecutive IDs in order of registration, starting with 0
+    using PointId = std::size_t;
+    //! Executes single transaction, used for transports other than TCP and RTU
+    using Transact = std::function<Result<ModbusResponse>(const ModbusRequest &)>;
+
+  private:
+    struct Group {
+        Clock::duration period;
+        ConnectionId connection;
+        //! Point with index i in the plan has ID firstPoint + i
+        ReadPlan plan;
+        PointId firstPoint;
+
+        //! Release of the current cycle, cycle 0 means not released yet
+        Clock::time_point release;
+        uint64_t cycle = 0;
+        //! Reads of the current cycle that did not complete yet
+        std::size_t pending = 0;
+        bool started        = false;
+
+        GroupStats stats;
+        Clock::duration jitterSum{};
+        uint64_t jitterSamples = 0;
+    };
+
+    //! Transaction of a released cycle
+    struct Job {
+        Clock::time_point deadline;
+        uint64_t cycle;
+        GroupId group;
+        //! Index of read in the plan of the group
+        std::size_t read;
+
+        //! Orders std heap functions so that the earliest deadline is on top,
+        //! transactions with equal deadlines keep order of registration
+        friend bool operator<(const Job &lhs, const Job &rhs) noexcept {
+            return std::tie(lhs.deadline, lhs.group, lhs.read) >
+                   std::tie(rhs.deadline, rhs.group, rhs.read);
+        }
+    };
+
+    struct Channel {
+        Transact transact;
+        std::vector<GroupId> groups;
+        //! Heap of released transactions
+        std::vector<Job> ready;
+        std::thread worker;
+    };
+
+    mutable std::mutex _mutex;
+    std::condition_variable _wake;
+    bool _running = false;
+
+    std::vector<std::unique_ptr<Channel>> _channels;
+    std::vector<std::unique_ptr<Group>> _groups;
+    std::vector<Point> _points;
+    Snapshot _snapshot;
+
+    //! Releases groups of the channel that are due, returns next release time
+    Clock::time_point releaseDue(Channel &channel, Clock::time_point now);
+    //! Earliest job of the channel, drops jobs of overrun cycles on the way
+    const Job *top(Channel &channel);
+    static Job pop(Channel &channel);
+    //! Executes job with the mutex unlocked and publishes its result
+    void execute(std::unique_lock<std::mutex> &lock, Channel &channel, const Job &job);
+    //! Publishes value of the point found at `offset` of response payload
+    void publish(PointId point, const Result<ModbusResponse> &response,
+                 uint16_t offset, Clock::time_point now);
+
+    //! Executes earliest job of all channels, `next` is set to next release
+    bool step(Clock::time_point &next);
+    void work(Channel &channel);
+
+  public:
+    PollEngine() = default;
+    PollEngine(const PollEngine &)            = delete;
+    PollEngine &operator=(const PollEngine &) = delete;
+    ~PollEngine();
+
+    /**
+     * Adds connection polled by the engine, it is only referenced. Responses
+     * of timed out TCP transactions that arrive late are skipped.
+     */
+    ConnectionId addConnection(TCP::Connection &connection);
+    ConnectionId addConnection(Serial::Connection &connection);
+    ConnectionId addConnection(Transact transact);
+
+    /**
+     * @brief Adds group of points read every `period` over the connection.
+     * Group is released for the first time when the engine runs next.
+     *
+     * Points are coalesced into reads by `planner`, so its limits decide
+     * how far apart points may be and still share a read. A failed read
+     * sets the error of all of its points.
+     * @throws std::invalid_argument - When period is not positive, connection
+     * does not exist or point does not use a reading function code.
+     */
+    GroupId addGroup(ConnectionId connection, Clock::duration period,
+                     std::vector<Point> points,
+                     const ReadPlanner &planner = ReadPlanner());
+
+    //! Returns ID of the first point with given name
+    [[nodiscard]] std::optional<PointId> find(std::string_view name) const;
+
+    /**
+     * @brief Executes single transaction, the one with the earliest deadline
+     * over all connections, releasing groups that are due first.
+     * @return False if there was no released transaction
+     */
+    bool runOnce();
+
+    //! Executes transactions and waits for releases until `end`
+    void runUntil(Clock::time_point end);
+
+    //! Starts worker thread for every connection, connections added later
+    //! are not polled until the engine is restarted
+    void start();
+    //! Stops workers after their current transactions
+    void stop();
+
+    //! Copies samples into `snapshot`, reusing its storage
+    void snapshot(Snapshot &snapshot) const;
+    [[nodiscard]] Snapshot snapshot() const;
+    [[nodiscard]] Sample sample(PointId point) const;
+
+    [[nodiscard]] GroupStats stats(GroupId group) const;
+};
+} // namespace MB::Poll
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -17,17 +18,24 @@
 #include <termios.h>
 #include <unistd.h>
 
+#include "MB/modbusBufferPool.hpp"
 #include "MB/modbusException.hpp"
+#include "MB/modbusFraming.hpp"
 #include "MB/modbusRequest.hpp"
 #include "MB/modbusResponse.hpp"
+#include "MB/modbusResult.hpp"
+#include "MB/modbusRtuFramer.hpp"
+#include "MB/modbusTrace.hpp"
 #include "MB/modbusUtils.hpp"
 
 namespace MB::Serial {
 	class Connection {
 	public:
 		// Pretty high timeout
-		static const unsigned int DefaultSerialTimeout = 100;
-		static const unsigned int MinPauseBetweenSendingMS = 10;
+		static constexpr unsigned int DefaultSerialTimeout = 100;
+		static constexpr unsigned int MinPauseBetweenSendingMS = 10;
+		// Largest single read of raw message functions
+		static constexpr std::size_t RawChunkSize = 1024;
 
 	private:
 		struct termios _termios;
@@ -36,10 +44,40 @@ namespace MB::Serial {
 		std::chrono::time_point<m_clock> _lastSendTime;
 
 		int _timeout = Connection::DefaultSerialTimeout;
-		
+
+		// Reused transmit buffer, keeps its capacity between sends
+		std::vector<uint8_t> _txBuffer;
+		// Splitters of received byte stream, one for each role
+		MB::RtuFramer _requestFramer{ MB::RtuFramer::Requests };
+		MB::RtuFramer _responseFramer{ MB::RtuFramer::Responses };
+
+		// Last read chunk, bytes after the awaited frame are kept for the next await
+		std::array<uint8_t, MB::RtuFramer::MaxFrameSize> _rxChunk{};
+		std::size_t _rxBegin = 0;
+		std::size_t _rxEnd = 0;
+
+		// Last complete frame (including CRC) returned by awaitFrame
+		std::array<uint8_t, MB::RtuFramer::MaxFrameSize> _frame{};
+
+		// Optional sink of sent and received frames, not owned
+		MB::TraceSink* _trace = nullptr;
+
+		// Waits for data and appends everything available to the buffer
+		MB::Status readAvailable(std::vector<uint8_t>& buffer) noexcept;
+
+		// Reads until framer emits complete frame with valid CRC, copies it to _frame
+		MB::Result<std::size_t> awaitFrame(MB::RtuFramer& framer) noexcept;
+
+		// Await and parse single message, frame is left in _frame
+		MB::Result<MB::ModbusResponse> receiveResponse(std::size_t& frameSize) noexcept;
+		MB::Result<MB::ModbusRequest> receiveRequest(std::size_t& frameSize) noexcept;
+
+		// Writes complete frame, respecting pause between frames
+		void writeFrame(const uint8_t* frame, std::size_t size);
+		void writeFrame() { writeFrame(_txBuffer.data(), _txBuffer.size()); }
 
 	public:
-		constexpr explicit Connection() : _termios(), _fd(-1) {}
+		explicit Connection() : _termios(), _fd(-1) {}
 		explicit Connection(const std::string& path);
 		explicit Connection(const Connection&) = delete;
 		explicit Connection(Connection&&) noexcept;
@@ -52,20 +90,52 @@ namespace MB::Serial {
 
 		std::vector<uint8_t> sendRequest(const MB::ModbusRequest& request, const int expectedResponseLength = 0, const int requestLength = 8);
 		std::vector<uint8_t> sendRequest(const MB::ModbusParam& param, bool writeParam = false, const std::vector<uint8_t>& data = {});
-		std::vector<uint8_t> sendResponse(const MB::ModbusResponse& response);
-		std::vector<uint8_t> sendException(const MB::ModbusException& exception);
+		const std::vector<uint8_t>& sendResponse(const MB::ModbusResponse& response);
+		const std::vector<uint8_t>& sendException(const MB::ModbusException& exception);
 
 		/**
-		 * @brief Sends data through the serial
+		 * @brief Sends data through the serial, CRC is appended
 		 * @param data - Vectorized data
+		 * @return Sent frame, valid until the next send
+		 */
+		const std::vector<uint8_t>& send(const std::vector<uint8_t>& data);
+
+		/**
+		 * @brief Sends precomputed frame as is, CRC must already be included
+		 * (see modbusFrames.hpp)
 		 */
-		std::vector<uint8_t> send(std::vector<uint8_t> data);
+		void sendFrame(const uint8_t* frame, std::size_t size) { writeFrame(frame, size); }
 
+		template <std::size_t N>
+		void sendFrame(const std::array<uint8_t, N>& frame) { writeFrame(frame.data(), N); }
+
+		//! Drops all received, not yet processed data
 		void clearInput();
 
+		/**
+		 * @brief Records every sent and received frame (including CRC) into
+		 * `sink`, nullptr disables tracing. Sink must outlive the connection.
+		 */
+		void setTraceSink(MB::TraceSink* sink) noexcept { _trace = sink; }
+
 		[[nodiscard]] std::tuple<MB::ModbusResponse, std::vector<uint8_t>> awaitResponse();
 		[[nodiscard]] std::tuple<MB::ModbusRequest, std::vector<uint8_t>> awaitRequest();
 
+		/**
+		 * @brief Non throwing variants of awaitResponse / awaitRequest.
+		 * Exception reported by the device is returned as its error code.
+		 */
+		[[nodiscard]] MB::Result<std::tuple<MB::ModbusResponse, std::vector<uint8_t>>> tryAwaitResponse() noexcept;
+		[[nodiscard]] MB::Result<std::tuple<MB::ModbusRequest, std::vector<uint8_t>>> tryAwaitRequest() noexcept;
+
+		/**
+		 * @brief Allocation free variants of tryAwaitResponse / tryAwaitRequest.
+		 * Raw frame (including CRC) is copied into `raw`, buffers of
+		 * FrameBufferPool with default size always fit.
+		 */
+		[[nodiscard]] MB::Result<MB::ModbusResponse> tryAwaitResponse(MB::FrameBuffer& raw) noexcept;
+		[[nodiscard]] MB::Result<MB::ModbusRequest> tryAwaitRequest(MB::FrameBuffer& raw) noexcept;
+
 		[[nodiscard]] std::vector<uint8_t> awaitRawMessage();
 		[[nodiscard]] std::vector<uint8_t> readRawMessage(const int expectedResponseLength = 0);
 
@@ -99,6 +169,8 @@ namespace MB::Serial {
 			return (_fd > -1);
 		}
 
+		[[nodiscard]] int nativeHandle() const { return _fd; }
+
 #define setBaud(s)                                                             \
   case s:                                                                      \
     speed = B##s;                                                              \
@@ -125,7 +197,7 @@ namespace MB::Serial {
 				setBaud(115200);
 				setBaud(230400);
 			default:
-				throw std::runtime_error("Invalid baud rate");
+				MB_THROW(std::runtime_error("Invalid baud rate"));
 			}
 			cfsetospeed(&_termios, speed);
 			cfsetispeed(&_termios, speed);
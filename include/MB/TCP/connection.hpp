@@ -5,17 +5,24 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <type_traits>
 
 #include <cerrno>
-#include <libnet.h>
+#include <arpa/inet.h>
 #include <netinet/in.h>
 #include <poll.h>
 #include <sys/socket.h>
+#include <unistd.h>
 
 #include "MB/modbusException.hpp"
+#include "MB/modbusFraming.hpp"
+#include "MB/modbusMbapFramer.hpp"
 #include "MB/modbusRequest.hpp"
 #include "MB/modbusResponse.hpp"
+#include "MB/modbusResult.hpp"
+#include "MB/modbusTrace.hpp"
+#include "socketOptions.hpp"
 
 namespace MB::TCP {
 class Connection {
@@ -26,6 +33,26 @@ class Connection {
     int _sockfd         = -1;
     uint16_t _messageID = 0;
     int _timeout        = Connection::DefaultTCPTimeout;
+    //! TCP_QUICKACK is re-armed after every receive
+    bool _quickAck = false;
+
+    //! Reused transmit buffer, keeps its capacity between sends
+    std::vector<uint8_t> _txBuffer;
+    //! Reassembles frames from received stream, keeps bytes of next frames
+    MB::MbapFramer _rxFramer;
+    //! Last frame returned by receive, valid until the next receive
+    MB::MbapFrame _rxFrame;
+    //! Optional sink of sent and received frames, not owned
+    MB::TraceSink *_trace = nullptr;
+
+    //! Receives single ADU into _rxFrame, reading the socket only if needed
+    MB::Status receive(int timeout, MB::utils::MBErrorCode onTimeout) noexcept;
+    //! Parses response (or exception) held in _rxFrame
+    MB::Result<MB::ModbusResponse> parseResponse() const noexcept;
+
+    template <typename Message> const std::vector<uint8_t> &sendMessage(const Message &);
+    //! Writes whole _txBuffer, stops early only if the connection failed
+    void write() noexcept;
 
   public:
     explicit Connection() noexcept : _sockfd(-1), _messageID(0) {};
@@ -41,6 +68,12 @@ class Connection {
 
         _sockfd       = other._sockfd;
         _messageID    = other._messageID;
+        _timeout      = other._timeout;
+        _quickAck     = other._quickAck;
+        _txBuffer     = std::move(other._txBuffer);
+        _rxFramer     = std::move(other._rxFramer);
+        _rxFrame      = other._rxFrame;
+        _trace        = other._trace;
         other._sockfd = -1;
 
         return *this;
@@ -48,21 +81,75 @@ class Connection {
 
     [[nodiscard]] int getSockfd() const { return _sockfd; }
 
-    static Connection with(std::string addr, int port);
+    static Connection with(std::string addr, int port,
+                           const SocketOptions &options = SocketOptions());
 
     ~Connection();
 
-    std::vector<uint8_t> sendRequest(const MB::ModbusRequest &req);
-    std::vector<uint8_t> sendResponse(const MB::ModbusResponse &res);
-    std::vector<uint8_t> sendException(const MB::ModbusException &ex);
-
+    /**
+     * Send functions encode the whole ADU in one pass into internal buffer.
+     * Returned reference stays valid until the next send.
+     */
+    const std::vector<uint8_t> &sendRequest(const MB::ModbusRequest &req);
+    const std::vector<uint8_t> &sendResponse(const MB::ModbusResponse &res);
+    const std::vector<uint8_t> &sendException(const MB::ModbusException &ex);
+
+    /**
+     * @brief Encodes requests back to back and writes them with single
+     * syscall. Transaction IDs are consecutive, starting with getMessageId(),
+     * which is left at ID of the last request.
+     */
+    const std::vector<uint8_t> &sendRequests(const MB::ModbusRequest *requests,
+                                             std::size_t count);
+
+    /**
+     * Await functions throw ModbusException on any error, including
+     * exception reported by the device.
+     *
+     * Exactly one frame is consumed per call. Frames that arrived together
+     * with it (or its part) are kept for the following calls.
+     */
     [[nodiscard]] MB::ModbusRequest awaitRequest();
     [[nodiscard]] MB::ModbusResponse awaitResponse();
 
+    /**
+     * Non throwing variants of awaitRequest / awaitResponse, exception
+     * reported by the device is returned as its error code.
+     */
+    [[nodiscard]] MB::Result<MB::ModbusRequest> tryAwaitRequest() noexcept;
+    [[nodiscard]] MB::Result<MB::ModbusResponse> tryAwaitResponse() noexcept;
+
+    /**
+     * @brief Awaits response of any transaction, not only the last one sent.
+     *
+     * Transaction ID of the received frame is stored into `transactionID`,
+     * also when parsing fails or the device reported exception, so several
+     * requests can be in flight (see PipelinedClient). It is left empty if
+     * no frame was received.
+     */
+    [[nodiscard]] MB::Result<MB::ModbusResponse>
+    tryAwaitAnyResponse(std::optional<uint16_t> &transactionID) noexcept;
+
     [[nodiscard]] std::vector<uint8_t> awaitRawMessage();
 
+    //! True if next frame was already received, so await functions do not
+    //! touch the socket
+    [[nodiscard]] bool hasBufferedFrame() const noexcept { return _rxFramer.hasFrame(); }
+
     [[nodiscard]] uint16_t getMessageId() const { return _messageID; }
 
     void setMessageId(uint16_t messageId) { _messageID = messageId; }
+
+    //! Time for response, in milliseconds
+    void setTimeout(int timeout) noexcept { _timeout = timeout; }
+
+    //! Applies options to the socket, false if kernel refused any of them
+    bool setSocketOptions(const SocketOptions &options) noexcept;
+
+    /**
+     * @brief Records every sent and received frame (unit id and PDU) into
+     * `sink`, nullptr disables tracing. Sink must outlive the connection.
+     */
+    void setTraceSink(MB::TraceSink *sink) noexcept { _trace = sink; }
 };
 } // namespace MB::TCP
@@ -0,0 +1,189 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "pipelinedClient.hpp"
+
+namespace MB::TCP {
+/**
+ * @brief Thread safe pool of connections to Modbus TCP gateways.
+ *
+ * Unit IDs are routed to gateways (endpoints), every gateway limits number
+ * of its open connections and of transactions in flight, summed over all
+ * of its connections. Connections are opened lazily, kept open for reuse
+ * and dropped when they fail.
+ *
+ * Transactions that do not fit into the limits wait in queue of their
+ * caller. Queues of callers waiting for the same gateway are served round
+ * robin. A turn is single transaction, or one window of pipelined requests,
+ * so a caller with many waiting transactions can not starve others.
+ *
+ * When connecting to gateway fails `failureThreshold` times in a row, it is
+ * considered unhealthy and its transactions fail immediately with
+ * ConnectionClosed until `retryDelay` passes.
+ */
+class ConnectionPool {
+  public:
+    //! Identifies queue of the caller, by default the calling thread
+    using CallerId = uint64_t;
+
+    struct Endpoint {
+        std::string address;
+        int port = 502;
+
+        friend bool operator<(const Endpoint &lhs, const Endpoint &rhs) noexcept {
+            return std::tie(lhs.address, lhs.port) < std::tie(rhs.address, rhs.port);
+        }
+        friend bool operator==(const Endpoint &lhs, const Endpoint &rhs) noexcept {
+            return lhs.address == rhs.address && lhs.port == rhs.port;
+        }
+    };
+
+    struct Limits {
+        std::size_t maxConnections = 2;
+        //! Transactions in flight over all connections of the gateway
+        std::size_t maxInFlight = 4;
+        //! Time for response, in milliseconds
+        int timeout = Connection::DefaultTCPTimeout;
+        std::chrono::milliseconds connectTimeout{3000};
+        //! Consecutive failed connections after which gateway is unhealthy
+        std::size_t failureThreshold = 3;
+        std::chrono::milliseconds retryDelay{1000};
+        //! Pipelined batches suffer from Nagle and delayed acks the most
+        SocketOptions socketOptions = SocketOptions::lowLatency();
+    };
+
+    struct GatewayStats {
+        //! Open connections, including those being connected
+        std::size_t connections = 0;
+        std::size_t idle        = 0;
+        std::size_t inFlight    = 0;
+        //! Transactions waiting for connection or in flight slot
+        std::size_t queued              = 0;
+        std::size_t consecutiveFailures = 0;
+        bool healthy                    = true;
+        uint64_t transactions           = 0;
+        //! Failed connects and connections dropped because of errors
+        uint64_t connectionFailures = 0;
+    };
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    //! Transactions of single call waiting for (or holding) connection
+    struct Waiter {
+        explicit Waiter(std::size_t slots) : wanted(slots) {}
+
+        //! In flight slots wanted, at least one is granted
+        std::size_t wanted;
+        std::size_t granted = 0;
+        bool served         = false;
+        //! Limits of the gateway at the time of grant
+        Limits limits;
+        //! Empty on grant if connection has to be opened
+        std::unique_ptr<PipelinedClient> client;
+        bool connected     = false;
+        bool connectFailed = false;
+        std::condition_variable ready;
+    };
+
+    struct Gateway {
+        Endpoint endpoint;
+        Limits limits;
+
+        std::size_t connections = 0;
+        std::size_t inFlight    = 0;
+        std::vector<std::unique_ptr<PipelinedClient>> idle;
+
+        std::map<CallerId, std::deque<Waiter *>> queues;
+        std::size_t queued = 0;
+        //! Caller served last, next turn goes to the one following it
+        CallerId lastServed = 0;
+
+        std::size_t consecutiveFailures = 0;
+        Clock::time_point retryAt;
+        uint64_t transactions       = 0;
+        uint64_t connectionFailures = 0;
+
+        [[nodiscard]] bool healthy() const noexcept {
+            return consecutiveFailures < limits.failureThreshold;
+        }
+    };
+
+    Limits _defaults;
+    mutable std::mutex _mutex;
+    std::map<Endpoint, std::unique_ptr<Gateway>> _gateways;
+    std::array<Gateway *, 256> _routes{};
+
+    Gateway &gateway(const Endpoint &endpoint);
+    //! Grants connections and slots of the gateway to waiters, in turns
+    void dispatch(Gateway &gateway);
+    //! Fails all waiters of the gateway, used when it becomes unhealthy
+    void reject(Gateway &gateway);
+
+    //! Waits for connection and slots of the gateway, false if unhealthy
+    bool acquire(Gateway &gateway, Waiter &waiter, CallerId caller);
+    //! Returns connection (unless it was dropped) and slots of the waiter
+    void release(Gateway &gateway, Waiter &waiter);
+
+    //! Executes requests, all routed to `gateway`, in turns of its queue
+    void execute(Gateway &gateway, const MB::ModbusRequest *requests, std::size_t count,
+                 MB::Result<MB::ModbusResponse> *results, CallerId caller);
+
+  public:
+    ConnectionPool();
+    //! Limits of gateways added implicitly by route()
+    explicit ConnectionPool(Limits defaults);
+    ConnectionPool(const ConnectionPool &)            = delete;
+    ConnectionPool &operator=(const ConnectionPool &) = delete;
+
+    /**
+     * @brief Adds gateway or changes its limits, connections are not opened
+     * yet. Limits of connections and in flight transactions of 0 are treated
+     * as 1.
+     */
+    void addGateway(const Endpoint &endpoint, Limits limits);
+    //! Routes unit ID to the gateway, adding it with default limits if needed
+    void route(uint8_t unit, const Endpoint &endpoint);
+
+    /**
+     * @brief Executes request on gateway of its unit ID, blocking until the
+     * response arrives.
+     *
+     * Fails with GatewayPathUnavailable if the unit is not routed, with
+     * ConnectionClosed if the gateway can not be reached, otherwise like
+     * PipelinedClient::receive.
+     */
+    [[nodiscard]] MB::Result<MB::ModbusResponse>
+    transact(const MB::ModbusRequest &request, CallerId caller = currentCaller());
+
+    /**
+     * @brief Executes requests, pipelined up to in flight limit of their
+     * gateway. Requests routed to different gateways are executed one
+     * gateway after another. Results are in order of requests.
+     */
+    [[nodiscard]] std::vector<MB::Result<MB::ModbusResponse>>
+    transact(const std::vector<MB::ModbusRequest> &requests,
+             CallerId caller = currentCaller());
+
+    [[nodiscard]] std::optional<GatewayStats> stats(const Endpoint &endpoint) const;
+
+    [[nodiscard]] static CallerId currentCaller() noexcept;
+};
+} // namespace MB::TCP
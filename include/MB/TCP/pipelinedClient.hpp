@@ -0,0 +1,137 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "connection.hpp"
+
+namespace MB::TCP {
+/**
+ * @brief Modbus TCP client keeping several transactions in flight on single
+ * connection.
+ *
+ * Every request gets next transaction ID and responses are matched by ID in
+ * whatever order the server sends them. Number of outstanding requests is
+ * limited by the window, gateways typically accept 8 to 16. Responses of
+ * unknown transactions (for example late responses of forgotten ones) are
+ * dropped.
+ */
+class PipelinedClient {
+  public:
+    static constexpr std::size_t DefaultWindow = 8;
+
+    //! Response (or error reported for it) of single transaction
+    struct Completion {
+        uint16_t transactionID;
+        MB::Result<MB::ModbusResponse> response;
+    };
+
+  private:
+    Connection _connection;
+    std::size_t _window;
+    uint16_t _nextID = 0;
+    //! Transaction IDs awaiting response, at most _window of them
+    std::vector<uint16_t> _inFlight;
+
+    //! Removes ID from in flight transactions, false if it was not there
+    bool complete(uint16_t transactionID) noexcept;
+
+  public:
+    //! Window of 0 is treated as 1
+    explicit PipelinedClient(Connection connection, std::size_t window = DefaultWindow);
+
+    [[nodiscard]] Connection &connection() noexcept { return _connection; }
+
+    [[nodiscard]] std::size_t window() const noexcept { return _window; }
+    //! Changes window, transactions already in flight are not affected
+    void setWindow(std::size_t window);
+
+    [[nodiscard]] std::size_t inFlight() const noexcept { return _inFlight.size(); }
+    [[nodiscard]] bool canSend() const noexcept { return _inFlight.size() < _window; }
+
+    /**
+     * @brief Sends request without waiting for its response.
+     * @return Transaction ID of the request, std::nullopt if window is full
+     */
+    std::optional<uint16_t> send(const MB::ModbusRequest &request);
+
+    /**
+     * @brief Sends as many requests as the window allows, encoded into one
+     * buffer and written with single syscall.
+     * @return Number of sent requests, their transaction IDs are consecutive
+     * starting with nextTransactionID() before the call
+     */
+    std::size_t send(const MB::ModbusRequest *requests, std::size_t count);
+
+    [[nodiscard]] uint16_t nextTransactionID() const noexcept { return _nextID; }
+
+    /**
+     * @brief Waits for response of any in flight transaction.
+     *
+     * Exception reported by the device (or malformed response) completes
+     * the transaction with error in Completion::response. Connection level
+     * failures (Timeout, ConnectionClosed, ...) are returned as error, in
+     * flight transactions stay pending.
+     */
+    [[nodiscard]] MB::Result<Completion> receive() noexcept;
+
+    //! True if receive() can complete from already received data
+    [[nodiscard]] bool hasBufferedResponse() const noexcept {
+        return _connection.hasBufferedFrame();
+    }
+
+    //! Forgets all in flight transactions, their responses will be dropped
+    void reset() noexcept { _inFlight.clear(); }
+
+    /**
+     * @brief Executes all requests, keeping the window full.
+     *
+     * Responses received together are completed before the window is
+     * refilled, so freed slots are refilled by single write.
+     *
+     * `onResponse(index, Result<ModbusResponse>)` is called for every
+     * request, in order of arrival of responses.
+     * @return First connection level error, remaining requests are not
+     * completed in that case
+     */
+    template <typename OnResponse>
+    MB::Status transact(const MB::ModbusRequest *requests, std::size_t count,
+                        OnResponse &&onResponse);
+
+    //! Executes all requests, results are in order of requests
+    std::vector<MB::Result<MB::ModbusResponse>>
+    transact(const std::vector<MB::ModbusRequest> &requests);
+};
+
+template <typename OnResponse>
+MB::Status PipelinedClient::transact(const MB::ModbusRequest *requests, std::size_t count,
+                                     OnResponse &&onResponse) {
+    // IDs are consecutive, so index is the distance from the first one
+    const uint16_t firstID = _nextID;
+    std::size_t sent       = 0;
+    std::size_t completed  = 0;
+
+    while (completed < count) {
+        sent += send(requests + sent, count - sent);
+
+        do {
+            auto completion = receive();
+            if (!completion)
+                return completion.error();
+
+            const auto index = static_cast<uint16_t>(completion->transactionID - firstID);
+            if (index >= sent)
+                continue; // Transaction sent before this batch
+            onResponse(static_cast<std::size_t>(index), std::move(completion->response));
+            completed++;
+        } while (completed < count && hasBufferedResponse());
+    }
+    return {};
+}
+} // namespace MB::TCP
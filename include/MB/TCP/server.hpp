@@ -8,7 +8,7 @@
 #include <stdexcept>
 #include <string>
 
-#include <libnet.h>
+#include <arpa/inet.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
 
@@ -20,15 +20,18 @@ class Server {
     int _serverfd;
     int _port;
     sockaddr_in _server;
+    SocketOptions _options;
 
   public:
-    explicit Server(int port);
+    //! Options are applied to the listening socket and to every accepted connection
+    explicit Server(int port, const SocketOptions &options = SocketOptions());
     ~Server();
 
     Server(const Server &) = delete;
     Server(Server &&moved) {
         _serverfd       = moved._serverfd;
         _port           = moved._port;
+        _options        = moved._options;
         moved._serverfd = -1;
     }
     Server &operator=(Server &&moved) {
@@ -37,6 +40,7 @@ class Server {
 
         _serverfd       = moved._serverfd;
         _port           = moved._port;
+        _options        = moved._options;
         moved._serverfd = -1;
         return *this;
     }
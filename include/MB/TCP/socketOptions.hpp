@@ -0,0 +1,54 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <chrono>
+
+namespace MB::TCP {
+/**
+ * @brief Options of TCP sockets, applied to client connections, listening
+ * sockets and accepted connections.
+ *
+ * Default constructed options change nothing, lowLatency() and throughput()
+ * are profiles for the two common cases.
+ */
+struct SocketOptions {
+    //! Disables Nagle algorithm (TCP_NODELAY), so ADU is sent without waiting
+    //! for acknowledgement of the previous one
+    bool noDelay = false;
+    //! Acknowledges segments immediately (TCP_QUICKACK). Kernel leaves quick
+    //! ack mode on its own, so Connection re-arms it after every receive,
+    //! which costs a syscall. Helps only against peers that keep Nagle on.
+    bool quickAck = false;
+
+    //! Probes idle connections, so dead peers are detected (SO_KEEPALIVE)
+    bool keepAlive = false;
+    std::chrono::seconds keepAliveIdle{60};
+    std::chrono::seconds keepAliveInterval{10};
+    int keepAliveProbes = 3;
+
+    //! Busy polls device queue in blocking receives (SO_BUSY_POLL), 0 disables.
+    //! Opt-in, no profile sets it: values above net.core.busy_read (0 by
+    //! default) require CAP_NET_ADMIN, otherwise apply() fails with EPERM.
+    std::chrono::microseconds busyPoll{0};
+
+    //! Kernel buffer sizes (SO_SNDBUF, SO_RCVBUF), 0 keeps system default
+    int sendBuffer    = 0;
+    int receiveBuffer = 0;
+
+    //! No Nagle and keepalive, applies without privileges
+    [[nodiscard]] static SocketOptions lowLatency() noexcept;
+    //! No Nagle, keepalive and 256 KiB buffers, acks stay delayed (piggybacked
+    //! on requests) and nothing costs syscalls or CPU per receive
+    [[nodiscard]] static SocketOptions throughput() noexcept;
+
+    /**
+     * @brief Applies options to the socket, options left at default are not
+     * touched. Every option is tried even if some of them fail.
+     * @return False if kernel refused any option
+     */
+    bool apply(int sockfd) const noexcept;
+};
+} // namespace MB::TCP
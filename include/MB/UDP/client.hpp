@@ -0,0 +1,192 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "MB/modbusRequest.hpp"
+#include "MB/modbusResponse.hpp"
+#include "MB/modbusResult.hpp"
+#include "datagramBatch.hpp"
+
+namespace MB::UDP {
+/**
+ * @brief Modbus/UDP client, one MBAP framed request per datagram.
+ *
+ * Requests of a transaction are sent by sendmmsg() in batches of up to
+ * window datagrams, responses are taken by recvmmsg() and matched by
+ * transaction ID in whatever order they arrive. Request left without
+ * response for the timeout is sent again with the same transaction ID, so
+ * late response to any of its copies completes it. After the last retry it
+ * completes with Timeout. Responses of unknown transactions, duplicates and
+ * malformed datagrams are dropped.
+ */
+class Client {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int DefaultTimeout        = 500;
+    static constexpr unsigned DefaultRetries   = 2;
+    static constexpr std::size_t DefaultWindow = 32;
+
+    struct Stats {
+        //! Datagrams sent, retransmissions included
+        uint64_t sent        = 0;
+        uint64_t retransmits = 0;
+        //! Requests completed with Timeout after the last retry
+        uint64_t timeouts = 0;
+        //! Received datagrams matching no transaction in flight
+        uint64_t dropped = 0;
+    };
+
+  private:
+    //! Request waiting for its response
+    struct Pending {
+        std::size_t index;
+        uint16_t transactionID;
+        unsigned attempts;
+        Clock::time_point deadline;
+    };
+
+    int _sockfd = -1;
+    std::size_t _window;
+    int _timeout      = DefaultTimeout;
+    unsigned _retries = DefaultRetries;
+    uint16_t _nextID  = 0;
+    DatagramBatch _tx;
+    DatagramBatch _rx;
+    std::vector<Pending> _pending;
+    Stats _stats;
+
+    //! Queues (re)transmission of pending request, flushes full batch
+    MB::Status send(const MB::ModbusRequest &request, Pending &pending,
+                    Clock::time_point now) noexcept;
+    //! Waits until the earliest deadline of pending requests for responses
+    MB::Result<std::size_t> receive() noexcept;
+    /**
+     * @brief Parses received datagram and completes its pending request,
+     * whose index is stored into `index`. It is left empty if the datagram
+     * matched no pending request.
+     */
+    MB::Result<MB::ModbusResponse> complete(std::size_t datagram,
+                                            std::optional<std::size_t> &index) noexcept;
+
+  public:
+    /**
+     * @brief Client over UDP socket connected to the device, taking its
+     * ownership. Window of 0 is treated as 1.
+     */
+    explicit Client(int sockfd, std::size_t window = DefaultWindow);
+    Client(const Client &)            = delete;
+    Client &operator=(const Client &) = delete;
+    Client(Client &&moved) noexcept;
+    Client &operator=(Client &&moved) noexcept;
+    ~Client();
+
+    //! Connects new UDP socket to the device
+    static Client with(const std::string &addr, int port,
+                       std::size_t window = DefaultWindow);
+
+    [[nodiscard]] int getSockfd() const noexcept { return _sockfd; }
+
+    //! Requests in flight at once, also the largest batch per syscall
+    [[nodiscard]] std::size_t window() const noexcept { return _window; }
+
+    //! Time for response of each send, in milliseconds
+    void setTimeout(int timeout) noexcept { _timeout = timeout; }
+    //! Retransmissions of request before it fails with Timeout
+    void setRetries(unsigned retries) noexcept { _retries = retries; }
+
+    [[nodiscard]] const Stats &stats() const noexcept { return _stats; }
+
+    //! Executes single request, exception reported by device is its error
+    [[nodiscard]] MB::Result<MB::ModbusResponse>
+    transact(const MB::ModbusRequest &request) noexcept;
+
+    /**
+     * @brief Executes all requests, keeping the window full.
+     *
+     * `onResponse(index, Result<ModbusResponse>)` is called for every
+     * request, in order of arrival of responses, requests without response
+     * get Timeout.
+     * @return Socket level error, remaining requests are not completed in
+     * that case
+     */
+    template <typename OnResponse>
+    MB::Status transact(const MB::ModbusRequest *requests, std::size_t count,
+                        OnResponse &&onResponse);
+
+    //! Executes all requests, results are in order of requests
+    std::vector<MB::Result<MB::ModbusResponse>>
+    transact(const std::vector<MB::ModbusRequest> &requests);
+};
+
+template <typename OnResponse>
+MB::Status Client::transact(const MB::ModbusRequest *requests, std::size_t count,
+                            OnResponse &&onResponse) {
+    // IDs of the call are consecutive, responses to earlier calls are dropped
+    const uint16_t firstID = _nextID;
+    _nextID                = static_cast<uint16_t>(_nextID + count);
+    _pending.clear();
+    std::size_t next      = 0;
+    std::size_t completed = 0;
+
+    while (completed < count) {
+        const auto now = Clock::now();
+        // Retransmits expired requests, fails those out of retries
+        for (std::size_t i = 0; i < _pending.size();) {
+            auto &pending = _pending[i];
+            if (pending.deadline > now) {
+                i++;
+                continue;
+            }
+            if (pending.attempts > _retries) {
+                const auto index = pending.index;
+                pending          = _pending.back();
+                _pending.pop_back();
+                _stats.timeouts++;
+                completed++;
+                onResponse(index, MB::Result<MB::ModbusResponse>(MB::utils::Timeout));
+                continue;
+            }
+            if (auto status = send(requests[pending.index], pending, now); !status)
+                return status;
+            i++;
+        }
+
+        while (next < count && _pending.size() < _window) {
+            _pending.push_back({next, static_cast<uint16_t>(firstID + next), 0, now});
+            if (auto status = send(requests[next], _pending.back(), now); !status)
+                return status;
+            next++;
+        }
+        if (auto status = _tx.send(_sockfd); !status)
+            return status;
+        if (_pending.empty())
+            continue;
+
+        auto received = receive();
+        if (!received) {
+            if (received.error() == MB::utils::Timeout)
+                continue;
+            return received.error();
+        }
+        for (std::size_t i = 0; i < received.value(); i++) {
+            std::optional<std::size_t> index;
+            auto response = complete(i, index);
+            if (!index)
+                continue;
+            completed++;
+            onResponse(*index, std::move(response));
+        }
+    }
+    return {};
+}
+} // namespace MB::UDP
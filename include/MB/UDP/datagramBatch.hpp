@@ -0,0 +1,97 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "MB/modbusFraming.hpp"
+#include "MB/modbusMbapFramer.hpp"
+#include "MB/modbusResult.hpp"
+
+namespace MB::UDP {
+/**
+ * @brief Fixed number of datagram slots, sent with single sendmmsg() or
+ * filled by single recvmmsg().
+ *
+ * Every slot holds one MBAP framed ADU with its peer address. All storage is
+ * allocated by the constructor, sending and receiving allocate nothing.
+ */
+class DatagramBatch {
+  public:
+    //! Largest Modbus/UDP datagram, same as largest Modbus/TCP ADU
+    static constexpr std::size_t SlotSize = MB::MbapFramer::MaxFrameSize;
+
+  private:
+    std::vector<uint8_t> _data;
+    std::vector<iovec> _vectors;
+    std::vector<mmsghdr> _headers;
+    std::vector<sockaddr_in> _addresses;
+    //! Used slots, from the front
+    std::size_t _size = 0;
+
+  public:
+    //! Batch of `slots` datagrams, 0 is treated as 1
+    explicit DatagramBatch(std::size_t slots);
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return _headers.size(); }
+    [[nodiscard]] std::size_t size() const noexcept { return _size; }
+    [[nodiscard]] bool empty() const noexcept { return _size == 0; }
+    [[nodiscard]] bool full() const noexcept { return _size == _headers.size(); }
+    void clear() noexcept { _size = 0; }
+
+    //! Contents of slot `index`
+    [[nodiscard]] const uint8_t *data(std::size_t index) const noexcept {
+        return _data.data() + index * SlotSize;
+    }
+    //! Received (or queued) bytes of slot `index`
+    [[nodiscard]] std::size_t length(std::size_t index) const noexcept {
+        return _headers[index].msg_len;
+    }
+    //! Sender of received slot `index`
+    [[nodiscard]] const sockaddr_in &address(std::size_t index) const noexcept {
+        return _addresses[index];
+    }
+
+    /**
+     * @brief Encodes message with MBAP header into next free slot, addressed
+     * to `address` or to the peer of connected socket if nullptr.
+     * @return False if batch is full
+     */
+    template <typename Message>
+    bool push(const Message &message, uint16_t transactionID,
+              const sockaddr_in *address = nullptr) {
+        if (full())
+            return false;
+        auto *slot        = _data.data() + _size * SlotSize;
+        const auto length = MB::encodeTCP(message, transactionID, slot, SlotSize);
+        commit(length, address);
+        return true;
+    }
+
+    /**
+     * @brief Sends all queued datagrams and clears the batch, sendmmsg() is
+     * called again only if the kernel took part of them.
+     * @return ConnectionClosed if peer of connected socket is unreachable,
+     * ProtocolError on other socket errors
+     */
+    MB::Status send(int fd) noexcept;
+
+    /**
+     * @brief Waits up to `timeout` milliseconds (-1 forever) for datagrams,
+     * then takes as many as are queued, up to capacity().
+     * @return Number of received datagrams, Timeout if none arrived
+     */
+    MB::Result<std::size_t> receive(int fd, int timeout) noexcept;
+
+  private:
+    void commit(std::size_t length, const sockaddr_in *address) noexcept;
+};
+} // namespace MB::UDP
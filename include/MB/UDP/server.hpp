@@ -0,0 +1,100 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "MB/modbusException.hpp"
+#include "MB/modbusRequest.hpp"
+#include "MB/modbusResponse.hpp"
+#include "MB/modbusResult.hpp"
+#include "datagramBatch.hpp"
+
+namespace MB::UDP {
+/**
+ * @brief Modbus/UDP server, answers requests of any number of clients on
+ * single socket.
+ *
+ * Requests are taken by recvmmsg() in batches, responses of the whole batch
+ * go back to their senders with single sendmmsg(). There is no per client
+ * state, every datagram is answered on its own with transaction ID of the
+ * request. Malformed datagrams are dropped.
+ */
+class Server {
+  public:
+    static constexpr std::size_t DefaultBatch = 32;
+
+  private:
+    int _sockfd = -1;
+    DatagramBatch _rx;
+    DatagramBatch _tx;
+
+    /**
+     * @brief Parses received datagram, stores transaction ID of the request
+     * into `transactionID`. It is left empty for datagrams that are not MBAP
+     * framed.
+     */
+    MB::Result<MB::ModbusRequest>
+    request(std::size_t datagram, std::optional<uint16_t> &transactionID) const noexcept;
+
+  public:
+    //! Binds to `port` on all interfaces, 0 picks free port (see port())
+    explicit Server(int port, std::size_t batch = DefaultBatch);
+    Server(const Server &)            = delete;
+    Server &operator=(const Server &) = delete;
+    Server(Server &&moved) noexcept;
+    Server &operator=(Server &&moved) noexcept;
+    ~Server();
+
+    [[nodiscard]] int nativeHandle() const noexcept { return _sockfd; }
+    //! Port the socket is bound to
+    [[nodiscard]] int port() const noexcept;
+
+    /**
+     * @brief Waits up to `timeout` milliseconds (-1 forever) for requests and
+     * answers every received one.
+     *
+     * `handler(const ModbusRequest &)` returns the response, or
+     * Result<ModbusResponse> whose standard error code is sent back as
+     * exception (other errors as SlaveDeviceFailure).
+     * @return Number of received requests, Timeout if none arrived
+     */
+    template <typename Handler>
+    MB::Result<std::size_t> serve(Handler &&handler, int timeout = -1);
+};
+
+template <typename Handler>
+MB::Result<std::size_t> Server::serve(Handler &&handler, int timeout) {
+    auto received = _rx.receive(_sockfd, timeout);
+    if (!received)
+        return received;
+
+    for (std::size_t i = 0; i < received.value(); i++) {
+        std::optional<uint16_t> transactionID;
+        const auto request = this->request(i, transactionID);
+        if (!request)
+            continue;
+
+        const MB::Result<MB::ModbusResponse> response = handler(request.value());
+        if (response) {
+            _tx.push(response.value(), *transactionID, &_rx.address(i));
+        } else {
+            const auto code = MB::utils::isStandardErrorCode(response.error())
+                                  ? response.error()
+                                  : MB::utils::SlaveDeviceFailure;
+            const MB::ModbusException exception(code, request->slaveID(),
+                                                request->functionCode());
+            _tx.push(exception, *transactionID, &_rx.address(i));
+        }
+    }
+
+    // Batches are equally large, so every request fits
+    if (auto status = _tx.send(_sockfd); !status)
+        return status.error();
+    return received;
+}
+} // namespace MB::UDP
@@ -0,0 +1,159 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+class FrameBufferPool;
+
+/**
+ * @brief Owning handle of single buffer taken from FrameBufferPool.
+ *
+ * Buffer goes back to its pool when the handle is destroyed. Size can change
+ * freely up to capacity(), contents are not cleared.
+ */
+class FrameBuffer {
+  private:
+    FrameBufferPool *_pool = nullptr;
+    uint8_t *_data         = nullptr;
+    std::size_t _size      = 0;
+
+    friend class FrameBufferPool;
+    FrameBuffer(FrameBufferPool *pool, uint8_t *data) noexcept
+        : _pool(pool), _data(data) {}
+
+  public:
+    //! Empty handle, holds no buffer
+    FrameBuffer() noexcept = default;
+    FrameBuffer(const FrameBuffer &)            = delete;
+    FrameBuffer &operator=(const FrameBuffer &) = delete;
+
+    FrameBuffer(FrameBuffer &&other) noexcept
+        : _pool(other._pool), _data(other._data), _size(other._size) {
+        other._pool = nullptr;
+        other._data = nullptr;
+        other._size = 0;
+    }
+
+    FrameBuffer &operator=(FrameBuffer &&other) noexcept {
+        if (this != &other) {
+            release();
+            std::swap(_pool, other._pool);
+            std::swap(_data, other._data);
+            std::swap(_size, other._size);
+        }
+        return *this;
+    }
+
+    ~FrameBuffer() { release(); }
+
+    //! Returns buffer to the pool, handle becomes empty
+    void release() noexcept;
+
+    [[nodiscard]] explicit operator bool() const noexcept { return _data != nullptr; }
+
+    [[nodiscard]] uint8_t *data() noexcept { return _data; }
+    [[nodiscard]] const uint8_t *data() const noexcept { return _data; }
+    [[nodiscard]] std::size_t size() const noexcept { return _size; }
+    [[nodiscard]] bool empty() const noexcept { return _size == 0; }
+    //! Size of every buffer of the pool, 0 for empty handle
+    [[nodiscard]] std::size_t capacity() const noexcept;
+
+    [[nodiscard]] uint8_t *begin() noexcept { return _data; }
+    [[nodiscard]] uint8_t *end() noexcept { return _data + _size; }
+    [[nodiscard]] const uint8_t *begin() const noexcept { return _data; }
+    [[nodiscard]] const uint8_t *end() const noexcept { return _data + _size; }
+
+    uint8_t &operator[](std::size_t index) noexcept { return _data[index]; }
+    uint8_t operator[](std::size_t index) const noexcept { return _data[index]; }
+
+    //! Sets size, returns false (and keeps size) if it exceeds capacity()
+    bool resize(std::size_t size) noexcept {
+        if (size > capacity())
+            return false;
+        _size = size;
+        return true;
+    }
+
+    //! Copies `size` bytes into the buffer, false if they do not fit
+    bool assign(const uint8_t *data, std::size_t size) noexcept;
+};
+
+/**
+ * @brief Pool of equally sized, cache line aligned frame buffers.
+ *
+ * Buffers are allocated in slabs when the pool runs dry and are never
+ * returned to the heap before the pool is destroyed, so code that acquires
+ * and releases buffers in a loop stops allocating once the pool has grown
+ * to its working set (or after reserve()). Free buffers are linked through
+ * their first bytes, acquire and release only move the list head.
+ *
+ * Pool is not thread safe, keep one per thread or connection (as
+ * Poll::PollEngine does for every serial line). All buffers must be
+ * released before the pool is destroyed.
+ */
+class FrameBufferPool {
+  public:
+    //! Fits largest RTU (256) and TCP (260) frame, multiple of cache line
+    static constexpr std::size_t DefaultBufferSize = 320;
+    static constexpr std::size_t CacheLine         = 64;
+    //! Number of buffers allocated at once when the pool is empty
+    static constexpr std::size_t SlabBuffers = 16;
+
+  private:
+    struct SlabDelete {
+        void operator()(uint8_t *slab) const noexcept;
+    };
+
+    std::size_t _bufferSize;
+    std::vector<std::unique_ptr<uint8_t[], SlabDelete>> _slabs;
+    //! Head of free buffers list, every free buffer starts with the next one
+    uint8_t *_free         = nullptr;
+    std::size_t _available = 0;
+    std::size_t _total     = 0;
+
+    friend class FrameBuffer;
+    void release(uint8_t *buffer) noexcept;
+    void grow(std::size_t buffers);
+
+  public:
+    //! Buffer size is rounded up to multiple of CacheLine
+    explicit FrameBufferPool(std::size_t bufferSize = DefaultBufferSize,
+                             std::size_t reserved   = 0);
+    FrameBufferPool(const FrameBufferPool &)            = delete;
+    FrameBufferPool &operator=(const FrameBufferPool &) = delete;
+
+    //! Takes buffer from the pool, allocates new slab if none is free
+    [[nodiscard]] FrameBuffer acquire();
+
+    //! Makes sure at least `buffers` buffers are free
+    void reserve(std::size_t buffers);
+
+    [[nodiscard]] std::size_t bufferSize() const noexcept { return _bufferSize; }
+    //! Number of buffers owned by the pool, free or in use
+    [[nodiscard]] std::size_t allocated() const noexcept { return _total; }
+    //! Number of buffers that can be acquired without allocation
+    [[nodiscard]] std::size_t available() const noexcept { return _available; }
+};
+
+inline std::size_t FrameBuffer::capacity() const noexcept {
+    return _pool ? _pool->bufferSize() : 0;
+}
+
+inline void FrameBuffer::release() noexcept {
+    if (_pool)
+        _pool->release(_data);
+    _pool = nullptr;
+    _data = nullptr;
+    _size = 0;
+}
+} // namespace MB
@@ -8,6 +8,8 @@
 #include <stdexcept>
 #include <variant>
 
+#include "modbusFormat.hpp"
+
 /**
  * Namespace that contains whole project
  */
@@ -109,5 +111,13 @@ class ModbusCell {
     [[nodiscard]] std::string toString() const noexcept {
         return isCoil() ? ((coil()) ? "true" : "false") : std::to_string(reg());
     }
+
+    //! Appends the same text as toString to `out`, never allocates
+    void formatTo(utils::FormatBuffer &out) const noexcept {
+        if (isCoil())
+            out << (coil() ? "true" : "false");
+        else
+            out << reg();
+    }
 };
 } // namespace MB
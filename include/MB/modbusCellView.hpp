@@ -0,0 +1,142 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include "modbusCell.hpp"
+#include "modbusCoilBitset.hpp"
+#include "modbusRegisterBlock.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * @brief Read only, ModbusCell based view over RegisterBlock or CoilBitset.
+ *
+ * Kept for compatibility with code written against std::vector<ModbusCell>.
+ * Cells are materialized on access, so prefer RegisterBlock / CoilBitset
+ * accessors in performance sensitive code.
+ */
+class ModbusCellView {
+  private:
+    const RegisterBlock *_registers = nullptr;
+    const CoilBitset *_coils        = nullptr;
+
+  public:
+    /**
+     * @brief Iterator refers to the storage, not to the view, so it stays
+     * valid after the view returned by registerValues() is destroyed.
+     */
+    class const_iterator {
+      private:
+        const RegisterBlock *_registers;
+        const CoilBitset *_coils;
+        std::size_t _index;
+
+        [[nodiscard]] ModbusCell at(std::size_t index) const noexcept {
+            if (_coils)
+                return ModbusCell::initCoil(_coils->test(index));
+            return ModbusCell::initReg((*_registers)[index]);
+        }
+
+      public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = ModbusCell;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = ModbusCell;
+
+        const_iterator(const RegisterBlock *registers, const CoilBitset *coils,
+                       std::size_t index) noexcept
+            : _registers(registers), _coils(coils), _index(index) {}
+
+        ModbusCell operator*() const noexcept { return at(_index); }
+        ModbusCell operator[](difference_type n) const noexcept { return at(_index + n); }
+
+        const_iterator &operator++() noexcept {
+            ++_index;
+            return *this;
+        }
+        const_iterator operator++(int) noexcept { return {_registers, _coils, _index++}; }
+        const_iterator &operator--() noexcept {
+            --_index;
+            return *this;
+        }
+        const_iterator operator--(int) noexcept { return {_registers, _coils, _index--}; }
+        const_iterator &operator+=(difference_type n) noexcept {
+            _index += n;
+            return *this;
+        }
+        const_iterator &operator-=(difference_type n) noexcept {
+            _index -= n;
+            return *this;
+        }
+        const_iterator operator+(difference_type n) const noexcept {
+            return {_registers, _coils, _index + n};
+        }
+        const_iterator operator-(difference_type n) const noexcept {
+            return {_registers, _coils, _index - n};
+        }
+        difference_type operator-(const const_iterator &other) const noexcept {
+            return static_cast<difference_type>(_index) -
+                   static_cast<difference_type>(other._index);
+        }
+
+        bool operator==(const const_iterator &other) const noexcept {
+            return _registers == other._registers && _coils == other._coils &&
+                   _index == other._index;
+        }
+        bool operator!=(const const_iterator &other) const noexcept {
+            return !(*this == other);
+        }
+        bool operator<(const const_iterator &other) const noexcept {
+            return _index < other._index;
+        }
+    };
+
+    explicit ModbusCellView(const RegisterBlock &registers) noexcept
+        : _registers(&registers) {}
+    explicit ModbusCellView(const CoilBitset &coils) noexcept : _coils(&coils) {}
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return _coils ? _coils->size() : _registers->size();
+    }
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+    [[nodiscard]] bool holdsCoils() const noexcept { return _coils != nullptr; }
+
+    ModbusCell operator[](std::size_t index) const noexcept {
+        if (_coils)
+            return ModbusCell::initCoil(_coils->test(index));
+        return ModbusCell::initReg((*_registers)[index]);
+    }
+
+    [[nodiscard]] ModbusCell front() const noexcept { return (*this)[0]; }
+    [[nodiscard]] ModbusCell back() const noexcept { return (*this)[size() - 1]; }
+
+    [[nodiscard]] const_iterator begin() const noexcept {
+        return {_registers, _coils, 0};
+    }
+    [[nodiscard]] const_iterator end() const noexcept {
+        return {_registers, _coils, size()};
+    }
+
+    //! Materializes cells, allocates
+    [[nodiscard]] std::vector<ModbusCell> toVector() const {
+        if (_coils) {
+            bool values[CoilBitset::Capacity];
+            _coils->copyTo(values);
+            return std::vector<ModbusCell>(values, values + _coils->size());
+        }
+        return std::vector<ModbusCell>(begin(), end());
+    }
+
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    operator std::vector<ModbusCell>() const { return toVector(); }
+};
+} // namespace MB
@@ -0,0 +1,173 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+
+#include "modbusCoilPack.hpp"
+#include "modbusUtils.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * @brief Packed set of coils with inline storage.
+ *
+ * Bits are stored in Modbus wire order (coil `i` is bit `i % 8` of byte `i / 8`),
+ * so frames can be loaded and stored with a plain memcpy. Bits past size() are
+ * always kept cleared.
+ */
+class CoilBitset {
+  public:
+    //! Maximum number of coils in a single Modbus read (FC1 / FC2)
+    static constexpr std::size_t Capacity     = 2000;
+    static constexpr std::size_t ByteCapacity = Capacity / 8;
+
+  private:
+    std::array<uint8_t, ByteCapacity> _bytes{};
+    uint16_t _size = 0;
+
+    void clearTail() noexcept {
+        const auto used = byteSize();
+        if (_size % 8 != 0)
+            _bytes[used - 1] &= static_cast<uint8_t>((1u << (_size % 8)) - 1);
+        std::fill(_bytes.begin() + used, _bytes.end(), 0);
+    }
+
+  public:
+    constexpr CoilBitset() noexcept = default;
+
+    /**
+     * @brief Constructs bitset with `count` coils set to `value`.
+     * @throws std::length_error - When count exceeds Capacity.
+     */
+    explicit CoilBitset(std::size_t count, bool value = false) {
+        resize(count);
+        if (value) {
+            std::fill_n(_bytes.begin(), byteSize(), 0xFF);
+            clearTail();
+        }
+    }
+
+    /**
+     * @brief Constructs bitset from list of coil values.
+     * @throws std::length_error - When list exceeds Capacity.
+     */
+    CoilBitset(std::initializer_list<bool> values) {
+        assign(values.begin(), values.size());
+    }
+
+    [[nodiscard]] static constexpr std::size_t capacity() noexcept { return Capacity; }
+    [[nodiscard]] std::size_t size() const noexcept { return _size; }
+    [[nodiscard]] bool empty() const noexcept { return _size == 0; }
+    //! Number of bytes needed to represent coils on the wire
+    [[nodiscard]] std::size_t byteSize() const noexcept { return (_size + 7) / 8; }
+
+    //! Packed bytes in Modbus wire order
+    [[nodiscard]] uint8_t *data() noexcept { return _bytes.data(); }
+    [[nodiscard]] const uint8_t *data() const noexcept { return _bytes.data(); }
+
+    [[nodiscard]] bool test(std::size_t index) const noexcept {
+        return (_bytes[index / 8] >> (index % 8)) & 1;
+    }
+
+    bool operator[](std::size_t index) const noexcept { return test(index); }
+
+    /**
+     * @brief Bounds checked access.
+     * @throws std::out_of_range - When index is not smaller than size().
+     */
+    [[nodiscard]] bool at(std::size_t index) const {
+        if (index >= _size)
+            MB_THROW(std::out_of_range("CoilBitset index out of range"));
+        return test(index);
+    }
+
+    void set(std::size_t index, bool value = true) noexcept {
+        const auto mask = static_cast<uint8_t>(1u << (index % 8));
+        if (value)
+            _bytes[index / 8] |= mask;
+        else
+            _bytes[index / 8] &= static_cast<uint8_t>(~mask);
+    }
+
+    void reset(std::size_t index) noexcept { set(index, false); }
+
+    /**
+     * @brief Changes number of coils, new coils are cleared.
+     * @throws std::length_error - When count exceeds Capacity.
+     */
+    void resize(std::size_t count) {
+        if (count > Capacity)
+            MB_THROW(std::length_error("CoilBitset capacity exceeded"));
+        _size = static_cast<uint16_t>(std::min<std::size_t>(_size, count));
+        clearTail();
+        _size = static_cast<uint16_t>(count);
+    }
+
+    /**
+     * @brief Appends coil to the back of the bitset.
+     * @throws std::length_error - When bitset is full.
+     */
+    void push_back(bool value) {
+        if (_size == Capacity)
+            MB_THROW(std::length_error("CoilBitset capacity exceeded"));
+        set(_size++, value);
+    }
+
+    void clear() noexcept {
+        std::fill_n(_bytes.begin(), byteSize(), 0);
+        _size = 0;
+    }
+
+    /**
+     * @brief Loads `count` coils from packed Modbus wire representation.
+     * @throws std::length_error - When count exceeds Capacity.
+     */
+    void assignPacked(const uint8_t *bytes, std::size_t count) {
+        if (count > Capacity)
+            MB_THROW(std::length_error("CoilBitset capacity exceeded"));
+        _size = static_cast<uint16_t>(count);
+        std::memcpy(_bytes.data(), bytes, byteSize());
+        clearTail();
+    }
+
+    /**
+     * @brief Loads `count` coils from array of bools.
+     * @throws std::length_error - When count exceeds Capacity.
+     */
+    void assign(const bool *values, std::size_t count) {
+        if (count > Capacity)
+            MB_THROW(std::length_error("CoilBitset capacity exceeded"));
+        const auto oldBytes = byteSize();
+        _size               = static_cast<uint16_t>(count);
+        utils::packCoils(values, count, _bytes.data());
+        if (oldBytes > byteSize())
+            std::fill(_bytes.begin() + byteSize(), _bytes.begin() + oldBytes, 0);
+    }
+
+    //! Stores all size() coils into `values`
+    void copyTo(bool *values) const noexcept {
+        utils::unpackCoils(_bytes.data(), _size, values);
+    }
+
+    friend bool operator==(const CoilBitset &lhs, const CoilBitset &rhs) noexcept {
+        return lhs._size == rhs._size &&
+               std::equal(lhs._bytes.begin(), lhs._bytes.begin() + lhs.byteSize(),
+                          rhs._bytes.begin());
+    }
+
+    friend bool operator!=(const CoilBitset &lhs, const CoilBitset &rhs) noexcept {
+        return !(lhs == rhs);
+    }
+};
+} // namespace MB
@@ -0,0 +1,60 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Conversion between packed coils (Modbus wire order, coil `i` is bit `i % 8`
+// of byte `i / 8`) and arrays holding one coil per byte. Packed form is also
+// the layout of CoilBitset, so no conversion is needed between the two.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace MB::utils {
+//! Available pack / unpack implementations
+enum CoilKernel : uint8_t {
+    CoilScalar, //!< Shifts, one byte of coils at a time
+    CoilSse2,   //!< PMOVMSKB / PCMPEQB over 16 coils (x86-64 only)
+    CoilBmi2    //!< PEXT / PDEP over 8 coils (x86-64 only)
+};
+
+//! Checks if kernel can be used on the running CPU
+bool isCoilKernelSupported(CoilKernel kernel) noexcept;
+
+//! Returns kernel used by default, selected once at startup
+CoilKernel activeCoilKernel() noexcept;
+
+/**
+ * @brief Packs `count` coils, any non zero byte of `values` is an ON coil.
+ *
+ * Writes (count + 7) / 8 bytes to `packed`, unused bits of the last byte
+ * are cleared.
+ * @note Kernel must be supported, see isCoilKernelSupported.
+ */
+void packCoils(const uint8_t *values, std::size_t count, uint8_t *packed,
+               CoilKernel kernel) noexcept;
+
+//! Packs coils using fastest kernel available on this CPU
+void packCoils(const uint8_t *values, std::size_t count, uint8_t *packed) noexcept;
+
+/**
+ * @brief Unpacks `count` coils into bytes equal to 0 or 1.
+ * @note Kernel must be supported, see isCoilKernelSupported.
+ */
+void unpackCoils(const uint8_t *packed, std::size_t count, uint8_t *values,
+                 CoilKernel kernel) noexcept;
+
+//! Unpacks coils using fastest kernel available on this CPU
+void unpackCoils(const uint8_t *packed, std::size_t count, uint8_t *values) noexcept;
+
+static_assert(sizeof(bool) == 1, "Coil kernels treat bool arrays as bytes");
+
+inline void packCoils(const bool *values, std::size_t count, uint8_t *packed) noexcept {
+    packCoils(reinterpret_cast<const uint8_t *>(values), count, packed);
+}
+
+inline void unpackCoils(const uint8_t *packed, std::size_t count, bool *values) noexcept {
+    unpackCoils(packed, count, reinterpret_cast<uint8_t *>(values));
+}
+} // namespace MB::utils
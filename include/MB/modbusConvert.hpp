@@ -0,0 +1,72 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Batch conversion between register payloads (as on the wire) and arrays of
+// native values. utils::bigEndianConv / combineUint32 stay for single values.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "modbusUtils.hpp"
+
+namespace MB::utils {
+//! Available conversion implementations
+enum ConvertKernel : uint8_t {
+    ConvertScalar, //!< Byte permutation, one element at a time
+    ConvertSsse3,  //!< PSHUFB over 16 bytes (x86 only)
+    ConvertAvx2    //!< VPSHUFB over 32 bytes (x86 only)
+};
+
+//! Checks if kernel can be used on the running CPU
+bool isConvertKernelSupported(ConvertKernel kernel) noexcept;
+
+//! Returns kernel used by default, selected once at startup
+ConvertKernel activeConvertKernel() noexcept;
+
+/**
+ * @brief Reorders bytes of `count` elements of `size` (2, 4 or 8) bytes
+ * between wire order and native order.
+ *
+ * Values wider than one register are split into registers according to
+ * `order`; 64 bit values follow the same rules over four registers (CDAB
+ * reverses register order, BADC swaps bytes within every register). Every
+ * order is its own inverse, so the same call serves both directions.
+ * `src` and `dst` may be the same buffer, but must not partially overlap.
+ * @note Kernel must be supported, see isConvertKernelSupported.
+ */
+void convertOrder(const uint8_t *src, uint8_t *dst, std::size_t count, std::size_t size,
+                  WordOrder order, ConvertKernel kernel) noexcept;
+
+//! Reorders bytes using fastest kernel available on this CPU
+void convertOrder(const uint8_t *src, uint8_t *dst, std::size_t count, std::size_t size,
+                  WordOrder order = ABCD) noexcept;
+
+/**
+ * @brief Decodes `count` values from register payload at `src`.
+ *
+ * 16 bit values take one register, 32 bit values two and doubles four.
+ * For 16 bit values only the byte swap part of `order` applies.
+ */
+template <typename T>
+void decodeRegisters(const uint8_t *src, std::size_t count, T *dst,
+                     WordOrder order = ABCD) noexcept {
+    static_assert(std::is_arithmetic_v<T> &&
+                      (sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8),
+                  "Unsupported value type");
+    convertOrder(src, reinterpret_cast<uint8_t *>(dst), count, sizeof(T), order);
+}
+
+//! Encodes `count` values into register payload at `dst`, see decodeRegisters
+template <typename T>
+void encodeRegisters(const T *src, std::size_t count, uint8_t *dst,
+                     WordOrder order = ABCD) noexcept {
+    static_assert(std::is_arithmetic_v<T> &&
+                      (sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8),
+                  "Unsupported value type");
+    convertOrder(reinterpret_cast<const uint8_t *>(src), dst, count, sizeof(T), order);
+}
+} // namespace MB::utils
@@ -0,0 +1,72 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// High throughput CRC-16/Modbus engine. utils::calculateCRC stays as the
+// scalar reference implementation.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace MB::utils {
+//! Initial value of Modbus CRC register
+constexpr uint16_t CrcInit = 0xFFFF;
+
+//! Available CRC implementations
+enum CrcKernel : uint8_t {
+    CrcReference, //!< Byte at a time table lookup, same algorithm as calculateCRC
+    CrcSlicing8,  //!< Slicing-by-8 tables
+    CrcSlicing16, //!< Slicing-by-16 tables
+    CrcClmul      //!< PCLMULQDQ carry-less multiplication folding (x86 only)
+};
+
+//! Checks if kernel can be used on the running CPU
+bool isCrcKernelSupported(CrcKernel kernel) noexcept;
+
+//! Returns kernel used by crc16 for large buffers, selected once at startup
+CrcKernel activeCrcKernel() noexcept;
+
+/**
+ * @brief Continues CRC calculation over `len` bytes using given kernel.
+ * @note Kernel not supported by the CPU (see isCrcKernelSupported) falls
+ * back to slicing-by-8.
+ */
+uint16_t crc16(const uint8_t *buff, std::size_t len, uint16_t crc,
+               CrcKernel kernel) noexcept;
+
+//! Continues CRC calculation using fastest kernel available on this CPU
+uint16_t crc16(const uint8_t *buff, std::size_t len, uint16_t crc = CrcInit) noexcept;
+
+//! Calculates CRC using fastest kernel available on this CPU
+inline uint16_t crc16(const std::vector<uint8_t> &buffer) noexcept {
+    return crc16(buffer.data(), buffer.size());
+}
+
+/**
+ * @brief Incremental CRC state, allows checking frame while bytes arrive.
+ *
+ * Feeding a frame together with its (little endian) CRC leaves the register
+ * at zero, which is what matches() checks.
+ */
+class Crc16 {
+  private:
+    uint16_t _crc = CrcInit;
+
+  public:
+    constexpr Crc16() noexcept = default;
+
+    void update(const uint8_t *buff, std::size_t len) noexcept {
+        _crc = crc16(buff, len, _crc);
+    }
+    void update(uint8_t byte) noexcept { update(&byte, 1); }
+
+    [[nodiscard]] uint16_t value() const noexcept { return _crc; }
+    //! True if all bytes fed so far form a frame ending with valid CRC
+    [[nodiscard]] bool matches() const noexcept { return _crc == 0; }
+
+    void reset() noexcept { _crc = CrcInit; }
+};
+} // namespace MB::utils
@@ -9,6 +9,7 @@
 #include <stdexcept>
 #include <vector>
 
+#include "modbusResult.hpp"
 #include "modbusUtils.hpp"
 
 /**
@@ -42,6 +43,9 @@ class ModbusException : public std::exception {
     explicit ModbusException(const std::vector<uint8_t> &inputData,
                              bool CRC = false) noexcept;
 
+    //! Constructs Exception from `size` raw bytes at `data`, see above
+    ModbusException(const uint8_t *data, std::size_t size, bool CRC = false) noexcept;
+
     //! Constructs Exception based on error code, function code and slaveId
     explicit ModbusException(
         utils::MBErrorCode errorCode, uint8_t slaveId = 0xFF,
@@ -55,12 +59,25 @@ class ModbusException : public std::exception {
      * checked at ModbusRequest/ModbusResponse
      * */
     static bool exist(const std::vector<uint8_t> &inputData) noexcept {
-        if (inputData.size() < 2) // TODO Figure out better solution to such mistake
+        return exist(inputData.data(), inputData.size());
+    }
+
+    //! Check if there is Modbus error in `size` raw bytes at `data`
+    static bool exist(const uint8_t *data, std::size_t size) noexcept {
+        if (size < 2) // TODO Figure out better solution to such mistake
             return false;
 
-        return inputData[1] & 0b10000000;
+        return data[1] & 0b10000000;
     }
 
+    /**
+     * @brief Parses exception frame from `size` bytes at `data`, never throws.
+     * @return Parsed exception, InvalidByteOrder if input is not a complete
+     * exception frame or InvalidCRC on CRC mismatch
+     */
+    static Result<ModbusException> tryFromRaw(const uint8_t *data, std::size_t size,
+                                              bool CRC = false) noexcept;
+
     /*
      *  Returns attached SlaveID
      *  NOTE: it is worth to check if slaveId is specified with isSlaveValid()
@@ -79,21 +96,35 @@ class ModbusException : public std::exception {
     //! Returns detected error code
     [[nodiscard]] utils::MBErrorCode getErrorCode() const noexcept { return _errorCode; }
 
+    //! Longest text produced by toString / formatTo, without terminating null
+    static constexpr std::size_t MaxStringSize = 160;
+
     /**
-     * This function is less optimal, it is just to be compatible with
-     * std::excepetion You should preferably use toString()
+     * @brief Compatibility with std::exception, see toString / formatTo.
+     * @note Text is kept in thread local buffer, valid until the next call
+     * to what() on any ModbusException in the same thread.
      */
-    [[nodiscard]] const char *what() const noexcept override {
-        auto og   = toString();
-        char *str = new char[og.size()];
-        stpcpy(str, og.c_str());
-        return str;
-    }
+    [[nodiscard]] const char *what() const noexcept override;
 
     //! Returns string representation of object
     [[nodiscard]] std::string toString() const noexcept;
+    /**
+     * @brief Writes string representation into caller provided buffer,
+     * truncated to `capacity` - 1 characters and null terminated.
+     * @return Number of characters written
+     */
+    std::size_t formatTo(char *buffer, std::size_t capacity) const noexcept;
     //! Converts object to modbus byte representation
     [[nodiscard]] std::vector<uint8_t> toRaw() const noexcept;
+    //! Returns number of bytes produced by toRaw / encodeInto
+    [[nodiscard]] static constexpr std::size_t encodedSize() noexcept { return 3; }
+    /**
+     * @brief Writes modbus byte representation into caller provided buffer.
+     * @return Number of bytes written, 0 if capacity is too small.
+     */
+    std::size_t encodeInto(uint8_t *buffer, std::size_t capacity) const noexcept;
+    //! Appends modbus byte representation to the buffer, reusing its capacity
+    void appendTo(std::vector<uint8_t> &buffer) const;
 
     [[nodiscard]] utils::MBFunctionCode functionCode() const noexcept {
         return _functionCode;
@@ -0,0 +1,71 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace MB::utils {
+/**
+ * @brief Builds text in caller provided buffer, never allocates.
+ *
+ * Output is cut when the buffer is full and is always null terminated, so
+ * it is safe to use for fixed size buffers in formatTo functions.
+ */
+class FormatBuffer {
+  private:
+    char *_buffer;
+    std::size_t _capacity;
+    std::size_t _size = 0;
+    bool _truncated   = false;
+
+  public:
+    //! `capacity` includes terminating null and must not be 0
+    FormatBuffer(char *buffer, std::size_t capacity) noexcept
+        : _buffer(buffer), _capacity(capacity) {
+        _buffer[0] = '\0';
+    }
+
+    FormatBuffer &operator<<(std::string_view text) noexcept {
+        const auto fits = std::min(text.size(), _capacity - 1 - _size);
+        std::memcpy(_buffer + _size, text.data(), fits);
+        _size += fits;
+        _truncated |= fits < text.size();
+        _buffer[_size] = '\0';
+        return *this;
+    }
+
+    FormatBuffer &operator<<(char c) noexcept { return *this << std::string_view(&c, 1); }
+
+    //! Appends decimal representation of integer (including uint8_t)
+    template <typename T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+    FormatBuffer &operator<<(T value) noexcept {
+        char digits[24];
+        const auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+        return *this << std::string_view(digits, static_cast<std::size_t>(end - digits));
+    }
+
+    //! Appends bytes as upper case hex pairs separated by spaces
+    FormatBuffer &hex(const uint8_t *data, std::size_t size) noexcept {
+        constexpr char Digits[] = "0123456789ABCDEF";
+        for (std::size_t i = 0; i < size; i++) {
+            const char pair[3] = {' ', Digits[data[i] >> 4], Digits[data[i] & 0xF]};
+            *this << (i == 0 ? std::string_view(pair + 1, 2) : std::string_view(pair, 3));
+        }
+        return *this;
+    }
+
+    //! Number of characters written, without terminating null
+    [[nodiscard]] std::size_t size() const noexcept { return _size; }
+    //! True if some of the text did not fit into the buffer
+    [[nodiscard]] bool truncated() const noexcept { return _truncated; }
+    [[nodiscard]] std::string_view view() const noexcept { return {_buffer, _size}; }
+};
+} // namespace MB::utils
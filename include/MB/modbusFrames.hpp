@@ -0,0 +1,88 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Compile time RTU frames for requests known in advance (fixed polling).
+//
+// Example:
+//   constexpr auto poll = MB::frames::ReadHolding<0x11, 0x006B, 3>;
+//   connection.sendFrame(poll);
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "modbusCoilBitset.hpp"
+#include "modbusRegisterBlock.hpp"
+#include "modbusUtils.hpp"
+
+namespace MB::frames {
+//! Size of every read / write single request frame, including CRC
+constexpr std::size_t RequestFrameSize = 8;
+
+//! Complete RTU request frame
+using RequestFrame = std::array<uint8_t, RequestFrameSize>;
+
+/**
+ * @brief Builds RTU frame with four byte body: address followed by value
+ * (write single) or by count (read).
+ */
+constexpr RequestFrame makeRequestFrame(uint8_t slave, utils::MBFunctionCode code,
+                                        uint16_t address, uint16_t value) {
+    RequestFrame frame{slave,
+                       code,
+                       static_cast<uint8_t>(address >> 8),
+                       static_cast<uint8_t>(address & 0xFF),
+                       static_cast<uint8_t>(value >> 8),
+                       static_cast<uint8_t>(value & 0xFF),
+                       0,
+                       0};
+    const auto crc = utils::calculateCRC(frame.data(), RequestFrameSize - 2);
+    frame[6]       = static_cast<uint8_t>(crc & 0xFF);
+    frame[7]       = static_cast<uint8_t>(crc >> 8);
+    return frame;
+}
+
+//! Builds read request frame, count is checked against protocol limits
+template <uint8_t Slave, utils::MBFunctionCode Code, uint16_t Address, uint16_t Count>
+constexpr RequestFrame makeReadFrame() {
+    static_assert(utils::functionType(Code) == utils::Read, "Not a read function");
+    static_assert(Count > 0, "Read count must be positive");
+    static_assert(Count <= (utils::isCoilFunction(Code) ? CoilBitset::Capacity
+                                                        : RegisterBlock::Capacity),
+                  "Read count exceeds single frame limit");
+    return makeRequestFrame(Slave, Code, Address, Count);
+}
+
+//! Read output coils (FC1)
+template <uint8_t Slave, uint16_t Address, uint16_t Count>
+inline constexpr RequestFrame ReadCoils =
+    makeReadFrame<Slave, utils::ReadDiscreteOutputCoils, Address, Count>();
+
+//! Read input contacts (FC2)
+template <uint8_t Slave, uint16_t Address, uint16_t Count>
+inline constexpr RequestFrame ReadDiscreteInputs =
+    makeReadFrame<Slave, utils::ReadDiscreteInputContacts, Address, Count>();
+
+//! Read holding registers (FC3)
+template <uint8_t Slave, uint16_t Address, uint16_t Count>
+inline constexpr RequestFrame ReadHolding =
+    makeReadFrame<Slave, utils::ReadAnalogOutputHoldingRegisters, Address, Count>();
+
+//! Read input registers (FC4)
+template <uint8_t Slave, uint16_t Address, uint16_t Count>
+inline constexpr RequestFrame ReadInput =
+    makeReadFrame<Slave, utils::ReadAnalogInputRegisters, Address, Count>();
+
+//! Write single coil (FC5)
+template <uint8_t Slave, uint16_t Address, bool Value>
+inline constexpr RequestFrame WriteSingleCoil =
+    makeRequestFrame(Slave, utils::WriteSingleDiscreteOutputCoil, Address,
+                     Value ? 0xFF00 : 0x0000);
+
+//! Write single holding register (FC6)
+template <uint8_t Slave, uint16_t Address, uint16_t Value>
+inline constexpr RequestFrame WriteSingleRegister =
+    makeRequestFrame(Slave, utils::WriteSingleAnalogOutputRegister, Address, Value);
+} // namespace MB::frames
@@ -0,0 +1,118 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Helpers that wrap encoded PDUs into transport frames (RTU / MBAP) in a
+// single pass, directly into caller provided buffers, and parse responses
+// out of received frames.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "modbusCrc.hpp"
+#include "modbusException.hpp"
+#include "modbusResponse.hpp"
+#include "modbusResult.hpp"
+#include "modbusUtils.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * @brief Modbus application protocol header used by TCP (and UDP).
+ * @note Unit identifier is not part of this struct, library treats it as
+ * slave id, i.e. as the first byte of encoded message.
+ */
+struct MbapHeader {
+    //! Bytes before unit identifier
+    static constexpr std::size_t Size = 6;
+
+    uint16_t transactionID = 0;
+    uint16_t protocolID    = 0;
+    //! Number of following bytes, including unit identifier
+    uint16_t length = 0;
+
+    void encodeInto(uint8_t *buffer) const noexcept {
+        buffer[0] = static_cast<uint8_t>(transactionID >> 8);
+        buffer[1] = static_cast<uint8_t>(transactionID & 0xFF);
+        buffer[2] = static_cast<uint8_t>(protocolID >> 8);
+        buffer[3] = static_cast<uint8_t>(protocolID & 0xFF);
+        buffer[4] = static_cast<uint8_t>(length >> 8);
+        buffer[5] = static_cast<uint8_t>(length & 0xFF);
+    }
+
+    static MbapHeader decode(const uint8_t *buffer) noexcept {
+        return {utils::bigEndianConv(buffer), utils::bigEndianConv(buffer + 2),
+                utils::bigEndianConv(buffer + 4)};
+    }
+};
+
+/**
+ * @brief Encodes message (request, response or exception) with MBAP header.
+ * @return Number of bytes written, 0 if capacity is too small.
+ */
+template <typename Message>
+std::size_t encodeTCP(const Message &message, uint16_t transactionID, uint8_t *buffer,
+                      std::size_t capacity) {
+    const auto size = message.encodedSize();
+    if (capacity < MbapHeader::Size + size)
+        return 0;
+
+    MbapHeader{transactionID, 0, static_cast<uint16_t>(size)}.encodeInto(buffer);
+    message.encodeInto(buffer + MbapHeader::Size, size);
+    return MbapHeader::Size + size;
+}
+
+//! Appends message with MBAP header to the buffer, reusing its capacity
+template <typename Message>
+void appendTCP(const Message &message, uint16_t transactionID,
+               std::vector<uint8_t> &buffer) {
+    const auto offset = buffer.size();
+    buffer.resize(offset + MbapHeader::Size + message.encodedSize());
+    encodeTCP(message, transactionID, buffer.data() + offset, buffer.size() - offset);
+}
+
+/**
+ * @brief Parses response PDU (starting with unit identifier, as it follows
+ * MBAP header) in place. Exception reported by the device is returned as
+ * its error code.
+ */
+inline Result<ModbusResponse> parseResponse(const uint8_t *pdu,
+                                            std::size_t size) noexcept {
+    if (ModbusException::exist(pdu, size)) {
+        const auto exception = ModbusException::tryFromRaw(pdu, size);
+        return exception ? exception->getErrorCode() : exception.error();
+    }
+
+    return ModbusResponse::tryFromRaw(pdu, size);
+}
+
+/**
+ * @brief Encodes message (request, response or exception) followed by CRC.
+ * @return Number of bytes written, 0 if capacity is too small.
+ */
+template <typename Message>
+std::size_t encodeRTU(const Message &message, uint8_t *buffer, std::size_t capacity) {
+    const auto size = message.encodedSize();
+    if (capacity < size + 2)
+        return 0;
+
+    message.encodeInto(buffer, size);
+    const auto crc   = utils::crc16(buffer, size);
+    buffer[size]     = static_cast<uint8_t>(crc & 0xFF);
+    buffer[size + 1] = static_cast<uint8_t>(crc >> 8);
+    return size + 2;
+}
+
+//! Appends message followed by CRC to the buffer, reusing its capacity
+template <typename Message>
+void appendRTU(const Message &message, std::vector<uint8_t> &buffer) {
+    const auto offset = buffer.size();
+    buffer.resize(offset + message.encodedSize() + 2);
+    encodeRTU(message, buffer.data() + offset, buffer.size() - offset);
+}
+} // namespace MB
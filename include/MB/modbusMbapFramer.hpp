@@ -0,0 +1,105 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "modbusFraming.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * @brief Non owning view of single ADU held by MbapFramer.
+ * @note View is valid until next call to MbapFramer::writable or clear.
+ */
+struct MbapFrame {
+    MbapHeader header;
+    //! Whole ADU, starting with MBAP header
+    const uint8_t *data = nullptr;
+    std::size_t size    = 0;
+
+    //! Unit identifier followed by PDU, this is what message parsers expect
+    [[nodiscard]] const uint8_t *pdu() const noexcept { return data + MbapHeader::Size; }
+    [[nodiscard]] std::size_t pduSize() const noexcept { return size - MbapHeader::Size; }
+};
+
+/**
+ * @brief Reassembles MBAP frames from TCP byte stream.
+ *
+ * Bytes are received directly into the framer (see writable / commit) and
+ * exact frames are cut using length field of MBAP header, so several frames
+ * from single recv() as well as frames split across many segments are
+ * handled. Leftover bytes stay in the buffer for the next call. Consumed
+ * space is reclaimed by moving the (short) unconsumed tail to the front,
+ * only when the free tail can not hold a maximal frame, so frames are always
+ * contiguous.
+ */
+class MbapFramer {
+  public:
+    //! Largest ADU: MBAP header, unit identifier and 253 bytes of PDU
+    static constexpr std::size_t MaxFrameSize    = MbapHeader::Size + 254;
+    static constexpr std::size_t DefaultCapacity = 4096;
+
+  private:
+    std::vector<uint8_t> _buffer;
+    std::size_t _capacity;
+    std::size_t _begin = 0;
+    std::size_t _end   = 0;
+    bool _invalid      = false;
+
+  public:
+    //! Buffer is allocated on first use, capacity is at least MaxFrameSize
+    explicit MbapFramer(std::size_t capacity = DefaultCapacity) noexcept;
+
+    /**
+     * @brief Returns pointer to free space that can be filled by recv().
+     *
+     * Invalidates previously returned frames. At least MaxFrameSize bytes
+     * are available, unless buffer is full of not yet consumed frames.
+     */
+    uint8_t *writable();
+    //! Number of bytes that can be written at pointer returned by writable()
+    [[nodiscard]] std::size_t writableSize() const noexcept {
+        return _buffer.size() - _end;
+    }
+    //! Marks `size` bytes written at writable() as received
+    void commit(std::size_t size) noexcept { _end += size; }
+
+    //! Copies bytes into the framer, returns how many fitted
+    std::size_t feed(const uint8_t *data, std::size_t size);
+
+    /**
+     * @brief Extracts next complete frame.
+     * @return Frame, or std::nullopt if more data is needed or the stream is
+     * invalid (see invalid())
+     */
+    std::optional<MbapFrame> next() noexcept;
+
+    /**
+     * @brief True after header with non zero protocol id or impossible
+     * length was found. TCP stream can not be resynchronized, connection
+     * should be closed.
+     */
+    [[nodiscard]] bool invalid() const noexcept { return _invalid; }
+
+    //! Number of received bytes not returned as frame yet
+    [[nodiscard]] std::size_t pending() const noexcept { return _end - _begin; }
+
+    //! True if whole next frame is buffered, so next() needs no more data
+    [[nodiscard]] bool hasFrame() const noexcept;
+
+    //! Drops all buffered bytes and invalid state
+    void clear() noexcept {
+        _begin   = 0;
+        _end     = 0;
+        _invalid = false;
+    }
+};
+} // namespace MB
@@ -0,0 +1,209 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Client side cache of read responses, shared by all threads reading the
+// same devices.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "modbusRequest.hpp"
+#include "modbusResponse.hpp"
+#include "modbusResult.hpp"
+#include "modbusUtils.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * @brief Caches responses of reads (FC1 - FC4) for a limited time.
+ *
+ * Responses are kept per endpoint, unit, table and address range. Endpoint is
+ * any name of the path to the device, e.g. "10.0.0.5:502" or "/dev/ttyUSB0".
+ * A cached range serves reads of any range it contains. Reads of a range
+ * that is being read already wait for that transaction instead of sending
+ * their own (single-flight), its result, error included, is shared.
+ *
+ * How long a response stays usable depends on TTL class of the read, so
+ * fast changing measurements and static configuration may share one cache.
+ * Writes sent through write() drop cached ranges they overlap, and results
+ * of reads in flight during the write are not cached.
+ *
+ * All methods are thread safe, transactions run outside of the cache lock.
+ */
+class ReadCache {
+  public:
+    using Clock = std::chrono::steady_clock;
+    //! Index of TTL class, class 0 always exists
+    using TtlClass = std::size_t;
+
+    struct Stats {
+        //! Reads served from cached ranges
+        uint64_t hits = 0;
+        //! Reads that sent their own transaction
+        uint64_t misses = 0;
+        //! Reads that waited for a transaction of another read
+        uint64_t shared = 0;
+        //! Cached ranges dropped by writes or invalidate()
+        uint64_t invalidations = 0;
+    };
+
+  private:
+    //! Transaction in progress, shared by all reads waiting for it
+    struct Flight {
+        uint16_t address;
+        uint16_t count;
+        //! Overlapping range was written, result must not be cached
+        bool stale = false;
+        std::optional<Result<ModbusResponse>> result;
+        std::condition_variable done;
+
+        Flight(uint16_t address, uint16_t count) : address(address), count(count) {}
+    };
+
+    struct Entry {
+        uint16_t address;
+        uint16_t count;
+        Clock::time_point fetched;
+        ModbusResponse response;
+    };
+
+    //! Ranges of single unit and table
+    struct Table {
+        std::vector<Entry> entries;
+        std::vector<std::shared_ptr<Flight>> flights;
+    };
+
+    //! Tables of an endpoint, keyed by unit << 8 | function code
+    using Device = std::map<uint16_t, Table>;
+
+    //! Read either hit, joined a flight, or owns a new one
+    struct Lookup {
+        std::optional<Result<ModbusResponse>> result;
+        std::shared_ptr<Flight> flight;
+        bool owner = false;
+    };
+
+    //! Finishes owned flight with ConnectionClosed if the transaction throws
+    class FlightGuard {
+      private:
+        ReadCache &_cache;
+        const std::string &_endpoint;
+        const ModbusRequest &_request;
+        Flight *_flight;
+
+      public:
+        FlightGuard(ReadCache &cache, const std::string &endpoint,
+                    const ModbusRequest &request, Flight &flight)
+            : _cache(cache), _endpoint(endpoint), _request(request), _flight(&flight) {}
+        FlightGuard(const FlightGuard &)            = delete;
+        FlightGuard &operator=(const FlightGuard &) = delete;
+        ~FlightGuard() {
+            if (_flight)
+                _cache.finish(_endpoint, _request, *_flight, utils::ConnectionClosed);
+        }
+
+        void finish(const Result<ModbusResponse> &result) {
+            _cache.finish(_endpoint, _request, *_flight, result);
+            _flight = nullptr;
+        }
+    };
+
+    mutable std::mutex _mutex;
+    std::vector<Clock::duration> _ttls;
+    //! Entries older than the longest TTL serve no class and are dropped
+    Clock::duration _maxTtl;
+    std::map<std::string, Device, std::less<>> _devices;
+    Stats _stats;
+
+    Lookup begin(const std::string &endpoint, const ModbusRequest &request, TtlClass ttl);
+    void finish(const std::string &endpoint, const ModbusRequest &request, Flight &flight,
+                const Result<ModbusResponse> &result);
+    Result<ModbusResponse> wait(Flight &flight, const ModbusRequest &request);
+    void invalidateLocked(Device &device, uint8_t unit, utils::MBFunctionCode table,
+                          uint32_t address, uint32_t count);
+
+  public:
+    //! Cache with TTL class 0 only
+    explicit ReadCache(Clock::duration ttl = std::chrono::milliseconds(100));
+    ReadCache(const ReadCache &)            = delete;
+    ReadCache &operator=(const ReadCache &) = delete;
+
+    //! Adds TTL class, returns its index
+    TtlClass addClass(Clock::duration ttl);
+    /**
+     * @brief Changes TTL of existing class.
+     * @throws std::invalid_argument - When the class does not exist.
+     */
+    void setTtl(TtlClass ttl, Clock::duration duration);
+    [[nodiscard]] Clock::duration ttl(TtlClass ttl) const;
+
+    //! Checks if responses of the function code can be cached (FC1 - FC4)
+    [[nodiscard]] static bool cacheable(utils::MBFunctionCode functionCode) noexcept;
+
+    /**
+     * @brief Serves read from cache, from transaction in flight, or calls
+     * `transact(request)` returning Result<ModbusResponse>.
+     *
+     * Requests that are not reads are passed through to `transact`, use
+     * write() for writes so they invalidate the cache.
+     * @throws std::invalid_argument - When the TTL class does not exist.
+     */
+    template <typename Transact>
+    Result<ModbusResponse> read(const std::string &endpoint, const ModbusRequest &request,
+                                Transact &&transact, TtlClass ttl = 0) {
+        if (!cacheable(request.functionCode()))
+            return transact(request);
+
+        auto lookup = begin(endpoint, request, ttl);
+        if (lookup.result)
+            return std::move(*lookup.result);
+        if (!lookup.owner)
+            return wait(*lookup.flight, request);
+
+        FlightGuard guard(*this, endpoint, request, *lookup.flight);
+        auto result = transact(request);
+        guard.finish(result);
+        return result;
+    }
+
+    /**
+     * @brief Sends write through `transact` and drops cached ranges it
+     * overlaps, before the write and after it, whether it succeeded or not.
+     */
+    template <typename Transact>
+    Result<ModbusResponse> write(const std::string &endpoint,
+                                 const ModbusRequest &request, Transact &&transact) {
+        invalidate(endpoint, request);
+        auto result = transact(request);
+        invalidate(endpoint, request);
+        return result;
+    }
+
+    //! Drops cached ranges overlapping the range, reads in flight are not cached
+    void invalidate(const std::string &endpoint, uint8_t unit,
+                    utils::MBFunctionCode table, uint16_t address, uint16_t count);
+    //! Drops cached ranges written by the request, nothing for reads
+    void invalidate(const std::string &endpoint, const ModbusRequest &request);
+    //! Drops all cached ranges of the endpoint
+    void invalidate(const std::string &endpoint);
+    //! Drops all cached ranges
+    void clear();
+
+    [[nodiscard]] Stats stats() const;
+    //! Number of cached ranges, expired included until they are dropped
+    [[nodiscard]] std::size_t size() const;
+};
+} // namespace MB
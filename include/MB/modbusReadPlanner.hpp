@@ -0,0 +1,139 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Coalescing of scattered register and coil ranges into the smallest set of
+// read requests, and mapping of their responses back to the ranges.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "modbusRequest.hpp"
+#include "modbusResponse.hpp"
+#include "modbusUtils.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+//! Range of registers (or coils) wanted by the application
+struct ReadPoint {
+    uint8_t unit = 1;
+    //! Table of the range, one of reading function codes FC1 - FC4
+    utils::MBFunctionCode table = utils::ReadAnalogOutputHoldingRegisters;
+    uint16_t address = 0;
+    uint16_t count   = 1;
+};
+
+//! Limits of reads sent to a device
+struct ReadLimits {
+    //! Largest read, protocol allows 125 registers (FC3 / FC4) and 2000 coils,
+    //! larger values are capped at these
+    uint16_t maxRegisters = 125;
+    uint16_t maxCoils     = 2000;
+    /**
+     * Unwanted registers (coils) a read may span to serve two ranges at once.
+     * Every spanned register costs 2 bytes of response, a read saved costs a
+     * whole round trip. Devices that reject reads of unmapped addresses need 0.
+     */
+    uint16_t registerGap = 16;
+    uint16_t coilGap     = 256;
+};
+
+/**
+ * @brief Read requests serving a list of points, see ReadPlanner.
+ *
+ * Every point is served by exactly one read, at an offset (in registers or
+ * coils) of its response payload.
+ */
+class ReadPlan {
+  public:
+    struct Read {
+        ModbusRequest request;
+        //! Points served by the read are members [firstMember, lastMember)
+        std::size_t firstMember;
+        std::size_t lastMember;
+    };
+
+    struct Member {
+        //! Index of the point in the planned list
+        std::size_t point;
+        //! First register (coil) of the point in response payload
+        uint16_t offset;
+    };
+
+  private:
+    std::vector<Read> _reads;
+    //! Ordered by read and address
+    std::vector<Member> _members;
+    //! Read serving each point
+    std::vector<std::size_t> _readOfPoint;
+    //! Member of each point
+    std::vector<std::size_t> _memberOfPoint;
+
+    friend class ReadPlanner;
+
+  public:
+    [[nodiscard]] const std::vector<Read> &reads() const noexcept { return _reads; }
+    [[nodiscard]] const std::vector<Member> &members() const noexcept { return _members; }
+
+    [[nodiscard]] std::size_t points() const noexcept { return _readOfPoint.size(); }
+    //! Index of read serving the point
+    [[nodiscard]] std::size_t readOf(std::size_t point) const noexcept {
+        return _readOfPoint[point];
+    }
+    //! First register (coil) of the point in response of its read
+    [[nodiscard]] uint16_t offsetOf(std::size_t point) const noexcept {
+        return _members[_memberOfPoint[point]].offset;
+    }
+
+    //! Copies requests of all reads, in order of reads()
+    [[nodiscard]] std::vector<ModbusRequest> requests() const;
+
+    /**
+     * @brief Registers of the point inside response of its read, nothing is
+     * copied. Pointer is valid as long as the response.
+     * @return Nullptr if response is shorter than the read
+     */
+    [[nodiscard]] const uint16_t *
+    registers(std::size_t point, const ModbusResponse &response) const noexcept;
+    //! Coil `index` of the point inside response of its read, false if missing
+    [[nodiscard]] bool coil(std::size_t point, const ModbusResponse &response,
+                            std::size_t index = 0) const noexcept;
+};
+
+/**
+ * @brief Finds the smallest set of reads covering a list of points.
+ *
+ * Points are merged per unit and table. Neighbouring points share a read if
+ * the gap between them fits into the gap limit and the read stays within
+ * the size limit, both taken from limits of the unit. Greedy merging in
+ * order of addresses is optimal under these two limits. Points may overlap.
+ */
+class ReadPlanner {
+  private:
+    ReadLimits _defaults;
+    std::map<uint8_t, ReadLimits> _units;
+
+  public:
+    explicit ReadPlanner(ReadLimits defaults = {}) : _defaults(defaults) {}
+
+    //! Overrides limits of single unit
+    void setLimits(uint8_t unit, ReadLimits limits) { _units[unit] = limits; }
+    [[nodiscard]] const ReadLimits &limits(uint8_t unit) const;
+
+    /**
+     * @brief Plans reads of `count` points.
+     * @throws std::invalid_argument - When point does not use reading function
+     * code, is empty, exceeds address space or does not fit into single read.
+     */
+    [[nodiscard]] ReadPlan plan(const ReadPoint *points, std::size_t count) const;
+    [[nodiscard]] ReadPlan plan(const std::vector<ReadPoint> &points) const {
+        return plan(points.data(), points.size());
+    }
+};
+} // namespace MB
@@ -0,0 +1,146 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+
+#include "modbusUtils.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * @brief Contiguous block of 16-bit registers with inline storage.
+ *
+ * Capacity is fixed to the protocol maximum of a single read (125 registers),
+ * so request and response objects never touch the heap for their payload.
+ */
+class RegisterBlock {
+  public:
+    //! Maximum number of registers in a single Modbus read (FC3 / FC4)
+    static constexpr std::size_t Capacity = 125;
+
+    using value_type     = uint16_t;
+    using iterator       = uint16_t *;
+    using const_iterator = const uint16_t *;
+
+  private:
+    std::array<uint16_t, Capacity> _registers{};
+    uint16_t _size = 0;
+
+  public:
+    constexpr RegisterBlock() noexcept = default;
+
+    /**
+     * @brief Constructs block with `count` registers set to `value`.
+     * @throws std::length_error - When count exceeds Capacity.
+     */
+    explicit RegisterBlock(std::size_t count, uint16_t value = 0) {
+        resize(count);
+        std::fill_n(_registers.begin(), _size, value);
+    }
+
+    /**
+     * @brief Constructs block from list of register values.
+     * @throws std::length_error - When list exceeds Capacity.
+     */
+    RegisterBlock(std::initializer_list<uint16_t> values) {
+        resize(values.size());
+        std::copy(values.begin(), values.end(), _registers.begin());
+    }
+
+    [[nodiscard]] static constexpr std::size_t capacity() noexcept { return Capacity; }
+    [[nodiscard]] std::size_t size() const noexcept { return _size; }
+    [[nodiscard]] bool empty() const noexcept { return _size == 0; }
+
+    [[nodiscard]] uint16_t *data() noexcept { return _registers.data(); }
+    [[nodiscard]] const uint16_t *data() const noexcept { return _registers.data(); }
+
+    [[nodiscard]] iterator begin() noexcept { return _registers.data(); }
+    [[nodiscard]] iterator end() noexcept { return _registers.data() + _size; }
+    [[nodiscard]] const_iterator begin() const noexcept { return _registers.data(); }
+    [[nodiscard]] const_iterator end() const noexcept {
+        return _registers.data() + _size;
+    }
+
+    uint16_t &operator[](std::size_t index) noexcept { return _registers[index]; }
+    const uint16_t &operator[](std::size_t index) const noexcept {
+        return _registers[index];
+    }
+
+    /**
+     * @brief Bounds checked access.
+     * @throws std::out_of_range - When index is not smaller than size().
+     */
+    uint16_t &at(std::size_t index) {
+        if (index >= _size)
+            MB_THROW(std::out_of_range("RegisterBlock index out of range"));
+        return _registers[index];
+    }
+
+    [[nodiscard]] const uint16_t &at(std::size_t index) const {
+        if (index >= _size)
+            MB_THROW(std::out_of_range("RegisterBlock index out of range"));
+        return _registers[index];
+    }
+
+    /**
+     * @brief Changes number of registers, new registers are zeroed.
+     * @throws std::length_error - When count exceeds Capacity.
+     */
+    void resize(std::size_t count) {
+        if (count > Capacity)
+            MB_THROW(std::length_error("RegisterBlock capacity exceeded"));
+        if (count > _size)
+            std::fill(_registers.begin() + _size, _registers.begin() + count, 0);
+        _size = static_cast<uint16_t>(count);
+    }
+
+    /**
+     * @brief Appends register to the back of the block.
+     * @throws std::length_error - When block is full.
+     */
+    void push_back(uint16_t value) {
+        if (_size == Capacity)
+            MB_THROW(std::length_error("RegisterBlock capacity exceeded"));
+        _registers[_size++] = value;
+    }
+
+    void clear() noexcept { _size = 0; }
+
+    /**
+     * @brief Loads `count` registers from big endian wire representation.
+     * @throws std::length_error - When count exceeds Capacity.
+     */
+    void assignBigEndian(const uint8_t *bytes, std::size_t count) {
+        resize(count);
+        for (std::size_t i = 0; i < count; i++) {
+            _registers[i] = static_cast<uint16_t>((bytes[2 * i] << 8) | bytes[2 * i + 1]);
+        }
+    }
+
+    //! Writes registers to `out` in big endian wire representation (2 * size() bytes)
+    void copyBigEndian(uint8_t *out) const noexcept {
+        for (std::size_t i = 0; i < _size; i++) {
+            out[2 * i]     = static_cast<uint8_t>(_registers[i] >> 8);
+            out[2 * i + 1] = static_cast<uint8_t>(_registers[i] & 0xFF);
+        }
+    }
+
+    friend bool operator==(const RegisterBlock &lhs, const RegisterBlock &rhs) noexcept {
+        return lhs._size == rhs._size && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    friend bool operator!=(const RegisterBlock &lhs, const RegisterBlock &rhs) noexcept {
+        return !(lhs == rhs);
+    }
+};
+} // namespace MB
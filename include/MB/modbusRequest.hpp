@@ -10,7 +10,12 @@
 #include <vector>
 
 #include "modbusCell.hpp"
+#include "modbusCellView.hpp"
+#include "modbusCoilBitset.hpp"
 #include "modbusException.hpp"
+#include "modbusRegisterBlock.hpp"
+#include "modbusResult.hpp"
+#include "modbusRequestView.hpp"
 
 /**
  * Namespace that contains whole project
@@ -45,8 +50,25 @@ class ModbusRequest {
 
     uint16_t _address;
     uint16_t _registersNumber;
-
-    std::vector<ModbusCell> _values;
+    //! Write address of FC23
+    uint16_t _writeAddress = 0;
+    //! File number of FC20 / FC21
+    uint16_t _fileNumber = 0;
+
+    RegisterBlock _registers;
+    CoilBitset _coils;
+
+    //! Checks if function code operates on coils, never throws
+    [[nodiscard]] bool holdsCoils() const noexcept;
+
+    static Result<ModbusRequest>
+    fromView(const Result<ModbusRequestView> &view) noexcept {
+        if (!view)
+            return view.error();
+        return ModbusRequest(view.value());
+    }
+    //! Resizes storage matching function code, clamped to its capacity
+    void resizeValues(std::size_t count);
 
   public:
     // We do not allow default CTORs: https://github.com/Mazurel/Modbus/issues/6
@@ -68,6 +90,9 @@ class ModbusRequest {
     explicit ModbusRequest(const std::vector<uint8_t> &inputData,
                            bool CRC = false) noexcept(false);
 
+    //! Constructs Request by copying data out of already validated view
+    explicit ModbusRequest(const ModbusRequestView &view);
+
     /*
      * @description Constructs Request from raw data
      * @params inputData is a vector of bytes that will be interpreted
@@ -88,6 +113,36 @@ class ModbusRequest {
         return ModbusRequest(inputData, true);
     }
 
+    //! Constructs Request from `size` bytes at `data`, without intermediate copies
+    static ModbusRequest fromRaw(const uint8_t *data, std::size_t size) {
+        return ModbusRequest(ModbusRequestView(data, size));
+    }
+
+    //! Constructs Request from `size` bytes at `data` and checks it's CRC
+    static ModbusRequest fromRawCRC(const uint8_t *data, std::size_t size) {
+        return ModbusRequest(ModbusRequestView(data, size, true));
+    }
+
+    /**
+     * Non throwing variants of fromRaw / fromRawCRC, see ModbusRequestView::tryFromRaw
+     * for possible errors.
+     */
+    static Result<ModbusRequest> tryFromRaw(const uint8_t *data,
+                                            std::size_t size) noexcept {
+        return fromView(ModbusRequestView::tryFromRaw(data, size));
+    }
+    static Result<ModbusRequest> tryFromRaw(const std::vector<uint8_t> &data) noexcept {
+        return tryFromRaw(data.data(), data.size());
+    }
+    static Result<ModbusRequest> tryFromRawCRC(const uint8_t *data,
+                                               std::size_t size) noexcept {
+        return fromView(ModbusRequestView::tryFromRawCRC(data, size));
+    }
+    static Result<ModbusRequest>
+    tryFromRawCRC(const std::vector<uint8_t> &data) noexcept {
+        return tryFromRawCRC(data.data(), data.size());
+    }
+
     /**
      * Simple constructor, that allows to create "dummy" ModbusResponse
      * object. May be useful in some cases.
@@ -100,11 +155,53 @@ class ModbusRequest {
 
     ModbusRequest(const ModbusRequest &) = default;
 
+    /**
+     * @brief Read / Write Multiple Registers (FC23), values are written before
+     * the registers are read, all in single transaction.
+     */
+    static ModbusRequest readWriteMultiple(uint8_t slaveId, uint16_t readAddress,
+                                           uint16_t readCount, uint16_t writeAddress,
+                                           const RegisterBlock &values) noexcept;
+
+    /**
+     * @brief Mask Write Register (FC22), device stores
+     * (current AND andMask) OR (orMask AND NOT andMask), see utils::applyMask.
+     */
+    static ModbusRequest maskWrite(uint8_t slaveId, uint16_t address, uint16_t andMask,
+                                   uint16_t orMask) noexcept;
+
+    //! Read File Record (FC20) with single record group
+    static ModbusRequest readFileRecord(uint8_t slaveId, uint16_t fileNumber,
+                                        uint16_t recordNumber,
+                                        uint16_t recordLength) noexcept;
+
+    //! Write File Record (FC21) with single record group
+    static ModbusRequest writeFileRecord(uint8_t slaveId, uint16_t fileNumber,
+                                         uint16_t recordNumber,
+                                         const RegisterBlock &values) noexcept;
+
     //! Returns string representation of object
     [[nodiscard]] std::string toString() const noexcept;
+    /**
+     * @brief Writes string representation into caller provided buffer,
+     * truncated to `capacity` - 1 characters and null terminated.
+     * @return Number of characters written
+     */
+    std::size_t formatTo(char *buffer, std::size_t capacity) const noexcept;
+    //! Longest text produced by toString / formatTo, without terminating null
+    static constexpr std::size_t MaxStringSize = 256;
     //! Returns raw bytes representation of object, ready for modbus
     //! communication
     [[nodiscard]] std::vector<uint8_t> toRaw() const noexcept;
+    //! Returns number of bytes produced by toRaw / encodeInto
+    [[nodiscard]] std::size_t encodedSize() const;
+    /**
+     * @brief Writes raw bytes representation into caller provided buffer.
+     * @return Number of bytes written, 0 if capacity is too small.
+     */
+    std::size_t encodeInto(uint8_t *buffer, std::size_t capacity) const;
+    //! Appends raw bytes representation to the buffer, reusing its capacity
+    void appendTo(std::vector<uint8_t> &buffer) const;
 
     //! Returns function type based on Modbus function code
     [[nodiscard]] utils::MBFunctionType functionType() const noexcept {
@@ -117,21 +214,41 @@ class ModbusRequest {
 
     [[nodiscard]] uint8_t slaveID() const { return _slaveID; }
     [[nodiscard]] utils::MBFunctionCode functionCode() const { return _functionCode; }
+    //! Start address, read address for FC23, record number for FC20 / FC21
     [[nodiscard]] uint16_t registerAddress() const { return _address; }
+    //! Number of values, read count for FC23, record length for FC20 / FC21
     [[nodiscard]] uint16_t numberOfRegisters() const { return _registersNumber; }
-    [[nodiscard]] const std::vector<ModbusCell> &registerValues() const {
-        return _values;
+    //! Address of written registers, only valid for FC23
+    [[nodiscard]] uint16_t writeAddress() const { return _writeAddress; }
+    //! File number, only valid for FC20 / FC21
+    [[nodiscard]] uint16_t fileNumber() const { return _fileNumber; }
+    //! AND mask, only valid for FC22
+    [[nodiscard]] uint16_t andMask() const { return _registers[0]; }
+    //! OR mask, only valid for FC22
+    [[nodiscard]] uint16_t orMask() const { return _registers[1]; }
+    //! Returns register payload (written values for FC23), valid for register
+    //! function codes
+    [[nodiscard]] const RegisterBlock &registers() const { return _registers; }
+    //! Returns coil payload, valid for coil function codes
+    [[nodiscard]] const CoilBitset &coils() const { return _coils; }
+    //! Returns payload as cells, kept for compatibility
+    [[nodiscard]] ModbusCellView registerValues() const {
+        return holdsCoils() ? ModbusCellView(_coils) : ModbusCellView(_registers);
     }
 
     void setSlaveId(uint8_t slaveId) { _slaveID = slaveId; }
-    void setFunctionCode(utils::MBFunctionCode functionCode) {
-        _functionCode = functionCode;
-    }
+    //! Sets function code, converts payload if its type changes
+    void setFunctionCode(utils::MBFunctionCode functionCode);
     void setAddress(uint16_t address) { _address = address; }
+    void setWriteAddress(uint16_t address) { _writeAddress = address; }
+    void setFileNumber(uint16_t fileNumber) { _fileNumber = fileNumber; }
     void setRegistersNumber(uint16_t registersNumber) {
         _registersNumber = registersNumber;
-        _values.resize(registersNumber);
+        resizeValues(registersNumber);
     }
-    void setValues(const std::vector<ModbusCell> &values) { _values = values; }
+    void setRegisters(const RegisterBlock &registers) { _registers = registers; }
+    void setCoils(const CoilBitset &coils) { _coils = coils; }
+    //! Sets payload from cells, converting them to type matching function code
+    void setValues(const std::vector<ModbusCell> &values);
 };
 } // namespace MB
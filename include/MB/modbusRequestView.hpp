@@ -0,0 +1,163 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "modbusCoilPack.hpp"
+#include "modbusException.hpp"
+#include "modbusResult.hpp"
+#include "modbusUtils.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * @brief Non owning view of a raw Modbus request.
+ *
+ * All lengths are validated once on construction, accessors read directly
+ * from the underlying buffer afterwards. The buffer must outlive the view.
+ */
+class ModbusRequestView {
+  private:
+    const uint8_t *_data = nullptr;
+    std::size_t _size    = 0;
+
+    uint8_t _slaveID                    = 0;
+    utils::MBFunctionCode _functionCode = utils::Undefined;
+    uint16_t _address                   = 0;
+    uint16_t _registersNumber           = 0;
+
+    const uint8_t *_payload = nullptr;
+    uint8_t _payloadSize    = 0;
+
+    uint16_t _writeAddress = 0;
+    uint16_t _fileNumber   = 0;
+
+    ModbusRequestView() noexcept = default;
+
+    //! Validates frame and fills all fields, never throws
+    Status parse(const uint8_t *data, std::size_t size, bool CRC) noexcept;
+
+    static Result<ModbusRequestView> tryParse(const uint8_t *data, std::size_t size,
+                                              bool CRC) noexcept;
+
+  public:
+    /**
+     * @brief Parses request from `size` bytes at `data`.
+     * @note if CRC = true input data needs to contain 2 CRC bytes on back (used
+     * in RS)
+     * @throws ModbusException - InvalidByteOrder on malformed / truncated frame,
+     * InvalidCRC on CRC mismatch
+     */
+    ModbusRequestView(const uint8_t *data, std::size_t size, bool CRC = false);
+
+    static ModbusRequestView fromRaw(const uint8_t *data, std::size_t size) {
+        return ModbusRequestView(data, size);
+    }
+    static ModbusRequestView fromRaw(const std::vector<uint8_t> &data) {
+        return ModbusRequestView(data.data(), data.size());
+    }
+    static ModbusRequestView fromRawCRC(const uint8_t *data, std::size_t size) {
+        return ModbusRequestView(data, size, true);
+    }
+    static ModbusRequestView fromRawCRC(const std::vector<uint8_t> &data) {
+        return ModbusRequestView(data.data(), data.size(), true);
+    }
+
+    /**
+     * Non throwing variants of fromRaw / fromRawCRC, errors are returned as
+     * InvalidByteOrder (malformed / truncated frame) or InvalidCRC.
+     */
+    static Result<ModbusRequestView> tryFromRaw(const uint8_t *data,
+                                                std::size_t size) noexcept {
+        return tryParse(data, size, false);
+    }
+    static Result<ModbusRequestView>
+    tryFromRaw(const std::vector<uint8_t> &data) noexcept {
+        return tryParse(data.data(), data.size(), false);
+    }
+    static Result<ModbusRequestView> tryFromRawCRC(const uint8_t *data,
+                                                   std::size_t size) noexcept {
+        return tryParse(data, size, true);
+    }
+    static Result<ModbusRequestView>
+    tryFromRawCRC(const std::vector<uint8_t> &data) noexcept {
+        return tryParse(data.data(), data.size(), true);
+    }
+
+    [[nodiscard]] uint8_t slaveID() const noexcept { return _slaveID; }
+    [[nodiscard]] utils::MBFunctionCode functionCode() const noexcept {
+        return _functionCode;
+    }
+    [[nodiscard]] utils::MBFunctionType functionType() const {
+        return utils::functionType(_functionCode);
+    }
+    [[nodiscard]] utils::MBFunctionRegisters functionRegisters() const {
+        return utils::functionRegister(_functionCode);
+    }
+    //! Start address, read address for FC23, record number for FC20 / FC21
+    [[nodiscard]] uint16_t registerAddress() const noexcept { return _address; }
+    //! Number of values, read count for FC23, record length for FC20 / FC21
+    [[nodiscard]] uint16_t numberOfRegisters() const noexcept { return _registersNumber; }
+    //! Address of written registers, only valid for FC23
+    [[nodiscard]] uint16_t writeAddress() const noexcept { return _writeAddress; }
+    //! Number of written registers, only valid for FC23
+    [[nodiscard]] uint16_t numberOfWriteRegisters() const noexcept {
+        return _payloadSize / 2;
+    }
+    //! File number, only valid for FC20 / FC21
+    [[nodiscard]] uint16_t fileNumber() const noexcept { return _fileNumber; }
+    //! AND mask, only valid for FC22
+    [[nodiscard]] uint16_t andMask() const noexcept { return registerAt(0); }
+    //! OR mask, only valid for FC22
+    [[nodiscard]] uint16_t orMask() const noexcept { return registerAt(1); }
+
+    //! Raw frame this view was parsed from
+    [[nodiscard]] const uint8_t *data() const noexcept { return _data; }
+    //! Number of bytes used by the frame (including CRC if it was checked)
+    [[nodiscard]] std::size_t size() const noexcept { return _size; }
+
+    //! Written register / coil bytes exactly as on the wire, empty for reads
+    [[nodiscard]] const uint8_t *payload() const noexcept { return _payload; }
+    [[nodiscard]] std::size_t payloadSize() const noexcept { return _payloadSize; }
+
+    //! Written register at index, only valid for write requests
+    [[nodiscard]] uint16_t registerAt(std::size_t index) const noexcept {
+        return utils::bigEndianConv(_payload + 2 * index);
+    }
+
+    //! Written coil at index, only valid for write requests
+    [[nodiscard]] bool coilAt(std::size_t index) const noexcept {
+        return (_payload[index / 8] >> (index % 8)) & 1;
+    }
+
+    //! Unpacks all written coils, only valid for write requests
+    void copyCoils(bool *values) const noexcept {
+        utils::unpackCoils(_payload, _registersNumber, values);
+    }
+
+    //! Unsigned 32 bit value written to registers index and index + 1
+    [[nodiscard]] uint32_t asUint32(std::size_t index,
+                                    utils::WordOrder order = utils::ABCD) const noexcept {
+        return utils::combineUint32(_payload + 2 * index, order);
+    }
+
+    //! Signed 32 bit value written to registers index and index + 1
+    [[nodiscard]] int32_t asInt32(std::size_t index,
+                                  utils::WordOrder order = utils::ABCD) const noexcept {
+        return static_cast<int32_t>(asUint32(index, order));
+    }
+
+    //! IEEE 754 float written to registers index and index + 1
+    [[nodiscard]] float asFloat32(std::size_t index,
+                                  utils::WordOrder order = utils::ABCD) const noexcept {
+        return utils::combineFloat32(_payload + 2 * index, order);
+    }
+};
+} // namespace MB
@@ -10,8 +10,13 @@
 #include <vector>
 
 #include "modbusCell.hpp"
+#include "modbusCellView.hpp"
+#include "modbusCoilBitset.hpp"
 #include "modbusException.hpp"
+#include "modbusRegisterBlock.hpp"
 #include "modbusRequest.hpp"
+#include "modbusResponseView.hpp"
+#include "modbusResult.hpp"
 #include "modbusUtils.hpp"
 
 /**
@@ -29,8 +34,23 @@ class ModbusResponse {
 
     uint16_t _address;
     uint16_t _registersNumber;
+    //! File number of FC21
+    uint16_t _fileNumber = 0;
 
-    std::vector<ModbusCell> _values;
+    RegisterBlock _registers;
+    CoilBitset _coils;
+
+    //! Checks if function code operates on coils, never throws
+    [[nodiscard]] bool holdsCoils() const noexcept;
+
+    static Result<ModbusResponse>
+    fromView(const Result<ModbusResponseView> &view) noexcept {
+        if (!view)
+            return view.error();
+        return ModbusResponse(view.value());
+    }
+    //! Resizes storage matching function code, clamped to its capacity
+    void resizeValues(std::size_t count);
 
   public:
     // We do not allow default CTORs: https://github.com/Mazurel/Modbus/issues/6
@@ -49,14 +69,17 @@ class ModbusResponse {
      *exception if it is invalid
      * @throws ModbusException
      **/
-    explicit ModbusResponse(std::vector<uint8_t> inputData, bool CRC = false);
+    explicit ModbusResponse(const std::vector<uint8_t> &inputData, bool CRC = false);
+
+    //! Constructs Response by copying data out of already validated view
+    explicit ModbusResponse(const ModbusResponseView &view);
 
     /*
      * @description Constructs Response from raw data
      * @params inputData is a vector of bytes that will be interpreted
      * @throws ModbusException
      **/
-    static ModbusResponse fromRaw(std::vector<uint8_t> inputData) {
+    static ModbusResponse fromRaw(const std::vector<uint8_t> &inputData) {
         return ModbusResponse(inputData);
     }
     /*
@@ -66,10 +89,40 @@ class ModbusResponse {
      * @note This methods performs CRC check that may throw ModbusException on
      * invalid CRC
      **/
-    static ModbusResponse fromRawCRC(std::vector<uint8_t> inputData) {
+    static ModbusResponse fromRawCRC(const std::vector<uint8_t> &inputData) {
         return ModbusResponse(inputData, true);
     }
 
+    //! Constructs Response from `size` bytes at `data`, without intermediate copies
+    static ModbusResponse fromRaw(const uint8_t *data, std::size_t size) {
+        return ModbusResponse(ModbusResponseView(data, size));
+    }
+
+    //! Constructs Response from `size` bytes at `data` and checks it's CRC
+    static ModbusResponse fromRawCRC(const uint8_t *data, std::size_t size) {
+        return ModbusResponse(ModbusResponseView(data, size, true));
+    }
+
+    /**
+     * Non throwing variants of fromRaw / fromRawCRC, see ModbusResponseView::tryFromRaw
+     * for possible errors.
+     */
+    static Result<ModbusResponse> tryFromRaw(const uint8_t *data,
+                                             std::size_t size) noexcept {
+        return fromView(ModbusResponseView::tryFromRaw(data, size));
+    }
+    static Result<ModbusResponse> tryFromRaw(const std::vector<uint8_t> &data) noexcept {
+        return tryFromRaw(data.data(), data.size());
+    }
+    static Result<ModbusResponse> tryFromRawCRC(const uint8_t *data,
+                                                std::size_t size) noexcept {
+        return fromView(ModbusResponseView::tryFromRawCRC(data, size));
+    }
+    static Result<ModbusResponse>
+    tryFromRawCRC(const std::vector<uint8_t> &data) noexcept {
+        return tryFromRawCRC(data.data(), data.size());
+    }
+
     /**
      * Simple constructor, that allows to create "dummy" ModbusResponse
      * object. May be useful in some cases.
@@ -84,7 +137,24 @@ class ModbusResponse {
 
     //! Converts object to it's string representation
     [[nodiscard]] std::string toString() const;
+    /**
+     * @brief Writes string representation into caller provided buffer,
+     * truncated to `capacity` - 1 characters and null terminated.
+     * @return Number of characters written
+     */
+    std::size_t formatTo(char *buffer, std::size_t capacity) const noexcept;
+    //! Longest text produced by toString / formatTo, without terminating null
+    static constexpr std::size_t MaxStringSize = 256;
     [[nodiscard]] std::vector<uint8_t> toRaw() const;
+    //! Returns number of bytes produced by toRaw / encodeInto
+    [[nodiscard]] std::size_t encodedSize() const;
+    /**
+     * @brief Writes raw bytes representation into caller provided buffer.
+     * @return Number of bytes written, 0 if capacity is too small.
+     */
+    std::size_t encodeInto(uint8_t *buffer, std::size_t capacity) const;
+    //! Appends raw bytes representation to the buffer, reusing its capacity
+    void appendTo(std::vector<uint8_t> &buffer) const;
     //! Fills all data from associated request
     void from(const ModbusRequest &);
 
@@ -98,21 +168,37 @@ class ModbusResponse {
 
     [[nodiscard]] uint8_t slaveID() const { return _slaveID; }
     [[nodiscard]] utils::MBFunctionCode functionCode() const { return _functionCode; }
+    //! Address of written registers (record number for FC21), 0 for reads
     [[nodiscard]] uint16_t registerAddress() const { return _address; }
+    //! Number of values, record length for FC20 / FC21
     [[nodiscard]] uint16_t numberOfRegisters() const { return _registersNumber; }
-    [[nodiscard]] const std::vector<ModbusCell> &registerValues() const {
-        return _values;
+    //! File number, only valid for FC21
+    [[nodiscard]] uint16_t fileNumber() const { return _fileNumber; }
+    //! AND mask, only valid for FC22
+    [[nodiscard]] uint16_t andMask() const { return _registers[0]; }
+    //! OR mask, only valid for FC22
+    [[nodiscard]] uint16_t orMask() const { return _registers[1]; }
+    //! Returns register payload, valid for register function codes
+    [[nodiscard]] const RegisterBlock &registers() const { return _registers; }
+    //! Returns coil payload, valid for coil function codes
+    [[nodiscard]] const CoilBitset &coils() const { return _coils; }
+    //! Returns payload as cells, kept for compatibility
+    [[nodiscard]] ModbusCellView registerValues() const {
+        return holdsCoils() ? ModbusCellView(_coils) : ModbusCellView(_registers);
     }
 
     void setSlaveId(uint8_t slaveId) { _slaveID = slaveId; }
-    void setFunctionCode(utils::MBFunctionCode functionCode) {
-        _functionCode = functionCode;
-    }
+    //! Sets function code, converts payload if its type changes
+    void setFunctionCode(utils::MBFunctionCode functionCode);
     void setAddress(uint16_t address) { _address = address; }
+    void setFileNumber(uint16_t fileNumber) { _fileNumber = fileNumber; }
     void setRegistersNumber(uint16_t registersNumber) {
         _registersNumber = registersNumber;
-        _values.resize(registersNumber);
+        resizeValues(registersNumber);
     }
-    void setValues(const std::vector<ModbusCell> &values) { _values = values; }
+    void setRegisters(const RegisterBlock &registers) { _registers = registers; }
+    void setCoils(const CoilBitset &coils) { _coils = coils; }
+    //! Sets payload from cells, converting them to type matching function code
+    void setValues(const std::vector<ModbusCell> &values);
 };
 } // namespace MB
@@ -0,0 +1,156 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "modbusCoilPack.hpp"
+#include "modbusException.hpp"
+#include "modbusResult.hpp"
+#include "modbusUtils.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * @brief Non owning view of a raw Modbus response.
+ *
+ * All lengths are validated once on construction, accessors read directly
+ * from the underlying buffer afterwards. The buffer must outlive the view.
+ */
+class ModbusResponseView {
+  private:
+    const uint8_t *_data = nullptr;
+    std::size_t _size    = 0;
+
+    uint8_t _slaveID                    = 0;
+    utils::MBFunctionCode _functionCode = utils::Undefined;
+    uint16_t _address                   = 0;
+    uint16_t _registersNumber           = 0;
+
+    const uint8_t *_payload = nullptr;
+    uint8_t _payloadSize    = 0;
+
+    uint16_t _fileNumber = 0;
+
+    ModbusResponseView() noexcept = default;
+
+    //! Validates frame and fills all fields, never throws
+    Status parse(const uint8_t *data, std::size_t size, bool CRC) noexcept;
+
+    static Result<ModbusResponseView> tryParse(const uint8_t *data, std::size_t size,
+                                               bool CRC) noexcept;
+
+  public:
+    /**
+     * @brief Parses response from `size` bytes at `data`.
+     * @note if CRC = true input data needs to contain 2 CRC bytes on back (used
+     * in RS)
+     * @throws ModbusException - InvalidByteOrder on malformed / truncated frame,
+     * InvalidCRC on CRC mismatch
+     */
+    ModbusResponseView(const uint8_t *data, std::size_t size, bool CRC = false);
+
+    static ModbusResponseView fromRaw(const uint8_t *data, std::size_t size) {
+        return ModbusResponseView(data, size);
+    }
+    static ModbusResponseView fromRaw(const std::vector<uint8_t> &data) {
+        return ModbusResponseView(data.data(), data.size());
+    }
+    static ModbusResponseView fromRawCRC(const uint8_t *data, std::size_t size) {
+        return ModbusResponseView(data, size, true);
+    }
+    static ModbusResponseView fromRawCRC(const std::vector<uint8_t> &data) {
+        return ModbusResponseView(data.data(), data.size(), true);
+    }
+
+    /**
+     * Non throwing variants of fromRaw / fromRawCRC, errors are returned as
+     * InvalidByteOrder (malformed / truncated frame) or InvalidCRC.
+     */
+    static Result<ModbusResponseView> tryFromRaw(const uint8_t *data,
+                                                 std::size_t size) noexcept {
+        return tryParse(data, size, false);
+    }
+    static Result<ModbusResponseView>
+    tryFromRaw(const std::vector<uint8_t> &data) noexcept {
+        return tryParse(data.data(), data.size(), false);
+    }
+    static Result<ModbusResponseView> tryFromRawCRC(const uint8_t *data,
+                                                    std::size_t size) noexcept {
+        return tryParse(data, size, true);
+    }
+    static Result<ModbusResponseView>
+    tryFromRawCRC(const std::vector<uint8_t> &data) noexcept {
+        return tryParse(data.data(), data.size(), true);
+    }
+
+    [[nodiscard]] uint8_t slaveID() const noexcept { return _slaveID; }
+    [[nodiscard]] utils::MBFunctionCode functionCode() const noexcept {
+        return _functionCode;
+    }
+    [[nodiscard]] utils::MBFunctionType functionType() const {
+        return utils::functionType(_functionCode);
+    }
+    [[nodiscard]] utils::MBFunctionRegisters functionRegisters() const {
+        return utils::functionRegister(_functionCode);
+    }
+    //! Address of written registers (record number for FC21), 0 for reads
+    [[nodiscard]] uint16_t registerAddress() const noexcept { return _address; }
+    //! Number of values, record length for FC20 / FC21
+    [[nodiscard]] uint16_t numberOfRegisters() const noexcept { return _registersNumber; }
+    //! File number, only valid for FC21
+    [[nodiscard]] uint16_t fileNumber() const noexcept { return _fileNumber; }
+    //! AND mask, only valid for FC22
+    [[nodiscard]] uint16_t andMask() const noexcept { return registerAt(0); }
+    //! OR mask, only valid for FC22
+    [[nodiscard]] uint16_t orMask() const noexcept { return registerAt(1); }
+
+    //! Raw frame this view was parsed from
+    [[nodiscard]] const uint8_t *data() const noexcept { return _data; }
+    //! Number of bytes used by the frame (including CRC if it was checked)
+    [[nodiscard]] std::size_t size() const noexcept { return _size; }
+
+    //! Register / coil data bytes, exactly as on the wire
+    [[nodiscard]] const uint8_t *payload() const noexcept { return _payload; }
+    [[nodiscard]] std::size_t payloadSize() const noexcept { return _payloadSize; }
+
+    //! Register at index, index must be smaller than numberOfRegisters()
+    [[nodiscard]] uint16_t registerAt(std::size_t index) const noexcept {
+        return utils::bigEndianConv(_payload + 2 * index);
+    }
+
+    //! Coil at index, index must be smaller than numberOfRegisters()
+    [[nodiscard]] bool coilAt(std::size_t index) const noexcept {
+        return (_payload[index / 8] >> (index % 8)) & 1;
+    }
+
+    //! Unpacks first `count` coils, count must not exceed numberOfRegisters()
+    void copyCoils(bool *values, std::size_t count) const noexcept {
+        utils::unpackCoils(_payload, count, values);
+    }
+
+    //! Unsigned 32 bit value stored in registers index and index + 1
+    [[nodiscard]] uint32_t asUint32(std::size_t index,
+                                    utils::WordOrder order = utils::ABCD) const noexcept {
+        return utils::combineUint32(_payload + 2 * index, order);
+    }
+
+    //! Signed 32 bit value stored in registers index and index + 1
+    [[nodiscard]] int32_t asInt32(std::size_t index,
+                                  utils::WordOrder order = utils::ABCD) const noexcept {
+        return static_cast<int32_t>(asUint32(index, order));
+    }
+
+    //! IEEE 754 float stored in registers index and index + 1
+    [[nodiscard]] float asFloat32(std::size_t index,
+                                  utils::WordOrder order = utils::ABCD) const noexcept {
+        return utils::combineFloat32(_payload + 2 * index, order);
+    }
+};
+} // namespace MB
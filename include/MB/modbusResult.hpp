@@ -0,0 +1,71 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Value-or-error type used by the noexcept (try*) API. It allows handling
+// expected failures, such as partial frames, without exceptions.
+
+#pragma once
+
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "modbusUtils.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * @brief Holds either value of type T or error of type E.
+ * @note Accessing value of failed result (or error of successful one) is
+ * undefined behaviour, check ok() first.
+ */
+template <typename T, typename E = utils::MBErrorCode> class Result {
+  private:
+    std::variant<T, E> _value;
+
+  public:
+    Result(const T &value) : _value(std::in_place_index<0>, value) {}
+    Result(T &&value) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : _value(std::in_place_index<0>, std::move(value)) {}
+    Result(E error) noexcept : _value(std::in_place_index<1>, error) {}
+
+    [[nodiscard]] bool ok() const noexcept { return _value.index() == 0; }
+    explicit operator bool() const noexcept { return ok(); }
+
+    [[nodiscard]] T &value() & noexcept { return *std::get_if<0>(&_value); }
+    [[nodiscard]] const T &value() const & noexcept { return *std::get_if<0>(&_value); }
+    [[nodiscard]] T &&value() && noexcept { return std::move(*std::get_if<0>(&_value)); }
+
+    T *operator->() noexcept { return std::get_if<0>(&_value); }
+    const T *operator->() const noexcept { return std::get_if<0>(&_value); }
+
+    [[nodiscard]] E error() const noexcept { return *std::get_if<1>(&_value); }
+
+    //! Returns value, or fallback if result holds an error
+    [[nodiscard]] T valueOr(T fallback) const & {
+        return ok() ? value() : std::move(fallback);
+    }
+};
+
+//! Result of operation that produces no value, only success or error
+template <typename E> class Result<void, E> {
+  private:
+    std::optional<E> _error;
+
+  public:
+    Result() noexcept = default;
+    Result(E error) noexcept : _error(error) {}
+
+    [[nodiscard]] bool ok() const noexcept { return !_error.has_value(); }
+    explicit operator bool() const noexcept { return ok(); }
+
+    [[nodiscard]] E error() const noexcept { return *_error; }
+};
+
+//! Success or error code
+using Status = Result<void>;
+} // namespace MB
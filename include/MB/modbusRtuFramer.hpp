@@ -0,0 +1,172 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "modbusCrc.hpp"
+
+/**
+ * Namespace that contains whole project
+ */
+namespace MB {
+/**
+ * @brief Streaming splitter of RTU byte stream into frames.
+ *
+ * Total frame length is predicted from function code and byte count /
+ * quantity fields as soon as they arrive and CRC is updated while frame
+ * grows, so no byte is parsed twice and buffer never grows. Frames with
+ * invalid CRC or unknown function code are dropped and framer
+ * resynchronizes by skipping single byte.
+ */
+class RtuFramer {
+  public:
+    //! Largest RTU frame allowed by the specification
+    static constexpr std::size_t MaxFrameSize = 256;
+
+    //! Which side of communication is being decoded
+    enum Direction : uint8_t {
+        Requests, //!< Frames sent by master (decoded by slave)
+        Responses //!< Frames sent by slave, including exceptions
+    };
+
+    //! Returned by predictFrameSize when more header bytes are needed
+    static constexpr std::size_t NeedMoreData = 0;
+    //! Returned by predictFrameSize when header can not start valid frame
+    static constexpr std::size_t InvalidFrame = SIZE_MAX;
+
+    /**
+     * @brief Predicts total frame size (including CRC) from first `size`
+     * bytes of the frame.
+     * @return Frame size, NeedMoreData or InvalidFrame
+     */
+    static std::size_t predictFrameSize(Direction direction, const uint8_t *header,
+                                        std::size_t size) noexcept;
+
+  private:
+    Direction _direction;
+    std::array<uint8_t, MaxFrameSize> _buffer{};
+    std::size_t _size     = 0;
+    std::size_t _expected = NeedMoreData;
+
+    // CRC covers first _crcSize bytes of the frame. It is advanced in blocks,
+    // so that wide kernels are used instead of stepping byte by byte.
+    static constexpr std::size_t CrcBlock = 64;
+    utils::Crc16 _crc;
+    std::size_t _crcSize = 0;
+
+    // Bytes that have to be scanned again after resynchronization
+    std::array<uint8_t, MaxFrameSize> _replay{};
+    std::size_t _replaySize = 0;
+    std::size_t _replayPos  = 0;
+
+    std::size_t _crcErrors      = 0;
+    std::size_t _discardedBytes = 0;
+
+    // Drops first byte of current frame, the rest is scanned again
+    void resync() noexcept;
+
+    // Appends up to `size` bytes to current frame, returns number taken
+    std::size_t append(const uint8_t *data, std::size_t size) noexcept {
+        if (_expected == NeedMoreData) {
+            // Header is taken byte by byte, until frame size is known
+            _buffer[_size++] = *data;
+            _expected        = predictFrameSize(_direction, _buffer.data(), _size);
+            return 1;
+        }
+
+        const auto chunk = std::min(size, _expected - _size);
+        std::copy(data, data + chunk, _buffer.data() + _size);
+        _size += chunk;
+        if (_size - _crcSize >= CrcBlock || _size == _expected)
+            updateCrc();
+        return chunk;
+    }
+
+    void updateCrc() noexcept {
+        _crc.update(_buffer.data() + _crcSize, _size - _crcSize);
+        _crcSize = _size;
+    }
+
+  public:
+    explicit RtuFramer(Direction direction) noexcept : _direction(direction) {}
+
+    /**
+     * @brief Consumes bytes, calling `onFrame(const uint8_t *frame,
+     * std::size_t size)` for every complete frame with valid CRC.
+     *
+     * Passed frame includes CRC and is valid only during the call. If
+     * callback returns bool, returning false stops consuming right after that
+     * frame (remaining input is not consumed).
+     * @return Number of consumed bytes
+     */
+    template <typename OnFrame>
+    std::size_t feed(const uint8_t *data, std::size_t size, OnFrame &&onFrame) {
+        std::size_t consumed = 0;
+        while (true) {
+            if (_replayPos < _replaySize) {
+                const auto left = _replaySize - _replayPos;
+                _replayPos += append(_replay.data() + _replayPos, left);
+            } else if (consumed < size) {
+                consumed += append(data + consumed, size - consumed);
+            } else {
+                break;
+            }
+
+            if (_expected == InvalidFrame) {
+                resync();
+                continue;
+            }
+            if (_expected == NeedMoreData || _size < _expected)
+                continue;
+
+            if (!_crc.matches()) {
+                _crcErrors++;
+                resync();
+                continue;
+            }
+
+            const auto frameSize = _size;
+            reset();
+            if constexpr (std::is_same_v<decltype(onFrame(_buffer.data(), frameSize)),
+                                         bool>) {
+                if (!onFrame(_buffer.data(), frameSize))
+                    break;
+            } else {
+                onFrame(_buffer.data(), frameSize);
+            }
+        }
+        return consumed;
+    }
+
+    //! Drops partially received frame (e.g. after inter frame silence)
+    void reset() noexcept {
+        _size     = 0;
+        _expected = NeedMoreData;
+        _crc.reset();
+        _crcSize = 0;
+    }
+
+    //! Drops partially received frame and all bytes waiting for rescan
+    void clear() noexcept {
+        reset();
+        _replaySize = 0;
+        _replayPos  = 0;
+    }
+
+    //! Number of held bytes that do not form complete frame yet
+    [[nodiscard]] std::size_t pending() const noexcept {
+        return _size + _replaySize - _replayPos;
+    }
+    //! Number of frames dropped because of CRC mismatch
+    [[nodiscard]] std::size_t crcErrors() const noexcept { return _crcErrors; }
+    //! Number of bytes skipped while resynchronizing
+    [[nodiscard]] std::size_t discardedBytes() const noexcept { return _discardedBytes; }
+};
+} // namespace MB
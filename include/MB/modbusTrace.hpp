@@ -0,0 +1,184 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Binary frame tracing. Hot path only copies a fixed size record into a ring
+// owned by the calling thread; text is produced later by the reader, see
+// formatTo.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace MB {
+//! Direction of traced frame, as seen by this side of the connection
+enum class TraceDirection : uint8_t { Rx, Tx };
+
+/**
+ * @brief Fixed size record of single frame, exactly one cache line.
+ *
+ * Records are trivially copyable, so they can be written to a file as they
+ * are (in host byte order) and formatted later by another process.
+ */
+struct TraceRecord {
+    //! Number of leading frame bytes stored in the record
+    static constexpr std::size_t MaxCaptured = 48;
+
+    uint64_t timestamp;       //!< Steady clock, nanoseconds
+    uint16_t size;            //!< Size of whole frame, may exceed `captured`
+    TraceDirection direction; //!< Received or sent
+    uint8_t slaveId;          //!< Unit identifier, first byte of the frame
+    uint8_t functionCode;     //!< Function code, including exception bit
+    uint8_t captured;         //!< Number of valid bytes in `data`
+    uint8_t reserved[2];
+    uint8_t data[MaxCaptured]; //!< Unit identifier followed by PDU (RTU: and CRC)
+};
+
+static_assert(sizeof(TraceRecord) == 64, "TraceRecord must fill one cache line");
+static_assert(std::is_trivially_copyable_v<TraceRecord>);
+
+//! Longest text produced by formatTo for single record, without terminating null
+constexpr std::size_t MaxTraceStringSize = 256;
+
+/**
+ * @brief Renders record as single line of text, for example
+ * `12.000345678 TX slave 17 Read from output registers [8] 11 03 00 6B ...`
+ * @return Number of characters written, see utils::FormatBuffer
+ */
+std::size_t formatTo(const TraceRecord &record, char *buffer,
+                     std::size_t capacity) noexcept;
+
+//! Renders record as string, see formatTo
+std::string toString(const TraceRecord &record);
+
+/**
+ * @brief Lock free single producer / single consumer ring of trace records.
+ *
+ * Producer never waits, record is dropped (and counted) when the ring is
+ * full.
+ */
+class TraceRing {
+  private:
+    std::size_t _mask;
+    std::unique_ptr<TraceRecord[]> _records;
+
+    alignas(64) std::atomic<std::size_t> _head{0}; //!< Written by producer
+    std::size_t _cachedTail = 0;                   //!< Producer copy of _tail
+    std::atomic<uint64_t> _dropped{0};
+    alignas(64) std::atomic<std::size_t> _tail{0}; //!< Written by consumer
+
+  public:
+    //! Capacity is rounded up to power of two
+    explicit TraceRing(std::size_t capacity);
+
+    /**
+     * @brief Producer side: returns slot for the next record or nullptr if
+     * the ring is full. Slot must be filled and published by publish().
+     */
+    TraceRecord *claim() noexcept {
+        const auto head = _head.load(std::memory_order_relaxed);
+        if (head - _cachedTail > _mask) {
+            _cachedTail = _tail.load(std::memory_order_acquire);
+            if (head - _cachedTail > _mask) {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+        return &_records[head & _mask];
+    }
+
+    //! Producer side: makes record returned by claim() visible to the consumer
+    void publish() noexcept {
+        _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    //! Producer side: copies record into the ring
+    bool push(const TraceRecord &record) noexcept {
+        auto *slot = claim();
+        if (!slot)
+            return false;
+        *slot = record;
+        publish();
+        return true;
+    }
+
+    //! Consumer side: passes every available record to `onRecord`
+    template <typename Callback> std::size_t drain(Callback &&onRecord) {
+        const auto head = _head.load(std::memory_order_acquire);
+        auto tail       = _tail.load(std::memory_order_relaxed);
+        const auto size = head - tail;
+        for (; tail != head; tail++) {
+            onRecord(static_cast<const TraceRecord &>(_records[tail & _mask]));
+            _tail.store(tail + 1, std::memory_order_release);
+        }
+        return size;
+    }
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return _mask + 1; }
+    //! Number of records dropped because the ring was full
+    [[nodiscard]] uint64_t dropped() const noexcept {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief Collects trace records from any number of threads.
+ *
+ * Every recording thread gets its own TraceRing on first use (the only
+ * allocation and lock), later records are lock free. Threads remember rings
+ * of the last 8 sinks they recorded into, so a thread may trace several
+ * connections into separate sinks without the lock. Single reader drains
+ * all rings, concurrently with recording threads.
+ */
+class TraceSink {
+  public:
+    static constexpr std::size_t DefaultRingCapacity = 1024;
+
+  private:
+    std::size_t _ringCapacity;
+    uint64_t _id;
+
+    mutable std::mutex _mutex;
+    std::vector<std::pair<std::thread::id, std::unique_ptr<TraceRing>>> _rings;
+
+    TraceRing &localRing();
+
+  public:
+    explicit TraceSink(std::size_t ringCapacity = DefaultRingCapacity);
+    TraceSink(const TraceSink &)            = delete;
+    TraceSink &operator=(const TraceSink &) = delete;
+
+    /**
+     * @brief Records frame starting with unit identifier: PDU with unit id
+     * (TCP) or whole RTU frame. Safe to call from any thread.
+     */
+    void record(TraceDirection direction, const uint8_t *frame,
+                std::size_t size) noexcept;
+
+    /**
+     * @brief Passes all records collected so far to `onRecord`, ring by ring
+     * (records of one thread stay in order).
+     * @note Only one thread may drain at a time.
+     * @return Number of records passed
+     */
+    template <typename Callback> std::size_t drain(Callback &&onRecord) {
+        std::lock_guard lock(_mutex);
+        std::size_t count = 0;
+        for (auto &ring : _rings)
+            count += ring.second->drain(onRecord);
+        return count;
+    }
+
+    //! Number of records dropped by all threads because their ring was full
+    [[nodiscard]] uint64_t dropped() const;
+};
+} // namespace MB
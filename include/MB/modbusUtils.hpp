@@ -6,17 +6,44 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <vector>
 
+/*!
+ * Throws given exception. When library is built with MODBUS_NO_EXCEPTIONS
+ * (exported to its users, so that header code behaves the same on both
+ * sides) or compiled with -fno-exceptions, it reports the error on stderr
+ * and aborts instead; use try* functions (see modbusResult.hpp) to handle
+ * errors without exceptions. The exception is named in unevaluated
+ * operand, so that variables used only to build it still count as used.
+ */
+#if !defined(MODBUS_NO_EXCEPTIONS) && (defined(__cpp_exceptions) || defined(__EXCEPTIONS))
+#define MB_EXCEPTIONS 1
+#define MB_THROW(exception) throw exception
+#else
+#define MB_THROW(exception)                                                             \
+    ((void)sizeof(exception), ::MB::utils::abortWithoutExceptions(#exception))
+#endif
+
 /*!
  * Namespace that contains many useful utility functions and enums
  * that are used in the whole project.
  */
 namespace MB::utils {
+//! Called by MB_THROW when exceptions are disabled
+[[noreturn]] inline void abortWithoutExceptions(const char *what) noexcept {
+    std::fprintf(stderr, "Modbus: unhandled error %s\n", what);
+    std::abort();
+}
+
 /*! All possible modbus error codes
  * @note Contains custom, non standard codes
  */
@@ -69,8 +96,8 @@ inline bool isStandardErrorCode(MBErrorCode code) {
     }
 }
 
-//! Converts Modbus error code to it's string representation
-inline std::string mbErrorCodeToStr(MBErrorCode code) noexcept {
+//! Converts Modbus error code to it's string representation, without allocation
+constexpr std::string_view mbErrorCodeToStrView(MBErrorCode code) noexcept {
     switch (code) {
     case IllegalFunction:
         return "Illegal function";
@@ -111,6 +138,11 @@ inline std::string mbErrorCodeToStr(MBErrorCode code) noexcept {
     }
 }
 
+//! Converts Modbus error code to it's string representation
+inline std::string mbErrorCodeToStr(MBErrorCode code) noexcept {
+    return std::string(mbErrorCodeToStrView(code));
+}
+
 //! All modbus standard function codes + Undefined one
 enum MBFunctionCode : uint8_t {
     // Reading functions
@@ -127,57 +159,112 @@ enum MBFunctionCode : uint8_t {
     WriteMultipleDiscreteOutputCoils          = 0x0F,
     WriteMultipleAnalogOutputHoldingRegisters = 0x10,
 
+    // File record access
+    ReadFileRecord  = 0x14,
+    WriteFileRecord = 0x15,
+
+    // Combined functions, save a round trip over read + write
+    MaskWriteRegister          = 0x16,
+    ReadWriteMultipleRegisters = 0x17,
+
     // User defined
     Undefined = 0x00
 };
 
 //! Simplified function types
-enum MBFunctionType { Read, WriteSingle, WriteMultiple };
+enum MBFunctionType {
+    Read,
+    WriteSingle,
+    WriteMultiple,
+    ReadWrite, //!< Write multiple registers, then read multiple registers (FC23)
+    MaskWrite, //!< AND / OR masks applied to single register (FC22)
+    FileRead,  //!< Read single file record group (FC20)
+    FileWrite  //!< Write single file record group (FC21)
+};
 
-//! Checks "Function type", according to MBFunctionType
-inline MBFunctionType functionType(const MBFunctionCode code) {
-    switch (code) {
-    case ReadDiscreteOutputCoils:
-    case ReadAnalogInputRegisters:
-    case ReadDiscreteInputContacts:
-    case ReadAnalogOutputHoldingRegisters:
-        return Read;
-    case WriteSingleAnalogOutputRegister:
-    case WriteSingleDiscreteOutputCoil:
-        return WriteSingle;
-    case WriteMultipleAnalogOutputHoldingRegisters:
-    case WriteMultipleDiscreteOutputCoils:
-        return WriteMultiple;
-    default:
-        throw std::runtime_error("The function code is undefined");
-    }
+//! Simplified register types
+enum MBFunctionRegisters {
+    OutputCoils,
+    InputContacts,
+    HoldingRegisters,
+    InputRegisters,
+    FileRecords
+};
+
+//! Static properties of a function code
+struct FunctionTraits {
+    bool defined                  = false;
+    MBFunctionType type           = Read;
+    MBFunctionRegisters registers = OutputCoils;
+    //! Values are bits packed into bytes instead of 16 bit registers
+    bool coils = false;
+};
+
+//! Builds traits for every possible function code byte
+constexpr std::array<FunctionTraits, 256> makeFunctionTraits() {
+    std::array<FunctionTraits, 256> traits{};
+    traits[ReadDiscreteOutputCoils]          = {true, Read, OutputCoils, true};
+    traits[ReadDiscreteInputContacts]        = {true, Read, InputContacts, true};
+    traits[ReadAnalogOutputHoldingRegisters] = {true, Read, HoldingRegisters};
+    traits[ReadAnalogInputRegisters]         = {true, Read, InputRegisters};
+    traits[WriteSingleDiscreteOutputCoil]    = {true, WriteSingle, OutputCoils, true};
+    traits[WriteSingleAnalogOutputRegister]  = {true, WriteSingle, HoldingRegisters};
+    traits[WriteMultipleDiscreteOutputCoils] = {true, WriteMultiple, OutputCoils, true};
+    traits[WriteMultipleAnalogOutputHoldingRegisters] = {true, WriteMultiple,
+                                                         HoldingRegisters};
+    traits[ReadFileRecord]             = {true, FileRead, FileRecords};
+    traits[WriteFileRecord]            = {true, FileWrite, FileRecords};
+    traits[MaskWriteRegister]          = {true, MaskWrite, HoldingRegisters};
+    traits[ReadWriteMultipleRegisters] = {true, ReadWrite, HoldingRegisters};
+    return traits;
 }
 
-//! Simplified register types
-enum MBFunctionRegisters { OutputCoils, InputContacts, HoldingRegisters, InputRegisters };
+//! Largest number of registers written by single Read / Write Multiple (FC23)
+constexpr uint16_t MaxReadWriteWriteCount = 121;
+//! Reference type of every file record group (FC20 / FC21)
+constexpr uint8_t FileRecordReferenceType = 6;
+
+//! Value stored by Mask Write Register (FC22)
+constexpr uint16_t applyMask(uint16_t current, uint16_t andMask,
+                             uint16_t orMask) noexcept {
+    return (current & andMask) | (orMask & ~andMask);
+}
+
+//! Function code properties, indexed by function code
+inline constexpr std::array<FunctionTraits, 256> FunctionTraitsTable =
+    makeFunctionTraits();
+
+//! Returns traits of function code, `defined` is false for unsupported codes
+constexpr const FunctionTraits &functionTraits(const MBFunctionCode code) noexcept {
+    return FunctionTraitsTable[code];
+}
+
+//! Checks "Function type", according to MBFunctionType
+constexpr MBFunctionType functionType(const MBFunctionCode code) {
+    if (!functionTraits(code).defined)
+        MB_THROW(std::runtime_error("The function code is undefined"));
+    return functionTraits(code).type;
+}
 
 //! Get register type based on function code
-inline MBFunctionRegisters functionRegister(const MBFunctionCode code) {
-    switch (code) {
-    case ReadDiscreteOutputCoils:
-    case WriteSingleDiscreteOutputCoil:
-    case WriteMultipleDiscreteOutputCoils:
-        return OutputCoils;
-    case ReadDiscreteInputContacts:
-        return InputContacts;
-    case ReadAnalogOutputHoldingRegisters:
-    case WriteSingleAnalogOutputRegister:
-    case WriteMultipleAnalogOutputHoldingRegisters:
-        return HoldingRegisters;
-    case ReadAnalogInputRegisters:
-        return InputRegisters;
-    default:
-        throw std::runtime_error("The function code is undefined");
-    }
+constexpr MBFunctionRegisters functionRegister(const MBFunctionCode code) {
+    if (!functionTraits(code).defined)
+        MB_THROW(std::runtime_error("The function code is undefined"));
+    return functionTraits(code).registers;
 }
 
-//! Converts modbus function code to its string represenatiton
-inline std::string mbFunctionToStr(MBFunctionCode code) noexcept {
+//! Checks if function code operates on coils (bits), never throws
+constexpr bool isCoilFunction(const MBFunctionCode code) noexcept {
+    return functionTraits(code).coils;
+}
+
+//! Checks if function code is a plain read of one table (FC1 - FC4), never throws
+constexpr bool isReadFunction(const MBFunctionCode code) noexcept {
+    return functionTraits(code).defined && functionTraits(code).type == Read;
+}
+
+//! Converts modbus function code to its string represenatiton, without allocation
+constexpr std::string_view mbFunctionToStrView(MBFunctionCode code) noexcept {
     switch (code) {
     case ReadDiscreteOutputCoils:
         return "Read from output coils";
@@ -195,48 +282,97 @@ inline std::string mbFunctionToStr(MBFunctionCode code) noexcept {
         return "Write to multiple holding registers";
     case WriteMultipleDiscreteOutputCoils:
         return "Write to multiple output coils";
+    case ReadFileRecord:
+        return "Read file record";
+    case WriteFileRecord:
+        return "Write file record";
+    case MaskWriteRegister:
+        return "Mask write register";
+    case ReadWriteMultipleRegisters:
+        return "Read / write multiple registers";
     default:
         return "Undefined";
     }
 }
 
+//! Converts modbus function code to its string represenatiton
+inline std::string mbFunctionToStr(MBFunctionCode code) noexcept {
+    return std::string(mbFunctionToStrView(code));
+}
+
 //! Create uint16_t from buffer of two bytes, ex. { 0x01, 0x02 } => 0x0102
 inline uint16_t bigEndianConv(const uint8_t *buf) {
     return static_cast<uint16_t>(buf[1]) +
            (static_cast<uint16_t>(buf[0]) << 8); // NOLINT(hicpp-signed-bitwise)
 }
 
-//! Calculates CRC
-inline uint16_t calculateCRC(const uint8_t *buff, size_t len) {
-    static const uint16_t wCRCTable[] = {
-        0X0000, 0XC0C1, 0XC181, 0X0140, 0XC301, 0X03C0, 0X0280, 0XC241, 0XC601, 0X06C0,
-        0X0780, 0XC741, 0X0500, 0XC5C1, 0XC481, 0X0440, 0XCC01, 0X0CC0, 0X0D80, 0XCD41,
-        0X0F00, 0XCFC1, 0XCE81, 0X0E40, 0X0A00, 0XCAC1, 0XCB81, 0X0B40, 0XC901, 0X09C0,
-        0X0880, 0XC841, 0XD801, 0X18C0, 0X1980, 0XD941, 0X1B00, 0XDBC1, 0XDA81, 0X1A40,
-        0X1E00, 0XDEC1, 0XDF81, 0X1F40, 0XDD01, 0X1DC0, 0X1C80, 0XDC41, 0X1400, 0XD4C1,
-        0XD581, 0X1540, 0XD701, 0X17C0, 0X1680, 0XD641, 0XD201, 0X12C0, 0X1380, 0XD341,
-        0X1100, 0XD1C1, 0XD081, 0X1040, 0XF001, 0X30C0, 0X3180, 0XF141, 0X3300, 0XF3C1,
-        0XF281, 0X3240, 0X3600, 0XF6C1, 0XF781, 0X3740, 0XF501, 0X35C0, 0X3480, 0XF441,
-        0X3C00, 0XFCC1, 0XFD81, 0X3D40, 0XFF01, 0X3FC0, 0X3E80, 0XFE41, 0XFA01, 0X3AC0,
-        0X3B80, 0XFB41, 0X3900, 0XF9C1, 0XF881, 0X3840, 0X2800, 0XE8C1, 0XE981, 0X2940,
-        0XEB01, 0X2BC0, 0X2A80, 0XEA41, 0XEE01, 0X2EC0, 0X2F80, 0XEF41, 0X2D00, 0XEDC1,
-        0XEC81, 0X2C40, 0XE401, 0X24C0, 0X2580, 0XE541, 0X2700, 0XE7C1, 0XE681, 0X2640,
-        0X2200, 0XE2C1, 0XE381, 0X2340, 0XE101, 0X21C0, 0X2080, 0XE041, 0XA001, 0X60C0,
-        0X6180, 0XA141, 0X6300, 0XA3C1, 0XA281, 0X6240, 0X6600, 0XA6C1, 0XA781, 0X6740,
-        0XA501, 0X65C0, 0X6480, 0XA441, 0X6C00, 0XACC1, 0XAD81, 0X6D40, 0XAF01, 0X6FC0,
-        0X6E80, 0XAE41, 0XAA01, 0X6AC0, 0X6B80, 0XAB41, 0X6900, 0XA9C1, 0XA881, 0X6840,
-        0X7800, 0XB8C1, 0XB981, 0X7940, 0XBB01, 0X7BC0, 0X7A80, 0XBA41, 0XBE01, 0X7EC0,
-        0X7F80, 0XBF41, 0X7D00, 0XBDC1, 0XBC81, 0X7C40, 0XB401, 0X74C0, 0X7580, 0XB541,
-        0X7700, 0XB7C1, 0XB681, 0X7640, 0X7200, 0XB2C1, 0XB381, 0X7340, 0XB101, 0X71C0,
-        0X7080, 0XB041, 0X5000, 0X90C1, 0X9181, 0X5140, 0X9301, 0X53C0, 0X5280, 0X9241,
-        0X9601, 0X56C0, 0X5780, 0X9741, 0X5500, 0X95C1, 0X9481, 0X5440, 0X9C01, 0X5CC0,
-        0X5D80, 0X9D41, 0X5F00, 0X9FC1, 0X9E81, 0X5E40, 0X5A00, 0X9AC1, 0X9B81, 0X5B40,
-        0X9901, 0X59C0, 0X5880, 0X9841, 0X8801, 0X48C0, 0X4980, 0X8941, 0X4B00, 0X8BC1,
-        0X8A81, 0X4A40, 0X4E00, 0X8EC1, 0X8F81, 0X4F40, 0X8D01, 0X4DC0, 0X4C80, 0X8C41,
-        0X4400, 0X84C1, 0X8581, 0X4540, 0X8701, 0X47C0, 0X4680, 0X8641, 0X8201, 0X42C0,
-        0X4380, 0X8341, 0X4100, 0X81C1, 0X8081, 0X4040};
-
-    uint8_t nTemp;
+/*! Order of bytes when value spans multiple registers.
+ * Letters name bytes as they appear on the wire, A being the most significant
+ * byte of the value in the standard (big endian) order.
+ */
+enum WordOrder : uint8_t {
+    ABCD, //!< Big endian, Modbus default
+    CDAB, //!< Registers swapped, bytes within register big endian
+    BADC, //!< Registers in order, bytes within register swapped
+    DCBA  //!< Little endian
+};
+
+//! Create uint32_t from four wire bytes (two registers) in given word order
+inline uint32_t combineUint32(const uint8_t *buf, WordOrder order = ABCD) {
+    const uint32_t a = buf[0], b = buf[1], c = buf[2], d = buf[3];
+    switch (order) {
+    case CDAB:
+        return (c << 24) | (d << 16) | (a << 8) | b;
+    case BADC:
+        return (b << 24) | (a << 16) | (d << 8) | c;
+    case DCBA:
+        return (d << 24) | (c << 16) | (b << 8) | a;
+    case ABCD:
+    default:
+        return (a << 24) | (b << 16) | (c << 8) | d;
+    }
+}
+
+//! Create float from four wire bytes (two registers) in given word order
+inline float combineFloat32(const uint8_t *buf, WordOrder order = ABCD) {
+    const auto raw = combineUint32(buf, order);
+    float result;
+    std::memcpy(&result, &raw, sizeof(result));
+    return result;
+}
+
+//! Lookup table used by calculateCRC
+inline constexpr uint16_t wCRCTable[] = {
+    0X0000, 0XC0C1, 0XC181, 0X0140, 0XC301, 0X03C0, 0X0280, 0XC241, 0XC601, 0X06C0,
+    0X0780, 0XC741, 0X0500, 0XC5C1, 0XC481, 0X0440, 0XCC01, 0X0CC0, 0X0D80, 0XCD41,
+    0X0F00, 0XCFC1, 0XCE81, 0X0E40, 0X0A00, 0XCAC1, 0XCB81, 0X0B40, 0XC901, 0X09C0,
+    0X0880, 0XC841, 0XD801, 0X18C0, 0X1980, 0XD941, 0X1B00, 0XDBC1, 0XDA81, 0X1A40,
+    0X1E00, 0XDEC1, 0XDF81, 0X1F40, 0XDD01, 0X1DC0, 0X1C80, 0XDC41, 0X1400, 0XD4C1,
+    0XD581, 0X1540, 0XD701, 0X17C0, 0X1680, 0XD641, 0XD201, 0X12C0, 0X1380, 0XD341,
+    0X1100, 0XD1C1, 0XD081, 0X1040, 0XF001, 0X30C0, 0X3180, 0XF141, 0X3300, 0XF3C1,
+    0XF281, 0X3240, 0X3600, 0XF6C1, 0XF781, 0X3740, 0XF501, 0X35C0, 0X3480, 0XF441,
+    0X3C00, 0XFCC1, 0XFD81, 0X3D40, 0XFF01, 0X3FC0, 0X3E80, 0XFE41, 0XFA01, 0X3AC0,
+    0X3B80, 0XFB41, 0X3900, 0XF9C1, 0XF881, 0X3840, 0X2800, 0XE8C1, 0XE981, 0X2940,
+    0XEB01, 0X2BC0, 0X2A80, 0XEA41, 0XEE01, 0X2EC0, 0X2F80, 0XEF41, 0X2D00, 0XEDC1,
+    0XEC81, 0X2C40, 0XE401, 0X24C0, 0X2580, 0XE541, 0X2700, 0XE7C1, 0XE681, 0X2640,
+    0X2200, 0XE2C1, 0XE381, 0X2340, 0XE101, 0X21C0, 0X2080, 0XE041, 0XA001, 0X60C0,
+    0X6180, 0XA141, 0X6300, 0XA3C1, 0XA281, 0X6240, 0X6600, 0XA6C1, 0XA781, 0X6740,
+    0XA501, 0X65C0, 0X6480, 0XA441, 0X6C00, 0XACC1, 0XAD81, 0X6D40, 0XAF01, 0X6FC0,
+    0X6E80, 0XAE41, 0XAA01, 0X6AC0, 0X6B80, 0XAB41, 0X6900, 0XA9C1, 0XA881, 0X6840,
+    0X7800, 0XB8C1, 0XB981, 0X7940, 0XBB01, 0X7BC0, 0X7A80, 0XBA41, 0XBE01, 0X7EC0,
+    0X7F80, 0XBF41, 0X7D00, 0XBDC1, 0XBC81, 0X7C40, 0XB401, 0X74C0, 0X7580, 0XB541,
+    0X7700, 0XB7C1, 0XB681, 0X7640, 0X7200, 0XB2C1, 0XB381, 0X7340, 0XB101, 0X71C0,
+    0X7080, 0XB041, 0X5000, 0X90C1, 0X9181, 0X5140, 0X9301, 0X53C0, 0X5280, 0X9241,
+    0X9601, 0X56C0, 0X5780, 0X9741, 0X5500, 0X95C1, 0X9481, 0X5440, 0X9C01, 0X5CC0,
+    0X5D80, 0X9D41, 0X5F00, 0X9FC1, 0X9E81, 0X5E40, 0X5A00, 0X9AC1, 0X9B81, 0X5B40,
+    0X9901, 0X59C0, 0X5880, 0X9841, 0X8801, 0X48C0, 0X4980, 0X8941, 0X4B00, 0X8BC1,
+    0X8A81, 0X4A40, 0X4E00, 0X8EC1, 0X8F81, 0X4F40, 0X8D01, 0X4DC0, 0X4C80, 0X8C41,
+    0X4400, 0X84C1, 0X8581, 0X4540, 0X8701, 0X47C0, 0X4680, 0X8641, 0X8201, 0X42C0,
+    0X4380, 0X8341, 0X4100, 0X81C1, 0X8081, 0X4040};
+
+//! Calculates CRC, usable in constant expressions
+constexpr uint16_t calculateCRC(const uint8_t *buff, size_t len) {
+    uint8_t nTemp     = 0;
     uint16_t wCRCWord = 0xFFFF;
 
     while (len--) {
@@ -2,6 +2,7 @@
 #define MODBUS_VOEGTLIN_HPP
 
 #include <MB/Serial/connection.hpp>
+#include <MB/modbusConvert.hpp>
 #include <algorithm>
 #include <iomanip>
 #include <iostream>
@@ -105,20 +106,12 @@ template <>
 inline auto VoegtlinGSC::convertPayload(std::vector<uint8_t> msg, MB::DataType type,
                                         float &val) -> bool {
     auto numBytes = getNumBytesFromDataType(type);
-    union {
-        float f;
-        char c[4];
-    } cnv;
 
     if (msg[2] == numBytes) {
         using namespace MB;
         switch (type) {
         case f32t:
-            cnv.c[0] = msg[6];
-            cnv.c[1] = msg[5];
-            cnv.c[2] = msg[4];
-            cnv.c[3] = msg[3];
-            val      = cnv.f;
+            utils::decodeRegisters(&msg[3], 1, &val);
             return true;
         }
     }
@@ -130,10 +123,6 @@ template <>
 inline auto VoegtlinGSC::convertPayload(std::vector<uint8_t> msg, MB::DataType type,
                                         unsigned int &val) -> bool {
     auto numBytes = getNumBytesFromDataType(type);
-    union {
-        uint32_t u;
-        char c[4];
-    } cnv;
 
     if (msg[2] == numBytes) {
         using namespace MB;
@@ -142,20 +131,15 @@ inline auto VoegtlinGSC::convertPayload(std::vector<uint8_t> msg, MB::DataType t
             val = msg[3];
             return true;
 
-        case u16t:
-            cnv.c[0] = 0;
-            cnv.c[1] = 0;
-            cnv.c[2] = msg[4];
-            cnv.c[3] = msg[3];
-            val      = cnv.u;
+        case u16t: {
+            uint16_t u16;
+            utils::decodeRegisters(&msg[3], 1, &u16);
+            val = u16;
             return true;
+        }
 
         case u32t:
-            cnv.c[0] = msg[6];
-            cnv.c[1] = msg[5];
-            cnv.c[2] = msg[4];
-            cnv.c[3] = msg[3];
-            val      = cnv.u;
+            utils::decodeRegisters(&msg[3], 1, &val);
             return true;
         }
     }
@@ -166,10 +150,6 @@ template <>
 inline auto VoegtlinGSC::convertPayload(std::vector<uint8_t> msg, MB::DataType type,
                                         uint16_t &val) -> bool {
     auto numBytes = getNumBytesFromDataType(type);
-    union {
-        uint32_t u;
-        char c[4];
-    } cnv;
 
     if (msg[2] == numBytes) {
         using namespace MB;
@@ -179,21 +159,16 @@ inline auto VoegtlinGSC::convertPayload(std::vector<uint8_t> msg, MB::DataType t
             return true;
 
         case u16t:
-            cnv.c[0] = 0;
-            cnv.c[1] = 0;
-            cnv.c[2] = msg[4];
-            cnv.c[3] = msg[3];
-            val      = cnv.u;
+            utils::decodeRegisters(&msg[3], 1, &val);
             return true;
 
-        case u32t:
-            cnv.c[0] = msg[6];
-            cnv.c[1] = msg[5];
-            cnv.c[2] = msg[4];
-            cnv.c[3] = msg[3];
-            val      = cnv.u;
+        case u32t: {
+            uint32_t u32;
+            utils::decodeRegisters(&msg[3], 1, &u32);
+            val = static_cast<uint16_t>(u32);
             return true;
         }
+        }
     }
     return false;
 }
@@ -216,48 +191,22 @@ inline auto VoegtlinGSC::writeParam(MB::ModbusParam param, std::vector<uint8_t>
 
 template <>
 inline auto VoegtlinGSC::writeParam(MB::ModbusParam param, float val) -> bool {
-    union {
-        float f;
-        char c[4];
-    } cnv;
-    std::vector<uint8_t> data(4, 0);
-
-    cnv.f   = val;
-    data[0] = cnv.c[3];
-    data[1] = cnv.c[2];
-    data[2] = cnv.c[1];
-    data[3] = cnv.c[0];
+    std::vector<uint8_t> data(sizeof(val), 0);
+    MB::utils::encodeRegisters(&val, 1, data.data());
     return writeParam(param, data);
 }
 
 template <>
 inline auto VoegtlinGSC::writeParam(MB::ModbusParam param, uint16_t val) -> bool {
-    union {
-        uint16_t u;
-        char c[2];
-    } cnv;
-    std::vector<uint8_t> data(2, 0);
-
-    cnv.u   = val;
-    data[0] = cnv.c[1];
-    data[1] = cnv.c[0];
-
+    std::vector<uint8_t> data(sizeof(val), 0);
+    MB::utils::encodeRegisters(&val, 1, data.data());
     return writeParam(param, data);
 }
 
 template <>
 inline auto VoegtlinGSC::writeParam(MB::ModbusParam param, uint32_t val) -> bool {
-    union {
-        uint32_t u;
-        char c[4];
-    } cnv;
-    std::vector<uint8_t> data(4, 0);
-
-    cnv.u   = val;
-    data[0] = cnv.c[3];
-    data[1] = cnv.c[2];
-    data[2] = cnv.c[1];
-    data[3] = cnv.c[0];
+    std::vector<uint8_t> data(sizeof(val), 0);
+    MB::utils::encodeRegisters(&val, 1, data.data());
     return writeParam(param, data);
 }
 
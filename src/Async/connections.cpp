@@ -0,0 +1,382 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "Async/connections.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "modbusFraming.hpp"
+
+using namespace MB::Async;
+
+namespace {
+using Clock = EventLoop::Clock;
+
+bool wouldBlock() noexcept { return errno == EAGAIN || errno == EWOULDBLOCK; }
+} // namespace
+
+IoWatcher::~IoWatcher() {
+    _loop.cancel(_timer);
+    if (_added)
+        _loop.remove(_fd);
+}
+
+void IoWatcher::arm(uint32_t events, Clock::time_point deadline) {
+    _ready = false;
+    if (_added) {
+        _loop.modify(_fd, events | EPOLLONESHOT, this);
+    } else {
+        _loop.add(_fd, events | EPOLLONESHOT, this);
+        _added = true;
+    }
+
+    if (deadline == Clock::time_point::max())
+        return;
+    _timer = _loop.schedule(deadline, [this] {
+        // Fd stays armed, its late event finds nobody waiting
+        _timer = {};
+        std::exchange(_waiting, {}).resume();
+    });
+}
+
+void IoWatcher::onEvents(uint32_t) {
+    if (!_waiting)
+        return;
+
+    _loop.cancel(_timer);
+    _timer = {};
+    _ready = true;
+    // Resumed coroutine may destroy the watcher, nothing follows
+    std::exchange(_waiting, {}).resume();
+}
+
+TcpStream::TcpStream(EventLoop &loop, int sockfd)
+    : _loop(&loop), _fd(sockfd), _io(std::make_unique<IoWatcher>(loop, sockfd)) {
+    ::fcntl(sockfd, F_SETFL, ::fcntl(sockfd, F_GETFL) | O_NONBLOCK);
+}
+
+TcpStream::TcpStream(TcpStream &&other) noexcept
+    : _loop(other._loop), _fd(std::exchange(other._fd, -1)), _io(std::move(other._io)),
+      _messageID(other._messageID), _timeout(other._timeout),
+      _txBuffer(std::move(other._txBuffer)), _rxFramer(std::move(other._rxFramer)),
+      _rxFrame(other._rxFrame) {}
+
+TcpStream &TcpStream::operator=(TcpStream &&other) noexcept {
+    if (this == &other)
+        return *this;
+
+    close();
+    _loop      = other._loop;
+    _fd        = std::exchange(other._fd, -1);
+    _io        = std::move(other._io);
+    _messageID = other._messageID;
+    _timeout   = other._timeout;
+    _txBuffer  = std::move(other._txBuffer);
+    _rxFramer  = std::move(other._rxFramer);
+    _rxFrame   = other._rxFrame;
+    return *this;
+}
+
+void TcpStream::close() noexcept {
+    // Watcher goes first, fd must be removed from epoll before closing
+    _io.reset();
+    if (_fd != -1)
+        ::close(_fd);
+    _fd = -1;
+}
+
+Task<MB::Result<TcpStream>> TcpStream::connect(EventLoop &loop, std::string address,
+                                               int port,
+                                               std::chrono::milliseconds timeout) {
+    const auto sock = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (sock == -1)
+        co_return MB::utils::ConnectionClosed;
+    TcpStream stream(loop, sock);
+
+    sockaddr_in server = {.sin_family = AF_INET,
+                          .sin_port   = htons(port),
+                          .sin_addr   = {inet_addr(address.c_str())},
+                          .sin_zero   = {}};
+
+    if (::connect(sock, reinterpret_cast<struct sockaddr *>(&server), sizeof(server)) ==
+        -1) {
+        if (errno != EINPROGRESS)
+            co_return MB::utils::ConnectionClosed;
+        if (!co_await stream._io->wait(EPOLLOUT, Clock::now() + timeout))
+            co_return MB::utils::Timeout;
+
+        int error      = 0;
+        socklen_t size = sizeof(error);
+        if (::getsockopt(sock, SOL_SOCKET, SO_ERROR, &error, &size) == -1 || error != 0)
+            co_return MB::utils::ConnectionClosed;
+    }
+
+    co_return std::move(stream);
+}
+
+Task<MB::Status> TcpStream::write() {
+    const auto deadline = Clock::now() + _timeout;
+    std::size_t offset  = 0;
+
+    while (offset < _txBuffer.size()) {
+        const auto sent = ::send(_fd, _txBuffer.data() + offset,
+                                 _txBuffer.size() - offset, MSG_NOSIGNAL);
+        if (sent >= 0) {
+            offset += static_cast<std::size_t>(sent);
+            continue;
+        }
+        if (errno == EINTR)
+            continue;
+        if (!wouldBlock())
+            co_return MB::utils::ConnectionClosed;
+        if (!co_await _io->wait(EPOLLOUT, deadline))
+            co_return MB::utils::Timeout;
+    }
+    co_return MB::Status();
+}
+
+Task<MB::Status> TcpStream::receive(Clock::time_point deadline) {
+    while (true) {
+        if (auto frame = _rxFramer.next()) {
+            _rxFrame = *frame;
+            co_return MB::Status();
+        }
+        if (_rxFramer.invalid())
+            co_return MB::utils::InvalidByteOrder;
+
+        auto *buffer    = _rxFramer.writable();
+        const auto size = ::recv(_fd, buffer, _rxFramer.writableSize(), 0);
+        if (size > 0) {
+            _rxFramer.commit(static_cast<std::size_t>(size));
+            continue;
+        }
+        if (size == 0)
+            co_return MB::utils::ConnectionClosed;
+        if (errno == EINTR)
+            continue;
+        if (!wouldBlock())
+            co_return MB::utils::ConnectionClosed;
+        if (!co_await _io->wait(EPOLLIN, deadline))
+            co_return MB::utils::Timeout;
+    }
+}
+
+Task<MB::Result<MB::ModbusResponse>> TcpStream::transact(MB::ModbusRequest request) {
+    if (!isOpen())
+        co_return MB::utils::ConnectionClosed;
+
+    _messageID++;
+    _txBuffer.clear();
+    MB::appendTCP(request, _messageID, _txBuffer);
+    const auto sent = co_await write();
+    if (!sent)
+        co_return sent.error();
+
+    const auto deadline = Clock::now() + _timeout;
+    while (true) {
+        const auto received = co_await receive(deadline);
+        if (!received)
+            co_return received.error();
+        // Late response of previous (timed out) transaction
+        if (_rxFrame.header.transactionID != _messageID)
+            continue;
+
+        co_return MB::parseResponse(_rxFrame.pdu(), _rxFrame.pduSize());
+    }
+}
+
+Task<MB::Result<MB::ModbusRequest>> TcpStream::awaitRequest() {
+    if (!isOpen())
+        co_return MB::utils::ConnectionClosed;
+
+    const auto received = co_await receive(Clock::time_point::max());
+    if (!received)
+        co_return received.error();
+
+    _messageID = _rxFrame.header.transactionID;
+    co_return MB::ModbusRequest::tryFromRaw(_rxFrame.pdu(), _rxFrame.pduSize());
+}
+
+Task<MB::Status> TcpStream::sendResponse(MB::ModbusResponse response) {
+    if (!isOpen())
+        co_return MB::utils::ConnectionClosed;
+
+    _txBuffer.clear();
+    MB::appendTCP(response, _messageID, _txBuffer);
+    co_return co_await write();
+}
+
+Task<MB::Status> TcpStream::sendException(MB::ModbusException exception) {
+    if (!isOpen())
+        co_return MB::utils::ConnectionClosed;
+
+    _txBuffer.clear();
+    MB::appendTCP(exception, _messageID, _txBuffer);
+    co_return co_await write();
+}
+
+TcpListener::TcpListener(EventLoop &loop, int fd, int port)
+    : _loop(&loop), _fd(fd), _port(port), _io(std::make_unique<IoWatcher>(loop, fd)) {}
+
+TcpListener::TcpListener(TcpListener &&other) noexcept
+    : _loop(other._loop), _fd(std::exchange(other._fd, -1)), _port(other._port),
+      _io(std::move(other._io)) {}
+
+TcpListener &TcpListener::operator=(TcpListener &&other) noexcept {
+    if (this == &other)
+        return *this;
+
+    _io.reset();
+    if (_fd != -1)
+        ::close(_fd);
+    _loop = other._loop;
+    _fd   = std::exchange(other._fd, -1);
+    _port = other._port;
+    _io   = std::move(other._io);
+    return *this;
+}
+
+TcpListener::~TcpListener() {
+    _io.reset();
+    if (_fd != -1)
+        ::close(_fd);
+}
+
+TcpListener TcpListener::listen(EventLoop &loop, int port) {
+    const auto fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1)
+        MB_THROW(std::runtime_error("Cannot create socket"));
+
+    const int enable = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    sockaddr_in address = {};
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port        = ::htons(port);
+
+    socklen_t size = sizeof(address);
+    if (::bind(fd, reinterpret_cast<struct sockaddr *>(&address), size) < 0 ||
+        ::listen(fd, 255) < 0) {
+        ::close(fd);
+        MB_THROW(std::runtime_error("Cannot bind socket"));
+    }
+
+    ::getsockname(fd, reinterpret_cast<struct sockaddr *>(&address), &size);
+    return TcpListener(loop, fd, ::ntohs(address.sin_port));
+}
+
+Task<MB::Result<TcpStream>> TcpListener::accept() {
+    while (true) {
+        const auto fd = ::accept4(_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd >= 0)
+            co_return TcpStream(*_loop, fd);
+        if (errno == EINTR || errno == ECONNABORTED)
+            continue;
+        if (!wouldBlock())
+            co_return MB::utils::ConnectionClosed;
+        co_await _io->wait(EPOLLIN);
+    }
+}
+
+RtuPort::RtuPort(EventLoop &loop, MB::Serial::Connection &connection)
+    : _loop(loop), _fd(connection.nativeHandle()), _io(loop, _fd) {}
+
+Task<MB::Status> RtuPort::write() {
+    const auto deadline = Clock::now() + _timeout;
+    std::size_t offset  = 0;
+
+    while (offset < _txBuffer.size()) {
+        const auto written =
+            ::write(_fd, _txBuffer.data() + offset, _txBuffer.size() - offset);
+        if (written >= 0) {
+            offset += static_cast<std::size_t>(written);
+            continue;
+        }
+        if (errno == EINTR)
+            continue;
+        if (!wouldBlock())
+            co_return MB::utils::SlaveDeviceFailure;
+        if (!co_await _io.wait(EPOLLOUT, deadline))
+            co_return MB::utils::Timeout;
+    }
+    co_return MB::Status();
+}
+
+Task<MB::Result<std::size_t>> RtuPort::receive(MB::RtuFramer &framer,
+                                               Clock::time_point deadline) {
+    std::size_t frameSize = 0;
+    auto onFrame          = [&](const uint8_t *frame, std::size_t size) {
+        std::copy(frame, frame + size, _frame.begin());
+        frameSize = size;
+        return false; // Stop at first frame, following bytes wait for the next receive
+    };
+
+    while (true) {
+        // Each received byte is fed to the framer exactly once
+        _rxBegin += framer.feed(_rxChunk.data() + _rxBegin, _rxEnd - _rxBegin, onFrame);
+        if (frameSize != 0)
+            co_return frameSize;
+
+        const auto size = ::read(_fd, _rxChunk.data(), _rxChunk.size());
+        if (size > 0) {
+            _rxBegin = 0;
+            _rxEnd   = static_cast<std::size_t>(size);
+            continue;
+        }
+        if (size < 0 && errno == EINTR)
+            continue;
+        if (size < 0 && !wouldBlock())
+            co_return MB::utils::SlaveDeviceFailure;
+        if (!co_await _io.wait(EPOLLIN, deadline))
+            co_return MB::utils::Timeout;
+    }
+}
+
+Task<MB::Result<MB::ModbusResponse>> RtuPort::transact(MB::ModbusRequest request) {
+    _txBuffer.clear();
+    MB::appendRTU(request, _txBuffer);
+    const auto sent = co_await write();
+    if (!sent)
+        co_return sent.error();
+
+    const auto size = co_await receive(_responseFramer, Clock::now() + _timeout);
+    if (!size)
+        co_return size.error();
+
+    if (MB::ModbusException::exist(_frame.data(), size.value()))
+        co_return MB::ModbusException(_frame.data(), size.value(), true).getErrorCode();
+
+    // CRC was already checked by the framer
+    co_return MB::ModbusResponse::tryFromRaw(_frame.data(), size.value() - 2);
+}
+
+Task<MB::Result<MB::ModbusRequest>> RtuPort::awaitRequest() {
+    const auto size = co_await receive(_requestFramer, Clock::time_point::max());
+    if (!size)
+        co_return size.error();
+
+    // CRC was already checked by the framer
+    co_return MB::ModbusRequest::tryFromRaw(_frame.data(), size.value() - 2);
+}
+
+Task<MB::Status> RtuPort::sendResponse(MB::ModbusResponse response) {
+    _txBuffer.clear();
+    MB::appendRTU(response, _txBuffer);
+    co_return co_await write();
+}
+
+Task<MB::Status> RtuPort::sendException(MB::ModbusException exception) {
+    _txBuffer.clear();
+    MB::appendRTU(exception, _txBuffer);
+    co_return co_await write();
+}
@@ -0,0 +1,193 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "Async/eventLoop.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <string>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "modbusUtils.hpp"
+
+using namespace MB::Async;
+
+EventLoop::EventLoop() : _events(EventBatch) {
+    _spareTimers.reserve(SpareTimers);
+    _epoll = ::epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll == -1)
+        MB_THROW(std::runtime_error("Cannot create epoll, errno = " +
+                                    std::to_string(errno)));
+
+    _wakeup = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_wakeup == -1) {
+        ::close(_epoll);
+        MB_THROW(std::runtime_error("Cannot create eventfd, errno = " +
+                                    std::to_string(errno)));
+    }
+
+    // Wakeup fd is the only one registered without handler
+    epoll_event event = {.events = EPOLLIN, .data = {.ptr = nullptr}};
+    ::epoll_ctl(_epoll, EPOLL_CTL_ADD, _wakeup, &event);
+}
+
+EventLoop::~EventLoop() {
+    ::close(_wakeup);
+    ::close(_epoll);
+}
+
+void EventLoop::add(int fd, uint32_t events, Handler *handler) {
+    epoll_event event = {.events = events, .data = {.ptr = handler}};
+    if (::epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &event) == -1)
+        MB_THROW(std::runtime_error("Cannot watch fd, errno = " + std::to_string(errno)));
+}
+
+void EventLoop::modify(int fd, uint32_t events, Handler *handler) {
+    epoll_event event = {.events = events, .data = {.ptr = handler}};
+    if (::epoll_ctl(_epoll, EPOLL_CTL_MOD, fd, &event) == -1)
+        MB_THROW(
+            std::runtime_error("Cannot modify fd, errno = " + std::to_string(errno)));
+}
+
+void EventLoop::remove(int fd) noexcept {
+    ::epoll_ctl(_epoll, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+EventLoop::TimerId EventLoop::schedule(Clock::time_point deadline, Task task) {
+    const TimerId id{deadline, ++_timerSequence};
+    if (_spareTimers.empty()) {
+        _timers.emplace(std::make_pair(deadline, id.sequence), std::move(task));
+        return id;
+    }
+
+    auto node     = std::move(_spareTimers.back());
+    node.key()    = std::make_pair(deadline, id.sequence);
+    node.mapped() = std::move(task);
+    _spareTimers.pop_back();
+    _timers.insert(std::move(node));
+    return id;
+}
+
+void EventLoop::cancel(TimerId id) noexcept {
+    if (!id)
+        return;
+    if (auto node = _timers.extract(std::make_pair(id.deadline, id.sequence)))
+        recycle(std::move(node));
+}
+
+void EventLoop::recycle(Timers::node_type &&node) noexcept {
+    node.mapped() = nullptr;
+    if (_spareTimers.size() < _spareTimers.capacity())
+        _spareTimers.push_back(std::move(node));
+}
+
+void EventLoop::post(Task task) {
+    {
+        std::lock_guard lock(_tasksMutex);
+        _tasks.push_back(std::move(task));
+    }
+    wake();
+}
+
+void EventLoop::dispatch(Task task) {
+    if (inLoopThread())
+        task();
+    else
+        post(std::move(task));
+}
+
+void EventLoop::wake() noexcept {
+    const uint64_t one = 1;
+    [[maybe_unused]] const auto written = ::write(_wakeup, &one, sizeof(one));
+}
+
+int EventLoop::waitTimeout(int timeout) const noexcept {
+    if (_timers.empty())
+        return timeout;
+
+    const auto untilTimer = std::chrono::ceil<std::chrono::milliseconds>(
+        _timers.begin()->first.first - Clock::now());
+    const auto timerTimeout =
+        static_cast<int>(std::max<std::chrono::milliseconds::rep>(untilTimer.count(), 0));
+    return timeout < 0 ? timerTimeout : std::min(timeout, timerTimeout);
+}
+
+std::size_t EventLoop::runTasks() {
+    {
+        std::lock_guard lock(_tasksMutex);
+        if (_tasks.empty())
+            return 0;
+        _running.swap(_tasks);
+    }
+
+    // Tasks posted meanwhile (also by these tasks) run in the next iteration
+    for (auto &task : _running)
+        task();
+
+    const auto count = _running.size();
+    _running.clear();
+    return count;
+}
+
+std::size_t EventLoop::runTimers() {
+    std::size_t count = 0;
+    const auto now    = Clock::now();
+
+    // Timer may schedule (or cancel) other timers, so the map is re-read
+    // after every task
+    while (!_timers.empty() && _timers.begin()->first.first <= now) {
+        auto node = _timers.extract(_timers.begin());
+        node.mapped()();
+        recycle(std::move(node));
+        count++;
+    }
+    return count;
+}
+
+std::size_t EventLoop::runOnce(int timeout) {
+    _thread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+
+    bool pendingTasks;
+    {
+        std::lock_guard lock(_tasksMutex);
+        pendingTasks = !_tasks.empty();
+    }
+
+    const auto ready =
+        ::epoll_wait(_epoll, _events.data(), static_cast<int>(_events.size()),
+                     pendingTasks ? 0 : waitTimeout(timeout));
+
+    std::size_t handled = 0;
+    for (int i = 0; i < ready; i++) {
+        auto *handler = static_cast<Handler *>(_events[i].data.ptr);
+        if (handler == nullptr) {
+            uint64_t count;
+            [[maybe_unused]] const auto read = ::read(_wakeup, &count, sizeof(count));
+            continue;
+        }
+
+        handler->onEvents(_events[i].events);
+        handled++;
+    }
+
+    handled += runTimers();
+    handled += runTasks();
+    return handled;
+}
+
+void EventLoop::run() {
+    while (!_stopped.load(std::memory_order_acquire))
+        runOnce();
+
+    _stopped.store(false, std::memory_order_release);
+    _thread.store(std::thread::id(), std::memory_order_relaxed);
+}
+
+void EventLoop::stop() noexcept {
+    _stopped.store(true, std::memory_order_release);
+    wake();
+}
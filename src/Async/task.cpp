@@ -0,0 +1,68 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "Async/task.hpp"
+
+#include <array>
+#include <new>
+
+using namespace MB::Async;
+
+namespace {
+constexpr std::size_t SizeClasses = FramePool::MaxPooledSize / FramePool::Granularity;
+
+struct FreeFrame {
+    FreeFrame *next;
+};
+
+//! Free lists of this thread, frames are returned to the heap at thread exit
+struct FreeLists {
+    std::array<FreeFrame *, SizeClasses> heads{};
+    std::size_t heapAllocations = 0;
+
+    ~FreeLists() {
+        for (auto *head : heads)
+            while (head) {
+                auto *next = head->next;
+                ::operator delete(head);
+                head = next;
+            }
+    }
+};
+
+thread_local FreeLists freeLists;
+
+std::size_t sizeClass(std::size_t size) noexcept {
+    return (size + FramePool::Granularity - 1) / FramePool::Granularity - 1;
+}
+} // namespace
+
+void *FramePool::allocate(std::size_t size) {
+    if (size > MaxPooledSize) {
+        freeLists.heapAllocations++;
+        return ::operator new(size);
+    }
+
+    auto &head = freeLists.heads[sizeClass(size)];
+    if (head) {
+        auto *frame = head;
+        head        = frame->next;
+        return frame;
+    }
+
+    freeLists.heapAllocations++;
+    return ::operator new((sizeClass(size) + 1) * Granularity);
+}
+
+void FramePool::deallocate(void *frame, std::size_t size) noexcept {
+    if (size > MaxPooledSize) {
+        ::operator delete(frame);
+        return;
+    }
+
+    auto &head = freeLists.heads[sizeClass(size)];
+    head       = new (frame) FreeFrame{head};
+}
+
+std::size_t FramePool::heapAllocations() noexcept { return freeLists.heapAllocations; }
@@ -0,0 +1,339 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "Async/tcpClient.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "modbusException.hpp"
+#include "modbusFraming.hpp"
+
+using namespace MB::Async;
+
+TcpSession::TcpSession(EventLoop &loop, int fd, State state, const Options &options)
+    : _loop(loop), _fd(fd), _options(options), _state(state) {
+    _options.window = std::max<std::size_t>(_options.window, 1);
+}
+
+TcpSession::~TcpSession() {
+    if (_state.load() != State::Closed)
+        fail(MB::utils::ConnectionClosed);
+}
+
+void TcpSession::start() {
+    if (_state.load() == State::Connecting) {
+        _loop.add(_fd, EPOLLOUT, this);
+        arm(EventLoop::Clock::now() + _options.connectTimeout);
+    } else {
+        _loop.add(_fd, EPOLLIN, this);
+        pump();
+    }
+}
+
+void TcpSession::arm(EventLoop::Clock::time_point deadline) {
+    _loop.cancel(_timer);
+    _timer = _loop.schedule(deadline, [this] {
+        _timer = {};
+        onTimer();
+    });
+}
+
+void TcpSession::onTimer() {
+    if (_state.load() == State::Connecting) {
+        fail(MB::utils::Timeout);
+        return;
+    }
+
+    const auto now = EventLoop::Clock::now();
+    while (!_inFlight.empty() && _inFlight.front().deadline <= now) {
+        // Late response of this transaction will be dropped as unknown
+        auto callback = std::move(_inFlight.front().callback);
+        _inFlight.pop_front();
+        callback(MB::utils::Timeout);
+        if (_state.load() == State::Closed)
+            return;
+    }
+
+    pump();
+    if (!_timer && !_inFlight.empty())
+        arm(_inFlight.front().deadline);
+}
+
+void TcpSession::onEvents(uint32_t events) {
+    if (_state.load() == State::Closed)
+        return;
+
+    if (_state.load() == State::Connecting) {
+        onConnected();
+        return;
+    }
+
+    if (events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+        receive();
+    if (_state.load() == State::Connected && (events & EPOLLOUT))
+        flush();
+}
+
+void TcpSession::onConnected() {
+    int error       = 0;
+    socklen_t size  = sizeof(error);
+    const auto done = ::getsockopt(_fd, SOL_SOCKET, SO_ERROR, &error, &size);
+    if (done == -1 || error != 0) {
+        fail(MB::utils::ConnectionClosed);
+        return;
+    }
+
+    _state.store(State::Connected);
+    _loop.cancel(_timer);
+    _timer = {};
+    watch(false);
+    pump();
+}
+
+void TcpSession::watch(bool writable) {
+    _watchWritable = writable;
+    _loop.modify(_fd, writable ? EPOLLIN | EPOLLOUT : EPOLLIN, this);
+}
+
+void TcpSession::submit(const MB::ModbusRequest &request, Callback callback) {
+    if (_loop.inLoopThread()) {
+        enqueue(request, std::move(callback));
+        return;
+    }
+
+    _loop.post([this, request, callback = std::move(callback)]() mutable {
+        enqueue(request, std::move(callback));
+    });
+}
+
+std::future<MB::Result<MB::ModbusResponse>>
+TcpSession::submit(const MB::ModbusRequest &request) {
+    // std::function needs copyable callable, so promise is shared
+    auto promise = std::make_shared<std::promise<MB::Result<MB::ModbusResponse>>>();
+    auto future  = promise->get_future();
+    submit(request, [promise = std::move(promise)](auto result) {
+        promise->set_value(std::move(result));
+    });
+    return future;
+}
+
+void TcpSession::enqueue(const MB::ModbusRequest &request, Callback &&callback) {
+    if (_state.load() == State::Closed) {
+        callback(MB::utils::ConnectionClosed);
+        return;
+    }
+
+    _queue.push_back({request, std::move(callback)});
+    if (_state.load() == State::Connected)
+        pump();
+}
+
+void TcpSession::pump() {
+    if (_txOffset == _txBuffer.size()) {
+        _txBuffer.clear();
+        _txOffset = 0;
+    }
+
+    // Everything that fits the window goes out in single send
+    const auto deadline = EventLoop::Clock::now() + _options.timeout;
+    const auto queued   = _queue.size();
+    while (!_queue.empty() && _inFlight.size() < _options.window) {
+        auto &next               = _queue.front();
+        const auto transactionID = _nextID++;
+        MB::appendTCP(next.request, transactionID, _txBuffer);
+        _inFlight.push_back({transactionID, deadline, std::move(next.callback)});
+        _queue.pop_front();
+    }
+
+    if (queued == _queue.size())
+        return;
+    if (!_timer)
+        arm(_inFlight.front().deadline);
+    flush();
+}
+
+void TcpSession::flush() {
+    while (_txOffset < _txBuffer.size()) {
+        const auto sent = ::send(_fd, _txBuffer.data() + _txOffset,
+                                 _txBuffer.size() - _txOffset, MSG_NOSIGNAL);
+        if (sent >= 0) {
+            _txOffset += static_cast<std::size_t>(sent);
+            continue;
+        }
+        if (errno == EINTR)
+            continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            if (!_watchWritable)
+                watch(true);
+            return;
+        }
+
+        fail(MB::utils::ConnectionClosed);
+        return;
+    }
+
+    if (_watchWritable)
+        watch(false);
+}
+
+void TcpSession::receive() {
+    while (true) {
+        auto *buffer    = _rxFramer.writable();
+        const auto size = ::recv(_fd, buffer, _rxFramer.writableSize(), 0);
+        if (size == 0) {
+            fail(MB::utils::ConnectionClosed);
+            return;
+        }
+        if (size < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                fail(MB::utils::ConnectionClosed);
+            return;
+        }
+
+        _rxFramer.commit(static_cast<std::size_t>(size));
+        while (auto frame = _rxFramer.next()) {
+            complete(*frame);
+            if (_state.load() == State::Closed)
+                return;
+        }
+        if (_rxFramer.invalid()) {
+            fail(MB::utils::InvalidByteOrder);
+            return;
+        }
+    }
+}
+
+void TcpSession::complete(const MB::MbapFrame &frame) {
+    const auto it = std::find_if(_inFlight.begin(), _inFlight.end(), [&](const auto &t) {
+        return t.transactionID == frame.header.transactionID;
+    });
+    if (it == _inFlight.end())
+        return;
+
+    auto callback = std::move(it->callback);
+    _inFlight.erase(it);
+
+    // Freed slot is refilled before the callback, which may submit more
+    pump();
+    callback(MB::parseResponse(frame.pdu(), frame.pduSize()));
+}
+
+void TcpSession::fail(MB::utils::MBErrorCode error) {
+    _state.store(State::Closed);
+    _loop.cancel(_timer);
+    _timer = {};
+    if (_fd != -1) {
+        _loop.remove(_fd);
+        ::close(_fd);
+        _fd = -1;
+    }
+
+    auto inFlight = std::move(_inFlight);
+    auto queue    = std::move(_queue);
+    _inFlight.clear();
+    _queue.clear();
+    for (auto &transaction : inFlight)
+        transaction.callback(error);
+    for (auto &queued : queue)
+        queued.callback(error);
+}
+
+TcpClient::TcpClient(std::size_t threads) {
+    for (std::size_t i = 0; i < std::max<std::size_t>(threads, 1); i++)
+        _loops.push_back(std::make_unique<EventLoop>());
+
+    for (std::size_t i = 0; i < threads; i++)
+        _threads.emplace_back([loop = _loops[i].get()] { loop->run(); });
+}
+
+TcpClient::~TcpClient() {
+    for (auto &loop : _loops)
+        loop->stop();
+    for (auto &thread : _threads)
+        thread.join();
+
+    // Loops are stopped, requests posted meanwhile are queued and then fail
+    // together with the others, callbacks run on this thread
+    for (auto &loop : _loops)
+        loop->runOnce(0);
+    _sessions.clear();
+}
+
+TcpSession &TcpClient::add(int fd, TcpSession::State state,
+                           const TcpSession::Options &options) {
+    TcpSession *session;
+    {
+        std::lock_guard lock(_sessionsMutex);
+        auto &loop = *_loops[_nextLoop++ % _loops.size()];
+        _sessions.push_back(
+            std::unique_ptr<TcpSession>(new TcpSession(loop, fd, state, options)));
+        session = _sessions.back().get();
+    }
+
+    session->loop().dispatch([session] { session->start(); });
+    return *session;
+}
+
+TcpSession &TcpClient::connect(const std::string &address, int port,
+                               const TcpSession::Options &options) {
+    const auto sock = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (sock == -1)
+        MB_THROW(
+            std::runtime_error("Cannot open socket, errno = " + std::to_string(errno)));
+
+    sockaddr_in server = {.sin_family = AF_INET,
+                          .sin_port   = htons(port),
+                          .sin_addr   = {inet_addr(address.c_str())},
+                          .sin_zero   = {}};
+
+    const auto connected =
+        ::connect(sock, reinterpret_cast<struct sockaddr *>(&server), sizeof(server));
+    if (connected == -1 && errno != EINPROGRESS) {
+        const auto error = errno;
+        ::close(sock);
+        MB_THROW(std::runtime_error("Cannot connect, errno = " + std::to_string(error)));
+    }
+
+    // Connect on loopback may complete immediately, readiness is checked the
+    // same way in both cases
+    return add(sock, TcpSession::State::Connecting, options);
+}
+
+TcpSession &TcpClient::adopt(int sockfd, const TcpSession::Options &options) {
+    ::fcntl(sockfd, F_SETFL, ::fcntl(sockfd, F_GETFL) | O_NONBLOCK);
+    return add(sockfd, TcpSession::State::Connected, options);
+}
+
+void TcpClient::close(TcpSession &session) {
+    session.loop().dispatch([this, &session] {
+        session.fail(MB::utils::ConnectionClosed);
+
+        // Destroyed after events of the current batch were handled
+        session.loop().post([this, &session] {
+            std::lock_guard lock(_sessionsMutex);
+            const auto it =
+                std::find_if(_sessions.begin(), _sessions.end(),
+                             [&](const auto &owned) { return owned.get() == &session; });
+            if (it == _sessions.end())
+                return;
+            std::swap(*it, _sessions.back());
+            _sessions.pop_back();
+        });
+    });
+}
+
+std::size_t TcpClient::sessions() {
+    std::lock_guard lock(_sessionsMutex);
+    return _sessions.size();
+}
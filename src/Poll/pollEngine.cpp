@@ -0,0 +1,384 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "Poll/pollEngine.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <stdexcept>
+
+#include "MB/modbusBufferPool.hpp"
+#include "MB/modbusConvert.hpp"
+#include "MB/modbusFraming.hpp"
+#include "MB/modbusRtuFramer.hpp"
+
+using namespace MB::Poll;
+
+namespace {
+//! State kept between transactions of serial connection
+struct SerialState {
+    MB::FrameBufferPool buffers{MB::FrameBufferPool::DefaultBufferSize, 1};
+    //! Late response of failed transaction may still arrive
+    bool failed = false;
+};
+
+template <typename T> double decodeAs(const uint8_t *wire, MB::utils::WordOrder order) {
+    T value;
+    MB::utils::decodeRegisters(wire, 1, &value, order);
+    return static_cast<double>(value);
+}
+
+//! Decodes value of the point starting at `offset` of response payload
+MB::Result<double> decode(const Point &point, const MB::ModbusResponse &response,
+                          std::size_t offset) noexcept {
+    const auto size = pointSize(point.type);
+
+    if (point.type == Bit) {
+        if (response.coils().size() < offset + size)
+            return MB::utils::ProtocolError;
+        return response.coils().test(offset) ? 1.0 : 0.0;
+    }
+
+    const auto &registers = response.registers();
+    if (registers.size() < offset + size)
+        return MB::utils::ProtocolError;
+
+    // Registers back to wire bytes, so word order applies as to received frame
+    std::array<uint8_t, 8> wire;
+    for (std::size_t i = 0; i < size; i++) {
+        wire[2 * i]     = static_cast<uint8_t>(registers[offset + i] >> 8);
+        wire[2 * i + 1] = static_cast<uint8_t>(registers[offset + i]);
+    }
+
+    switch (point.type) {
+    case S16:
+        return decodeAs<int16_t>(wire.data(), point.order);
+    case U32:
+        return decodeAs<uint32_t>(wire.data(), point.order);
+    case S32:
+        return decodeAs<int32_t>(wire.data(), point.order);
+    case F32:
+        return decodeAs<float>(wire.data(), point.order);
+    case F64:
+        return decodeAs<double>(wire.data(), point.order);
+    default:
+        return decodeAs<uint16_t>(wire.data(), point.order);
+    }
+}
+} // namespace
+
+uint16_t MB::Poll::pointSize(PointType type) noexcept {
+    switch (type) {
+    case U32:
+    case S32:
+    case F32:
+        return 2;
+    case F64:
+        return 4;
+    default:
+        return 1;
+    }
+}
+
+PollEngine::~PollEngine() { stop(); }
+
+PollEngine::ConnectionId PollEngine::addConnection(TCP::Connection &connection) {
+    return addConnection([&connection](const ModbusRequest &request) {
+        connection.setMessageId(connection.getMessageId() + 1);
+        connection.sendRequest(request);
+
+        auto response = connection.tryAwaitResponse();
+        // Late responses of timed out transactions carry older IDs
+        while (!response && response.error() == utils::InvalidMessageID)
+            response = connection.tryAwaitResponse();
+        return response;
+    });
+}
+
+PollEngine::ConnectionId PollEngine::addConnection(Serial::Connection &connection) {
+    auto state = std::make_shared<SerialState>();
+    return addConnection([&connection, state](const ModbusRequest &request) {
+        if (state->failed)
+            connection.clearInput();
+
+        std::array<uint8_t, RtuFramer::MaxFrameSize> frame;
+        const auto size = encodeRTU(request, frame.data(), frame.size());
+        connection.sendFrame(frame.data(), size);
+
+        auto raw      = state->buffers.acquire();
+        auto response = connection.tryAwaitResponse(raw);
+        state->failed = !response;
+        return response;
+    });
+}
+
+PollEngine::ConnectionId PollEngine::addConnection(Transact transact) {
+    auto channel      = std::make_unique<Channel>();
+    channel->transact = std::move(transact);
+
+    std::lock_guard lock(_mutex);
+    _channels.push_back(std::move(channel));
+    return _channels.size() - 1;
+}
+
+PollEngine::GroupId PollEngine::addGroup(ConnectionId connection, Clock::duration period,
+                                         std::vector<Point> points,
+                                         const ReadPlanner &planner) {
+    if (period <= Clock::duration::zero())
+        MB_THROW(std::invalid_argument("Period of poll group must be positive"));
+    if (points.empty())
+        MB_THROW(std::invalid_argument("Poll group has no points"));
+    for (const auto &point : points)
+        if (!MB::utils::isReadFunction(point.functionCode) ||
+            MB::utils::isCoilFunction(point.functionCode) != (point.type == Bit))
+            MB_THROW(std::invalid_argument("Point " + point.name +
+                                           " does not use reading function code" +
+                                           " matching its type"));
+
+    std::lock_guard lock(_mutex);
+    if (connection >= _channels.size())
+        MB_THROW(std::invalid_argument("Poll connection does not exist"));
+
+    std::vector<ReadPoint> ranges;
+    ranges.reserve(points.size());
+    for (const auto &point : points)
+        ranges.push_back(
+            {point.unit, point.functionCode, point.address, pointSize(point.type)});
+
+    auto group          = std::make_unique<Group>();
+    group->period       = period;
+    group->connection   = connection;
+    group->plan         = planner.plan(ranges);
+    group->firstPoint   = _points.size();
+    group->stats.period = period;
+
+    std::move(points.begin(), points.end(), std::back_inserter(_points));
+    _snapshot.samples.resize(_points.size());
+
+    // Stale cycle and current one, so releases do not allocate
+    auto &channel = *_channels[connection];
+    channel.ready.reserve(channel.ready.capacity() + 2 * group->plan.reads().size());
+    channel.groups.push_back(_groups.size());
+    _groups.push_back(std::move(group));
+
+    _wake.notify_all();
+    return _groups.size() - 1;
+}
+
+std::optional<PollEngine::PointId> PollEngine::find(std::string_view name) const {
+    std::lock_guard lock(_mutex);
+    const auto it = std::find_if(_points.begin(), _points.end(),
+                                 [&](const Point &point) { return point.name == name; });
+    if (it == _points.end())
+        return std::nullopt;
+    return static_cast<PointId>(it - _points.begin());
+}
+
+Clock::time_point PollEngine::releaseDue(Channel &channel, Clock::time_point now) {
+    auto next = Clock::time_point::max();
+
+    for (const auto id : channel.groups) {
+        auto &group = *_groups[id];
+        auto due    = group.cycle == 0 ? now : group.release + group.period;
+
+        if (due <= now) {
+            if (group.cycle > 0) {
+                if (group.pending > 0)
+                    group.stats.deadlineMisses++;
+                // Releases the engine was too late for are skipped
+                const auto skipped = (now - due) / group.period;
+                group.stats.deadlineMisses += static_cast<uint64_t>(skipped);
+                due += skipped * group.period;
+            }
+
+            group.release = due;
+            group.cycle++;
+            group.pending = group.plan.reads().size();
+            group.started = false;
+            for (std::size_t i = 0; i < group.pending; i++) {
+                channel.ready.push_back({due + group.period, group.cycle, id, i});
+                std::push_heap(channel.ready.begin(), channel.ready.end());
+            }
+        }
+
+        next = std::min(next, group.release + group.period);
+    }
+    return next;
+}
+
+const PollEngine::Job *PollEngine::top(Channel &channel) {
+    // Transactions of overrun cycles are dropped
+    while (!channel.ready.empty() &&
+           channel.ready.front().cycle != _groups[channel.ready.front().group]->cycle) {
+        std::pop_heap(channel.ready.begin(), channel.ready.end());
+        channel.ready.pop_back();
+    }
+    return channel.ready.empty() ? nullptr : &channel.ready.front();
+}
+
+PollEngine::Job PollEngine::pop(Channel &channel) {
+    std::pop_heap(channel.ready.begin(), channel.ready.end());
+    const auto job = channel.ready.back();
+    channel.ready.pop_back();
+    return job;
+}
+
+void PollEngine::execute(std::unique_lock<std::mutex> &lock, Channel &channel,
+                         const Job &job) {
+    auto &group        = *_groups[job.group];
+    const auto &read   = group.plan.reads()[job.read];
+    const auto request = read.request;
+
+    const auto start = Clock::now();
+    if (!group.started) {
+        const auto jitter     = start - group.release;
+        group.started         = true;
+        group.stats.maxJitter = std::max(group.stats.maxJitter, jitter);
+        group.jitterSum += jitter;
+        group.jitterSamples++;
+    }
+
+    lock.unlock();
+    const auto response = channel.transact(request);
+    const auto now      = Clock::now();
+    lock.lock();
+
+    group.stats.transactions++;
+    if (!response)
+        group.stats.errors++;
+    for (auto i = read.firstMember; i < read.lastMember; i++) {
+        const auto &member = group.plan.members()[i];
+        publish(group.firstPoint + member.point, response, member.offset, now);
+    }
+
+    // Cycle may have been released again meanwhile, the miss is already counted
+    if (job.cycle != group.cycle || --group.pending > 0)
+        return;
+
+    group.stats.cycles++;
+    group.stats.lastCycleTime = now - group.release;
+    group.stats.maxCycleTime  = std::max(group.stats.maxCycleTime, now - group.release);
+    if (now > job.deadline)
+        group.stats.deadlineMisses++;
+}
+
+void PollEngine::publish(PointId point, const Result<ModbusResponse> &response,
+                         uint16_t offset, Clock::time_point now) {
+    auto &sample = _snapshot.samples[point];
+    _snapshot.version++;
+
+    if (!response) {
+        sample.error = response.error();
+        return;
+    }
+
+    const auto value = decode(_points[point], response.value(), offset);
+    if (!value) {
+        sample.error = value.error();
+        return;
+    }
+
+    sample.value = value.value();
+    sample.time  = now;
+    sample.error.reset();
+    sample.updates++;
+}
+
+bool PollEngine::step(Clock::time_point &next) {
+    std::unique_lock lock(_mutex);
+    const auto now = Clock::now();
+
+    next              = Clock::time_point::max();
+    Channel *earliest = nullptr;
+    for (auto &channel : _channels) {
+        next            = std::min(next, releaseDue(*channel, now));
+        const auto *job = top(*channel);
+        if (job && (!earliest || job->deadline < earliest->ready.front().deadline))
+            earliest = channel.get();
+    }
+
+    if (!earliest)
+        return false;
+    execute(lock, *earliest, pop(*earliest));
+    return true;
+}
+
+bool PollEngine::runOnce() {
+    Clock::time_point next;
+    return step(next);
+}
+
+void PollEngine::runUntil(Clock::time_point end) {
+    Clock::time_point next;
+    while (Clock::now() < end)
+        if (!step(next))
+            std::this_thread::sleep_until(std::min(next, end));
+}
+
+void PollEngine::work(Channel &channel) {
+    std::unique_lock lock(_mutex);
+    while (_running) {
+        const auto next = releaseDue(channel, Clock::now());
+        if (top(channel)) {
+            execute(lock, channel, pop(channel));
+            continue;
+        }
+
+        if (next == Clock::time_point::max())
+            _wake.wait(lock);
+        else
+            _wake.wait_until(lock, next);
+    }
+}
+
+void PollEngine::start() {
+    std::lock_guard lock(_mutex);
+    if (_running)
+        return;
+
+    _running = true;
+    for (auto &channel : _channels)
+        channel->worker = std::thread([this, target = channel.get()] { work(*target); });
+}
+
+void PollEngine::stop() {
+    {
+        std::lock_guard lock(_mutex);
+        _running = false;
+    }
+    _wake.notify_all();
+
+    for (auto &channel : _channels)
+        if (channel->worker.joinable())
+            channel->worker.join();
+}
+
+void PollEngine::snapshot(Snapshot &snapshot) const {
+    std::lock_guard lock(_mutex);
+    snapshot.samples.assign(_snapshot.samples.begin(), _snapshot.samples.end());
+    snapshot.version = _snapshot.version;
+}
+
+Snapshot PollEngine::snapshot() const {
+    Snapshot copy;
+    snapshot(copy);
+    return copy;
+}
+
+Sample PollEngine::sample(PointId point) const {
+    std::lock_guard lock(_mutex);
+    return _snapshot.samples.at(point);
+}
+
+GroupStats PollEngine::stats(GroupId group) const {
+    std::lock_guard lock(_mutex);
+    const auto &target = *_groups.at(group);
+
+    auto stats = target.stats;
+    if (target.jitterSamples > 0)
+        stats.meanJitter =
+            target.jitterSum / static_cast<Clock::rep>(target.jitterSamples);
+    return stats;
+}
@@ -18,12 +18,12 @@ void Connection::open(const std::string& path) {
 	_fd = ::open(path.c_str(), O_RDWR | O_SYNC | O_NONBLOCK);
 
 	if (_fd < 0) {
-		throw std::runtime_error("Cannot open serial port " + path);
+		MB_THROW(std::runtime_error("Cannot open serial port " + path));
 	}
 
 	if (tcgetattr(_fd, &_termios) != 0) {
-		throw std::runtime_error("Error at tcgetattr - " +
-			std::to_string(errno));
+		MB_THROW(std::runtime_error("Error at tcgetattr - " +
+			std::to_string(errno)));
 	}
 
 	cfmakeraw(&_termios);
@@ -35,8 +35,8 @@ void Connection::open(const std::string& path) {
 void Connection::connect() {
 	tcflush(_fd, TCIFLUSH);
 	if (tcsetattr(_fd, TCSAFLUSH, &_termios) != 0) {
-		throw std::runtime_error("Error {" + std::to_string(_fd) +
-			"} at tcsetattr - " + std::to_string(errno));
+		MB_THROW(std::runtime_error("Error {" + std::to_string(_fd) +
+			"} at tcsetattr - " + std::to_string(errno)));
 	}
 }
 
@@ -71,7 +71,10 @@ std::vector<uint8_t> Connection::sendRequest(const MB::ModbusParam& param, bool
 }
 
 std::vector<uint8_t> Connection::sendRequest(const MB::ModbusRequest& request, const int expectedResponseLength, const int requestLength) {
-	auto sent = send(request.toRaw());
+	_txBuffer.clear();
+	MB::appendRTU(request, _txBuffer);
+	writeFrame();
+
 	if (expectedResponseLength != 0) {
 		auto resp = readRawMessage(expectedResponseLength);
 		if (expectedResponseLength > 0)
@@ -80,45 +83,60 @@ std::vector<uint8_t> Connection::sendRequest(const MB::ModbusRequest& request, c
 		}
 		return resp;
 	}
-	return sent;
+	return _txBuffer;
 }
 
-std::vector<uint8_t> Connection::sendResponse(const MB::ModbusResponse& response) {
-	return send(response.toRaw());
+const std::vector<uint8_t>& Connection::sendResponse(const MB::ModbusResponse& response) {
+	_txBuffer.clear();
+	MB::appendRTU(response, _txBuffer);
+	writeFrame();
+	return _txBuffer;
 }
 
-std::vector<uint8_t> Connection::sendException(const MB::ModbusException& exception) {
-	return send(exception.toRaw());
+const std::vector<uint8_t>& Connection::sendException(const MB::ModbusException& exception) {
+	_txBuffer.clear();
+	MB::appendRTU(exception, _txBuffer);
+	writeFrame();
+	return _txBuffer;
 }
 
-std::vector<uint8_t> Connection::awaitRawMessage() {
-	std::vector<uint8_t> data(1024);
-
+MB::Status Connection::readAvailable(std::vector<uint8_t>& buffer) noexcept {
 	pollfd waitingFD = { .fd = _fd, .events = POLLIN, .revents = POLLIN };
 
 	if (::poll(&waitingFD, 1, _timeout) <= 0) {
-		throw MB::ModbusException(MB::utils::Timeout);
+		return MB::utils::Timeout;
 	}
 
-	auto size = ::read(_fd, data.begin().base(), 1024);
+	// Read on stack, so the result is allocated once with its final size
+	std::array<uint8_t, RawChunkSize> chunk;
+	const auto size = ::read(_fd, chunk.data(), chunk.size());
 
 	if (size < 0) {
-		throw MB::ModbusException(MB::utils::SlaveDeviceFailure);
+		return MB::utils::SlaveDeviceFailure;
 	}
 
-	data.resize(size);
-	data.shrink_to_fit();
+	buffer.insert(buffer.end(), chunk.data(), chunk.data() + size);
+	return {};
+}
+
+std::vector<uint8_t> Connection::awaitRawMessage() {
+	std::vector<uint8_t> data;
+
+	const auto status = readAvailable(data);
+	if (!status)
+		MB_THROW(MB::ModbusException(status.error()));
 
 	return data;
 }
 
 std::vector<uint8_t> Connection::readRawMessage(const int expectedResponseLength) {
+	// Read on stack, so the result is allocated once with its final size
+	std::array<uint8_t, RawChunkSize> chunk;
 
 	if (expectedResponseLength == 0) {
 		// read whatever data is available
 
-		std::vector<uint8_t> data(1024);
-		auto size = ::read(_fd, data.begin().base(), 1024);
+		auto size = ::read(_fd, chunk.data(), chunk.size());
 
 		if (size < 0) {
 			if (errno == EBADF) {
@@ -126,31 +144,26 @@ std::vector<uint8_t> Connection::readRawMessage(const int expectedResponseLength
 			}
 			else if (errno != EAGAIN) {
 				std::cout << "errno: " << errno << " | fd = " << _fd << "\n";
-				throw MB::ModbusException(MB::utils::SlaveDeviceFailure);
+				MB_THROW(MB::ModbusException(MB::utils::SlaveDeviceFailure));
 			}
-			data.clear();
-			return data;
+			return std::vector<uint8_t>();
 		}
 
-		data.resize(size);
-		data.shrink_to_fit();
 		_lastSendTime = std::chrono::high_resolution_clock::now();
-		return data;
+		return std::vector<uint8_t>(chunk.data(), chunk.data() + size);
 	}
 	else if (expectedResponseLength > 0) {
 		// read exactly expectedResponseLength bytes
 
 		int numReadBytes = 0;
-		std::vector<uint8_t> data(1024);
 		while (numReadBytes < expectedResponseLength) {
-			auto size = ::read(_fd, data.begin().base() + numReadBytes, 1024 - numReadBytes);
+			auto size = ::read(_fd, chunk.data() + numReadBytes, chunk.size() - numReadBytes);
 			if (size > 0) {
 				numReadBytes += size;
 				//std::cout << " ( got " << numReadBytes << " of " << expectedResponseLength << ") ";
 				if (numReadBytes >= expectedResponseLength) {
-					std::vector<uint8_t> resp(data.begin(), data.begin() + expectedResponseLength);
 					_lastSendTime = std::chrono::high_resolution_clock::now();
-					return resp;
+					return std::vector<uint8_t>(chunk.data(), chunk.data() + expectedResponseLength);
 				}
 			}
 			std::this_thread::sleep_for(std::chrono::milliseconds(10));
@@ -159,73 +172,145 @@ std::vector<uint8_t> Connection::readRawMessage(const int expectedResponseLength
 	else {
 		// negative value => wait for however many bytes there are within a given timeout
 		std::this_thread::sleep_for(std::chrono::milliseconds(-expectedResponseLength));
-		std::vector<uint8_t> data(1024);
-		auto size = ::read(_fd, data.begin().base(), 1024);
-		data.resize(size);
-		data.shrink_to_fit();
+		auto size = ::read(_fd, chunk.data(), chunk.size());
 		_lastSendTime = std::chrono::high_resolution_clock::now();
-		return data;
+		return std::vector<uint8_t>(chunk.data(), chunk.data() + std::max<ssize_t>(size, 0));
 	}
 
 	return std::vector<uint8_t>();//unreachable
 }
 
-// TODO: Figure out how to return raw data when exception is being thrown
-std::tuple<MB::ModbusResponse, std::vector<uint8_t>> Connection::awaitResponse() {
-	std::vector<uint8_t> data;
-	data.reserve(8);
-
-	MB::ModbusResponse response(0, MB::utils::ReadAnalogInputRegisters);
+MB::Result<std::size_t> Connection::awaitFrame(MB::RtuFramer& framer) noexcept {
+	std::size_t frameSize = 0;
+	auto onFrame = [&](const uint8_t* frame, std::size_t size) {
+		std::copy(frame, frame + size, _frame.begin());
+		frameSize = size;
+		if (_trace)
+			_trace->record(MB::TraceDirection::Rx, frame, size);
+		return false; // Stop at first frame, following bytes wait for the next await
+	};
 
 	while (true) {
-		try {
-			auto tmpResponse = awaitRawMessage();
-			data.insert(data.end(), tmpResponse.begin(), tmpResponse.end());
-
-			if (MB::ModbusException::exist(data)) throw MB::ModbusException(data);
-
-			response = MB::ModbusResponse::fromRawCRC(data);
-			break;
+		// Each received byte is fed to the framer exactly once
+		_rxBegin += framer.feed(_rxChunk.data() + _rxBegin, _rxEnd - _rxBegin, onFrame);
+		if (frameSize != 0)
+			return frameSize;
+
+		pollfd waitingFD = { .fd = _fd, .events = POLLIN, .revents = POLLIN };
+		if (::poll(&waitingFD, 1, _timeout) <= 0) {
+			// Silence ends the frame, partial one must not swallow the next frame
+			framer.clear();
+			_rxBegin = _rxEnd = 0;
+			return MB::utils::Timeout;
 		}
-		catch (const MB::ModbusException& ex) {
-			if (MB::utils::isStandardErrorCode(ex.getErrorCode()) || ex.getErrorCode() == MB::utils::Timeout || ex.getErrorCode() == MB::utils::SlaveDeviceFailure) throw ex;
-			continue;
+
+		const auto size = ::read(_fd, _rxChunk.data(), _rxChunk.size());
+		if (size < 0) {
+			return MB::utils::SlaveDeviceFailure;
 		}
+
+		_rxBegin = 0;
+		_rxEnd = static_cast<std::size_t>(size);
 	}
+}
 
-	return std::tie(response, data);
+void Connection::clearInput() {
+	tcflush(_fd, TCIFLUSH);
+	_rxBegin = _rxEnd = 0;
+	_requestFramer.clear();
+	_responseFramer.clear();
 }
 
-std::tuple<MB::ModbusRequest, std::vector<uint8_t>> Connection::awaitRequest() {
-	std::vector<uint8_t> data;
-	data.reserve(8);
+MB::Result<MB::ModbusResponse> Connection::receiveResponse(std::size_t& frameSize) noexcept {
+	const auto size = awaitFrame(_responseFramer);
+	if (!size)
+		return size.error();
 
-	MB::ModbusRequest request(0, MB::utils::ReadAnalogInputRegisters);
+	frameSize = size.value();
+	if (MB::ModbusException::exist(_frame.data(), frameSize))
+		return MB::ModbusException(_frame.data(), frameSize, true).getErrorCode();
 
-	while (true) {
-		try {
-			auto tmpResponse = awaitRawMessage();
-			data.insert(data.end(), tmpResponse.begin(), tmpResponse.end());
+	// CRC was already checked by the framer
+	return MB::ModbusResponse::tryFromRaw(_frame.data(), frameSize - 2);
+}
 
-			request = MB::ModbusRequest::fromRawCRC(data);
-			break;
-		}
-		catch (const MB::ModbusException& ex) {
-			if (ex.getErrorCode() == MB::utils::Timeout || ex.getErrorCode() == MB::utils::SlaveDeviceFailure) throw ex;
-			continue;
-		}
+MB::Result<MB::ModbusRequest> Connection::receiveRequest(std::size_t& frameSize) noexcept {
+	const auto size = awaitFrame(_requestFramer);
+	if (!size)
+		return size.error();
+
+	// CRC was already checked by the framer
+	frameSize = size.value();
+	return MB::ModbusRequest::tryFromRaw(_frame.data(), frameSize - 2);
+}
+
+MB::Result<std::tuple<MB::ModbusResponse, std::vector<uint8_t>>> Connection::tryAwaitResponse() noexcept {
+	std::size_t frameSize = 0;
+	auto response = receiveResponse(frameSize);
+	if (!response)
+		return response.error();
+
+	return std::make_tuple(std::move(response).value(), std::vector<uint8_t>(_frame.data(), _frame.data() + frameSize));
+}
+
+MB::Result<std::tuple<MB::ModbusRequest, std::vector<uint8_t>>> Connection::tryAwaitRequest() noexcept {
+	std::size_t frameSize = 0;
+	auto request = receiveRequest(frameSize);
+	if (!request)
+		return request.error();
+
+	return std::make_tuple(std::move(request).value(), std::vector<uint8_t>(_frame.data(), _frame.data() + frameSize));
+}
+
+MB::Result<MB::ModbusResponse> Connection::tryAwaitResponse(MB::FrameBuffer& raw) noexcept {
+	std::size_t frameSize = 0;
+	auto response = receiveResponse(frameSize);
+	if (response)
+		raw.assign(_frame.data(), frameSize);
+	return response;
+}
+
+MB::Result<MB::ModbusRequest> Connection::tryAwaitRequest(MB::FrameBuffer& raw) noexcept {
+	std::size_t frameSize = 0;
+	auto request = receiveRequest(frameSize);
+	if (request)
+		raw.assign(_frame.data(), frameSize);
+	return request;
+}
+
+std::tuple<MB::ModbusResponse, std::vector<uint8_t>> Connection::awaitResponse() {
+	auto response = tryAwaitResponse();
+	if (!response) {
+		// Keep slave id and function code of exceptions reported by the device
+		if (MB::utils::isStandardErrorCode(response.error()))
+			MB_THROW(MB::ModbusException(_frame.data(), 5, true));
+
+		MB_THROW(MB::ModbusException(response.error()));
 	}
 
-	return std::tie(request, data);
+	return std::move(response).value();
+}
+
+std::tuple<MB::ModbusRequest, std::vector<uint8_t>> Connection::awaitRequest() {
+	auto request = tryAwaitRequest();
+	if (!request)
+		MB_THROW(MB::ModbusException(request.error()));
+
+	return std::move(request).value();
 }
 
-std::vector<uint8_t> Connection::send(std::vector<uint8_t> data) {
-	data.reserve(data.size() + 2);
-	const auto crc = utils::calculateCRC(data.begin().base(), data.size());
+const std::vector<uint8_t>& Connection::send(const std::vector<uint8_t>& data) {
+	_txBuffer.assign(data.begin(), data.end());
+	const auto crc = utils::crc16(_txBuffer.data(), _txBuffer.size());
+
+	_txBuffer.push_back(static_cast<uint8_t>(crc & 0xFF));
+	_txBuffer.push_back(static_cast<uint8_t>(crc >> 8));
 
-	data.push_back(reinterpret_cast<const uint8_t*>(&crc)[0]);
-	data.push_back(reinterpret_cast<const uint8_t*>(&crc)[1]);
+	writeFrame();
+	return _txBuffer;
+}
 
+void Connection::writeFrame(const uint8_t* frame, std::size_t size) {
 	auto nextSendTime = _lastSendTime + std::chrono::milliseconds(MinPauseBetweenSendingMS);
 	std::this_thread::sleep_until(nextSendTime);
 
@@ -234,24 +319,43 @@ std::vector<uint8_t> Connection::send(std::vector<uint8_t> data) {
 	// most cases)
 	tcflush(_fd, TCOFLUSH);
 	// Write
-	std::ignore = write(_fd, data.begin().base(), data.size());
+	std::ignore = write(_fd, frame, size);
+
+	if (_trace)
+		_trace->record(MB::TraceDirection::Tx, frame, size);
 	// It may be a good idea to use tcdrain, although it has tendency to not
 	// work as expected tcdrain(_fd);
-	
-	return data;
 }
 
-Connection::Connection(Connection&& moved) noexcept {
-	_fd = moved._fd;
-	_termios = moved._termios;
+Connection::Connection(Connection&& moved) noexcept
+	: _termios(moved._termios), _fd(moved._fd), _lastSendTime(moved._lastSendTime),
+	  _timeout(moved._timeout), _txBuffer(std::move(moved._txBuffer)),
+	  _requestFramer(moved._requestFramer), _responseFramer(moved._responseFramer),
+	  _rxChunk(moved._rxChunk), _rxBegin(moved._rxBegin), _rxEnd(moved._rxEnd),
+	  _frame(moved._frame), _trace(moved._trace) {
 	moved._fd = -1;
+	moved._rxBegin = moved._rxEnd = 0;
 }
 
 Connection& Connection::operator=(Connection&& moved) {
 	if (this == &moved) return *this;
 
+	close();
+
+	// Buffered bytes and half parsed frames go with the descriptor
 	_fd = moved._fd;
 	memcpy(&_termios, &(moved._termios), sizeof(moved._termios));
+	_lastSendTime = moved._lastSendTime;
+	_timeout = moved._timeout;
+	_txBuffer = std::move(moved._txBuffer);
+	_requestFramer = moved._requestFramer;
+	_responseFramer = moved._responseFramer;
+	_rxChunk = moved._rxChunk;
+	_rxBegin = moved._rxBegin;
+	_rxEnd = moved._rxEnd;
+	_frame = moved._frame;
+	_trace = moved._trace;
 	moved._fd = -1;
+	moved._rxBegin = moved._rxEnd = 0;
 	return *this;
 }
@@ -4,6 +4,8 @@
 
 #include "TCP/connection.hpp"
 
+#include <netinet/tcp.h>
+
 using namespace MB::TCP;
 
 Connection::Connection(const int sockfd) noexcept {
@@ -19,151 +21,172 @@ Connection::~Connection() {
     _sockfd = -1;
 }
 
-std::vector<uint8_t> Connection::sendRequest(const MB::ModbusRequest &req) {
-    std::vector<uint8_t> rawReq;
-    rawReq.reserve(6);
-
-    rawReq.push_back(reinterpret_cast<const uint8_t *>(&_messageID)[1]);
-    rawReq.push_back(reinterpret_cast<const uint8_t *>(&_messageID)[0]);
-    rawReq.push_back(0x00);
-    rawReq.push_back(0x00);
-
-    std::vector<uint8_t> dat = req.toRaw();
-
-    uint32_t size = dat.size();
-    rawReq.push_back(reinterpret_cast<uint16_t *>(&size)[1]);
-    rawReq.push_back(reinterpret_cast<uint16_t *>(&size)[0]);
-
-    rawReq.insert(rawReq.end(), dat.begin(), dat.end());
-
-    ::send(_sockfd, rawReq.begin().base(), rawReq.size(), 0);
-
-    return rawReq;
+void Connection::write() noexcept {
+    std::size_t offset = 0;
+    while (offset < _txBuffer.size()) {
+        // Lost peer is reported by the following receive, not by SIGPIPE
+        const auto sent = ::send(_sockfd, _txBuffer.data() + offset,
+                                 _txBuffer.size() - offset, MSG_NOSIGNAL);
+        if (sent > 0)
+            offset += static_cast<std::size_t>(sent);
+        else if (sent == 0 || errno != EINTR)
+            return;
+    }
 }
 
-std::vector<uint8_t> Connection::sendResponse(const MB::ModbusResponse &res) {
-    std::vector<uint8_t> rawReq;
-    rawReq.reserve(6);
-
-    rawReq.push_back(reinterpret_cast<const uint8_t *>(&_messageID)[1]);
-    rawReq.push_back(reinterpret_cast<const uint8_t *>(&_messageID)[0]);
-    rawReq.push_back(0x00);
-    rawReq.push_back(0x00);
-
-    std::vector<uint8_t> dat = res.toRaw();
+template <typename Message>
+const std::vector<uint8_t> &Connection::sendMessage(const Message &message) {
+    _txBuffer.clear();
+    MB::appendTCP(message, _messageID, _txBuffer);
+    write();
 
-    uint32_t size = dat.size();
-    rawReq.push_back(reinterpret_cast<uint16_t *>(&size)[1]);
-    rawReq.push_back(reinterpret_cast<uint16_t *>(&size)[0]);
+    if (_trace)
+        _trace->record(MB::TraceDirection::Tx, _txBuffer.data() + MB::MbapHeader::Size,
+                       _txBuffer.size() - MB::MbapHeader::Size);
 
-    rawReq.insert(rawReq.end(), dat.begin(), dat.end());
-
-    ::send(_sockfd, rawReq.begin().base(), rawReq.size(), 0);
-
-    return rawReq;
+    return _txBuffer;
 }
 
-std::vector<uint8_t> Connection::sendException(const MB::ModbusException &ex) {
-    std::vector<uint8_t> rawReq;
-    rawReq.reserve(6);
-
-    rawReq.push_back(reinterpret_cast<const uint8_t *>(&_messageID)[1]);
-    rawReq.push_back(reinterpret_cast<const uint8_t *>(&_messageID)[0]);
-    rawReq.push_back(0x00);
-    rawReq.push_back(0x00);
-
-    std::vector<uint8_t> dat = ex.toRaw();
+const std::vector<uint8_t> &Connection::sendRequest(const MB::ModbusRequest &req) {
+    return sendMessage(req);
+}
 
-    uint32_t size = dat.size();
-    rawReq.push_back(reinterpret_cast<uint16_t *>(&size)[1]);
-    rawReq.push_back(reinterpret_cast<uint16_t *>(&size)[0]);
+const std::vector<uint8_t> &Connection::sendResponse(const MB::ModbusResponse &res) {
+    return sendMessage(res);
+}
 
-    rawReq.insert(rawReq.end(), dat.begin(), dat.end());
+const std::vector<uint8_t> &Connection::sendException(const MB::ModbusException &ex) {
+    return sendMessage(ex);
+}
 
-    ::send(_sockfd, rawReq.begin().base(), rawReq.size(), 0);
+const std::vector<uint8_t> &Connection::sendRequests(const MB::ModbusRequest *requests,
+                                                     std::size_t count) {
+    _txBuffer.clear();
+    for (std::size_t i = 0; i < count; i++) {
+        if (i > 0)
+            _messageID++;
+        MB::appendTCP(requests[i], _messageID, _txBuffer);
+    }
+    write();
+
+    if (_trace) {
+        // Frames lie back to back, each one starts with its MBAP header
+        for (std::size_t offset = 0; offset < _txBuffer.size();) {
+            const auto *frame = _txBuffer.data() + offset;
+            const auto header = MB::MbapHeader::decode(frame);
+            _trace->record(MB::TraceDirection::Tx, frame + MB::MbapHeader::Size,
+                           header.length);
+            offset += MB::MbapHeader::Size + header.length;
+        }
+    }
 
-    return rawReq;
+    return _txBuffer;
 }
 
 std::vector<uint8_t> Connection::awaitRawMessage() {
-    pollfd _pfd = {.fd = _sockfd, .events = POLLIN, .revents = POLLIN};
-    if (::poll(&_pfd, 1, 60 * 1000 /* 1 minute means the connection has died */) <= 0) {
-        throw MB::ModbusException(MB::utils::ConnectionClosed);
-    }
+    const auto status = receive(60 * 1000 /* 1 minute means the connection has died */,
+                                MB::utils::ConnectionClosed);
+    if (!status)
+        MB_THROW(MB::ModbusException(status.error()));
 
-    std::vector<uint8_t> r(1024);
-
-    auto size = ::recv(_sockfd, r.begin().base(), r.size(), 0);
+    return {_rxFrame.data, _rxFrame.data + _rxFrame.size};
+}
 
-    if (size == -1)
-        throw MB::ModbusException(MB::utils::ProtocolError);
-    else if (size == 0) {
-        throw MB::ModbusException(MB::utils::ConnectionClosed);
+MB::Status Connection::receive(int timeout, MB::utils::MBErrorCode onTimeout) noexcept {
+    while (true) {
+        if (auto frame = _rxFramer.next()) {
+            _rxFrame = *frame;
+            if (_trace)
+                _trace->record(MB::TraceDirection::Rx, _rxFrame.pdu(),
+                               _rxFrame.pduSize());
+            return {};
+        }
+        if (_rxFramer.invalid())
+            return MB::utils::InvalidByteOrder;
+
+        pollfd _pfd = {.fd = _sockfd, .events = POLLIN, .revents = POLLIN};
+        if (::poll(&_pfd, 1, timeout) <= 0)
+            return onTimeout;
+
+        auto *buffer    = _rxFramer.writable();
+        const auto size = ::recv(_sockfd, buffer, _rxFramer.writableSize(), 0);
+
+        if (size == -1)
+            return MB::utils::ProtocolError;
+        else if (size == 0)
+            return MB::utils::ConnectionClosed;
+
+        _rxFramer.commit(static_cast<std::size_t>(size));
+        if (_quickAck) {
+            int enable = 1;
+            ::setsockopt(_sockfd, IPPROTO_TCP, TCP_QUICKACK, &enable, sizeof(enable));
+        }
     }
+}
 
-    r.resize(size); // Set vector to proper shape
-    r.shrink_to_fit();
-
-    return r;
+bool Connection::setSocketOptions(const SocketOptions &options) noexcept {
+    _quickAck = options.quickAck;
+    return options.apply(_sockfd);
 }
 
-MB::ModbusRequest Connection::awaitRequest() {
-    pollfd _pfd = {.fd = _sockfd, .events = POLLIN, .revents = POLLIN};
-    if (::poll(&_pfd, 1, 60 * 1000 /* 1 minute means the connection has died */) <= 0) {
-        throw MB::ModbusException(MB::utils::Timeout);
-    }
+MB::Result<MB::ModbusRequest> Connection::tryAwaitRequest() noexcept {
+    const auto status = receive(60 * 1000 /* 1 minute means the connection has died */,
+                                MB::utils::Timeout);
+    if (!status)
+        return status.error();
 
-    std::vector<uint8_t> r(1024);
+    _messageID = _rxFrame.header.transactionID;
 
-    auto size = ::recv(_sockfd, r.begin().base(), r.size(), 0);
+    // Parse in place, PDU (with unit id) starts right after MBAP header
+    return MB::ModbusRequest::tryFromRaw(_rxFrame.pdu(), _rxFrame.pduSize());
+}
 
-    if (size == -1)
-        throw MB::ModbusException(MB::utils::ProtocolError);
-    else if (size == 0) {
-        throw MB::ModbusException(MB::utils::ConnectionClosed);
-    }
+MB::Result<MB::ModbusResponse> Connection::tryAwaitResponse() noexcept {
+    const auto status = receive(_timeout, MB::utils::Timeout);
+    if (!status)
+        return status.error();
 
-    r.resize(size); // Set vector to proper shape
-    r.shrink_to_fit();
+    if (_rxFrame.header.transactionID != _messageID)
+        return MB::utils::InvalidMessageID;
 
-    const auto resultMessageID = *reinterpret_cast<uint16_t *>(&r[0]);
+    return parseResponse();
+}
 
-    _messageID = resultMessageID;
+MB::Result<MB::ModbusResponse>
+Connection::tryAwaitAnyResponse(std::optional<uint16_t> &transactionID) noexcept {
+    transactionID.reset();
+    const auto status = receive(_timeout, MB::utils::Timeout);
+    if (!status)
+        return status.error();
 
-    r.erase(r.begin(), r.begin() + 6);
+    transactionID = _rxFrame.header.transactionID;
+    return parseResponse();
+}
 
-    return MB::ModbusRequest::fromRaw(r);
+MB::Result<MB::ModbusResponse> Connection::parseResponse() const noexcept {
+    return MB::parseResponse(_rxFrame.pdu(), _rxFrame.pduSize());
 }
 
-MB::ModbusResponse Connection::awaitResponse() {
-    pollfd _pfd = {.fd = _sockfd, .events = POLLIN, .revents = POLLIN};
-    if (::poll(&_pfd, 1, _timeout) <= 0) {
-        throw MB::ModbusException(MB::utils::Timeout);
-    }
+MB::ModbusRequest Connection::awaitRequest() {
+    auto request = tryAwaitRequest();
+    if (!request)
+        MB_THROW(MB::ModbusException(request.error()));
 
-    std::vector<uint8_t> r(1024);
-    auto size = ::recv(_sockfd, r.begin().base(), r.size(), 0);
+    return std::move(request).value();
+}
 
-    if (size == -1)
-        throw MB::ModbusException(MB::utils::ProtocolError);
-    else if (size == 0) {
-        throw MB::ModbusException(MB::utils::ConnectionClosed);
+MB::ModbusResponse Connection::awaitResponse() {
+    auto response = tryAwaitResponse();
+    if (!response) {
+        // Keep slave id and function code of exceptions reported by the device
+        if (MB::utils::isStandardErrorCode(response.error()))
+            MB_THROW(MB::ModbusException(_rxFrame.pdu(),
+                                         MB::ModbusException::encodedSize()));
+
+        MB_THROW(MB::ModbusException(response.error()));
     }
 
-    r.resize(size); // Set vector to proper shape
-    r.shrink_to_fit();
-
-    const auto resultMessageID = *reinterpret_cast<uint16_t *>(&r[0]);
-
-    if (resultMessageID != _messageID)
-        throw MB::ModbusException(MB::utils::InvalidMessageID);
-
-    r.erase(r.begin(), r.begin() + 6);
-
-    if (MB::ModbusException::exist(r))
-        throw MB::ModbusException(r);
-
-    return MB::ModbusResponse::fromRaw(r);
+    return std::move(response).value();
 }
 
 Connection::Connection(Connection &&moved) noexcept {
@@ -172,13 +195,20 @@ Connection::Connection(Connection &&moved) noexcept {
 
     _sockfd       = moved._sockfd;
     _messageID    = moved._messageID;
+    _timeout      = moved._timeout;
+    _quickAck     = moved._quickAck;
+    _txBuffer     = std::move(moved._txBuffer);
+    _rxFramer     = std::move(moved._rxFramer);
+    _rxFrame      = moved._rxFrame;
+    _trace        = moved._trace;
     moved._sockfd = -1;
 }
 
-Connection Connection::with(std::string addr, int port) {
+Connection Connection::with(std::string addr, int port, const SocketOptions &options) {
     auto sock = socket(AF_INET, SOCK_STREAM, 0);
     if (sock == -1)
-        throw std::runtime_error("Cannot open socket, errno = " + std::to_string(errno));
+        MB_THROW(
+            std::runtime_error("Cannot open socket, errno = " + std::to_string(errno)));
 
     sockaddr_in server = {.sin_family = AF_INET,
                           .sin_port   = htons(port),
@@ -186,7 +216,9 @@ Connection Connection::with(std::string addr, int port) {
                           .sin_zero   = {}};
 
     if (::connect(sock, reinterpret_cast<struct sockaddr *>(&server), sizeof(server)) < 0)
-        throw std::runtime_error("Cannot connect, errno = " + std::to_string(errno));
+        MB_THROW(std::runtime_error("Cannot connect, errno = " + std::to_string(errno)));
 
-    return Connection(sock);
+    Connection connection(sock);
+    connection.setSocketOptions(options);
+    return connection;
 }
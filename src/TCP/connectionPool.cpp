@@ -0,0 +1,309 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "TCP/connectionPool.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+#include <fcntl.h>
+
+using namespace MB::TCP;
+
+namespace {
+//! Connects to IPv4 endpoint within timeout, returns blocking socket or -1
+int connectWithin(const ConnectionPool::Endpoint &endpoint,
+                  std::chrono::milliseconds timeout) noexcept {
+    const auto sock = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (sock == -1)
+        return -1;
+
+    sockaddr_in server = {.sin_family = AF_INET,
+                          .sin_port   = htons(endpoint.port),
+                          .sin_addr   = {inet_addr(endpoint.address.c_str())},
+                          .sin_zero   = {}};
+
+    if (::connect(sock, reinterpret_cast<struct sockaddr *>(&server), sizeof(server)) ==
+        -1) {
+        pollfd waiting = {.fd = sock, .events = POLLOUT, .revents = 0};
+        int error      = 0;
+        socklen_t size = sizeof(error);
+        if (errno != EINPROGRESS ||
+            ::poll(&waiting, 1, static_cast<int>(timeout.count())) <= 0 ||
+            ::getsockopt(sock, SOL_SOCKET, SO_ERROR, &error, &size) == -1 || error != 0) {
+            ::close(sock);
+            return -1;
+        }
+    }
+
+    // Connection does blocking I/O
+    ::fcntl(sock, F_SETFL, ::fcntl(sock, F_GETFL) & ~O_NONBLOCK);
+    return sock;
+}
+
+//! Idle connection is usable if the gateway neither closed it nor sent anything
+bool alive(const Connection &connection) noexcept {
+    pollfd waiting = {.fd = connection.getSockfd(), .events = POLLIN, .revents = 0};
+    return ::poll(&waiting, 1, 0) == 0;
+}
+
+//! Errors after which the byte stream can not be trusted anymore
+bool connectionLost(MB::utils::MBErrorCode error) noexcept {
+    return error == MB::utils::ConnectionClosed || error == MB::utils::ProtocolError ||
+           error == MB::utils::InvalidByteOrder;
+}
+} // namespace
+
+ConnectionPool::ConnectionPool() : ConnectionPool(Limits()) {}
+
+ConnectionPool::ConnectionPool(Limits defaults) : _defaults(defaults) {}
+
+ConnectionPool::Gateway &ConnectionPool::gateway(const Endpoint &endpoint) {
+    auto &gateway = _gateways[endpoint];
+    if (!gateway) {
+        gateway           = std::make_unique<Gateway>();
+        gateway->endpoint = endpoint;
+        gateway->limits   = _defaults;
+    }
+    return *gateway;
+}
+
+void ConnectionPool::addGateway(const Endpoint &endpoint, Limits limits) {
+    limits.maxConnections = std::max<std::size_t>(limits.maxConnections, 1);
+    limits.maxInFlight    = std::max<std::size_t>(limits.maxInFlight, 1);
+
+    std::lock_guard lock(_mutex);
+    auto &target  = gateway(endpoint);
+    target.limits = limits;
+    dispatch(target);
+}
+
+void ConnectionPool::route(uint8_t unit, const Endpoint &endpoint) {
+    std::lock_guard lock(_mutex);
+    _routes[unit] = &gateway(endpoint);
+}
+
+void ConnectionPool::dispatch(Gateway &gateway) {
+    const auto &limits = gateway.limits;
+
+    while (gateway.queued > 0 && gateway.inFlight < limits.maxInFlight &&
+           (!gateway.idle.empty() || gateway.connections < limits.maxConnections)) {
+        // Caller following the one served last, in order of IDs
+        auto turn = gateway.queues.upper_bound(gateway.lastServed);
+        if (turn == gateway.queues.end())
+            turn = gateway.queues.begin();
+
+        auto *waiter = turn->second.front();
+        turn->second.pop_front();
+        gateway.lastServed = turn->first;
+        if (turn->second.empty())
+            gateway.queues.erase(turn);
+        gateway.queued--;
+
+        waiter->granted = std::min(waiter->wanted, limits.maxInFlight - gateway.inFlight);
+        waiter->limits  = limits;
+        gateway.inFlight += waiter->granted;
+        if (gateway.idle.empty()) {
+            gateway.connections++;
+        } else {
+            waiter->client = std::move(gateway.idle.back());
+            gateway.idle.pop_back();
+        }
+
+        waiter->served = true;
+        waiter->ready.notify_one();
+    }
+}
+
+void ConnectionPool::reject(Gateway &gateway) {
+    for (auto &[caller, queue] : gateway.queues)
+        for (auto *waiter : queue) {
+            waiter->served = true;
+            waiter->ready.notify_one();
+        }
+
+    gateway.queues.clear();
+    gateway.queued = 0;
+}
+
+bool ConnectionPool::acquire(Gateway &gateway, Waiter &waiter, CallerId caller) {
+    std::unique_lock lock(_mutex);
+    if (!gateway.healthy() && Clock::now() < gateway.retryAt)
+        return false;
+
+    gateway.queues[caller].push_back(&waiter);
+    gateway.queued++;
+    dispatch(gateway);
+
+    waiter.ready.wait(lock, [&] { return waiter.served; });
+    return waiter.granted > 0;
+}
+
+void ConnectionPool::release(Gateway &gateway, Waiter &waiter) {
+    std::lock_guard lock(_mutex);
+    gateway.inFlight -= waiter.granted;
+
+    if (waiter.client) {
+        gateway.idle.push_back(std::move(waiter.client));
+    } else {
+        gateway.connections--;
+        gateway.connectionFailures++;
+    }
+
+    if (waiter.connectFailed) {
+        gateway.consecutiveFailures++;
+        gateway.retryAt = Clock::now() + gateway.limits.retryDelay;
+        if (!gateway.healthy()) {
+            reject(gateway);
+            return;
+        }
+    } else {
+        if (waiter.connected)
+            gateway.consecutiveFailures = 0;
+        gateway.transactions += waiter.granted;
+    }
+
+    dispatch(gateway);
+}
+
+void ConnectionPool::execute(Gateway &gateway, const MB::ModbusRequest *requests,
+                             std::size_t count, MB::Result<MB::ModbusResponse> *results,
+                             CallerId caller) {
+    std::size_t done = 0;
+
+    while (done < count) {
+        Waiter waiter(count - done);
+        if (!acquire(gateway, waiter, caller))
+            break;
+
+        if (waiter.client && !alive(waiter.client->connection()))
+            waiter.client.reset();
+        if (!waiter.client) {
+            const auto sock =
+                connectWithin(gateway.endpoint, waiter.limits.connectTimeout);
+            if (sock == -1) {
+                waiter.connectFailed = true;
+                release(gateway, waiter);
+                break;
+            }
+            Connection connection(sock);
+            connection.setSocketOptions(waiter.limits.socketOptions);
+            waiter.client    = std::make_unique<PipelinedClient>(std::move(connection));
+            waiter.connected = true;
+        }
+
+        auto &client = *waiter.client;
+        client.setWindow(waiter.granted);
+        client.connection().setTimeout(waiter.limits.timeout);
+
+        // One turn executes as many requests as slots were granted
+        std::vector<bool> completed(waiter.granted);
+        const auto onResponse = [&](std::size_t index,
+                                    MB::Result<MB::ModbusResponse> response) {
+            results[done + index] = std::move(response);
+            completed[index]      = true;
+        };
+        const auto status = client.transact(requests + done, waiter.granted, onResponse);
+        if (!status) {
+            for (std::size_t i = 0; i < waiter.granted; i++)
+                if (!completed[i])
+                    results[done + i] = status.error();
+
+            // Late responses are dropped as unknown transactions
+            client.reset();
+            if (connectionLost(status.error()))
+                waiter.client.reset();
+        }
+
+        done += waiter.granted;
+        release(gateway, waiter);
+    }
+
+    for (; done < count; done++)
+        results[done] = MB::utils::ConnectionClosed;
+}
+
+MB::Result<MB::ModbusResponse> ConnectionPool::transact(const MB::ModbusRequest &request,
+                                                        CallerId caller) {
+    Gateway *target = nullptr;
+    {
+        std::lock_guard lock(_mutex);
+        target = _routes[request.slaveID()];
+    }
+    if (!target)
+        return MB::utils::GatewayPathUnavailable;
+
+    MB::Result<MB::ModbusResponse> result = MB::utils::ConnectionClosed;
+    execute(*target, &request, 1, &result, caller);
+    return result;
+}
+
+std::vector<MB::Result<MB::ModbusResponse>>
+ConnectionPool::transact(const std::vector<MB::ModbusRequest> &requests,
+                         CallerId caller) {
+    std::vector<MB::Result<MB::ModbusResponse>> results(
+        requests.size(), MB::utils::GatewayPathUnavailable);
+    std::vector<Gateway *> targets(requests.size());
+    {
+        std::lock_guard lock(_mutex);
+        for (std::size_t i = 0; i < requests.size(); i++)
+            targets[i] = _routes[requests[i].slaveID()];
+    }
+
+    // Common case, the whole batch goes through one gateway
+    if (!requests.empty() && targets.front() &&
+        std::all_of(targets.begin(), targets.end(),
+                    [&](Gateway *target) { return target == targets.front(); })) {
+        execute(*targets.front(), requests.data(), requests.size(), results.data(),
+                caller);
+        return results;
+    }
+
+    for (std::size_t first = 0; first < requests.size(); first++) {
+        auto *target = targets[first];
+        if (!target)
+            continue; // Not routed, or already executed with its gateway
+
+        std::vector<std::size_t> indices;
+        std::vector<MB::ModbusRequest> group;
+        for (std::size_t i = first; i < requests.size(); i++)
+            if (targets[i] == target) {
+                indices.push_back(i);
+                group.push_back(requests[i]);
+                targets[i] = nullptr;
+            }
+
+        std::vector<MB::Result<MB::ModbusResponse>> groupResults(
+            group.size(), MB::utils::ConnectionClosed);
+        execute(*target, group.data(), group.size(), groupResults.data(), caller);
+        for (std::size_t i = 0; i < indices.size(); i++)
+            results[indices[i]] = std::move(groupResults[i]);
+    }
+    return results;
+}
+
+std::optional<ConnectionPool::GatewayStats>
+ConnectionPool::stats(const Endpoint &endpoint) const {
+    std::lock_guard lock(_mutex);
+    const auto it = _gateways.find(endpoint);
+    if (it == _gateways.end())
+        return std::nullopt;
+
+    const auto &gateway = *it->second;
+    GatewayStats stats;
+    stats.connections         = gateway.connections;
+    stats.idle                = gateway.idle.size();
+    stats.inFlight            = gateway.inFlight;
+    stats.queued              = gateway.queued;
+    stats.consecutiveFailures = gateway.consecutiveFailures;
+    stats.healthy             = gateway.healthy();
+    stats.transactions        = gateway.transactions;
+    stats.connectionFailures  = gateway.connectionFailures;
+    return stats;
+}
+
+ConnectionPool::CallerId ConnectionPool::currentCaller() noexcept {
+    return std::hash<std::thread::id>{}(std::this_thread::get_id());
+}
@@ -0,0 +1,87 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "TCP/pipelinedClient.hpp"
+
+#include <algorithm>
+
+using namespace MB::TCP;
+
+PipelinedClient::PipelinedClient(Connection connection, std::size_t window)
+    : _connection(std::move(connection)), _window(std::max<std::size_t>(window, 1)) {
+    _inFlight.reserve(_window);
+}
+
+void PipelinedClient::setWindow(std::size_t window) {
+    _window = std::max<std::size_t>(window, 1);
+    _inFlight.reserve(_window);
+}
+
+bool PipelinedClient::complete(uint16_t transactionID) noexcept {
+    const auto it = std::find(_inFlight.begin(), _inFlight.end(), transactionID);
+    if (it == _inFlight.end())
+        return false;
+
+    // Order of in flight transactions does not matter
+    *it = _inFlight.back();
+    _inFlight.pop_back();
+    return true;
+}
+
+std::optional<uint16_t> PipelinedClient::send(const MB::ModbusRequest &request) {
+    if (!canSend())
+        return std::nullopt;
+
+    const auto transactionID = _nextID++;
+    _connection.setMessageId(transactionID);
+    _connection.sendRequest(request);
+    _inFlight.push_back(transactionID);
+    return transactionID;
+}
+
+std::size_t PipelinedClient::send(const MB::ModbusRequest *requests, std::size_t count) {
+    const auto free  = _window - std::min(_window, _inFlight.size());
+    const auto batch = std::min(count, free);
+    if (batch == 0)
+        return 0;
+
+    _connection.setMessageId(_nextID);
+    _connection.sendRequests(requests, batch);
+    for (std::size_t i = 0; i < batch; i++)
+        _inFlight.push_back(_nextID++);
+    return batch;
+}
+
+MB::Result<PipelinedClient::Completion> PipelinedClient::receive() noexcept {
+    while (true) {
+        std::optional<uint16_t> transactionID;
+        auto response = _connection.tryAwaitAnyResponse(transactionID);
+        if (!transactionID)
+            return response.error();
+
+        if (complete(*transactionID))
+            return Completion{*transactionID, std::move(response)};
+    }
+}
+
+std::vector<MB::Result<MB::ModbusResponse>>
+PipelinedClient::transact(const std::vector<MB::ModbusRequest> &requests) {
+    std::vector<MB::Result<MB::ModbusResponse>> results(requests.size(),
+                                                        MB::utils::ConnectionClosed);
+    std::vector<bool> completed(requests.size());
+
+    const auto status =
+        transact(requests.data(), requests.size(),
+                 [&](std::size_t index, MB::Result<MB::ModbusResponse> response) {
+                     results[index]   = std::move(response);
+                     completed[index] = true;
+                 });
+
+    // Requests left without response carry the connection error
+    if (!status)
+        for (std::size_t i = 0; i < results.size(); i++)
+            if (!completed[i])
+                results[i] = status.error();
+    return results;
+}
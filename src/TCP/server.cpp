@@ -6,15 +6,19 @@
 
 using namespace MB::TCP;
 
-Server::Server(int port) {
+Server::Server(int port, const SocketOptions &options) {
     _port     = port;
+    _options  = options;
     _serverfd = socket(AF_INET, SOCK_STREAM, 0);
 
     if (_serverfd == -1)
-        throw std::runtime_error("Cannot create socket");
+        MB_THROW(std::runtime_error("Cannot create socket"));
 
-    setsockopt(_serverfd, SOL_SOCKET, SO_REUSEADDR, new int(1), sizeof(int));
-    setsockopt(_serverfd, SOL_SOCKET, SO_REUSEPORT, new int(1), sizeof(int));
+    const int reuse = 1;
+    setsockopt(_serverfd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    setsockopt(_serverfd, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse));
+    // Buffer sizes must be set before listen() to affect window scaling
+    _options.apply(_serverfd);
 
     _server = {};
 
@@ -24,7 +28,7 @@ Server::Server(int port) {
 
     if (::bind(_serverfd, reinterpret_cast<struct sockaddr *>(&_server),
                sizeof(_server)) < 0)
-        throw std::runtime_error("Cannot bind socket");
+        MB_THROW(std::runtime_error("Cannot bind socket"));
 
     ::listen(_serverfd, 255);
 }
@@ -43,7 +47,9 @@ std::optional<Connection> Server::awaitConnection() {
         ::accept(_serverfd, reinterpret_cast<struct sockaddr *>(&_server), &addrLen);
 
     if (connfd < 0)
-        throw;
+        return std::nullopt;
 
-    return Connection(connfd);
+    Connection connection(connfd);
+    connection.setSocketOptions(_options);
+    return connection;
 }
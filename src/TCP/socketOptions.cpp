@@ -0,0 +1,65 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "TCP/socketOptions.hpp"
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+using namespace MB::TCP;
+
+namespace {
+bool set(int sockfd, int level, int option, int value) noexcept {
+    return ::setsockopt(sockfd, level, option, &value, sizeof(value)) == 0;
+}
+} // namespace
+
+SocketOptions SocketOptions::lowLatency() noexcept {
+    SocketOptions options;
+    // Quick acks are left out, responses carry the acks of requests anyway.
+    // Busy polling too, raising it needs CAP_NET_ADMIN.
+    options.noDelay   = true;
+    options.keepAlive = true;
+    return options;
+}
+
+SocketOptions SocketOptions::throughput() noexcept {
+    // Nagle is off here too, request / response traffic stalls on it
+    SocketOptions options;
+    options.noDelay       = true;
+    options.keepAlive     = true;
+    options.sendBuffer    = 256 * 1024;
+    options.receiveBuffer = 256 * 1024;
+    return options;
+}
+
+bool SocketOptions::apply(int sockfd) const noexcept {
+    bool applied = true;
+
+    if (noDelay)
+        applied &= set(sockfd, IPPROTO_TCP, TCP_NODELAY, 1);
+    if (quickAck)
+        applied &= set(sockfd, IPPROTO_TCP, TCP_QUICKACK, 1);
+
+    if (keepAlive) {
+        applied &= set(sockfd, SOL_SOCKET, SO_KEEPALIVE, 1);
+        applied &= set(sockfd, IPPROTO_TCP, TCP_KEEPIDLE,
+                       static_cast<int>(keepAliveIdle.count()));
+        applied &= set(sockfd, IPPROTO_TCP, TCP_KEEPINTVL,
+                       static_cast<int>(keepAliveInterval.count()));
+        applied &= set(sockfd, IPPROTO_TCP, TCP_KEEPCNT, keepAliveProbes);
+    }
+
+    if (busyPoll.count() > 0)
+        applied &=
+            set(sockfd, SOL_SOCKET, SO_BUSY_POLL, static_cast<int>(busyPoll.count()));
+
+    if (sendBuffer > 0)
+        applied &= set(sockfd, SOL_SOCKET, SO_SNDBUF, sendBuffer);
+    if (receiveBuffer > 0)
+        applied &= set(sockfd, SOL_SOCKET, SO_RCVBUF, receiveBuffer);
+
+    return applied;
+}
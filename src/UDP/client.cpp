@@ -0,0 +1,163 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "UDP/client.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "MB/modbusException.hpp"
+
+using namespace MB::UDP;
+
+Client::Client(int sockfd, std::size_t window)
+    : _sockfd(sockfd), _window(std::max<std::size_t>(window, 1)), _tx(_window),
+      _rx(_window) {
+    _pending.reserve(_window);
+}
+
+Client::Client(Client &&moved) noexcept
+    : _sockfd(moved._sockfd), _window(moved._window), _timeout(moved._timeout),
+      _retries(moved._retries), _nextID(moved._nextID), _tx(std::move(moved._tx)),
+      _rx(std::move(moved._rx)), _pending(std::move(moved._pending)),
+      _stats(moved._stats) {
+    moved._sockfd = -1;
+}
+
+Client &Client::operator=(Client &&moved) noexcept {
+    if (this == &moved)
+        return *this;
+
+    if (_sockfd != -1)
+        ::close(_sockfd);
+
+    _sockfd       = moved._sockfd;
+    _window       = moved._window;
+    _timeout      = moved._timeout;
+    _retries      = moved._retries;
+    _nextID       = moved._nextID;
+    _tx           = std::move(moved._tx);
+    _rx           = std::move(moved._rx);
+    _pending      = std::move(moved._pending);
+    _stats        = moved._stats;
+    moved._sockfd = -1;
+    return *this;
+}
+
+Client::~Client() {
+    if (_sockfd != -1)
+        ::close(_sockfd);
+}
+
+Client Client::with(const std::string &addr, int port, std::size_t window) {
+    const auto sock = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock == -1)
+        MB_THROW(
+            std::runtime_error("Cannot open socket, errno = " + std::to_string(errno)));
+
+    sockaddr_in server = {.sin_family = AF_INET,
+                          .sin_port   = htons(port),
+                          .sin_addr   = {inet_addr(addr.c_str())},
+                          .sin_zero   = {}};
+
+    // Connected socket takes datagrams of the device only
+    const auto *address = reinterpret_cast<struct sockaddr *>(&server);
+    if (::connect(sock, address, sizeof(server)) < 0) {
+        ::close(sock);
+        MB_THROW(std::runtime_error("Cannot connect, errno = " + std::to_string(errno)));
+    }
+
+    return Client(sock, window);
+}
+
+MB::Status Client::send(const MB::ModbusRequest &request, Pending &pending,
+                        Clock::time_point now) noexcept {
+    if (_tx.full())
+        if (auto status = _tx.send(_sockfd); !status)
+            return status;
+
+    _tx.push(request, pending.transactionID);
+    if (pending.attempts > 0)
+        _stats.retransmits++;
+    _stats.sent++;
+    pending.attempts++;
+    pending.deadline = now + std::chrono::milliseconds(_timeout);
+    return {};
+}
+
+MB::Result<std::size_t> Client::receive() noexcept {
+    auto deadline = _pending.front().deadline;
+    for (const auto &pending : _pending)
+        deadline = std::min(deadline, pending.deadline);
+
+    // Rounded up, so that the deadline has passed when poll times out
+    const auto left =
+        std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now()).count();
+    return _rx.receive(_sockfd, static_cast<int>(std::max<decltype(left)>(left, 0)));
+}
+
+MB::Result<MB::ModbusResponse>
+Client::complete(std::size_t datagram, std::optional<std::size_t> &index) noexcept {
+    index.reset();
+    const auto *data = _rx.data(datagram);
+    const auto size  = _rx.length(datagram);
+    if (size <= MB::MbapHeader::Size) {
+        _stats.dropped++;
+        return MB::utils::ProtocolError;
+    }
+
+    const auto header = MB::MbapHeader::decode(data);
+    const auto it = std::find_if(_pending.begin(), _pending.end(), [&](const auto &p) {
+        return p.transactionID == header.transactionID;
+    });
+    if (header.protocolID != 0 || header.length != size - MB::MbapHeader::Size ||
+        it == _pending.end()) {
+        _stats.dropped++;
+        return MB::utils::InvalidMessageID;
+    }
+
+    // Order of pending requests does not matter
+    index = it->index;
+    *it   = _pending.back();
+    _pending.pop_back();
+
+    return MB::parseResponse(data + MB::MbapHeader::Size, size - MB::MbapHeader::Size);
+}
+
+MB::Result<MB::ModbusResponse>
+Client::transact(const MB::ModbusRequest &request) noexcept {
+    std::optional<MB::Result<MB::ModbusResponse>> result;
+    const auto status =
+        transact(&request, 1, [&](std::size_t, MB::Result<MB::ModbusResponse> response) {
+            result = std::move(response);
+        });
+    if (!status)
+        return status.error();
+    return std::move(*result);
+}
+
+std::vector<MB::Result<MB::ModbusResponse>>
+Client::transact(const std::vector<MB::ModbusRequest> &requests) {
+    std::vector<MB::Result<MB::ModbusResponse>> results(requests.size(),
+                                                        MB::utils::ConnectionClosed);
+    std::vector<bool> completed(requests.size());
+
+    const auto status =
+        transact(requests.data(), requests.size(),
+                 [&](std::size_t index, MB::Result<MB::ModbusResponse> response) {
+                     results[index]   = std::move(response);
+                     completed[index] = true;
+                 });
+
+    // Requests left without response carry the socket error
+    if (!status)
+        for (std::size_t i = 0; i < results.size(); i++)
+            if (!completed[i])
+                results[i] = status.error();
+    return results;
+}
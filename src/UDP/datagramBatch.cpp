@@ -0,0 +1,90 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "UDP/datagramBatch.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <poll.h>
+
+using namespace MB::UDP;
+
+DatagramBatch::DatagramBatch(std::size_t slots) {
+    slots = std::max<std::size_t>(slots, 1);
+    _data.resize(slots * SlotSize);
+    _vectors.resize(slots);
+    _headers.resize(slots);
+    _addresses.resize(slots);
+
+    for (std::size_t i = 0; i < slots; i++) {
+        _vectors[i]                    = {_data.data() + i * SlotSize, SlotSize};
+        _headers[i]                    = {};
+        _headers[i].msg_hdr.msg_iov    = &_vectors[i];
+        _headers[i].msg_hdr.msg_iovlen = 1;
+    }
+}
+
+void DatagramBatch::commit(std::size_t length, const sockaddr_in *address) noexcept {
+    auto &header            = _headers[_size];
+    _vectors[_size].iov_len = length;
+    header.msg_len          = static_cast<unsigned int>(length);
+    if (address) {
+        _addresses[_size]          = *address;
+        header.msg_hdr.msg_name    = &_addresses[_size];
+        header.msg_hdr.msg_namelen = sizeof(sockaddr_in);
+    } else {
+        header.msg_hdr.msg_name    = nullptr;
+        header.msg_hdr.msg_namelen = 0;
+    }
+    _size++;
+}
+
+MB::Status DatagramBatch::send(int fd) noexcept {
+    std::size_t offset = 0;
+    while (offset < _size) {
+        const auto sent = ::sendmmsg(fd, _headers.data() + offset,
+                                     static_cast<unsigned int>(_size - offset), 0);
+        if (sent > 0) {
+            offset += static_cast<std::size_t>(sent);
+        } else if (sent < 0 && errno != EINTR) {
+            _size = 0;
+            return errno == ECONNREFUSED ? MB::utils::ConnectionClosed
+                                         : MB::utils::ProtocolError;
+        }
+    }
+    _size = 0;
+    return {};
+}
+
+MB::Result<std::size_t> DatagramBatch::receive(int fd, int timeout) noexcept {
+    _size          = 0;
+    pollfd waiting = {.fd = fd, .events = POLLIN, .revents = 0};
+    if (::poll(&waiting, 1, timeout) <= 0)
+        return MB::utils::Timeout;
+
+    for (std::size_t i = 0; i < _headers.size(); i++) {
+        _vectors[i].iov_len             = SlotSize;
+        _headers[i].msg_hdr.msg_name    = &_addresses[i];
+        _headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        _headers[i].msg_hdr.msg_flags   = 0;
+    }
+
+    // Socket is readable, so only what is already queued is taken
+    const auto received = ::recvmmsg(fd, _headers.data(),
+                                     static_cast<unsigned int>(_headers.size()),
+                                     MSG_DONTWAIT, nullptr);
+    if (received < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            return std::size_t(0);
+        return errno == ECONNREFUSED ? MB::utils::ConnectionClosed
+                                     : MB::utils::ProtocolError;
+    }
+
+    _size = static_cast<std::size_t>(received);
+    // Datagrams longer than a slot are not Modbus, length 0 makes them invalid
+    for (std::size_t i = 0; i < _size; i++)
+        if (_headers[i].msg_hdr.msg_flags & MSG_TRUNC)
+            _headers[i].msg_len = 0;
+    return _size;
+}
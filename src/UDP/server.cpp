@@ -0,0 +1,81 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "UDP/server.hpp"
+
+#include <cerrno>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <unistd.h>
+
+using namespace MB::UDP;
+
+Server::Server(int port, std::size_t batch) : _rx(batch), _tx(batch) {
+    _sockfd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (_sockfd == -1)
+        MB_THROW(std::runtime_error("Cannot create socket"));
+
+    const int reuse = 1;
+    setsockopt(_sockfd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in server     = {};
+    server.sin_family      = AF_INET;
+    server.sin_addr.s_addr = INADDR_ANY;
+    server.sin_port        = ::htons(port);
+
+    if (::bind(_sockfd, reinterpret_cast<struct sockaddr *>(&server), sizeof(server)) < 0)
+        MB_THROW(std::runtime_error("Cannot bind socket"));
+}
+
+Server::Server(Server &&moved) noexcept
+    : _sockfd(moved._sockfd), _rx(std::move(moved._rx)), _tx(std::move(moved._tx)) {
+    moved._sockfd = -1;
+}
+
+Server &Server::operator=(Server &&moved) noexcept {
+    if (this == &moved)
+        return *this;
+
+    if (_sockfd != -1)
+        ::close(_sockfd);
+
+    _sockfd       = moved._sockfd;
+    _rx           = std::move(moved._rx);
+    _tx           = std::move(moved._tx);
+    moved._sockfd = -1;
+    return *this;
+}
+
+Server::~Server() {
+    if (_sockfd != -1)
+        ::close(_sockfd);
+}
+
+int Server::port() const noexcept {
+    sockaddr_in address{};
+    socklen_t size = sizeof(address);
+    if (::getsockname(_sockfd, reinterpret_cast<sockaddr *>(&address), &size) < 0)
+        return -1;
+    return ntohs(address.sin_port);
+}
+
+MB::Result<MB::ModbusRequest>
+Server::request(std::size_t datagram,
+                std::optional<uint16_t> &transactionID) const noexcept {
+    transactionID.reset();
+    const auto *data = _rx.data(datagram);
+    const auto size  = _rx.length(datagram);
+    if (size <= MB::MbapHeader::Size)
+        return MB::utils::ProtocolError;
+
+    const auto header = MB::MbapHeader::decode(data);
+    if (header.protocolID != 0 || header.length != size - MB::MbapHeader::Size)
+        return MB::utils::ProtocolError;
+
+    transactionID = header.transactionID;
+    // Parse in place, PDU (with unit id) starts right after MBAP header
+    return MB::ModbusRequest::tryFromRaw(data + MB::MbapHeader::Size,
+                                         size - MB::MbapHeader::Size);
+}
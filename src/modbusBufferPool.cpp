@@ -0,0 +1,60 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusBufferPool.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+using namespace MB;
+
+bool FrameBuffer::assign(const uint8_t *data, std::size_t size) noexcept {
+    if (!resize(size))
+        return false;
+    std::memcpy(_data, data, size);
+    return true;
+}
+
+void FrameBufferPool::SlabDelete::operator()(uint8_t *slab) const noexcept {
+    ::operator delete[](slab, std::align_val_t(CacheLine));
+}
+
+FrameBufferPool::FrameBufferPool(std::size_t bufferSize, std::size_t reserved)
+    : _bufferSize((std::max<std::size_t>(bufferSize, 1) + CacheLine - 1) / CacheLine *
+                  CacheLine) {
+    if (reserved > 0)
+        reserve(reserved);
+}
+
+void FrameBufferPool::grow(std::size_t buffers) {
+    auto *slab = static_cast<uint8_t *>(
+        ::operator new[](buffers * _bufferSize, std::align_val_t(CacheLine)));
+    _slabs.emplace_back(slab);
+
+    _total += buffers;
+    for (std::size_t i = buffers; i-- > 0;)
+        release(slab + i * _bufferSize);
+}
+
+FrameBuffer FrameBufferPool::acquire() {
+    if (!_free)
+        grow(SlabBuffers);
+
+    auto *buffer = _free;
+    std::memcpy(&_free, buffer, sizeof(_free));
+    _available--;
+    return FrameBuffer(this, buffer);
+}
+
+void FrameBufferPool::reserve(std::size_t buffers) {
+    if (_available < buffers)
+        grow(buffers - _available);
+}
+
+void FrameBufferPool::release(uint8_t *buffer) noexcept {
+    std::memcpy(buffer, &_free, sizeof(_free));
+    _free = buffer;
+    _available++;
+}
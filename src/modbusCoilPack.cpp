@@ -0,0 +1,181 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusCoilPack.hpp"
+
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define MB_COIL_SIMD 1
+#include <immintrin.h>
+#endif
+
+using namespace MB;
+
+namespace {
+constexpr uint64_t LowBits = 0x0101010101010101;
+
+// Both return number of processed coils, always multiple of 8
+std::size_t packScalar(const uint8_t *values, std::size_t count,
+                       uint8_t *packed) noexcept {
+    std::size_t done = 0;
+    for (; done + 8 <= count; done += 8) {
+        uint8_t byte = 0;
+        for (std::size_t bit = 0; bit < 8; bit++)
+            byte |= static_cast<uint8_t>((values[done + bit] != 0) << bit);
+        packed[done / 8] = byte;
+    }
+    return done;
+}
+
+std::size_t unpackScalar(const uint8_t *packed, std::size_t count,
+                         uint8_t *values) noexcept {
+    std::size_t done = 0;
+    for (; done + 8 <= count; done += 8) {
+        const uint8_t byte = packed[done / 8];
+        for (std::size_t bit = 0; bit < 8; bit++)
+            values[done + bit] = (byte >> bit) & 1;
+    }
+    return done;
+}
+
+#ifdef MB_COIL_SIMD
+__attribute__((target("sse2"))) std::size_t
+packSse2(const uint8_t *values, std::size_t count, uint8_t *packed) noexcept {
+    const __m128i zero = _mm_setzero_si128();
+    std::size_t done   = 0;
+    for (; done + 16 <= count; done += 16) {
+        const auto in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + done));
+        const auto off =
+            static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(in, zero)));
+        const auto bits = static_cast<uint16_t>(~off);
+        std::memcpy(packed + done / 8, &bits, 2);
+    }
+    return done;
+}
+
+// Every byte of 16 is filled with its packed source byte, then bit `i % 8`
+// is selected by compare with single bit mask
+__attribute__((target("sse2"))) std::size_t
+unpackSse2(const uint8_t *packed, std::size_t count, uint8_t *values) noexcept {
+    const __m128i select = _mm_set1_epi64x(static_cast<long long>(0x8040201008040201));
+    const __m128i one    = _mm_set1_epi8(1);
+    std::size_t done     = 0;
+    for (; done + 16 <= count; done += 16) {
+        const auto lo     = static_cast<long long>(packed[done / 8] * LowBits);
+        const auto hi     = static_cast<long long>(packed[done / 8 + 1] * LowBits);
+        const auto spread = _mm_and_si128(_mm_set_epi64x(hi, lo), select);
+        const auto bits   = _mm_and_si128(_mm_cmpeq_epi8(spread, select), one);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(values + done), bits);
+    }
+    return done;
+}
+
+// High bit of every byte is set for non zero value, PEXT gathers them
+__attribute__((target("bmi2"))) std::size_t
+packBmi2(const uint8_t *values, std::size_t count, uint8_t *packed) noexcept {
+    constexpr uint64_t Low7 = 0x7F7F7F7F7F7F7F7F;
+    std::size_t done        = 0;
+    for (; done + 8 <= count; done += 8) {
+        uint64_t word;
+        std::memcpy(&word, values + done, 8);
+        word             = ((word & Low7) + Low7) | word;
+        packed[done / 8] = static_cast<uint8_t>(_pext_u64(word, LowBits << 7));
+    }
+    return done;
+}
+
+__attribute__((target("bmi2"))) std::size_t
+unpackBmi2(const uint8_t *packed, std::size_t count, uint8_t *values) noexcept {
+    std::size_t done = 0;
+    for (; done + 8 <= count; done += 8) {
+        const uint64_t word = _pdep_u64(packed[done / 8], LowBits);
+        std::memcpy(values + done, &word, 8);
+    }
+    return done;
+}
+#endif
+
+utils::CoilKernel selectKernel() noexcept {
+    // PDEP / PEXT are microcoded on AMD before Zen 3, SSE2 is never slower
+    if (isCoilKernelSupported(utils::CoilSse2))
+        return utils::CoilSse2;
+    return utils::CoilScalar;
+}
+} // namespace
+
+bool utils::isCoilKernelSupported(CoilKernel kernel) noexcept {
+    switch (kernel) {
+    case CoilScalar:
+        return true;
+    case CoilSse2:
+#ifdef MB_COIL_SIMD
+        return __builtin_cpu_supports("sse2");
+#else
+        return false;
+#endif
+    case CoilBmi2:
+#ifdef MB_COIL_SIMD
+        return __builtin_cpu_supports("bmi2");
+#else
+        return false;
+#endif
+    default:
+        return false;
+    }
+}
+
+utils::CoilKernel utils::activeCoilKernel() noexcept {
+    static const CoilKernel kernel = selectKernel();
+    return kernel;
+}
+
+void utils::packCoils(const uint8_t *values, std::size_t count, uint8_t *packed,
+                      CoilKernel kernel) noexcept {
+    std::size_t done = 0;
+#ifdef MB_COIL_SIMD
+    if (kernel == CoilSse2)
+        done = packSse2(values, count, packed);
+    else if (kernel == CoilBmi2)
+        done = packBmi2(values, count, packed);
+#else
+    static_cast<void>(kernel);
+#endif
+    done += packScalar(values + done, count - done, packed + done / 8);
+
+    // Last, partial byte
+    if (done < count) {
+        uint8_t byte = 0;
+        for (std::size_t bit = 0; done + bit < count; bit++)
+            byte |= static_cast<uint8_t>((values[done + bit] != 0) << bit);
+        packed[done / 8] = byte;
+    }
+}
+
+void utils::packCoils(const uint8_t *values, std::size_t count,
+                      uint8_t *packed) noexcept {
+    packCoils(values, count, packed, activeCoilKernel());
+}
+
+void utils::unpackCoils(const uint8_t *packed, std::size_t count, uint8_t *values,
+                        CoilKernel kernel) noexcept {
+    std::size_t done = 0;
+#ifdef MB_COIL_SIMD
+    if (kernel == CoilSse2)
+        done = unpackSse2(packed, count, values);
+    else if (kernel == CoilBmi2)
+        done = unpackBmi2(packed, count, values);
+#else
+    static_cast<void>(kernel);
+#endif
+    done += unpackScalar(packed + done / 8, count - done, values + done);
+
+    for (; done < count; done++)
+        values[done] = (packed[done / 8] >> (done % 8)) & 1;
+}
+
+void utils::unpackCoils(const uint8_t *packed, std::size_t count,
+                        uint8_t *values) noexcept {
+    unpackCoils(packed, count, values, activeCoilKernel());
+}
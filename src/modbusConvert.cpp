@@ -0,0 +1,206 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusConvert.hpp"
+
+#include <array>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MB_CONVERT_SIMD 1
+#include <immintrin.h>
+#endif
+
+using namespace MB;
+
+namespace {
+constexpr bool LittleEndianHost = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+// Index of source byte for every destination byte of an element. Register
+// order and byte order inside a register are reversed independently, so the
+// permutation is its own inverse.
+constexpr std::size_t sourceIndex(std::size_t index, std::size_t size,
+                                  utils::WordOrder order) {
+    const std::size_t registers = size / 2;
+    std::size_t reg             = index / 2;
+    std::size_t byte            = index % 2;
+
+    // Native order of little endian host is the reversed ABCD wire order
+    if (LittleEndianHost) {
+        reg  = registers - 1 - reg;
+        byte = 1 - byte;
+    }
+    if (order == utils::CDAB || order == utils::DCBA)
+        reg = registers - 1 - reg;
+    if (order == utils::BADC || order == utils::DCBA)
+        byte = 1 - byte;
+
+    return 2 * reg + byte;
+}
+
+using ShuffleMask = std::array<uint8_t, 16>;
+
+// Element permutation repeated over 16 bytes, usable by PSHUFB
+constexpr ShuffleMask makeMask(std::size_t size, utils::WordOrder order) {
+    ShuffleMask mask{};
+    for (std::size_t i = 0; i < mask.size(); i++)
+        mask[i] =
+            static_cast<uint8_t>(i / size * size + sourceIndex(i % size, size, order));
+    return mask;
+}
+
+// Masks indexed by [log2(size) - 1][order]
+constexpr std::array<std::array<ShuffleMask, 4>, 3> makeMasks() {
+    std::array<std::array<ShuffleMask, 4>, 3> masks{};
+    for (std::size_t s = 0; s < masks.size(); s++)
+        for (std::size_t order = 0; order < 4; order++)
+            masks[s][order] =
+                makeMask(std::size_t(2) << s, static_cast<utils::WordOrder>(order));
+    return masks;
+}
+
+constexpr auto Masks = makeMasks();
+
+template <std::size_t Size, utils::WordOrder Order>
+void convertScalar(const uint8_t *src, uint8_t *dst, std::size_t count) noexcept {
+    constexpr auto mask = makeMask(Size, Order);
+    for (std::size_t n = 0; n < count; n++) {
+        uint8_t element[Size];
+        for (std::size_t i = 0; i < Size; i++)
+            element[i] = src[mask[i]];
+        std::memcpy(dst, element, Size);
+        src += Size;
+        dst += Size;
+    }
+}
+
+template <std::size_t Size>
+void convertScalar(const uint8_t *src, uint8_t *dst, std::size_t count,
+                   utils::WordOrder order) noexcept {
+    switch (order) {
+    case utils::CDAB:
+        return convertScalar<Size, utils::CDAB>(src, dst, count);
+    case utils::BADC:
+        return convertScalar<Size, utils::BADC>(src, dst, count);
+    case utils::DCBA:
+        return convertScalar<Size, utils::DCBA>(src, dst, count);
+    case utils::ABCD:
+    default:
+        return convertScalar<Size, utils::ABCD>(src, dst, count);
+    }
+}
+
+void convertScalar(const uint8_t *src, uint8_t *dst, std::size_t count, std::size_t size,
+                   utils::WordOrder order) noexcept {
+    switch (size) {
+    case 2:
+        return convertScalar<2>(src, dst, count, order);
+    case 4:
+        return convertScalar<4>(src, dst, count, order);
+    case 8:
+        return convertScalar<8>(src, dst, count, order);
+    default:
+        return;
+    }
+}
+
+#ifdef MB_CONVERT_SIMD
+// Both return number of converted bytes, always whole elements
+__attribute__((target("ssse3"))) std::size_t
+convertSsse3(const uint8_t *src, uint8_t *dst, std::size_t bytes,
+             const ShuffleMask &mask) noexcept {
+    const __m128i shuffle =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(mask.data()));
+    std::size_t done = 0;
+    for (; done + 16 <= bytes; done += 16) {
+        const auto in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + done));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + done),
+                         _mm_shuffle_epi8(in, shuffle));
+    }
+    return done;
+}
+
+__attribute__((target("avx2"))) std::size_t
+convertAvx2(const uint8_t *src, uint8_t *dst, std::size_t bytes,
+            const ShuffleMask &mask) noexcept {
+    const __m256i shuffle = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(mask.data())));
+    std::size_t done = 0;
+    for (; done + 64 <= bytes; done += 64) {
+        const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + done));
+        const auto b =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + done + 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + done),
+                            _mm256_shuffle_epi8(a, shuffle));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + done + 32),
+                            _mm256_shuffle_epi8(b, shuffle));
+    }
+    for (; done + 32 <= bytes; done += 32) {
+        const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + done));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + done),
+                            _mm256_shuffle_epi8(a, shuffle));
+    }
+    return done + convertSsse3(src + done, dst + done, bytes - done, mask);
+}
+#endif
+
+utils::ConvertKernel selectKernel() noexcept {
+    if (isConvertKernelSupported(utils::ConvertAvx2))
+        return utils::ConvertAvx2;
+    if (isConvertKernelSupported(utils::ConvertSsse3))
+        return utils::ConvertSsse3;
+    return utils::ConvertScalar;
+}
+} // namespace
+
+bool utils::isConvertKernelSupported(ConvertKernel kernel) noexcept {
+    switch (kernel) {
+    case ConvertScalar:
+        return true;
+    case ConvertSsse3:
+#ifdef MB_CONVERT_SIMD
+        return LittleEndianHost && __builtin_cpu_supports("ssse3");
+#else
+        return false;
+#endif
+    case ConvertAvx2:
+#ifdef MB_CONVERT_SIMD
+        return LittleEndianHost && __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    default:
+        return false;
+    }
+}
+
+utils::ConvertKernel utils::activeConvertKernel() noexcept {
+    static const ConvertKernel kernel = selectKernel();
+    return kernel;
+}
+
+void utils::convertOrder(const uint8_t *src, uint8_t *dst, std::size_t count,
+                         std::size_t size, WordOrder order,
+                         ConvertKernel kernel) noexcept {
+    if (size != 2 && size != 4 && size != 8)
+        return;
+
+    std::size_t done = 0;
+#ifdef MB_CONVERT_SIMD
+    const auto &mask = Masks[size == 2 ? 0 : size == 4 ? 1 : 2][order & 3];
+    if (kernel == ConvertAvx2)
+        done = convertAvx2(src, dst, count * size, mask);
+    else if (kernel == ConvertSsse3)
+        done = convertSsse3(src, dst, count * size, mask);
+#else
+    static_cast<void>(kernel);
+#endif
+
+    convertScalar(src + done, dst + done, count - done / size, size, order);
+}
+
+void utils::convertOrder(const uint8_t *src, uint8_t *dst, std::size_t count,
+                         std::size_t size, WordOrder order) noexcept {
+    convertOrder(src, dst, count, size, order, activeConvertKernel());
+}
@@ -0,0 +1,209 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusCrc.hpp"
+
+#include <array>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MB_CRC_CLMUL 1
+#include <immintrin.h>
+#endif
+
+using namespace MB;
+
+namespace {
+// Modbus polynomial x^16 + x^15 + x^2 + 1, reflected
+constexpr uint16_t ReflectedPoly = 0xA001;
+constexpr uint32_t Poly          = 0x18005;
+
+using CrcTables = std::array<std::array<uint16_t, 256>, 16>;
+
+// T[k][b] is CRC register after byte b followed by k zero bytes
+constexpr CrcTables makeTables() {
+    CrcTables tables{};
+    for (uint16_t b = 0; b < 256; b++) {
+        uint16_t crc = b;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 1) ? (crc >> 1) ^ ReflectedPoly : crc >> 1;
+        tables[0][b] = crc;
+    }
+    for (std::size_t k = 1; k < tables.size(); k++) {
+        for (std::size_t b = 0; b < 256; b++) {
+            const auto prev = tables[k - 1][b];
+            tables[k][b]    = (prev >> 8) ^ tables[0][prev & 0xFF];
+        }
+    }
+    return tables;
+}
+
+constexpr CrcTables Tables = makeTables();
+
+inline uint16_t crcBytewise(const uint8_t *buff, std::size_t len, uint16_t crc) noexcept {
+    while (len--)
+        crc = (crc >> 8) ^ Tables[0][(crc ^ *buff++) & 0xFF];
+    return crc;
+}
+
+template <std::size_t Slice>
+uint16_t crcSlicing(const uint8_t *buff, std::size_t len, uint16_t crc) noexcept {
+    while (len >= Slice) {
+        const uint16_t head = crc ^ (buff[0] | (buff[1] << 8));
+        uint16_t next = Tables[Slice - 1][head & 0xFF] ^ Tables[Slice - 2][head >> 8];
+        for (std::size_t i = 2; i < Slice; i++)
+            next ^= Tables[Slice - 1 - i][buff[i]];
+        crc = next;
+        buff += Slice;
+        len -= Slice;
+    }
+    return crcBytewise(buff, len, crc);
+}
+
+#ifdef MB_CRC_CLMUL
+// x^n mod P
+constexpr uint16_t xPowModP(unsigned n) {
+    uint32_t r = 1;
+    while (n--) {
+        r <<= 1;
+        if (r & 0x10000)
+            r ^= Poly;
+    }
+    return static_cast<uint16_t>(r);
+}
+
+// Bit reflected 64 bit representation of polynomial with degree < 16
+constexpr uint64_t reflect64(uint16_t k) {
+    uint64_t r = 0;
+    for (int j = 0; j < 16; j++)
+        if (k & (1u << j))
+            r |= uint64_t(1) << (63 - j);
+    return r;
+}
+
+/*
+ * Folding constants. Low qword multiplies first 8 bytes of a 16 byte chunk,
+ * high qword the last 8. Exponents are reduced by one, as multiplication of
+ * reflected operands yields product shifted by one bit.
+ */
+constexpr uint64_t Fold128Lo = reflect64(xPowModP(128 + 64 - 1));
+constexpr uint64_t Fold128Hi = reflect64(xPowModP(128 - 1));
+constexpr uint64_t Fold512Lo = reflect64(xPowModP(512 + 64 - 1));
+constexpr uint64_t Fold512Hi = reflect64(xPowModP(512 - 1));
+
+__attribute__((target("pclmul,sse2"))) inline __m128i fold(__m128i x, __m128i k) {
+    return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00),
+                         _mm_clmulepi64_si128(x, k, 0x11));
+}
+
+__attribute__((target("pclmul,sse2"))) uint16_t
+crcClmul(const uint8_t *buff, std::size_t len, uint16_t crc) noexcept {
+    if (len < 64)
+        return crcSlicing<8>(buff, len, crc);
+
+    auto load = [](const uint8_t *p) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    };
+
+    // Initial register value is equivalent to xor with first two message bytes
+    __m128i x0 = _mm_xor_si128(load(buff), _mm_cvtsi32_si128(crc));
+    __m128i x1 = load(buff + 16);
+    __m128i x2 = load(buff + 32);
+    __m128i x3 = load(buff + 48);
+    buff += 64;
+    len -= 64;
+
+    const __m128i k512 = _mm_set_epi64x(static_cast<long long>(Fold512Hi),
+                                        static_cast<long long>(Fold512Lo));
+    while (len >= 64) {
+        x0 = _mm_xor_si128(fold(x0, k512), load(buff));
+        x1 = _mm_xor_si128(fold(x1, k512), load(buff + 16));
+        x2 = _mm_xor_si128(fold(x2, k512), load(buff + 32));
+        x3 = _mm_xor_si128(fold(x3, k512), load(buff + 48));
+        buff += 64;
+        len -= 64;
+    }
+
+    const __m128i k128 = _mm_set_epi64x(static_cast<long long>(Fold128Hi),
+                                        static_cast<long long>(Fold128Lo));
+    __m128i x = _mm_xor_si128(fold(x0, k128), x1);
+    x         = _mm_xor_si128(fold(x, k128), x2);
+    x         = _mm_xor_si128(fold(x, k128), x3);
+
+    while (len >= 16) {
+        x = _mm_xor_si128(fold(x, k128), load(buff));
+        buff += 16;
+        len -= 16;
+    }
+
+    // Remainder is congruent to everything folded so far, finish with tables
+    alignas(16) uint8_t rest[16];
+    _mm_store_si128(reinterpret_cast<__m128i *>(rest), x);
+    crc = crcSlicing<16>(rest, sizeof(rest), 0);
+    return crcSlicing<8>(buff, len, crc);
+}
+
+//! CPU features are checked once, crc16 dispatch runs per call
+bool clmulSupported() noexcept {
+    static const bool supported =
+        __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse2");
+    return supported;
+}
+#endif
+
+utils::CrcKernel selectKernel() noexcept {
+    if (isCrcKernelSupported(utils::CrcClmul))
+        return utils::CrcClmul;
+    return utils::CrcSlicing8;
+}
+
+// Below this size table kernels beat folding setup cost
+constexpr std::size_t ClmulThreshold = 64;
+} // namespace
+
+bool utils::isCrcKernelSupported(CrcKernel kernel) noexcept {
+    switch (kernel) {
+    case CrcReference:
+    case CrcSlicing8:
+    case CrcSlicing16:
+        return true;
+    case CrcClmul:
+#ifdef MB_CRC_CLMUL
+        return clmulSupported();
+#else
+        return false;
+#endif
+    default:
+        return false;
+    }
+}
+
+utils::CrcKernel utils::activeCrcKernel() noexcept {
+    static const CrcKernel kernel = selectKernel();
+    return kernel;
+}
+
+uint16_t utils::crc16(const uint8_t *buff, std::size_t len, uint16_t crc,
+                      CrcKernel kernel) noexcept {
+    switch (kernel) {
+    case CrcClmul:
+#ifdef MB_CRC_CLMUL
+        if (clmulSupported())
+            return crcClmul(buff, len, crc);
+#endif
+        [[fallthrough]];
+    case CrcSlicing8:
+        return crcSlicing<8>(buff, len, crc);
+    case CrcSlicing16:
+        return crcSlicing<16>(buff, len, crc);
+    case CrcReference:
+    default:
+        return crcBytewise(buff, len, crc);
+    }
+}
+
+uint16_t utils::crc16(const uint8_t *buff, std::size_t len, uint16_t crc) noexcept {
+    if (len < ClmulThreshold)
+        return crcSlicing<8>(buff, len, crc);
+    return crc16(buff, len, crc, activeCrcKernel());
+}
@@ -3,13 +3,19 @@
 // Licensed under: MIT License <http://opensource.org/licenses/MIT>
 
 #include "modbusException.hpp"
+#include "modbusCrc.hpp"
+#include "modbusFormat.hpp"
 
 using namespace MB;
 
 // Construct Modbus exception from raw data
 ModbusException::ModbusException(const std::vector<uint8_t> &inputData,
+                                 bool CRC) noexcept
+    : ModbusException(inputData.data(), inputData.size(), CRC) {}
+
+ModbusException::ModbusException(const uint8_t *inputData, std::size_t size,
                                  bool CRC) noexcept {
-    if (inputData.size() != ((CRC) ? 5 : 3)) {
+    if (size != ((CRC) ? 5 : 3)) {
         _slaveId      = 0xFF;
         _functionCode = utils::Undefined;
         _validSlave   = false;
@@ -23,39 +29,68 @@ ModbusException::ModbusException(const std::vector<uint8_t> &inputData,
     _errorCode    = static_cast<utils::MBErrorCode>(inputData[2]);
 
     if (CRC) {
-        auto CRC           = *reinterpret_cast<const uint16_t *>(&inputData[3]);
-        auto calculatedCRC = utils::calculateCRC(inputData.begin().base(), 3);
-
-        if (CRC != calculatedCRC) {
+        // Frame followed by its CRC leaves zero in CRC register
+        if (utils::crc16(inputData, 5) != 0) {
             _errorCode = utils::ErrorCodeCRCError;
         }
     }
 }
 
+Result<ModbusException> ModbusException::tryFromRaw(const uint8_t *data,
+                                                    std::size_t size,
+                                                    bool CRC) noexcept {
+    if (size != (CRC ? 5u : 3u) || !exist(data, size))
+        return utils::InvalidByteOrder;
+    if (CRC && utils::crc16(data, 5) != 0)
+        return utils::InvalidCRC;
+    return ModbusException(data, size, CRC);
+}
+
+const char *ModbusException::what() const noexcept {
+    thread_local char buffer[MaxStringSize + 1];
+    formatTo(buffer, sizeof(buffer));
+    return buffer;
+}
+
 // Returns string representation of exception
 std::string ModbusException::toString() const noexcept {
-    std::string res;
-    res += "Error on slave ";
+    char buffer[MaxStringSize + 1];
+    return std::string(buffer, formatTo(buffer, sizeof(buffer)));
+}
+
+std::size_t ModbusException::formatTo(char *buffer, std::size_t capacity) const noexcept {
+    utils::FormatBuffer out(buffer, capacity);
+    out << "Error on slave ";
     if (_validSlave)
-        res += std::to_string(_slaveId);
+        out << _slaveId;
     else
-        res += "Unknown";
-    res += " - ";
-    res += utils::mbErrorCodeToStr(_errorCode);
-    if (_functionCode != MB::utils::Undefined) {
-        res += " ( on function: ";
-        res += utils::mbFunctionToStr(_functionCode);
-        res += " )";
-    }
-    return res;
+        out << "Unknown";
+    out << " - " << utils::mbErrorCodeToStrView(_errorCode);
+    if (_functionCode != MB::utils::Undefined)
+        out << " ( on function: " << utils::mbFunctionToStrView(_functionCode) << " )";
+    return out.size();
 }
 
 std::vector<uint8_t> ModbusException::toRaw() const noexcept {
-    std::vector<uint8_t> result(3);
+    std::vector<uint8_t> result(encodedSize());
+    encodeInto(result.data(), result.size());
+    return result;
+}
 
-    result[0] = _slaveId;
-    result[1] = static_cast<uint8_t>(_errorCode | 0b10000000);
-    result[2] = static_cast<uint8_t>(_functionCode);
+std::size_t ModbusException::encodeInto(uint8_t *buffer,
+                                        std::size_t capacity) const noexcept {
+    if (capacity < encodedSize())
+        return 0;
 
-    return result;
+    buffer[0] = _slaveId;
+    buffer[1] = static_cast<uint8_t>(_functionCode | 0b10000000);
+    buffer[2] = static_cast<uint8_t>(_errorCode);
+
+    return encodedSize();
+}
+
+void ModbusException::appendTo(std::vector<uint8_t> &buffer) const {
+    const auto offset = buffer.size();
+    buffer.resize(offset + encodedSize());
+    encodeInto(buffer.data() + offset, encodedSize());
 }
@@ -0,0 +1,68 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusMbapFramer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace MB;
+
+MbapFramer::MbapFramer(std::size_t capacity) noexcept
+    : _capacity(std::max(capacity, MaxFrameSize)) {}
+
+uint8_t *MbapFramer::writable() {
+    if (_buffer.size() != _capacity)
+        _buffer.resize(_capacity);
+
+    if (_begin == _end) {
+        _begin = 0;
+        _end   = 0;
+    } else if (_buffer.size() - _end < MaxFrameSize && _begin > 0) {
+        const auto size = _end - _begin;
+        std::memmove(_buffer.data(), _buffer.data() + _begin, size);
+        _begin = 0;
+        _end   = size;
+    }
+
+    return _buffer.data() + _end;
+}
+
+std::size_t MbapFramer::feed(const uint8_t *data, std::size_t size) {
+    auto *dst       = writable();
+    const auto fits = std::min(size, writableSize());
+    std::memcpy(dst, data, fits);
+    commit(fits);
+    return fits;
+}
+
+bool MbapFramer::hasFrame() const noexcept {
+    if (pending() < MbapHeader::Size)
+        return false;
+
+    const auto header = MbapHeader::decode(_buffer.data() + _begin);
+    return pending() >= MbapHeader::Size + header.length;
+}
+
+std::optional<MbapFrame> MbapFramer::next() noexcept {
+    if (_invalid || pending() < MbapHeader::Size)
+        return std::nullopt;
+
+    const auto *data  = _buffer.data() + _begin;
+    const auto header = MbapHeader::decode(data);
+
+    // Length covers unit identifier and at least function code
+    if (header.protocolID != 0 || header.length < 2 ||
+        MbapHeader::Size + header.length > MaxFrameSize) {
+        _invalid = true;
+        return std::nullopt;
+    }
+
+    const std::size_t size = MbapHeader::Size + header.length;
+    if (pending() < size)
+        return std::nullopt;
+
+    _begin += size;
+    return MbapFrame{header, data, size};
+}
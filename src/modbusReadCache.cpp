@@ -0,0 +1,270 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusReadCache.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace MB;
+
+namespace {
+uint16_t tableKey(uint8_t unit, utils::MBFunctionCode table) noexcept {
+    return static_cast<uint16_t>(unit << 8 | table);
+}
+
+bool contains(uint32_t address, uint32_t count, const ModbusRequest &request) noexcept {
+    return address <= request.registerAddress() &&
+           request.registerAddress() + request.numberOfRegisters() <= address + count;
+}
+
+//! Checks if response carries `count` registers (coils) of the table
+bool complete(const ModbusResponse &response, utils::MBFunctionCode table,
+              uint16_t count) noexcept {
+    const auto size = utils::isCoilFunction(table) ? response.coils().size()
+                                                   : response.registers().size();
+    return size >= count;
+}
+
+//! Response to the request, cut out of response to the range at `address`
+ModbusResponse slice(const ModbusResponse &source, uint16_t address, uint16_t count,
+                     const ModbusRequest &request) {
+    if (address == request.registerAddress() && count == request.numberOfRegisters())
+        return source;
+
+    const auto offset = static_cast<std::size_t>(request.registerAddress() - address);
+    const auto size   = request.numberOfRegisters();
+    ModbusResponse response(request.slaveID(), request.functionCode(),
+                            request.registerAddress(), size);
+    if (utils::isCoilFunction(request.functionCode())) {
+        CoilBitset coils(size);
+        for (std::size_t i = 0; i < size; i++)
+            coils.set(i, source.coils().test(offset + i));
+        response.setCoils(coils);
+    } else {
+        RegisterBlock registers(size);
+        std::copy_n(source.registers().data() + offset, size, registers.data());
+        response.setRegisters(registers);
+    }
+    return response;
+}
+} // namespace
+
+ReadCache::ReadCache(Clock::duration ttl) : _ttls{ttl}, _maxTtl(ttl) {}
+
+ReadCache::TtlClass ReadCache::addClass(Clock::duration ttl) {
+    std::lock_guard lock(_mutex);
+    _ttls.push_back(ttl);
+    _maxTtl = std::max(_maxTtl, ttl);
+    return _ttls.size() - 1;
+}
+
+void ReadCache::setTtl(TtlClass ttl, Clock::duration duration) {
+    std::lock_guard lock(_mutex);
+    if (ttl >= _ttls.size())
+        MB_THROW(std::invalid_argument("Unknown TTL class " + std::to_string(ttl)));
+    _ttls[ttl] = duration;
+    _maxTtl    = *std::max_element(_ttls.begin(), _ttls.end());
+}
+
+ReadCache::Clock::duration ReadCache::ttl(TtlClass ttl) const {
+    std::lock_guard lock(_mutex);
+    if (ttl >= _ttls.size())
+        MB_THROW(std::invalid_argument("Unknown TTL class " + std::to_string(ttl)));
+    return _ttls[ttl];
+}
+
+bool ReadCache::cacheable(utils::MBFunctionCode functionCode) noexcept {
+    return utils::isReadFunction(functionCode);
+}
+
+ReadCache::Lookup ReadCache::begin(const std::string &endpoint,
+                                   const ModbusRequest &request, TtlClass ttl) {
+    std::lock_guard lock(_mutex);
+    if (ttl >= _ttls.size())
+        MB_THROW(std::invalid_argument("Unknown TTL class " + std::to_string(ttl)));
+
+    auto device = _devices.find(endpoint);
+    if (device == _devices.end())
+        device = _devices.emplace(endpoint, Device()).first;
+    auto &table = device->second[tableKey(request.slaveID(), request.functionCode())];
+
+    Lookup lookup;
+    const auto now = Clock::now();
+    for (const auto &entry : table.entries) {
+        if (now - entry.fetched <= _ttls[ttl] &&
+            contains(entry.address, entry.count, request)) {
+            _stats.hits++;
+            lookup.result = slice(entry.response, entry.address, entry.count, request);
+            return lookup;
+        }
+    }
+
+    for (const auto &flight : table.flights) {
+        if (contains(flight->address, flight->count, request)) {
+            _stats.shared++;
+            lookup.flight = flight;
+            return lookup;
+        }
+    }
+
+    _stats.misses++;
+    lookup.flight = std::make_shared<Flight>(request.registerAddress(),
+                                             request.numberOfRegisters());
+    lookup.owner  = true;
+    table.flights.push_back(lookup.flight);
+    return lookup;
+}
+
+void ReadCache::finish(const std::string &endpoint, const ModbusRequest &request,
+                       Flight &flight, const Result<ModbusResponse> &result) {
+    std::lock_guard lock(_mutex);
+    flight.result = result;
+    flight.done.notify_all();
+
+    // Stale flights were already removed, their device may be gone too
+    if (flight.stale)
+        return;
+    auto &table = _devices.find(endpoint)->second[tableKey(request.slaveID(),
+                                                           request.functionCode())];
+    table.flights.erase(
+        std::find_if(table.flights.begin(), table.flights.end(),
+                     [&](const auto &other) { return other.get() == &flight; }));
+    if (!result.ok() || !complete(result.value(), request.functionCode(), flight.count))
+        return;
+
+    // Drop expired ranges and ranges the new one contains
+    const auto now     = Clock::now();
+    const auto covered = [&](const Entry &entry) {
+        return now - entry.fetched > _maxTtl ||
+               (flight.address <= entry.address &&
+                entry.address + entry.count <= flight.address + flight.count);
+    };
+    auto &entries = table.entries;
+    entries.erase(std::remove_if(entries.begin(), entries.end(), covered), entries.end());
+    table.entries.push_back({flight.address, flight.count, now, result.value()});
+}
+
+Result<ModbusResponse> ReadCache::wait(Flight &flight, const ModbusRequest &request) {
+    std::unique_lock lock(_mutex);
+    flight.done.wait(lock, [&] { return flight.result.has_value(); });
+    lock.unlock();
+
+    // Result does not change once set
+    const auto &result = *flight.result;
+    if (!result.ok())
+        return result.error();
+    if (!complete(result.value(), request.functionCode(), flight.count))
+        return utils::ProtocolError;
+    return slice(result.value(), flight.address, flight.count, request);
+}
+
+void ReadCache::invalidateLocked(Device &device, uint8_t unit,
+                                 utils::MBFunctionCode table, uint32_t address,
+                                 uint32_t count) {
+    const auto it = device.find(tableKey(unit, table));
+    if (it == device.end())
+        return;
+    const auto overlaps = [&](uint32_t otherAddress, uint32_t otherCount) {
+        return otherAddress < address + count && address < otherAddress + otherCount;
+    };
+
+    auto &entries    = it->second.entries;
+    const auto valid = std::remove_if(entries.begin(), entries.end(), [&](const auto &e) {
+        return overlaps(e.address, e.count);
+    });
+    _stats.invalidations += static_cast<uint64_t>(entries.end() - valid);
+    entries.erase(valid, entries.end());
+
+    // Reads started after the write must not join reads started before it
+    auto &flights = it->second.flights;
+    flights.erase(std::remove_if(flights.begin(), flights.end(),
+                                 [&](const std::shared_ptr<Flight> &flight) {
+                                     if (!overlaps(flight->address, flight->count))
+                                         return false;
+                                     flight->stale = true;
+                                     return true;
+                                 }),
+                  flights.end());
+}
+
+void ReadCache::invalidate(const std::string &endpoint, uint8_t unit,
+                           utils::MBFunctionCode table, uint16_t address,
+                           uint16_t count) {
+    std::lock_guard lock(_mutex);
+    const auto device = _devices.find(endpoint);
+    if (device != _devices.end())
+        invalidateLocked(device->second, unit, table, address, count);
+}
+
+void ReadCache::invalidate(const std::string &endpoint, const ModbusRequest &request) {
+    auto table       = utils::ReadAnalogOutputHoldingRegisters;
+    uint32_t address = request.registerAddress();
+    uint32_t count   = 1;
+    switch (request.functionCode()) {
+    case utils::WriteSingleDiscreteOutputCoil:
+        table = utils::ReadDiscreteOutputCoils;
+        break;
+    case utils::WriteMultipleDiscreteOutputCoils:
+        table = utils::ReadDiscreteOutputCoils;
+        count = request.numberOfRegisters();
+        break;
+    case utils::WriteSingleAnalogOutputRegister:
+    case utils::MaskWriteRegister:
+        break;
+    case utils::WriteMultipleAnalogOutputHoldingRegisters:
+        count = request.numberOfRegisters();
+        break;
+    case utils::ReadWriteMultipleRegisters:
+        address = request.writeAddress();
+        count   = static_cast<uint32_t>(request.registers().size());
+        break;
+    default:
+        return;
+    }
+
+    std::lock_guard lock(_mutex);
+    const auto device = _devices.find(endpoint);
+    if (device != _devices.end())
+        invalidateLocked(device->second, request.slaveID(), table, address, count);
+}
+
+void ReadCache::invalidate(const std::string &endpoint) {
+    std::lock_guard lock(_mutex);
+    const auto device = _devices.find(endpoint);
+    if (device == _devices.end())
+        return;
+    for (auto &[key, table] : device->second) {
+        _stats.invalidations += table.entries.size();
+        for (auto &flight : table.flights)
+            flight->stale = true;
+    }
+    _devices.erase(device);
+}
+
+void ReadCache::clear() {
+    std::lock_guard lock(_mutex);
+    for (auto &[endpoint, device] : _devices) {
+        for (auto &[key, table] : device) {
+            _stats.invalidations += table.entries.size();
+            for (auto &flight : table.flights)
+                flight->stale = true;
+        }
+    }
+    _devices.clear();
+}
+
+ReadCache::Stats ReadCache::stats() const {
+    std::lock_guard lock(_mutex);
+    return _stats;
+}
+
+std::size_t ReadCache::size() const {
+    std::lock_guard lock(_mutex);
+    std::size_t size = 0;
+    for (const auto &[endpoint, device] : _devices)
+        for (const auto &[key, table] : device)
+            size += table.entries.size();
+    return size;
+}
@@ -0,0 +1,115 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusReadPlanner.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace MB;
+
+namespace {
+//! Largest read of the table, per device limit capped at protocol limit
+uint32_t maxRead(const ReadLimits &limits, bool coils) noexcept {
+    return coils ? std::min<uint32_t>(limits.maxCoils, CoilBitset::Capacity)
+                 : std::min<uint32_t>(limits.maxRegisters, RegisterBlock::Capacity);
+}
+} // namespace
+
+std::vector<ModbusRequest> ReadPlan::requests() const {
+    std::vector<ModbusRequest> requests;
+    requests.reserve(_reads.size());
+    for (const auto &read : _reads)
+        requests.push_back(read.request);
+    return requests;
+}
+
+const uint16_t *ReadPlan::registers(std::size_t point,
+                                    const ModbusResponse &response) const noexcept {
+    const auto &read = _reads[_readOfPoint[point]];
+    if (response.registers().size() < read.request.numberOfRegisters())
+        return nullptr;
+    return response.registers().data() + offsetOf(point);
+}
+
+bool ReadPlan::coil(std::size_t point, const ModbusResponse &response,
+                    std::size_t index) const noexcept {
+    const auto bit = offsetOf(point) + index;
+    return bit < response.coils().size() && response.coils().test(bit);
+}
+
+const ReadLimits &ReadPlanner::limits(uint8_t unit) const {
+    const auto it = _units.find(unit);
+    return it == _units.end() ? _defaults : it->second;
+}
+
+ReadPlan ReadPlanner::plan(const ReadPoint *points, std::size_t count) const {
+    for (std::size_t i = 0; i < count; i++) {
+        const auto &point = points[i];
+        const auto &limit = limits(point.unit);
+        const auto max    = maxRead(limit, utils::isCoilFunction(point.table));
+        if (!utils::isReadFunction(point.table) || point.count == 0 ||
+            point.count > max || point.address + point.count > 0x10000)
+            MB_THROW(std::invalid_argument("Point " + std::to_string(i) +
+                                           " can not be served by single read"));
+    }
+
+    // Points ordered by unit, table and address, sorted as packed keys with
+    // index of the point in the low 32 bits
+    std::vector<uint64_t> order(count);
+    for (std::size_t i = 0; i < count; i++) {
+        const auto &point = points[i];
+        order[i] = (uint64_t(point.unit) << 56) | (uint64_t(point.table) << 48) |
+                   (uint64_t(point.address) << 32) | i;
+    }
+    std::sort(order.begin(), order.end());
+    for (auto &key : order)
+        key &= 0xFFFFFFFF;
+
+    ReadPlan plan;
+    plan._members.reserve(count);
+    plan._readOfPoint.resize(count);
+    plan._memberOfPoint.resize(count);
+
+    std::size_t first = 0;
+    while (first < count) {
+        const auto &head   = points[order[first]];
+        const auto &limit  = limits(head.unit);
+        const bool coils   = utils::isCoilFunction(head.table);
+        const uint32_t max = maxRead(limit, coils);
+        const uint32_t gap = coils ? limit.coilGap : limit.registerGap;
+
+        // Extend the read while the next point fits, greedy is optimal here
+        const uint32_t start = head.address;
+        uint32_t end         = start + head.count;
+        std::size_t last     = first + 1;
+        for (; last < count; last++) {
+            const auto &next = points[order[last]];
+            if (next.unit != head.unit || next.table != head.table)
+                break;
+            const auto nextEnd = std::max<uint32_t>(end, next.address + next.count);
+            if ((next.address > end && next.address - end > gap) ||
+                nextEnd - start > max)
+                break;
+            end = nextEnd;
+        }
+
+        const auto read = plan._reads.size();
+        const auto members = plan._members.size();
+        plan._reads.push_back({ModbusRequest(head.unit, head.table,
+                                             static_cast<uint16_t>(start),
+                                             static_cast<uint16_t>(end - start)),
+                               members, members + last - first});
+        for (auto i = first; i < last; i++) {
+            const auto point           = static_cast<std::size_t>(order[i]);
+            plan._readOfPoint[point]   = read;
+            plan._memberOfPoint[point] = plan._members.size();
+            plan._members.push_back(
+                {point, static_cast<uint16_t>(points[point].address - start)});
+        }
+        first = last;
+    }
+
+    return plan;
+}
@@ -3,132 +3,200 @@
 // Licensed under: MIT License <http://opensource.org/licenses/MIT>
 
 #include "modbusRequest.hpp"
+#include "modbusFormat.hpp"
 #include "modbusUtils.hpp"
 
 #include <algorithm>
-#include <sstream>
 
 using namespace MB;
 
+namespace {
+uint8_t *putUint16(uint8_t *out, uint16_t value) {
+    *out++ = static_cast<uint8_t>(value >> 8);
+    *out++ = static_cast<uint8_t>(value & 0xFF);
+    return out;
+}
+} // namespace
+
 ModbusRequest::ModbusRequest(uint8_t slaveId, utils::MBFunctionCode functionCode,
                              uint16_t address, uint16_t registersNumber,
                              std::vector<ModbusCell> values) noexcept
     : _slaveID(slaveId), _functionCode(functionCode), _address(address),
-      _registersNumber(registersNumber), _values(std::move(values)) {
+      _registersNumber(registersNumber) {
     // Force proper modbuscell type
     switch (functionRegisters()) {
     case utils::OutputCoils:
     case utils::InputContacts:
-        std::for_each(_values.begin(), _values.end(),
-                      [](ModbusCell &cell) -> void { cell.coil(); });
-        break;
     case utils::HoldingRegisters:
     case utils::InputRegisters:
-        std::for_each(_values.begin(), _values.end(),
-                      [](ModbusCell &cell) -> void { cell.reg(); });
+    case utils::FileRecords:
+        setValues(values);
         break;
     }
 }
 
-ModbusRequest::ModbusRequest(const std::vector<uint8_t> &inputData, bool CRC) {
-    try {
-        if (inputData.size() < 3)
-            throw ModbusException(utils::InvalidByteOrder);
-
-        _slaveID      = inputData[0];
-        _functionCode = static_cast<utils::MBFunctionCode>(inputData[1]);
-        _address      = utils::bigEndianConv(&inputData[2]);
-
-        int crcIndex = -1;
-        int8_t follow;
-
-        switch (_functionCode) {
-        case utils::ReadDiscreteOutputCoils:
-        case utils::ReadDiscreteInputContacts:
-        case utils::ReadAnalogOutputHoldingRegisters:
-        case utils::ReadAnalogInputRegisters:
-            _registersNumber = utils::bigEndianConv(&inputData[4]);
-            _values          = {};
-            crcIndex         = 3 * 2;
-            break;
-        case utils::WriteSingleDiscreteOutputCoil:
-            _registersNumber = 1;
-            _values          = {ModbusCell::initCoil(inputData[4] == 0xFF)};
-            crcIndex         = 3 * 2;
-            break;
-        case utils::WriteSingleAnalogOutputRegister:
-            _registersNumber = 1;
-            _values          = {utils::bigEndianConv(&inputData[4])};
-            crcIndex         = 3 * 2;
-            break;
-        case utils::WriteMultipleDiscreteOutputCoils:
-            _registersNumber = utils::bigEndianConv(&inputData[4]);
-            follow           = inputData[6];
-            _values          = std::vector<ModbusCell>(_registersNumber);
-            for (int8_t i = 0; i < _registersNumber; i++) {
-                _values[i].coil() = inputData[7 + (i / 8)] & (1 << (i % 8));
-            }
-            crcIndex = 6 + follow + 1;
-            break;
-        case utils::WriteMultipleAnalogOutputHoldingRegisters:
-            _registersNumber = utils::bigEndianConv(&inputData[4]);
-            follow           = inputData[6];
-            _values          = std::vector<ModbusCell>(_registersNumber);
-            for (int8_t i = 0; i < _registersNumber; i++) {
-                _values[i].reg() = utils::bigEndianConv(&inputData[i * 2 + 7]);
-            }
-            crcIndex = 6 + follow + 1;
-            break;
-        default:
-            throw ModbusException(utils::InvalidByteOrder);
-        }
+ModbusRequest::ModbusRequest(const std::vector<uint8_t> &inputData, bool CRC)
+    : ModbusRequest(ModbusRequestView(inputData.data(), inputData.size(), CRC)) {}
+
+ModbusRequest::ModbusRequest(const ModbusRequestView &view)
+    : _slaveID(view.slaveID()), _functionCode(view.functionCode()),
+      _address(view.registerAddress()), _registersNumber(view.numberOfRegisters()) {
+    switch (functionType()) {
+    case utils::FileRead:
+        _fileNumber = view.fileNumber();
+        [[fallthrough]];
+    case utils::Read:
+        resizeValues(_registersNumber);
+        break;
+    case utils::ReadWrite:
+        _writeAddress = view.writeAddress();
+        _registers.assignBigEndian(view.payload(), view.numberOfWriteRegisters());
+        break;
+    case utils::MaskWrite:
+        _registers = {view.andMask(), view.orMask()};
+        break;
+    case utils::FileWrite:
+        _fileNumber = view.fileNumber();
+        _registers.assignBigEndian(view.payload(), _registersNumber);
+        break;
+    case utils::WriteSingle:
+        if (holdsCoils())
+            _coils = {view.payload()[0] == 0xFF};
+        else
+            _registers = {view.registerAt(0)};
+        break;
+    case utils::WriteMultiple:
+        if (holdsCoils())
+            _coils.assignPacked(view.payload(), _registersNumber);
+        else
+            _registers.assignBigEndian(view.payload(), _registersNumber);
+        break;
+    }
+}
 
-        _values.resize(_registersNumber);
+ModbusRequest ModbusRequest::readWriteMultiple(uint8_t slaveId, uint16_t readAddress,
+                                               uint16_t readCount, uint16_t writeAddress,
+                                               const RegisterBlock &values) noexcept {
+    ModbusRequest request(slaveId, utils::ReadWriteMultipleRegisters, readAddress,
+                          readCount);
+    request._writeAddress = writeAddress;
+    request._registers    = values;
+    return request;
+}
 
-        if (CRC) {
-            if (crcIndex == -1 || static_cast<size_t>(crcIndex) + 2 > inputData.size())
-                throw ModbusException(utils::InvalidByteOrder);
+ModbusRequest ModbusRequest::maskWrite(uint8_t slaveId, uint16_t address,
+                                       uint16_t andMask, uint16_t orMask) noexcept {
+    ModbusRequest request(slaveId, utils::MaskWriteRegister, address, 1);
+    request._registers = {andMask, orMask};
+    return request;
+}
 
-            auto recvCRC = *reinterpret_cast<const uint16_t *>(&inputData[crcIndex]);
-            auto myCRC   = utils::calculateCRC(inputData.begin().base(), crcIndex);
+ModbusRequest ModbusRequest::readFileRecord(uint8_t slaveId, uint16_t fileNumber,
+                                            uint16_t recordNumber,
+                                            uint16_t recordLength) noexcept {
+    ModbusRequest request(slaveId, utils::ReadFileRecord, recordNumber, recordLength);
+    request._fileNumber = fileNumber;
+    return request;
+}
 
-            if (recvCRC != myCRC) {
-                throw ModbusException(utils::InvalidCRC, _slaveID);
-            }
-        }
-    } catch (const ModbusException &ex) {
-        throw ex;
-    } catch (const std::exception &ex) {
-        throw ModbusException(utils::InvalidByteOrder);
+ModbusRequest ModbusRequest::writeFileRecord(uint8_t slaveId, uint16_t fileNumber,
+                                             uint16_t recordNumber,
+                                             const RegisterBlock &values) noexcept {
+    ModbusRequest request(slaveId, utils::WriteFileRecord, recordNumber,
+                          static_cast<uint16_t>(values.size()));
+    request._fileNumber = fileNumber;
+    request._registers  = values;
+    return request;
+}
+
+bool ModbusRequest::holdsCoils() const noexcept { return utils::isCoilFunction(_functionCode); }
+
+void ModbusRequest::resizeValues(std::size_t count) {
+    if (holdsCoils())
+        _coils.resize(std::min(count, CoilBitset::Capacity));
+    else
+        _registers.resize(std::min(count, RegisterBlock::Capacity));
+}
+
+void ModbusRequest::setFunctionCode(utils::MBFunctionCode functionCode) {
+    const bool wasCoils = holdsCoils();
+    _functionCode       = functionCode;
+
+    if (wasCoils && !holdsCoils()) {
+        _registers.resize(_coils.size());
+        for (std::size_t i = 0; i < _coils.size(); i++)
+            _registers[i] = _coils.test(i);
+    } else if (!wasCoils && holdsCoils()) {
+        _coils.resize(std::min(_registers.size(), CoilBitset::Capacity));
+        for (std::size_t i = 0; i < _coils.size(); i++)
+            _coils.set(i, _registers[i] != 0);
+    }
+}
+
+void ModbusRequest::setValues(const std::vector<ModbusCell> &values) {
+    if (holdsCoils()) {
+        const auto count = std::min(values.size(), CoilBitset::Capacity);
+        bool coils[CoilBitset::Capacity];
+        for (std::size_t i = 0; i < count; i++)
+            coils[i] = values[i].isCoil() ? values[i].coil() : values[i].reg() != 0;
+        _coils.assign(coils, count);
+    } else {
+        _registers.resize(std::min(values.size(), RegisterBlock::Capacity));
+        for (std::size_t i = 0; i < _registers.size(); i++)
+            _registers[i] = values[i].isReg() ? values[i].reg() : values[i].coil();
     }
 }
 
 std::string ModbusRequest::toString() const noexcept {
-    std::stringstream result;
-
-    result << utils::mbFunctionToStr(_functionCode)
-           << ", from slave " + std::to_string(_slaveID);
-
-    if (functionType() != utils::WriteSingle) {
-        result << ", starting from address " + std::to_string(_address)
-               << ", on " + std::to_string(_registersNumber) + " registers";
-        if (functionType() == utils::WriteMultiple) {
-            result << "\n values = { ";
-            for (std::size_t i = 0; i < _values.size(); i++) {
-                result << _values[i].toString() + " , ";
-                if (i >= 3) {
-                    result << " , ... ";
-                    break;
-                }
+    char buffer[MaxStringSize + 1];
+    return std::string(buffer, formatTo(buffer, sizeof(buffer)));
+}
+
+std::size_t ModbusRequest::formatTo(char *buffer, std::size_t capacity) const noexcept {
+    utils::FormatBuffer result(buffer, capacity);
+
+    result << utils::mbFunctionToStrView(_functionCode) << ", from slave " << _slaveID;
+
+    const auto values = registerValues();
+
+    switch (functionType()) {
+    case utils::WriteSingle:
+        result << ", starting from address " << _address << "\nvalue = ";
+        values.front().formatTo(result);
+        return result.size();
+    case utils::MaskWrite:
+        result << ", on address " << _address << "\nand mask = " << andMask()
+               << ", or mask = " << orMask();
+        return result.size();
+    case utils::FileRead:
+    case utils::FileWrite:
+        result << ", file " << _fileNumber << ", record " << _address << ", on "
+               << _registersNumber << " registers";
+        break;
+    default:
+        result << ", starting from address " << _address << ", on " << _registersNumber
+               << " registers";
+        if (functionType() == utils::ReadWrite)
+            result << ", writing " << _registers.size() << " registers from address "
+                   << _writeAddress;
+        break;
+    }
+
+    if (functionType() == utils::WriteMultiple || functionType() == utils::ReadWrite ||
+        functionType() == utils::FileWrite) {
+        result << "\n values = { ";
+        for (std::size_t i = 0; i < values.size(); i++) {
+            values[i].formatTo(result);
+            result << " , ";
+            if (i >= 3) {
+                result << " , ... ";
+                break;
             }
-            result << "}";
         }
-    } else {
-        result << ", starting from address " + std::to_string(_address)
-               << "\nvalue = " + (*_values.begin()).toString();
+        result << "}";
     }
 
-    return result.str();
+    return result.size();
 }
 
 int MB::getNumBytesFromDataType(MB::DataType type) {
@@ -154,46 +222,97 @@ int MB::getNumBytesFromDataType(MB::DataType type) {
 }
 
 std::vector<uint8_t> ModbusRequest::toRaw() const noexcept {
-    std::vector<uint8_t> result;
-    result.reserve(6);
-
-    result.push_back(_slaveID);
-    result.push_back(_functionCode);
-    utils::pushUint16(result, _address);
+    std::vector<uint8_t> result(encodedSize());
+    encodeInto(result.data(), result.size());
+    return result;
+}
 
-    if (functionType() != utils::WriteSingle) {
-        utils::pushUint16(result, _registersNumber);
+std::size_t ModbusRequest::encodedSize() const {
+    switch (functionType()) {
+    case utils::WriteMultiple:
+        return 7 + (holdsCoils() ? _coils.byteSize() : _registers.size() * 2);
+    case utils::ReadWrite:
+        return 11 + _registers.size() * 2;
+    case utils::MaskWrite:
+        return 8;
+    case utils::FileRead:
+        return 10;
+    case utils::FileWrite:
+        return 10 + _registers.size() * 2;
+    default:
+        return 6;
     }
+}
 
-    if (_functionCode == utils::WriteMultipleAnalogOutputHoldingRegisters) {
-        result.push_back(numberOfRegisters() * 2);
-    } else if (_functionCode == utils::WriteMultipleDiscreteOutputCoils) {
-        result.push_back((_registersNumber / 8) + (_registersNumber % 8 == 0 ? 0 : 1));
-    }
+std::size_t ModbusRequest::encodeInto(uint8_t *buffer, std::size_t capacity) const {
+    const auto size = encodedSize();
+    if (capacity < size)
+        return 0;
 
-    if (functionType() == utils::WriteMultiple) {
-        if (_values[0].isReg()) {
-            for (auto value : _values) {
-                utils::pushUint16(result, value.reg());
-            }
+    auto *out = buffer;
+    *out++    = _slaveID;
+    *out++    = _functionCode;
+
+    switch (functionType()) {
+    case utils::Read:
+        out = putUint16(out, _address);
+        putUint16(out, _registersNumber);
+        break;
+    case utils::WriteSingle:
+        out = putUint16(out, _address);
+        if (!holdsCoils()) {
+            putUint16(out, _registers[0]);
         } else {
-            int end = result.size() - 1;
-            for (std::size_t i = 0; i < _values.size(); i++) {
-                if (i % 8 == 0) {
-                    result.push_back(0x00);
-                    end++;
-                }
-                result[end] |= _values[i].coil() << (i % 8);
-            }
+            out[0] = _coils.test(0) ? 0xFF : 0x00;
+            out[1] = 0x00;
         }
-    } else if (functionType() == utils::WriteSingle) {
-        if (_values[0].isReg()) {
-            utils::pushUint16(result, _values[0].reg());
+        break;
+    case utils::WriteMultiple:
+        out = putUint16(out, _address);
+        out = putUint16(out, _registersNumber);
+        if (!holdsCoils()) {
+            *out++ = static_cast<uint8_t>(numberOfRegisters() * 2);
+            _registers.copyBigEndian(out);
         } else {
-            result.push_back(_values[0].coil() ? 0xFF : 0x00);
-            result.push_back(0x00);
+            *out++ = (_registersNumber / 8) + (_registersNumber % 8 == 0 ? 0 : 1);
+            std::copy(_coils.data(), _coils.data() + _coils.byteSize(), out);
         }
+        break;
+    case utils::ReadWrite:
+        out    = putUint16(out, _address);
+        out    = putUint16(out, _registersNumber);
+        out    = putUint16(out, _writeAddress);
+        out    = putUint16(out, static_cast<uint16_t>(_registers.size()));
+        *out++ = static_cast<uint8_t>(_registers.size() * 2);
+        _registers.copyBigEndian(out);
+        break;
+    case utils::MaskWrite:
+        out = putUint16(out, _address);
+        out = putUint16(out, _registers[0]);
+        putUint16(out, _registers[1]);
+        break;
+    case utils::FileRead:
+    case utils::FileWrite: {
+        const bool write  = functionType() == utils::FileWrite;
+        const auto length = write ? _registers.size() : _registersNumber;
+
+        *out++ = static_cast<uint8_t>(7 + (write ? length * 2 : 0));
+        *out++ = utils::FileRecordReferenceType;
+        out    = putUint16(out, _fileNumber);
+        out    = putUint16(out, _address);
+        out    = putUint16(out, static_cast<uint16_t>(length));
+        if (write)
+            _registers.copyBigEndian(out);
+        break;
+    }
     }
 
-    return result;
+    return size;
+}
+
+void ModbusRequest::appendTo(std::vector<uint8_t> &buffer) const {
+    const auto offset = buffer.size();
+    const auto size   = encodedSize();
+    buffer.resize(offset + size);
+    encodeInto(buffer.data() + offset, size);
 }
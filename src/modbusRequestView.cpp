@@ -0,0 +1,201 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusRequestView.hpp"
+#include "modbusCoilBitset.hpp"
+#include "modbusCrc.hpp"
+#include "modbusRegisterBlock.hpp"
+
+#include <array>
+
+using namespace MB;
+
+namespace {
+//! Fields decoded from function specific part of the request
+struct RequestFields {
+    uint16_t address         = 0;
+    uint16_t registersNumber = 0;
+    const uint8_t *payload   = nullptr;
+    uint8_t payloadSize      = 0;
+    //! Zero if frame is malformed or truncated
+    std::size_t crcIndex  = 0;
+    uint16_t writeAddress = 0;
+    uint16_t fileNumber   = 0;
+};
+
+using RequestDecoder = RequestFields (*)(const uint8_t *data, std::size_t size);
+
+RequestFields decodeRead(const uint8_t *data, std::size_t) {
+    return {utils::bigEndianConv(&data[2]), utils::bigEndianConv(&data[4]), nullptr, 0,
+            6};
+}
+
+RequestFields decodeWriteSingle(const uint8_t *data, std::size_t) {
+    return {utils::bigEndianConv(&data[2]), 1, &data[4], 2, 6};
+}
+
+template <std::size_t Capacity, std::size_t BitsPerValue>
+RequestFields decodeWriteMultiple(const uint8_t *data, std::size_t size) {
+    if (size < 7)
+        return {};
+    const auto registersNumber = utils::bigEndianConv(&data[4]);
+    const uint8_t follow       = data[6];
+    if (registersNumber > Capacity || follow < (registersNumber * BitsPerValue + 7) / 8 ||
+        size < 7u + follow)
+        return {};
+    return {utils::bigEndianConv(&data[2]), registersNumber, &data[7], follow,
+            7u + follow};
+}
+
+// Read address, read count, write address, write count, byte count, values
+RequestFields decodeReadWrite(const uint8_t *data, std::size_t size) {
+    if (size < 11)
+        return {};
+    const auto readNumber  = utils::bigEndianConv(&data[4]);
+    const auto writeNumber = utils::bigEndianConv(&data[8]);
+    const uint8_t follow   = data[10];
+    if (readNumber == 0 || readNumber > RegisterBlock::Capacity || writeNumber == 0 ||
+        writeNumber > utils::MaxReadWriteWriteCount || follow != writeNumber * 2 ||
+        size < 11u + follow)
+        return {};
+    return {utils::bigEndianConv(&data[2]),
+            readNumber,
+            &data[11],
+            follow,
+            11u + follow,
+            utils::bigEndianConv(&data[6])};
+}
+
+// Address, AND mask, OR mask
+RequestFields decodeMaskWrite(const uint8_t *data, std::size_t size) {
+    if (size < 8)
+        return {};
+    return {utils::bigEndianConv(&data[2]), 1, &data[4], 4, 8};
+}
+
+// Byte count, single group: reference type, file, record, record length
+RequestFields decodeFileRead(const uint8_t *data, std::size_t size) {
+    if (size < 10 || data[2] != 7 || data[3] != utils::FileRecordReferenceType)
+        return {};
+    const auto recordLength = utils::bigEndianConv(&data[8]);
+    if (recordLength == 0 || recordLength > RegisterBlock::Capacity)
+        return {};
+    return {utils::bigEndianConv(&data[6]), recordLength, nullptr, 0, 10, 0,
+            utils::bigEndianConv(&data[4])};
+}
+
+// Same as read, followed by record data
+RequestFields decodeFileWrite(const uint8_t *data, std::size_t size) {
+    if (size < 10 || data[3] != utils::FileRecordReferenceType)
+        return {};
+    const auto recordLength = utils::bigEndianConv(&data[8]);
+    const uint8_t follow    = data[2];
+    if (recordLength == 0 || recordLength > RegisterBlock::Capacity ||
+        follow != 7 + recordLength * 2 || size < 3u + follow)
+        return {};
+    return {utils::bigEndianConv(&data[6]),
+            recordLength,
+            &data[10],
+            static_cast<uint8_t>(recordLength * 2),
+            3u + follow,
+            0,
+            utils::bigEndianConv(&data[4])};
+}
+
+//! Decoder for every function code byte, generated from function traits
+constexpr std::array<RequestDecoder, 256> makeRequestDecoders() {
+    std::array<RequestDecoder, 256> decoders{};
+    for (std::size_t code = 0; code < decoders.size(); code++) {
+        const auto &traits = utils::FunctionTraitsTable[code];
+        if (!traits.defined)
+            continue;
+        switch (traits.type) {
+        case utils::Read:
+            decoders[code] = decodeRead;
+            break;
+        case utils::WriteSingle:
+            decoders[code] = decodeWriteSingle;
+            break;
+        case utils::WriteMultiple:
+            if (traits.coils)
+                decoders[code] = decodeWriteMultiple<CoilBitset::Capacity, 1>;
+            else
+                decoders[code] = decodeWriteMultiple<RegisterBlock::Capacity, 16>;
+            break;
+        case utils::ReadWrite:
+            decoders[code] = decodeReadWrite;
+            break;
+        case utils::MaskWrite:
+            decoders[code] = decodeMaskWrite;
+            break;
+        case utils::FileRead:
+            decoders[code] = decodeFileRead;
+            break;
+        case utils::FileWrite:
+            decoders[code] = decodeFileWrite;
+            break;
+        }
+    }
+    return decoders;
+}
+
+constexpr std::array<RequestDecoder, 256> RequestDecoders = makeRequestDecoders();
+} // namespace
+
+ModbusRequestView::ModbusRequestView(const uint8_t *data, std::size_t size, bool CRC) {
+    const auto status = parse(data, size, CRC);
+    if (!status)
+        MB_THROW(ModbusException(status.error(), status.error() == utils::InvalidCRC
+                                                     ? _slaveID
+                                                     : uint8_t(0xFF)));
+}
+
+Result<ModbusRequestView> ModbusRequestView::tryParse(const uint8_t *data,
+                                                      std::size_t size,
+                                                      bool CRC) noexcept {
+    ModbusRequestView view;
+    const auto status = view.parse(data, size, CRC);
+    if (!status)
+        return status.error();
+    return view;
+}
+
+Status ModbusRequestView::parse(const uint8_t *data, std::size_t size,
+                                bool CRC) noexcept {
+    if (size < 6)
+        return utils::InvalidByteOrder;
+
+    _data         = data;
+    _slaveID      = data[0];
+    _functionCode = static_cast<utils::MBFunctionCode>(data[1]);
+
+    const auto decoder = RequestDecoders[_functionCode];
+    if (decoder == nullptr)
+        return utils::InvalidByteOrder;
+
+    const auto fields   = decoder(data, size);
+    const auto crcIndex = fields.crcIndex;
+    if (crcIndex == 0)
+        return utils::InvalidByteOrder;
+
+    _address         = fields.address;
+    _registersNumber = fields.registersNumber;
+    _payload         = fields.payload;
+    _payloadSize     = fields.payloadSize;
+    _writeAddress    = fields.writeAddress;
+    _fileNumber      = fields.fileNumber;
+    _size            = crcIndex;
+
+    if (CRC) {
+        if (size < crcIndex + 2)
+            return utils::InvalidByteOrder;
+
+        const uint16_t recvCRC = data[crcIndex] | (data[crcIndex + 1] << 8);
+        if (recvCRC != utils::crc16(data, crcIndex))
+            return utils::InvalidCRC;
+
+        _size += 2;
+    }
+    return {};
+}
@@ -3,190 +3,264 @@
 // Licensed under: MIT License <http://opensource.org/licenses/MIT>
 
 #include "modbusResponse.hpp"
+#include "modbusFormat.hpp"
 #include "modbusUtils.hpp"
 
 #include <algorithm>
-#include <sstream>
 
 using namespace MB;
 
+namespace {
+uint8_t *putUint16(uint8_t *out, uint16_t value) {
+    *out++ = static_cast<uint8_t>(value >> 8);
+    *out++ = static_cast<uint8_t>(value & 0xFF);
+    return out;
+}
+} // namespace
+
 ModbusResponse::ModbusResponse(uint8_t slaveId, utils::MBFunctionCode functionCode,
                                uint16_t address, uint16_t registersNumber,
                                std::vector<ModbusCell> values)
     : _slaveID(slaveId), _functionCode(functionCode), _address(address),
-      _registersNumber(registersNumber), _values(std::move(values)) {
+      _registersNumber(registersNumber) {
     // Force proper modbuscell type
     switch (functionRegisters()) {
     case utils::OutputCoils:
     case utils::InputContacts:
-        std::for_each(_values.begin(), _values.end(),
-                      [](ModbusCell &cell) -> void { cell.coil(); });
-        break;
     case utils::HoldingRegisters:
     case utils::InputRegisters:
-        std::for_each(_values.begin(), _values.end(),
-                      [](ModbusCell &cell) -> void { cell.reg(); });
+    case utils::FileRecords:
+        setValues(values);
         break;
     }
 }
 
-ModbusResponse::ModbusResponse(std::vector<uint8_t> inputData, bool CRC) {
-    try {
-        if (inputData.size() < 3)
-            throw ModbusException(utils::InvalidByteOrder);
-
-        _slaveID      = inputData[0];
-        _functionCode = static_cast<utils::MBFunctionCode>(inputData[1]);
+ModbusResponse::ModbusResponse(const std::vector<uint8_t> &inputData, bool CRC)
+    : ModbusResponse(ModbusResponseView(inputData.data(), inputData.size(), CRC)) {}
 
-        if (functionType() != utils::Read)
-            _address = utils::bigEndianConv(&inputData[2]);
-
-        int crcIndex = -1;
-        uint8_t bytes;
+ModbusResponse::ModbusResponse(const ModbusResponseView &view)
+    : _slaveID(view.slaveID()), _functionCode(view.functionCode()),
+      _address(view.registerAddress()), _registersNumber(view.numberOfRegisters()) {
+    switch (functionType()) {
+    case utils::FileWrite:
+        _fileNumber = view.fileNumber();
+        [[fallthrough]];
+    case utils::FileRead:
+    case utils::ReadWrite:
+        _registers.assignBigEndian(view.payload(), _registersNumber);
+        break;
+    case utils::MaskWrite:
+        _registers = {view.andMask(), view.orMask()};
+        break;
+    case utils::Read:
+        if (holdsCoils())
+            _coils.assignPacked(view.payload(), _registersNumber);
+        else
+            _registers.assignBigEndian(view.payload(), _registersNumber);
+        break;
+    case utils::WriteSingle:
+        if (holdsCoils())
+            _coils = {view.payload()[0] == 0xFF};
+        else
+            _registers = {view.registerAt(0)};
+        break;
+    case utils::WriteMultiple:
+        resizeValues(_registersNumber);
+        break;
+    }
+}
 
-        switch (_functionCode) {
-        case utils::ReadDiscreteOutputCoils:
-        case utils::ReadDiscreteInputContacts:
-            bytes            = inputData[2];
-            _registersNumber = bytes * 8;
-            _values          = std::vector<ModbusCell>(_registersNumber);
-            for (auto i = 0; i < _registersNumber; i++) {
-                _values[i].coil() = inputData[3 + (i / 8)] & (1 << (i % 8));
-            }
-            crcIndex = 2 + bytes + 1;
-            break;
-        case utils::ReadAnalogOutputHoldingRegisters:
-        case utils::ReadAnalogInputRegisters:
-            bytes            = inputData[2];
-            _registersNumber = bytes / 2;
-            for (auto i = 0; i < bytes / 2; i++) {
-                _values.emplace_back(utils::bigEndianConv(&inputData[3 + (i * 2)]));
-            }
-            crcIndex = 2 + bytes + 1;
-            break;
-        case utils::WriteSingleDiscreteOutputCoil:
-            _registersNumber = 1;
-            _address         = utils::bigEndianConv(&inputData[2]);
-            _values          = {ModbusCell::initCoil(inputData[4] == 0xFF)};
-            crcIndex         = 6;
-            break;
-        case utils::WriteSingleAnalogOutputRegister:
-            _registersNumber = 1;
-            _address         = utils::bigEndianConv(&inputData[2]);
-            _values          = {ModbusCell::initReg(utils::bigEndianConv(&inputData[4]))};
-            crcIndex         = 6;
-            break;
-        case utils::WriteMultipleDiscreteOutputCoils:
-        case utils::WriteMultipleAnalogOutputHoldingRegisters:
-            _address         = utils::bigEndianConv(&inputData[2]);
-            _registersNumber = utils::bigEndianConv(&inputData[4]);
-            crcIndex         = 6;
-            break;
-        default:
-            throw ModbusException(utils::InvalidByteOrder);
-        }
+bool ModbusResponse::holdsCoils() const noexcept {
+    return utils::isCoilFunction(_functionCode);
+}
 
-        _values.resize(_registersNumber);
+void ModbusResponse::resizeValues(std::size_t count) {
+    if (holdsCoils())
+        _coils.resize(std::min(count, CoilBitset::Capacity));
+    else
+        _registers.resize(std::min(count, RegisterBlock::Capacity));
+}
 
-        if (CRC) {
-            if (crcIndex == -1 || static_cast<size_t>(crcIndex) + 2 > inputData.size())
-                throw ModbusException(utils::InvalidByteOrder);
+void ModbusResponse::setFunctionCode(utils::MBFunctionCode functionCode) {
+    const bool wasCoils = holdsCoils();
+    _functionCode       = functionCode;
 
-            auto recievedCRC = *reinterpret_cast<const uint16_t *>(&inputData[crcIndex]);
-            auto myCRC       = utils::calculateCRC(inputData.begin().base(), crcIndex);
+    if (wasCoils && !holdsCoils()) {
+        _registers.resize(std::min(_coils.size(), RegisterBlock::Capacity));
+        for (std::size_t i = 0; i < _registers.size(); i++)
+            _registers[i] = _coils.test(i);
+    } else if (!wasCoils && holdsCoils()) {
+        _coils.resize(_registers.size());
+        for (std::size_t i = 0; i < _coils.size(); i++)
+            _coils.set(i, _registers[i] != 0);
+    }
+}
 
-            if (recievedCRC != myCRC) {
-                throw ModbusException(utils::InvalidCRC, _slaveID);
-            }
-        }
-    } catch (const ModbusException &ex) {
-        throw ex;
-    } catch (const std::exception &ex) {
-        throw ModbusException(utils::InvalidByteOrder);
+void ModbusResponse::setValues(const std::vector<ModbusCell> &values) {
+    if (holdsCoils()) {
+        const auto count = std::min(values.size(), CoilBitset::Capacity);
+        bool coils[CoilBitset::Capacity];
+        for (std::size_t i = 0; i < count; i++)
+            coils[i] = values[i].isCoil() ? values[i].coil() : values[i].reg() != 0;
+        _coils.assign(coils, count);
+    } else {
+        _registers.resize(std::min(values.size(), RegisterBlock::Capacity));
+        for (std::size_t i = 0; i < _registers.size(); i++)
+            _registers[i] = values[i].isReg() ? values[i].reg() : values[i].coil();
     }
 }
 
 std::string ModbusResponse::toString() const {
-    std::stringstream result;
-
-    result << utils::mbFunctionToStr(_functionCode)
-           << ", from slave " + std::to_string(_slaveID);
-
-    if (functionType() != utils::WriteSingle) {
-        result << ", starting from address " + std::to_string(_address)
-               << ", on " + std::to_string(_registersNumber) + " registers";
-        if (functionType() == utils::WriteMultiple) {
-            result << "\n values = { ";
-            for (decltype(_values)::size_type i = 0; i < _values.size(); i++) {
-                result << _values[i].toString() + " , ";
-                if (i >= 3) {
-                    result << " , ... ";
-                    break;
-                }
+    char buffer[MaxStringSize + 1];
+    return std::string(buffer, formatTo(buffer, sizeof(buffer)));
+}
+
+std::size_t ModbusResponse::formatTo(char *buffer, std::size_t capacity) const noexcept {
+    utils::FormatBuffer result(buffer, capacity);
+
+    result << utils::mbFunctionToStrView(_functionCode) << ", from slave " << _slaveID;
+
+    const auto values = registerValues();
+
+    switch (functionType()) {
+    case utils::WriteSingle:
+        result << ", starting from address " << _address << "\nvalue = ";
+        values.front().formatTo(result);
+        return result.size();
+    case utils::MaskWrite:
+        result << ", on address " << _address << "\nand mask = " << andMask()
+               << ", or mask = " << orMask();
+        return result.size();
+    case utils::FileWrite:
+        result << ", file " << _fileNumber << ", record " << _address << ", on "
+               << _registersNumber << " registers";
+        break;
+    default:
+        result << ", starting from address " << _address << ", on " << _registersNumber
+               << " registers";
+        break;
+    }
+
+    if (functionType() == utils::WriteMultiple || functionType() == utils::FileWrite) {
+        result << "\n values = { ";
+        for (std::size_t i = 0; i < values.size(); i++) {
+            values[i].formatTo(result);
+            result << " , ";
+            if (i >= 3) {
+                result << " , ... ";
+                break;
             }
-            result << "}";
         }
-    } else {
-        result << ", starting from address " + std::to_string(_address)
-               << "\nvalue = " + (*_values.begin()).toString();
+        result << "}";
     }
 
-    return result.str();
+    return result.size();
 }
 
 std::vector<uint8_t> ModbusResponse::toRaw() const {
-    std::vector<uint8_t> result;
-    result.reserve(6);
-
-    result.push_back(_slaveID);
-    result.push_back(_functionCode);
-
-    if (functionType() == utils::Read) {
-        if (_values[0].isCoil()) {
-            result.push_back(
-                (_registersNumber / 8) +
-                (_registersNumber % 8 == 0 ? 0 : 1)); // number of bytes to follow
-            auto end = result.size() - 1;
-            for (std::size_t i = 0; i < _values.size(); i++) {
-                if (i % 8 == 0) {
-                    result.push_back(0x00);
-                    end++;
-                }
-                result[end] |= _values[i].coil() << (i % 8);
-            }
+    std::vector<uint8_t> result(encodedSize());
+    encodeInto(result.data(), result.size());
+    return result;
+}
+
+std::size_t ModbusResponse::encodedSize() const {
+    switch (functionType()) {
+    case utils::Read:
+    case utils::ReadWrite:
+        return 3 + (holdsCoils() ? _coils.byteSize() : _registers.size() * 2);
+    case utils::MaskWrite:
+        return 8;
+    case utils::FileRead:
+        return 5 + _registers.size() * 2;
+    case utils::FileWrite:
+        return 10 + _registers.size() * 2;
+    default:
+        return 6;
+    }
+}
+
+std::size_t ModbusResponse::encodeInto(uint8_t *buffer, std::size_t capacity) const {
+    const auto size = encodedSize();
+    if (capacity < size)
+        return 0;
+
+    auto *out = buffer;
+    *out++    = _slaveID;
+    *out++    = _functionCode;
+
+    switch (functionType()) {
+    case utils::Read:
+    case utils::ReadWrite:
+        if (holdsCoils()) {
+            // number of bytes to follow
+            *out++ = (_registersNumber / 8) + (_registersNumber % 8 == 0 ? 0 : 1);
+            std::copy(_coils.data(), _coils.data() + _coils.byteSize(), out);
         } else {
-            result.push_back(_registersNumber * 2); // number of bytes to follow
-            for (auto _value : _values) {
-                utils::pushUint16(result, _value.reg());
-            }
+            *out++ = static_cast<uint8_t>(_registersNumber * 2); // number of bytes to follow
+            _registers.copyBigEndian(out);
         }
-    } else {
-        utils::pushUint16(result, _address);
-
-        if (functionType() == utils::WriteSingle) {
-            if (_values[0].isCoil()) {
-                result.push_back(_values[0].coil() ? 0xFF : 0x00);
-                result.push_back(0x00);
-            } else {
-                utils::pushUint16(result, _values[0].reg());
-            }
+        break;
+    case utils::WriteSingle:
+        out = putUint16(out, _address);
+        if (holdsCoils()) {
+            out[0] = _coils.test(0) ? 0xFF : 0x00;
+            out[1] = 0x00;
         } else {
-            utils::pushUint16(result, _registersNumber);
+            putUint16(out, _registers[0]);
         }
+        break;
+    case utils::WriteMultiple:
+        out = putUint16(out, _address);
+        putUint16(out, _registersNumber);
+        break;
+    case utils::MaskWrite:
+        out = putUint16(out, _address);
+        out = putUint16(out, _registers[0]);
+        putUint16(out, _registers[1]);
+        break;
+    case utils::FileRead:
+        *out++ = static_cast<uint8_t>(2 + _registers.size() * 2);
+        *out++ = static_cast<uint8_t>(1 + _registers.size() * 2);
+        *out++ = utils::FileRecordReferenceType;
+        _registers.copyBigEndian(out);
+        break;
+    case utils::FileWrite:
+        *out++ = static_cast<uint8_t>(7 + _registers.size() * 2);
+        *out++ = utils::FileRecordReferenceType;
+        out    = putUint16(out, _fileNumber);
+        out    = putUint16(out, _address);
+        out    = putUint16(out, static_cast<uint16_t>(_registers.size()));
+        _registers.copyBigEndian(out);
+        break;
     }
 
-    return result;
+    return size;
+}
+
+void ModbusResponse::appendTo(std::vector<uint8_t> &buffer) const {
+    const auto offset = buffer.size();
+    const auto size   = encodedSize();
+    buffer.resize(offset + size);
+    encodeInto(buffer.data() + offset, size);
 }
 
 void ModbusResponse::from(const ModbusRequest &req) {
-    if (functionType() == utils::Read) {
+    if (functionType() == utils::MaskWrite || functionType() == utils::FileWrite) {
+        // Echo of the request
+        _address         = req.registerAddress();
+        _fileNumber      = req.fileNumber();
+        _registersNumber = req.numberOfRegisters();
+        _registers       = req.registers();
+    } else if (functionType() == utils::Read || functionType() == utils::ReadWrite ||
+               functionType() == utils::FileRead) {
         _address = req.registerAddress();
         if (_registersNumber > req.numberOfRegisters()) {
             _registersNumber = req.numberOfRegisters();
-            _values.resize(req.numberOfRegisters());
+            resizeValues(req.numberOfRegisters());
         }
     } else if (functionType() == utils::WriteMultiple) {
-        _values = req.registerValues();
-        _values.resize(_registersNumber);
+        _registers = req.registers();
+        _coils     = req.coils();
+        resizeValues(_registersNumber);
     }
 }
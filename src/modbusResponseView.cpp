@@ -0,0 +1,180 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusResponseView.hpp"
+#include "modbusCoilBitset.hpp"
+#include "modbusCrc.hpp"
+#include "modbusRegisterBlock.hpp"
+
+#include <array>
+
+using namespace MB;
+
+namespace {
+//! Fields decoded from function specific part of the response
+struct ResponseFields {
+    uint16_t address         = 0;
+    uint16_t registersNumber = 0;
+    const uint8_t *payload   = nullptr;
+    uint8_t payloadSize      = 0;
+    //! Zero if frame is malformed or truncated
+    std::size_t crcIndex = 0;
+    uint16_t fileNumber  = 0;
+};
+
+using ResponseDecoder = ResponseFields (*)(const uint8_t *data, std::size_t size);
+
+template <std::size_t ByteCapacity, std::size_t BitsPerValue>
+ResponseFields decodeRead(const uint8_t *data, std::size_t size) {
+    const uint8_t bytes = data[2];
+    if (bytes > ByteCapacity || size < 3u + bytes)
+        return {};
+    const auto registersNumber = static_cast<uint16_t>(bytes * 8 / BitsPerValue);
+    return {0, registersNumber, &data[3], bytes, 3u + bytes};
+}
+
+ResponseFields decodeWriteSingle(const uint8_t *data, std::size_t size) {
+    if (size < 6)
+        return {};
+    return {utils::bigEndianConv(&data[2]), 1, &data[4], 2, 6};
+}
+
+ResponseFields decodeWriteMultiple(const uint8_t *data, std::size_t size) {
+    if (size < 6)
+        return {};
+    return {utils::bigEndianConv(&data[2]), utils::bigEndianConv(&data[4]), nullptr, 0,
+            6};
+}
+
+// Address, AND mask, OR mask - echo of the request
+ResponseFields decodeMaskWrite(const uint8_t *data, std::size_t size) {
+    if (size < 8)
+        return {};
+    return {utils::bigEndianConv(&data[2]), 1, &data[4], 4, 8};
+}
+
+// Data length, single group: group length, reference type, record data
+ResponseFields decodeFileRead(const uint8_t *data, std::size_t size) {
+    if (size < 5)
+        return {};
+    const uint8_t follow      = data[2];
+    const uint8_t groupLength = data[3];
+    if (data[4] != utils::FileRecordReferenceType || follow != groupLength + 1 ||
+        groupLength % 2 == 0 || size < 3u + follow)
+        return {};
+    const auto recordLength = static_cast<uint16_t>(groupLength / 2);
+    if (recordLength == 0 || recordLength > RegisterBlock::Capacity)
+        return {};
+    return {0, recordLength, &data[5], static_cast<uint8_t>(groupLength - 1),
+            3u + follow};
+}
+
+// Echo of the request: byte count, reference type, file, record, length, data
+ResponseFields decodeFileWrite(const uint8_t *data, std::size_t size) {
+    if (size < 10 || data[3] != utils::FileRecordReferenceType)
+        return {};
+    const auto recordLength = utils::bigEndianConv(&data[8]);
+    const uint8_t follow    = data[2];
+    if (recordLength == 0 || recordLength > RegisterBlock::Capacity ||
+        follow != 7 + recordLength * 2 || size < 3u + follow)
+        return {};
+    return {utils::bigEndianConv(&data[6]),
+            recordLength,
+            &data[10],
+            static_cast<uint8_t>(recordLength * 2),
+            3u + follow,
+            utils::bigEndianConv(&data[4])};
+}
+
+//! Decoder for every function code byte, generated from function traits
+constexpr std::array<ResponseDecoder, 256> makeResponseDecoders() {
+    std::array<ResponseDecoder, 256> decoders{};
+    for (std::size_t code = 0; code < decoders.size(); code++) {
+        const auto &traits = utils::FunctionTraitsTable[code];
+        if (!traits.defined)
+            continue;
+        switch (traits.type) {
+        case utils::Read:
+        case utils::ReadWrite:
+            decoders[code] = traits.coils ? decodeRead<CoilBitset::ByteCapacity, 1>
+                                          : decodeRead<RegisterBlock::Capacity * 2, 16>;
+            break;
+        case utils::WriteSingle:
+            decoders[code] = decodeWriteSingle;
+            break;
+        case utils::WriteMultiple:
+            decoders[code] = decodeWriteMultiple;
+            break;
+        case utils::MaskWrite:
+            decoders[code] = decodeMaskWrite;
+            break;
+        case utils::FileRead:
+            decoders[code] = decodeFileRead;
+            break;
+        case utils::FileWrite:
+            decoders[code] = decodeFileWrite;
+            break;
+        }
+    }
+    return decoders;
+}
+
+constexpr std::array<ResponseDecoder, 256> ResponseDecoders = makeResponseDecoders();
+} // namespace
+
+ModbusResponseView::ModbusResponseView(const uint8_t *data, std::size_t size, bool CRC) {
+    const auto status = parse(data, size, CRC);
+    if (!status)
+        MB_THROW(ModbusException(status.error(), status.error() == utils::InvalidCRC
+                                                     ? _slaveID
+                                                     : uint8_t(0xFF)));
+}
+
+Result<ModbusResponseView> ModbusResponseView::tryParse(const uint8_t *data,
+                                                        std::size_t size,
+                                                        bool CRC) noexcept {
+    ModbusResponseView view;
+    const auto status = view.parse(data, size, CRC);
+    if (!status)
+        return status.error();
+    return view;
+}
+
+Status ModbusResponseView::parse(const uint8_t *data, std::size_t size,
+                                 bool CRC) noexcept {
+    if (size < 3)
+        return utils::InvalidByteOrder;
+
+    _data         = data;
+    _slaveID      = data[0];
+    _functionCode = static_cast<utils::MBFunctionCode>(data[1]);
+
+    const auto decoder = ResponseDecoders[_functionCode];
+    if (decoder == nullptr)
+        return utils::InvalidByteOrder;
+
+    const auto fields   = decoder(data, size);
+    const auto crcIndex = fields.crcIndex;
+    if (crcIndex == 0)
+        return utils::InvalidByteOrder;
+
+    _address         = fields.address;
+    _registersNumber = fields.registersNumber;
+    _payload         = fields.payload;
+    _payloadSize     = fields.payloadSize;
+    _fileNumber      = fields.fileNumber;
+    _size            = crcIndex;
+
+    if (CRC) {
+        if (size < crcIndex + 2)
+            return utils::InvalidByteOrder;
+
+        const uint16_t recvCRC = data[crcIndex] | (data[crcIndex + 1] << 8);
+        if (recvCRC != utils::crc16(data, crcIndex))
+            return utils::InvalidCRC;
+
+        _size += 2;
+    }
+    return {};
+}
@@ -0,0 +1,80 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusRtuFramer.hpp"
+#include "modbusUtils.hpp"
+
+#include <cstring>
+
+using namespace MB;
+
+std::size_t RtuFramer::predictFrameSize(Direction direction, const uint8_t *header,
+                                        std::size_t size) noexcept {
+    if (size < 2)
+        return NeedMoreData;
+
+    // Exception: slave id, function code | 0x80, error code, CRC
+    if (direction == Responses && (header[1] & 0x80))
+        return 5;
+
+    const auto code    = static_cast<utils::MBFunctionCode>(header[1]);
+    const auto &traits = utils::functionTraits(code);
+    if (!traits.defined)
+        return InvalidFrame;
+
+    std::size_t byteCountIndex;
+    switch (traits.type) {
+    case utils::Read:
+        // Request: slave, function, address, count, CRC
+        // Response: slave, function, byte count, data, CRC
+        if (direction == Requests)
+            return 8;
+        byteCountIndex = 2;
+        break;
+    case utils::WriteSingle:
+        // Slave, function, address, value, CRC - same in both directions
+        return 8;
+    case utils::WriteMultiple:
+        // Request: slave, function, address, count, byte count, data, CRC
+        // Response: slave, function, address, count, CRC
+        if (direction == Responses)
+            return 8;
+        byteCountIndex = 6;
+        break;
+    case utils::ReadWrite:
+        // Request: slave, function, read address / count, write address /
+        // count, byte count, data, CRC. Response is the same as for read
+        byteCountIndex = direction == Requests ? 10 : 2;
+        break;
+    case utils::MaskWrite:
+        // Slave, function, address, AND mask, OR mask, CRC - same in both directions
+        return 10;
+    case utils::FileRead:
+    case utils::FileWrite:
+        // Slave, function, byte count, record groups, CRC
+        byteCountIndex = 2;
+        break;
+    default:
+        return InvalidFrame;
+    }
+
+    if (size <= byteCountIndex)
+        return NeedMoreData;
+
+    const std::size_t frameSize = byteCountIndex + 1 + header[byteCountIndex] + 2;
+    return frameSize <= MaxFrameSize ? frameSize : InvalidFrame;
+}
+
+void RtuFramer::resync() noexcept {
+    // Not yet scanned replay bytes follow current frame in the stream
+    const auto held      = _size - 1;
+    const auto remaining = _replaySize - _replayPos;
+    std::memmove(_replay.data() + held, _replay.data() + _replayPos, remaining);
+    std::memcpy(_replay.data(), _buffer.data() + 1, held);
+    _replaySize = held + remaining;
+    _replayPos  = 0;
+
+    _discardedBytes++;
+    reset();
+}
@@ -0,0 +1,125 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "modbusTrace.hpp"
+#include "modbusFormat.hpp"
+#include "modbusUtils.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+
+using namespace MB;
+
+namespace {
+std::atomic<uint64_t> nextSinkId{1};
+
+// Rings of the sinks recently used by this thread, avoid lookup under the
+// lock. Sink ids are never reused, so entries of destroyed sinks never match.
+struct LocalRing {
+    uint64_t sinkId = 0;
+    TraceRing *ring = nullptr;
+};
+constexpr std::size_t LocalRingCount = 8;
+struct LocalRings {
+    std::array<LocalRing, LocalRingCount> rings;
+    std::size_t next = 0;
+};
+thread_local LocalRings localRings;
+
+std::size_t roundUpToPowerOfTwo(std::size_t value) noexcept {
+    std::size_t result = 1;
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+} // namespace
+
+std::size_t MB::formatTo(const TraceRecord &record, char *buffer,
+                         std::size_t capacity) noexcept {
+    utils::FormatBuffer out(buffer, capacity);
+
+    // Seconds with nanosecond fraction
+    auto fraction = record.timestamp % 1000000000;
+    char digits[9];
+    for (int i = 8; i >= 0; i--) {
+        digits[i] = static_cast<char>('0' + fraction % 10);
+        fraction /= 10;
+    }
+    out << record.timestamp / 1000000000 << '.' << std::string_view(digits, 9);
+
+    out << (record.direction == TraceDirection::Tx ? " TX" : " RX") << " slave "
+        << record.slaveId << ' ';
+    const auto code = static_cast<utils::MBFunctionCode>(record.functionCode & 0x7F);
+    if (record.functionCode & 0x80)
+        out << "exception on ";
+    out << utils::mbFunctionToStrView(code) << " [" << record.size << "] ";
+    out.hex(record.data, record.captured);
+    if (record.captured < record.size)
+        out << " ...";
+
+    return out.size();
+}
+
+std::string MB::toString(const TraceRecord &record) {
+    char buffer[MaxTraceStringSize + 1];
+    return std::string(buffer, formatTo(record, buffer, sizeof(buffer)));
+}
+
+TraceRing::TraceRing(std::size_t capacity)
+    : _mask(roundUpToPowerOfTwo(std::max<std::size_t>(capacity, 2)) - 1),
+      _records(new TraceRecord[_mask + 1]) {}
+
+TraceSink::TraceSink(std::size_t ringCapacity)
+    : _ringCapacity(ringCapacity), _id(nextSinkId.fetch_add(1)) {}
+
+TraceRing &TraceSink::localRing() {
+    auto &cache = ::localRings;
+    for (const auto &cached : cache.rings)
+        if (cached.sinkId == _id)
+            return *cached.ring;
+
+    std::lock_guard lock(_mutex);
+    const auto self = std::this_thread::get_id();
+    auto it         = std::find_if(_rings.begin(), _rings.end(),
+                                   [&](const auto &ring) { return ring.first == self; });
+    if (it == _rings.end()) {
+        _rings.emplace_back(self, std::make_unique<TraceRing>(_ringCapacity));
+        it = std::prev(_rings.end());
+    }
+
+    // Replaces the oldest entry once all are taken
+    cache.rings[cache.next] = {_id, it->second.get()};
+    cache.next              = (cache.next + 1) % LocalRingCount;
+    return *it->second;
+}
+
+void TraceSink::record(TraceDirection direction, const uint8_t *frame,
+                       std::size_t size) noexcept {
+    auto &ring  = localRing();
+    auto *entry = ring.claim();
+    if (!entry)
+        return;
+
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    entry->timestamp =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+    entry->size         = static_cast<uint16_t>(size);
+    entry->direction    = direction;
+    entry->slaveId      = size > 0 ? frame[0] : 0;
+    entry->functionCode = size > 1 ? frame[1] : 0;
+    entry->captured =
+        static_cast<uint8_t>(std::min<std::size_t>(size, TraceRecord::MaxCaptured));
+    std::memcpy(entry->data, frame, entry->captured);
+    ring.publish();
+}
+
+uint64_t TraceSink::dropped() const {
+    std::lock_guard lock(_mutex);
+    uint64_t dropped = 0;
+    for (const auto &ring : _rings)
+        dropped += ring.second->dropped();
+    return dropped;
+}
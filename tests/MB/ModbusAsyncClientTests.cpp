@@ -0,0 +1,156 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "../simulatedDevice.hpp"
+#include "MB/Async/tcpClient.hpp"
+#include "MB/TCP/server.hpp"
+#include "gtest/gtest.h"
+
+#include <sys/socket.h>
+#include <thread>
+
+using namespace MB;
+using namespace std::chrono_literals;
+
+namespace {
+//! Runs loop until `done` returns true or a second passes
+template <typename Done> bool runUntil(Async::EventLoop &loop, Done &&done) {
+    const auto deadline = std::chrono::steady_clock::now() + 1s;
+    while (!done() && std::chrono::steady_clock::now() < deadline)
+        loop.runOnce(10);
+    return done();
+}
+} // namespace
+
+TEST(ModbusAsync, EventLoopTimersAndTasks) {
+    Async::EventLoop loop;
+    std::vector<int> order;
+
+    const auto now = Async::EventLoop::Clock::now();
+    loop.schedule(now + 2ms, [&] { order.push_back(2); });
+    loop.schedule(now + 1ms, [&] { order.push_back(1); });
+    const auto cancelled = loop.schedule(now + 1ms, [&] { order.push_back(-1); });
+    loop.cancel(cancelled);
+    loop.schedule(now + 3ms, [&] {
+        order.push_back(3);
+        loop.stop();
+    });
+
+    std::thread other([&] { loop.post([&] { order.push_back(0); }); });
+    other.join();
+    loop.run();
+
+    EXPECT_EQ((std::vector<int>{0, 1, 2, 3}), order);
+}
+
+TEST(ModbusAsync, OutOfOrderResponsesWithinWindow) {
+    Async::TcpClient client(0);
+    int fds[2];
+    ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    auto &session = client.adopt(fds[0], {.window = 3});
+    TCP::Connection server(fds[1]);
+
+    std::vector<std::pair<uint16_t, Result<ModbusResponse>>> results;
+    for (uint16_t address = 0; address < 5; address++)
+        session.submit(test::readHolding(address), [&results, address](auto response) {
+            results.emplace_back(address, std::move(response));
+        });
+    client.loop().runOnce(0);
+    EXPECT_EQ(3u, session.inFlight());
+    EXPECT_EQ(2u, session.queued());
+
+    // Device answers first window in reverse order
+    std::vector<std::pair<uint16_t, ModbusRequest>> received;
+    for (int i = 0; i < 3; i++) {
+        auto request = server.tryAwaitRequest();
+        ASSERT_TRUE(request);
+        received.emplace_back(server.getMessageId(), request.value());
+    }
+    for (auto it = received.rbegin(); it != received.rend(); it++) {
+        server.setMessageId(it->first);
+        server.sendResponse(test::answer(it->second));
+    }
+
+    std::thread device([&server] { test::serve(server); });
+    ASSERT_TRUE(runUntil(client.loop(), [&] { return results.size() == 5; }));
+    ::shutdown(fds[1], SHUT_RDWR);
+    device.join();
+
+    const std::vector<uint16_t> order = {2, 1, 0, 3, 4};
+    for (std::size_t i = 0; i < order.size(); i++) {
+        EXPECT_EQ(order[i], results[i].first);
+        ASSERT_TRUE(results[i].second);
+        EXPECT_EQ(order[i], results[i].second->registers()[0]);
+    }
+}
+
+TEST(ModbusAsync, FuturesAcrossThreads) {
+    TCP::Server server(0);
+    sockaddr_in address{};
+    socklen_t size = sizeof(address);
+    ::getsockname(server.nativeHandle(), reinterpret_cast<sockaddr *>(&address), &size);
+
+    std::thread device([&server] {
+        auto connection = server.awaitConnection();
+        if (connection)
+            test::serve(*connection);
+    });
+
+    {
+        Async::TcpClient client(2);
+        auto &session = client.connect("127.0.0.1", ntohs(address.sin_port));
+
+        // Submitted before connect completes, sent once connected
+        std::vector<std::future<Result<ModbusResponse>>> futures;
+        for (uint16_t i = 0; i < 20; i++)
+            futures.push_back(session.submit(test::readHolding(i)));
+
+        for (uint16_t i = 0; i < 20; i++) {
+            auto response = futures[i].get();
+            ASSERT_TRUE(response) << response.error();
+            EXPECT_EQ(i, response->registers()[0]);
+        }
+        EXPECT_EQ(Async::TcpSession::State::Connected, session.state());
+
+        client.close(session);
+        const auto deadline = std::chrono::steady_clock::now() + 1s;
+        while (client.sessions() != 0 && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(1ms);
+        EXPECT_EQ(0u, client.sessions());
+    }
+    device.join();
+}
+
+TEST(ModbusAsync, TimeoutAndConnectionLoss) {
+    Async::TcpClient client(0);
+    int fds[2];
+    ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    auto &session = client.adopt(fds[0], {.window = 1, .timeout = 20ms});
+    TCP::Connection server(fds[1]);
+
+    std::vector<Result<ModbusResponse>> results;
+    const auto collect = [&results](auto response) { results.push_back(response); };
+    session.submit(test::readHolding(1), collect);
+    session.submit(test::readHolding(2), collect);
+    session.submit(test::readHolding(3), collect);
+
+    // First request is never answered, second one is answered and third
+    // one is lost together with the connection
+    ASSERT_TRUE(runUntil(client.loop(), [&] { return results.size() == 1; }));
+    EXPECT_EQ(utils::Timeout, results[0].error());
+
+    ASSERT_TRUE(server.tryAwaitRequest());
+    auto second = server.tryAwaitRequest();
+    ASSERT_TRUE(second);
+    server.sendResponse(test::answer(second.value()));
+    ASSERT_TRUE(runUntil(client.loop(), [&] { return results.size() == 2; }));
+    ASSERT_TRUE(results[1]);
+    EXPECT_EQ(2, results[1]->registers()[0]);
+
+    ASSERT_TRUE(server.tryAwaitRequest());
+    ::shutdown(fds[1], SHUT_RDWR);
+    ASSERT_TRUE(runUntil(client.loop(), [&] { return results.size() == 3; }));
+    EXPECT_EQ(utils::ConnectionClosed, results[2].error());
+    EXPECT_EQ(Async::TcpSession::State::Closed, session.state());
+}
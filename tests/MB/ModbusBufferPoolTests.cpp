@@ -0,0 +1,137 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "../allocCounter.hpp"
+#include "MB/Serial/connection.hpp"
+#include "MB/TCP/connection.hpp"
+#include "MB/modbusBufferPool.hpp"
+#include "gtest/gtest.h"
+
+#include <array>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/socket.h>
+
+using namespace MB;
+using MB::test::AllocationCounter;
+
+TEST(ModbusBufferPool, AcquireAndRelease) {
+    FrameBufferPool pool(100);
+    EXPECT_EQ(128u, pool.bufferSize());
+    EXPECT_EQ(0u, pool.allocated());
+
+    {
+        auto first  = pool.acquire();
+        auto second = pool.acquire();
+        ASSERT_TRUE(first);
+        ASSERT_TRUE(second);
+        EXPECT_NE(first.data(), second.data());
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(first.data()) % 64);
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(second.data()) % 64);
+        EXPECT_EQ(FrameBufferPool::SlabBuffers, pool.allocated());
+        EXPECT_EQ(FrameBufferPool::SlabBuffers - 2, pool.available());
+
+        const uint8_t frame[] = {0x11, 0x03, 0x00, 0x6B};
+        EXPECT_TRUE(first.assign(frame, sizeof(frame)));
+        EXPECT_EQ(4u, first.size());
+        EXPECT_EQ(0x6B, first[3]);
+        EXPECT_FALSE(first.resize(129));
+        EXPECT_EQ(4u, first.size());
+
+        // Moved from handle does not return the buffer twice
+        auto moved = std::move(second);
+        EXPECT_FALSE(second);
+        EXPECT_TRUE(moved);
+    }
+    EXPECT_EQ(FrameBufferPool::SlabBuffers, pool.available());
+}
+
+TEST(ModbusBufferPool, NoAllocationsAfterReserve) {
+    FrameBufferPool pool;
+    pool.reserve(40);
+    EXPECT_LE(40u, pool.available());
+
+    AllocationCounter counter;
+    for (int i = 0; i < 1000; i++) {
+        std::array<FrameBuffer, 40> buffers;
+        for (auto &buffer : buffers)
+            buffer = pool.acquire();
+    }
+    EXPECT_EQ(0u, counter.count());
+}
+
+TEST(ModbusBufferPool, TcpSteadyStateDoesNotAllocate) {
+    int fds[2];
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    TCP::Connection client(fds[0]);
+    TCP::Connection server(fds[1]);
+
+    const ModbusRequest request(1, utils::ReadAnalogOutputHoldingRegisters, 0, 10);
+    RegisterBlock registers;
+    registers.resize(10);
+
+    const auto poll = [&] {
+        client.sendRequest(request);
+        auto received = server.tryAwaitRequest();
+        ASSERT_TRUE(received) << received.error();
+
+        ModbusResponse response(1, utils::ReadAnalogOutputHoldingRegisters, 0, 10);
+        response.setRegisters(registers);
+        server.sendResponse(response);
+
+        const auto answer = client.tryAwaitResponse();
+        ASSERT_TRUE(answer) << answer.error();
+        EXPECT_EQ(10, answer->numberOfRegisters());
+    };
+
+    // Warm up, buffers of both connections grow to their final size
+    poll();
+
+    AllocationCounter counter;
+    for (int i = 0; i < 100; i++)
+        poll();
+    EXPECT_EQ(0u, counter.count());
+}
+
+TEST(ModbusBufferPool, SerialSteadyStateDoesNotAllocate) {
+    const int master = ::posix_openpt(O_RDWR | O_NOCTTY);
+    ASSERT_GE(master, 0);
+    ASSERT_EQ(0, ::grantpt(master));
+    ASSERT_EQ(0, ::unlockpt(master));
+
+    Serial::Connection slave(::ptsname(master));
+    slave.connect();
+
+    FrameBufferPool pool;
+    pool.reserve(1);
+
+    const uint8_t request[] = {0x11, 0x03, 0x00, 0x6B, 0x00, 0x03, 0x76, 0x87};
+    std::array<uint8_t, 64> answer{};
+
+    const auto poll = [&] {
+        ASSERT_EQ(long(sizeof(request)), ::write(master, request, sizeof(request)));
+
+        auto raw      = pool.acquire();
+        auto received = slave.tryAwaitRequest(raw);
+        ASSERT_TRUE(received) << received.error();
+        ASSERT_EQ(sizeof(request), raw.size());
+        EXPECT_EQ(0, std::memcmp(request, raw.data(), raw.size()));
+
+        ModbusResponse response(received->slaveID(), received->functionCode(),
+                                received->registerAddress(),
+                                received->numberOfRegisters());
+        response.setRegisters(received->registers());
+        const auto &sent = slave.sendResponse(response);
+        ASSERT_EQ(long(sent.size()), ::read(master, answer.data(), answer.size()));
+    };
+
+    poll();
+
+    AllocationCounter counter;
+    for (int i = 0; i < 20; i++)
+        poll();
+    EXPECT_EQ(0u, counter.count());
+
+    ::close(master);
+}
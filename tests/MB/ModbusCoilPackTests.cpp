@@ -0,0 +1,116 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusCellView.hpp"
+#include "MB/modbusCoilPack.hpp"
+#include "MB/modbusResponse.hpp"
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <random>
+
+using namespace MB;
+
+namespace {
+std::vector<uint8_t> randomBytes(std::size_t size) {
+    std::mt19937 gen(1234);
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::vector<uint8_t> data(size);
+    for (auto &byte : data)
+        byte = static_cast<uint8_t>(dist(gen));
+    return data;
+}
+
+const utils::CoilKernel Kernels[] = {utils::CoilScalar, utils::CoilSse2, utils::CoilBmi2};
+} // namespace
+
+TEST(ModbusCoilPack, KnownValues) {
+    const uint8_t packed[] = {0xCD, 0x6B, 0x05};
+    uint8_t values[19];
+    utils::unpackCoils(packed, 19, values);
+    const uint8_t expected[] = {1, 0, 1, 1, 0, 0, 1, 1, 1, 1, 0, 1, 0, 1, 1, 0, 1, 0, 1};
+    EXPECT_EQ(0, std::memcmp(expected, values, sizeof(values)));
+
+    uint8_t repacked[3] = {0xFF, 0xFF, 0xFF};
+    utils::packCoils(values, 19, repacked);
+    EXPECT_EQ(0xCD, repacked[0]);
+    EXPECT_EQ(0x6B, repacked[1]);
+    EXPECT_EQ(0x05, repacked[2]);
+}
+
+// Every kernel and length must match the scalar kernel, pack treats any non
+// zero byte as ON coil and clears unused bits of the last byte
+TEST(ModbusCoilPack, KernelsMatchScalar) {
+    const auto packed = randomBytes(CoilBitset::ByteCapacity);
+    auto bytes        = randomBytes(CoilBitset::Capacity);
+    for (std::size_t i = 0; i < bytes.size(); i += 3)
+        bytes[i] = 0;
+
+    for (auto kernel : Kernels) {
+        if (!utils::isCoilKernelSupported(kernel))
+            continue;
+        for (std::size_t count = 0; count <= 300; count++) {
+            std::vector<uint8_t> expected(count), result(count);
+            utils::unpackCoils(packed.data(), count, expected.data(), utils::CoilScalar);
+            utils::unpackCoils(packed.data(), count, result.data(), kernel);
+            ASSERT_EQ(expected, result) << "kernel " << int(kernel) << " count " << count;
+
+            std::vector<uint8_t> expectedPacked((count + 7) / 8, 0xAA);
+            std::vector<uint8_t> resultPacked((count + 7) / 8, 0x55);
+            utils::packCoils(bytes.data(), count, expectedPacked.data(),
+                             utils::CoilScalar);
+            utils::packCoils(bytes.data(), count, resultPacked.data(), kernel);
+            ASSERT_EQ(expectedPacked, resultPacked)
+                << "kernel " << int(kernel) << " count " << count;
+            for (std::size_t i = 0; i < count; i++)
+                ASSERT_EQ(bytes[i] != 0, (resultPacked[i / 8] >> (i % 8)) & 1);
+            if (count % 8 != 0) {
+                EXPECT_EQ(0, resultPacked.back() >> (count % 8));
+            }
+        }
+    }
+}
+
+TEST(ModbusCoilPack, CoilBitsetRoundTrip) {
+    bool values[37];
+    for (std::size_t i = 0; i < 37; i++)
+        values[i] = i % 3 == 0;
+
+    CoilBitset coils(100, true);
+    coils.assign(values, 37);
+    EXPECT_EQ(37u, coils.size());
+    EXPECT_EQ(0, coils.data()[5]);
+    for (std::size_t i = 0; i < 37; i++)
+        EXPECT_EQ(values[i], coils.test(i));
+
+    bool copy[37];
+    coils.copyTo(copy);
+    EXPECT_EQ(0, std::memcmp(values, copy, sizeof(values)));
+
+    const CoilBitset list = {true, false, false, true, false};
+    EXPECT_EQ(5u, list.size());
+    EXPECT_EQ(0x09, list.data()[0]);
+}
+
+TEST(ModbusCoilPack, CellPathsUseKernels) {
+    std::vector<ModbusCell> cells;
+    for (uint16_t i = 0; i < 21; i++)
+        cells.push_back(i % 2 == 0 ? ModbusCell::initCoil(true)
+                                   : ModbusCell::initReg(i % 3));
+
+    ModbusResponse response(0x11, utils::ReadDiscreteOutputCoils);
+    response.setValues(cells);
+    const std::vector<ModbusCell> unpacked = response.registerValues();
+    ASSERT_EQ(cells.size(), unpacked.size());
+    for (std::size_t i = 0; i < cells.size(); i++)
+        EXPECT_EQ(cells[i].isCoil() ? cells[i].coil() : cells[i].reg() != 0,
+                  unpacked[i].coil());
+
+    const auto raw  = response.toRaw();
+    const auto view = ModbusResponseView::fromRaw(raw);
+    bool fromView[21];
+    view.copyCoils(fromView, 21);
+    for (std::size_t i = 0; i < 21; i++)
+        EXPECT_EQ(unpacked[i].coil(), fromView[i]);
+}
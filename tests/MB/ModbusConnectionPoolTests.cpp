@@ -0,0 +1,287 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/TCP/connectionPool.hpp"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+using namespace MB;
+using namespace std::chrono_literals;
+
+namespace {
+ModbusRequest readRequest(uint8_t unit, uint16_t address) {
+    return ModbusRequest(unit, utils::ReadAnalogOutputHoldingRegisters, address, 2);
+}
+
+//! Listening socket on loopback, port 0 picks free port
+int listenOn(int port) {
+    const auto sock = ::socket(AF_INET, SOCK_STREAM, 0);
+    int reuse       = 1;
+    ::setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address = {.sin_family = AF_INET,
+                           .sin_port   = htons(port),
+                           .sin_addr   = {inet_addr("127.0.0.1")},
+                           .sin_zero   = {}};
+    ::bind(sock, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+    ::listen(sock, 64);
+    return sock;
+}
+
+int portOf(int sock) {
+    sockaddr_in address = {};
+    socklen_t size      = sizeof(address);
+    ::getsockname(sock, reinterpret_cast<sockaddr *>(&address), &size);
+    return ntohs(address.sin_port);
+}
+
+/**
+ * Gateway answering reads with registers {marker, address} after `delay`,
+ * every connection is served by its own thread.
+ */
+class FakeGateway {
+  private:
+    int _fd;
+    uint16_t _marker;
+    std::chrono::milliseconds _delay;
+
+    std::mutex _mutex;
+    std::vector<int> _sessionFds;
+    std::vector<std::thread> _sessions;
+    std::atomic<int> _connections{0};
+    std::atomic<int> _maxConnections{0};
+    std::atomic<int> _accepted{0};
+    std::thread _acceptor;
+
+    void serve(int sockfd) {
+        TCP::Connection connection(sockfd);
+        while (true) {
+            auto request = connection.tryAwaitRequest();
+            if (!request)
+                break;
+            std::this_thread::sleep_for(_delay);
+
+            ModbusResponse response(request->slaveID(), request->functionCode(),
+                                    request->registerAddress(), 2);
+            response.setRegisters({_marker, request->registerAddress()});
+            connection.sendResponse(response);
+        }
+        _connections--;
+    }
+
+  public:
+    explicit FakeGateway(uint16_t marker, std::chrono::milliseconds delay = 0ms,
+                         int port = 0)
+        : _fd(listenOn(port)), _marker(marker), _delay(delay) {
+        _acceptor = std::thread([this] {
+            while (true) {
+                const auto sockfd = ::accept(_fd, nullptr, nullptr);
+                if (sockfd == -1)
+                    return;
+
+                _accepted++;
+                const auto open = ++_connections;
+                _maxConnections = std::max(_maxConnections.load(), open);
+
+                std::lock_guard lock(_mutex);
+                _sessionFds.push_back(sockfd);
+                _sessions.emplace_back([this, sockfd] { serve(sockfd); });
+            }
+        });
+    }
+
+    ~FakeGateway() {
+        ::shutdown(_fd, SHUT_RDWR);
+        _acceptor.join();
+        ::close(_fd);
+
+        std::lock_guard lock(_mutex);
+        for (auto sockfd : _sessionFds)
+            ::shutdown(sockfd, SHUT_RDWR);
+        for (auto &session : _sessions)
+            session.join();
+    }
+
+    [[nodiscard]] TCP::ConnectionPool::Endpoint endpoint() const {
+        return {"127.0.0.1", portOf(_fd)};
+    }
+    [[nodiscard]] int accepted() const { return _accepted; }
+    [[nodiscard]] int maxConnections() const { return _maxConnections; }
+};
+} // namespace
+
+TEST(ModbusConnectionPool, LazyConnectAndReuse) {
+    FakeGateway gateway(7);
+    TCP::ConnectionPool pool;
+    pool.route(1, gateway.endpoint());
+    EXPECT_EQ(0u, pool.stats(gateway.endpoint())->connections);
+
+    for (uint16_t address = 0; address < 10; address++) {
+        const auto response = pool.transact(readRequest(1, address));
+        ASSERT_TRUE(response) << response.error();
+        EXPECT_EQ(7, response->registers()[0]);
+        EXPECT_EQ(address, response->registers()[1]);
+    }
+
+    const auto stats = pool.stats(gateway.endpoint());
+    ASSERT_TRUE(stats);
+    EXPECT_EQ(1u, stats->connections);
+    EXPECT_EQ(1u, stats->idle);
+    EXPECT_EQ(0u, stats->inFlight);
+    EXPECT_EQ(10u, stats->transactions);
+    EXPECT_TRUE(stats->healthy);
+    EXPECT_EQ(1, gateway.accepted());
+}
+
+TEST(ModbusConnectionPool, RoutesUnitsToGateways) {
+    FakeGateway first(100), second(200);
+    TCP::ConnectionPool pool;
+    pool.route(1, first.endpoint());
+    pool.route(2, first.endpoint());
+    pool.route(3, second.endpoint());
+
+    const std::vector<ModbusRequest> requests = {readRequest(1, 0), readRequest(3, 1),
+                                                 readRequest(2, 2), readRequest(3, 3),
+                                                 readRequest(9, 4)};
+    const auto results = pool.transact(requests);
+    ASSERT_EQ(requests.size(), results.size());
+
+    const uint16_t markers[] = {100, 200, 100, 200};
+    for (uint16_t i = 0; i < 4; i++) {
+        ASSERT_TRUE(results[i]) << results[i].error();
+        EXPECT_EQ(markers[i], results[i]->registers()[0]);
+        EXPECT_EQ(i, results[i]->registers()[1]);
+    }
+    EXPECT_EQ(utils::GatewayPathUnavailable, results[4].error());
+    EXPECT_EQ(utils::GatewayPathUnavailable, pool.transact(readRequest(9, 0)).error());
+}
+
+TEST(ModbusConnectionPool, ConnectionAndInFlightCaps) {
+    const auto hammer = [](TCP::ConnectionPool &pool) {
+        std::atomic<int> failed{0};
+        std::vector<std::thread> callers;
+        for (int i = 0; i < 8; i++)
+            callers.emplace_back([&] {
+                for (uint16_t address = 0; address < 10; address++)
+                    failed += !pool.transact(readRequest(1, address));
+            });
+        for (auto &caller : callers)
+            caller.join();
+        return failed.load();
+    };
+
+    FakeGateway fewConnections(1, 1ms);
+    TCP::ConnectionPool::Limits limits;
+    limits.maxConnections = 2;
+    limits.maxInFlight    = 8;
+    TCP::ConnectionPool first;
+    first.addGateway(fewConnections.endpoint(), limits);
+    first.route(1, fewConnections.endpoint());
+    EXPECT_EQ(0, hammer(first));
+    EXPECT_EQ(2, fewConnections.maxConnections());
+
+    FakeGateway fewSlots(1, 1ms);
+    limits.maxConnections = 8;
+    limits.maxInFlight    = 3;
+    TCP::ConnectionPool second;
+    second.addGateway(fewSlots.endpoint(), limits);
+    second.route(1, fewSlots.endpoint());
+    EXPECT_EQ(0, hammer(second));
+    EXPECT_LE(fewSlots.maxConnections(), 3);
+    EXPECT_EQ(80u, second.stats(fewSlots.endpoint())->transactions);
+}
+
+TEST(ModbusConnectionPool, PipelinedBatchKeepsOrder) {
+    FakeGateway gateway(1);
+    TCP::ConnectionPool::Limits limits;
+    limits.maxConnections = 1;
+    limits.maxInFlight    = 4;
+    TCP::ConnectionPool pool;
+    pool.addGateway(gateway.endpoint(), limits);
+    pool.route(1, gateway.endpoint());
+
+    std::vector<ModbusRequest> requests;
+    for (uint16_t address = 0; address < 30; address++)
+        requests.push_back(readRequest(1, address));
+
+    const auto results = pool.transact(requests);
+    for (uint16_t address = 0; address < 30; address++) {
+        ASSERT_TRUE(results[address]) << results[address].error();
+        EXPECT_EQ(address, results[address]->registers()[1]);
+    }
+    EXPECT_EQ(1, gateway.accepted());
+}
+
+TEST(ModbusConnectionPool, FairQueuingAcrossCallers) {
+    FakeGateway gateway(1, 2ms);
+    TCP::ConnectionPool::Limits limits;
+    limits.maxConnections = 1;
+    limits.maxInFlight    = 1;
+    TCP::ConnectionPool pool;
+    pool.addGateway(gateway.endpoint(), limits);
+    pool.route(1, gateway.endpoint());
+
+    // Hot caller keeps four transactions queued all the time
+    constexpr TCP::ConnectionPool::CallerId Hot = 1, Light = 2;
+    std::atomic<bool> stop{false};
+    std::atomic<int> hotCompleted{0};
+    std::vector<std::thread> hot;
+    for (int i = 0; i < 4; i++)
+        hot.emplace_back([&] {
+            while (!stop) {
+                std::ignore = pool.transact(readRequest(1, 0), Hot);
+                hotCompleted++;
+            }
+        });
+    while (hotCompleted < 4)
+        std::this_thread::yield();
+
+    const auto before = hotCompleted.load();
+    for (uint16_t address = 0; address < 5; address++)
+        EXPECT_TRUE(pool.transact(readRequest(1, address), Light));
+    const auto overtaken = hotCompleted.load() - before;
+    stop                 = true;
+    for (auto &thread : hot)
+        thread.join();
+
+    // Served in turns, about one hot transaction per light one (FIFO gives four)
+    EXPECT_LE(overtaken, 12);
+}
+
+TEST(ModbusConnectionPool, UnhealthyGatewayFailsFastAndRecovers) {
+    const auto probe = listenOn(0);
+    const auto port  = portOf(probe);
+    ::close(probe);
+
+    const TCP::ConnectionPool::Endpoint endpoint = {"127.0.0.1", port};
+    TCP::ConnectionPool::Limits limits;
+    limits.failureThreshold = 2;
+    limits.retryDelay       = 100ms;
+    TCP::ConnectionPool pool;
+    pool.addGateway(endpoint, limits);
+    pool.route(1, endpoint);
+
+    EXPECT_EQ(utils::ConnectionClosed, pool.transact(readRequest(1, 0)).error());
+    EXPECT_EQ(utils::ConnectionClosed, pool.transact(readRequest(1, 0)).error());
+    auto stats = pool.stats(endpoint);
+    EXPECT_FALSE(stats->healthy);
+    EXPECT_EQ(2u, stats->consecutiveFailures);
+    EXPECT_EQ(0u, stats->connections);
+
+    // Fails without connecting
+    EXPECT_EQ(utils::ConnectionClosed, pool.transact(readRequest(1, 0)).error());
+    EXPECT_EQ(2u, pool.stats(endpoint)->connectionFailures);
+
+    FakeGateway gateway(5, 0ms, port);
+    std::this_thread::sleep_for(150ms);
+    const auto response = pool.transact(readRequest(1, 0));
+    ASSERT_TRUE(response) << response.error();
+    EXPECT_EQ(5, response->registers()[0]);
+    stats = pool.stats(endpoint);
+    EXPECT_TRUE(stats->healthy);
+    EXPECT_EQ(0u, stats->consecutiveFailures);
+}
@@ -0,0 +1,127 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusConvert.hpp"
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <random>
+
+using namespace MB;
+
+namespace {
+std::vector<uint8_t> randomBytes(std::size_t size) {
+    std::mt19937 gen(1234);
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::vector<uint8_t> data(size);
+    for (auto &byte : data)
+        byte = static_cast<uint8_t>(dist(gen));
+    return data;
+}
+
+const utils::ConvertKernel Kernels[] = {utils::ConvertScalar, utils::ConvertSsse3,
+                                        utils::ConvertAvx2};
+const utils::WordOrder Orders[] = {utils::ABCD, utils::CDAB, utils::BADC, utils::DCBA};
+} // namespace
+
+TEST(ModbusConvert, MatchesCombineUint32) {
+    const auto wire = randomBytes(4 * 37);
+    for (auto order : Orders) {
+        std::vector<uint32_t> u32(37);
+        std::vector<float> f32(37);
+        utils::decodeRegisters(wire.data(), u32.size(), u32.data(), order);
+        utils::decodeRegisters(wire.data(), f32.size(), f32.data(), order);
+        for (std::size_t i = 0; i < u32.size(); i++) {
+            EXPECT_EQ(utils::combineUint32(&wire[4 * i], order), u32[i]);
+            EXPECT_EQ(0, std::memcmp(&f32[i], &u32[i], 4));
+        }
+    }
+}
+
+TEST(ModbusConvert, KnownValues) {
+    const std::vector<uint8_t> wire = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+
+    uint16_t u16[4];
+    utils::decodeRegisters(wire.data(), 4, u16);
+    EXPECT_EQ(0x0102, u16[0]);
+    EXPECT_EQ(0x0708, u16[3]);
+    utils::decodeRegisters(wire.data(), 4, u16, utils::BADC);
+    EXPECT_EQ(0x0201, u16[0]);
+
+    int16_t i16;
+    const uint8_t negative[] = {0xFF, 0xFE};
+    utils::decodeRegisters(negative, 1, &i16);
+    EXPECT_EQ(-2, i16);
+
+    uint64_t u64;
+    utils::decodeRegisters(wire.data(), 1, &u64);
+    EXPECT_EQ(0x0102030405060708u, u64);
+    utils::decodeRegisters(wire.data(), 1, &u64, utils::CDAB);
+    EXPECT_EQ(0x0708050603040102u, u64);
+    utils::decodeRegisters(wire.data(), 1, &u64, utils::BADC);
+    EXPECT_EQ(0x0201040306050807u, u64);
+    utils::decodeRegisters(wire.data(), 1, &u64, utils::DCBA);
+    EXPECT_EQ(0x0807060504030201u, u64);
+
+    double f64;
+    const uint8_t pi[] = {0x40, 0x09, 0x21, 0xFB, 0x54, 0x44, 0x2D, 0x18};
+    utils::decodeRegisters(pi, 1, &f64);
+    EXPECT_DOUBLE_EQ(3.141592653589793, f64);
+}
+
+// Every kernel, size, order and length (including tails shorter than vector)
+// must give the same bytes as the scalar kernel
+TEST(ModbusConvert, KernelsMatchScalar) {
+    const auto wire = randomBytes(8 * 125);
+    for (auto kernel : Kernels) {
+        if (!utils::isConvertKernelSupported(kernel))
+            continue;
+        for (std::size_t size : {2, 4, 8}) {
+            for (auto order : Orders) {
+                for (std::size_t count = 0; count * size <= 300; count++) {
+                    const auto *src = wire.data() + 1;
+                    std::vector<uint8_t> expected(count * size), result(count * size);
+                    utils::convertOrder(src, expected.data(), count, size, order,
+                                        utils::ConvertScalar);
+                    utils::convertOrder(src, result.data(), count, size, order, kernel);
+                    ASSERT_EQ(expected, result)
+                        << "kernel " << int(kernel) << " size " << size << " order "
+                        << int(order) << " count " << count;
+                }
+            }
+        }
+    }
+}
+
+TEST(ModbusConvert, RoundTripInPlace) {
+    const auto wire = randomBytes(8 * 125);
+    for (auto kernel : Kernels) {
+        if (!utils::isConvertKernelSupported(kernel))
+            continue;
+        for (std::size_t size : {2, 4, 8}) {
+            for (auto order : Orders) {
+                const auto count = wire.size() / size;
+                auto buffer      = wire;
+                utils::convertOrder(buffer.data(), buffer.data(), count, size, order,
+                                    kernel);
+                utils::convertOrder(buffer.data(), buffer.data(), count, size, order,
+                                    kernel);
+                EXPECT_EQ(wire, buffer);
+            }
+        }
+    }
+}
+
+TEST(ModbusConvert, EncodeInvertsDecode) {
+    const std::vector<int32_t> values = {0, -1, 123456789, INT32_MIN, INT32_MAX, -7};
+    for (auto order : Orders) {
+        std::vector<uint8_t> wire(values.size() * 4);
+        utils::encodeRegisters(values.data(), values.size(), wire.data(), order);
+        EXPECT_EQ(123456789u, utils::combineUint32(&wire[8], order));
+
+        std::vector<int32_t> decoded(values.size());
+        utils::decodeRegisters(wire.data(), decoded.size(), decoded.data(), order);
+        EXPECT_EQ(values, decoded);
+    }
+}
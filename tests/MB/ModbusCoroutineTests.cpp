@@ -0,0 +1,175 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "../simulatedDevice.hpp"
+#include "MB/Async/connections.hpp"
+#include "MB/modbusFraming.hpp"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <fcntl.h>
+#include <poll.h>
+#include <thread>
+
+using namespace MB;
+using namespace std::chrono_literals;
+
+namespace {
+//! Slave session: answers requests until the connection is closed
+Async::Task<> serve(Async::TcpStream stream) {
+    while (true) {
+        auto request = co_await stream.awaitRequest();
+        if (!request)
+            co_return;
+        if (request->registerAddress() == 0xFFFF)
+            continue; // Never answered
+        co_await stream.sendResponse(test::answer(request.value()));
+    }
+}
+
+//! Accepts `count` connections, each one served by its own coroutine
+Async::Task<> listen(Async::TcpListener &listener, std::size_t count) {
+    for (std::size_t i = 0; i < count; i++) {
+        auto stream = co_await listener.accept();
+        if (!stream)
+            co_return;
+        Async::spawn(serve(std::move(stream).value()));
+    }
+}
+
+//! Master session: `reads` sequential reads, returns sum of read values
+Async::Task<Result<uint32_t>> poll(Async::EventLoop &loop, int port, uint16_t reads) {
+    auto stream = co_await Async::TcpStream::connect(loop, "127.0.0.1", port);
+    if (!stream)
+        co_return stream.error();
+
+    uint32_t sum = 0;
+    for (uint16_t address = 0; address < reads; address++) {
+        auto response = co_await stream->transact(test::readHolding(address));
+        if (!response)
+            co_return response.error();
+        sum += response->registers()[0];
+    }
+    co_return sum;
+}
+} // namespace
+
+TEST(ModbusCoroutine, MasterAndSlaveOnOneThread) {
+    Async::EventLoop loop;
+    auto listener = Async::TcpListener::listen(loop, 0);
+    Async::spawn(listen(listener, 1));
+
+    const auto sum = Async::syncWait(loop, poll(loop, listener.port(), 10));
+    ASSERT_TRUE(sum) << sum.error();
+    EXPECT_EQ(45u, sum.value());
+}
+
+TEST(ModbusCoroutine, ConcurrentSessionsReuseFrames) {
+    constexpr std::size_t Sessions = 100;
+    Async::EventLoop loop;
+    auto listener = Async::TcpListener::listen(loop, 0);
+    Async::spawn(listen(listener, 2 * Sessions));
+
+    std::size_t finished = 0;
+    const auto session   = [&](int port) -> Async::Task<> {
+        const auto sum = co_await poll(loop, port, 20);
+        EXPECT_TRUE(sum);
+        finished++;
+    };
+
+    // Second round of sessions runs entirely on frames of the first one
+    std::size_t allocations = 0;
+    for (int round = 0; round < 2; round++) {
+        finished = 0;
+        for (std::size_t i = 0; i < Sessions; i++)
+            Async::spawn(session(listener.port()));
+        while (finished < Sessions)
+            loop.runOnce(100);
+        // Lets slave sessions see their connections closed
+        for (int i = 0; i < 5; i++)
+            loop.runOnce(10);
+
+        if (round == 0)
+            allocations = Async::FramePool::heapAllocations();
+    }
+    EXPECT_EQ(allocations, Async::FramePool::heapAllocations());
+}
+
+TEST(ModbusCoroutine, TransactTimeout) {
+    Async::EventLoop loop;
+    auto listener = Async::TcpListener::listen(loop, 0);
+    Async::spawn(listen(listener, 1));
+
+    const auto task = [&]() -> Async::Task<Result<ModbusResponse>> {
+        auto stream =
+            co_await Async::TcpStream::connect(loop, "127.0.0.1", listener.port());
+        stream->setTimeout(20ms);
+        auto lost = co_await stream->transact(test::readHolding(0xFFFF));
+        EXPECT_EQ(utils::Timeout, lost.error());
+        co_return co_await stream->transact(test::readHolding(7));
+    };
+
+    const auto response = Async::syncWait(loop, task());
+    ASSERT_TRUE(response) << response.error();
+    EXPECT_EQ(7, response->registers()[0]);
+}
+
+TEST(ModbusCoroutine, RtuTransactOverPseudoTerminal) {
+    const auto master = ::posix_openpt(O_RDWR | O_NOCTTY);
+    ASSERT_GE(master, 0);
+    ASSERT_EQ(0, ::grantpt(master));
+    ASSERT_EQ(0, ::unlockpt(master));
+
+    Serial::Connection connection(::ptsname(master));
+    connection.connect();
+
+    std::atomic<bool> stop{false};
+    std::thread device([&] {
+        RtuFramer framer(RtuFramer::Requests);
+        std::array<uint8_t, RtuFramer::MaxFrameSize> chunk;
+        std::array<uint8_t, RtuFramer::MaxFrameSize> reply;
+        auto onFrame = [&](const uint8_t *frame, std::size_t size) {
+            auto request = ModbusRequest::tryFromRaw(frame, size - 2);
+            const auto replySize =
+                request.value().registerAddress() == 13
+                    ? encodeRTU(ModbusException(utils::IllegalDataAddress, 1,
+                                                utils::ReadAnalogOutputHoldingRegisters),
+                                reply.data(), reply.size())
+                    : encodeRTU(test::answer(request.value()), reply.data(),
+                                reply.size());
+            std::ignore = ::write(master, reply.data(), replySize);
+        };
+
+        while (!stop) {
+            pollfd waiting = {.fd = master, .events = POLLIN, .revents = 0};
+            if (::poll(&waiting, 1, 20) <= 0)
+                continue;
+            const auto size = ::read(master, chunk.data(), chunk.size());
+            if (size <= 0)
+                break;
+            framer.feed(chunk.data(), static_cast<std::size_t>(size), onFrame);
+        }
+    });
+
+    Async::EventLoop loop;
+    Async::RtuPort port(loop, connection);
+    const auto task = [&]() -> Async::Task<uint32_t> {
+        uint32_t sum = 0;
+        for (uint16_t address = 10; address < 15; address++) {
+            auto response = co_await port.transact(test::readHolding(address));
+            if (address == 13) {
+                EXPECT_EQ(utils::IllegalDataAddress, response.error());
+                continue;
+            }
+            EXPECT_TRUE(response);
+            sum += response->registers()[0];
+        }
+        co_return sum;
+    };
+
+    EXPECT_EQ(10u + 11u + 12u + 14u, Async::syncWait(loop, task()));
+    stop = true;
+    device.join();
+    ::close(master);
+}
@@ -0,0 +1,96 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusCrc.hpp"
+#include "MB/modbusUtils.hpp"
+#include "gtest/gtest.h"
+
+#include <random>
+
+using namespace MB;
+
+namespace {
+std::vector<uint8_t> randomBytes(std::size_t size) {
+    std::mt19937 gen(1234);
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::vector<uint8_t> data(size);
+    for (auto &byte : data)
+        byte = static_cast<uint8_t>(dist(gen));
+    return data;
+}
+
+const utils::CrcKernel Kernels[] = {utils::CrcReference, utils::CrcSlicing8,
+                                    utils::CrcSlicing16, utils::CrcClmul};
+} // namespace
+
+// Check value of CRC-16/MODBUS catalogue entry
+TEST(ModbusCrc, CheckValue) {
+    const std::vector<uint8_t> check = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    EXPECT_EQ(0x4B37, utils::calculateCRC(check));
+    // Unsupported kernels fall back to tables, so all of them are checked
+    for (auto kernel : Kernels)
+        EXPECT_EQ(0x4B37,
+                  utils::crc16(check.data(), check.size(), utils::CrcInit, kernel));
+}
+
+TEST(ModbusCrc, KernelsMatchReference) {
+    const auto data = randomBytes(64 * 1024 + 32);
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<std::size_t> offsetDist(0, 31);
+    std::uniform_int_distribution<std::size_t> lenDist(0, 64 * 1024);
+
+    std::vector<std::size_t> lengths;
+    for (std::size_t len = 0; len <= 300; len++)
+        lengths.push_back(len);
+    for (int i = 0; i < 50; i++)
+        lengths.push_back(lenDist(gen));
+    lengths.push_back(64 * 1024);
+
+    for (auto kernel : Kernels) {
+        for (auto len : lengths) {
+            const auto offset   = offsetDist(gen);
+            const auto expected = utils::calculateCRC(data.data() + offset, len);
+            const auto *begin   = data.data() + offset;
+            ASSERT_EQ(expected, utils::crc16(begin, len, utils::CrcInit, kernel))
+                << "kernel " << int(kernel) << ", length " << len
+                << ", offset " << offset;
+        }
+    }
+    EXPECT_EQ(utils::calculateCRC(data), utils::crc16(data));
+}
+
+TEST(ModbusCrc, Incremental) {
+    const auto data = randomBytes(1000);
+
+    utils::Crc16 crc;
+    std::size_t pos = 0;
+    for (std::size_t chunk = 1; pos < data.size(); chunk = chunk * 3 % 97 + 1) {
+        const auto len = std::min(chunk, data.size() - pos);
+        crc.update(data.data() + pos, len);
+        pos += len;
+    }
+    EXPECT_EQ(utils::calculateCRC(data), crc.value());
+
+    crc.reset();
+    for (auto byte : data)
+        crc.update(byte);
+    EXPECT_EQ(utils::calculateCRC(data), crc.value());
+}
+
+TEST(ModbusCrc, Residue) {
+    // Testing data from https://www.simplymodbus.ca/
+    const std::vector<uint8_t> frame = {0x11, 0x03, 0x00, 0x6B, 0x00, 0x03, 0x76, 0x87};
+
+    utils::Crc16 crc;
+    for (std::size_t i = 0; i < frame.size(); i++) {
+        EXPECT_FALSE(crc.matches());
+        crc.update(frame[i]);
+    }
+    EXPECT_TRUE(crc.matches());
+
+    crc.reset();
+    crc.update(frame.data(), frame.size() - 1);
+    crc.update(static_cast<uint8_t>(frame.back() ^ 1));
+    EXPECT_FALSE(crc.matches());
+}
@@ -15,3 +15,14 @@ TEST(ModbusException, Other) {
     EXPECT_EQ(MB::ModbusException({0x0A, 0x82, 0x02}).functionCode(),
               MB::utils::ReadDiscreteInputContacts);
 }
+
+TEST(ModbusException, Raw) {
+    MB::ModbusException ex(MB::utils::IllegalDataAddress, 0x0A,
+                           MB::utils::ReadDiscreteInputContacts);
+    const auto raw = ex.toRaw();
+    EXPECT_EQ(std::vector<uint8_t>({0x0A, 0x82, 0x02}), raw);
+
+    MB::ModbusException parsed(raw);
+    EXPECT_EQ(MB::utils::IllegalDataAddress, parsed.getErrorCode());
+    EXPECT_EQ(MB::utils::ReadDiscreteInputContacts, parsed.functionCode());
+}
@@ -0,0 +1,147 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/modbusFraming.hpp"
+#include "MB/modbusRequest.hpp"
+#include "MB/modbusResponse.hpp"
+#include "MB/modbusRtuFramer.hpp"
+#include "gtest/gtest.h"
+
+using namespace MB;
+
+namespace {
+using Frame = std::vector<uint8_t>;
+
+// Examples from Modbus Application Protocol Specification V1.1b3 (slave 0x11)
+const Frame Fn23Request  = {0x11, 0x17, 0x00, 0x03, 0x00, 0x06, 0x00, 0x0E, 0x00,
+                            0x03, 0x06, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0xFF};
+const Frame Fn23Response = {0x11, 0x17, 0x0C, 0x00, 0xFE, 0x0A, 0xCD, 0x00,
+                            0x01, 0x00, 0x03, 0x00, 0x0D, 0x00, 0xFF};
+const Frame Fn22Request  = {0x11, 0x16, 0x00, 0x04, 0x00, 0xF2, 0x00, 0x25};
+const Frame Fn20Request  = {0x11, 0x14, 0x07, 0x06, 0x00, 0x04, 0x00, 0x01, 0x00, 0x02};
+const Frame Fn20Response = {0x11, 0x14, 0x06, 0x05, 0x06, 0x0D, 0xFE, 0x00, 0x20};
+const Frame Fn21Request  = {0x11, 0x15, 0x0D, 0x06, 0x00, 0x04, 0x00, 0x07,
+                            0x00, 0x03, 0x06, 0xAF, 0x04, 0xBE, 0x10, 0x0D};
+
+Frame withCRC(Frame frame) {
+    const auto crc = utils::crc16(frame);
+    frame.push_back(static_cast<uint8_t>(crc & 0xFF));
+    frame.push_back(static_cast<uint8_t>(crc >> 8));
+    return frame;
+}
+} // namespace
+
+TEST(ModbusExtendedFunctions, Traits) {
+    EXPECT_EQ(utils::ReadWrite, utils::functionType(utils::ReadWriteMultipleRegisters));
+    EXPECT_EQ(utils::MaskWrite, utils::functionType(utils::MaskWriteRegister));
+    EXPECT_EQ(utils::FileRead, utils::functionType(utils::ReadFileRecord));
+    EXPECT_EQ(utils::FileWrite, utils::functionType(utils::WriteFileRecord));
+    EXPECT_EQ(utils::HoldingRegisters,
+              utils::functionRegister(utils::ReadWriteMultipleRegisters));
+    EXPECT_EQ(utils::FileRecords, utils::functionRegister(utils::WriteFileRecord));
+
+    static_assert(utils::applyMask(0x12, 0xF2, 0x25) == 0x17);
+}
+
+TEST(ModbusExtendedFunctions, ReadWriteMultiple) {
+    const auto request = ModbusRequest::fromRaw(Fn23Request);
+    EXPECT_EQ(0x03, request.registerAddress());
+    EXPECT_EQ(6, request.numberOfRegisters());
+    EXPECT_EQ(0x0E, request.writeAddress());
+    EXPECT_EQ(RegisterBlock({0x00FF, 0x00FF, 0x00FF}), request.registers());
+    EXPECT_EQ(Fn23Request, request.toRaw());
+
+    const auto built = ModbusRequest::readWriteMultiple(0x11, 0x03, 6, 0x0E,
+                                                        {0x00FF, 0x00FF, 0x00FF});
+    EXPECT_EQ(Fn23Request, built.toRaw());
+
+    const auto response = ModbusResponse::fromRaw(Fn23Response);
+    EXPECT_EQ(6, response.numberOfRegisters());
+    EXPECT_EQ(0x00FE, response.registers()[0]);
+    EXPECT_EQ(0x00FF, response.registers()[5]);
+    EXPECT_EQ(Fn23Response, response.toRaw());
+}
+
+TEST(ModbusExtendedFunctions, MaskWrite) {
+    const auto view = ModbusRequestView::fromRaw(Fn22Request);
+    EXPECT_EQ(0x04, view.registerAddress());
+    EXPECT_EQ(0x00F2, view.andMask());
+    EXPECT_EQ(0x0025, view.orMask());
+
+    const auto request = ModbusRequest::maskWrite(0x11, 0x04, 0x00F2, 0x0025);
+    EXPECT_EQ(Fn22Request, request.toRaw());
+
+    // Response is an echo of the request
+    ModbusResponse response(0x11, utils::MaskWriteRegister);
+    response.from(request);
+    EXPECT_EQ(Fn22Request, response.toRaw());
+    EXPECT_EQ(0x00F2, ModbusResponse::fromRaw(Fn22Request).andMask());
+}
+
+TEST(ModbusExtendedFunctions, FileRecords) {
+    const auto read = ModbusRequest::fromRaw(Fn20Request);
+    EXPECT_EQ(4, read.fileNumber());
+    EXPECT_EQ(1, read.registerAddress());
+    EXPECT_EQ(2, read.numberOfRegisters());
+    EXPECT_EQ(Fn20Request, ModbusRequest::readFileRecord(0x11, 4, 1, 2).toRaw());
+
+    const auto readResponse = ModbusResponse::fromRaw(Fn20Response);
+    EXPECT_EQ(RegisterBlock({0x0DFE, 0x0020}), readResponse.registers());
+    EXPECT_EQ(Fn20Response, readResponse.toRaw());
+
+    const auto write = ModbusRequest::fromRaw(Fn21Request);
+    EXPECT_EQ(4, write.fileNumber());
+    EXPECT_EQ(7, write.registerAddress());
+    EXPECT_EQ(RegisterBlock({0x06AF, 0x04BE, 0x100D}), write.registers());
+    const auto built =
+        ModbusRequest::writeFileRecord(0x11, 4, 7, {0x06AF, 0x04BE, 0x100D});
+    EXPECT_EQ(Fn21Request, built.toRaw());
+
+    const auto writeResponse = ModbusResponse::fromRaw(Fn21Request);
+    EXPECT_EQ(4, writeResponse.fileNumber());
+    EXPECT_EQ(Fn21Request, writeResponse.toRaw());
+}
+
+TEST(ModbusExtendedFunctions, Malformed) {
+    auto wrongByteCount = Fn23Request;
+    wrongByteCount[10]  = 0x04;
+    EXPECT_EQ(utils::InvalidByteOrder,
+              ModbusRequestView::tryFromRaw(wrongByteCount).error());
+
+    auto wrongReference = Fn21Request;
+    wrongReference[3]   = 0x05;
+    EXPECT_EQ(utils::InvalidByteOrder,
+              ModbusRequestView::tryFromRaw(wrongReference).error());
+
+    // Several record groups are not supported
+    const Frame twoGroups = {0x11, 0x14, 0x0E, 0x06, 0x00, 0x04, 0x00, 0x01, 0x00,
+                             0x02, 0x06, 0x00, 0x03, 0x00, 0x09, 0x00, 0x02};
+    EXPECT_FALSE(ModbusRequestView::tryFromRaw(twoGroups));
+
+    const Frame truncated(Fn20Response.begin(), Fn20Response.end() - 1);
+    EXPECT_FALSE(ModbusResponseView::tryFromRaw(truncated));
+}
+
+TEST(ModbusExtendedFunctions, RtuFramer) {
+    Frame requests;
+    for (const auto &frame : {Fn23Request, Fn22Request, Fn20Request, Fn21Request}) {
+        const auto rtu = withCRC(frame);
+        requests.insert(requests.end(), rtu.begin(), rtu.end());
+    }
+    Frame responses;
+    for (const auto &frame : {Fn23Response, Fn22Request, Fn20Response, Fn21Request}) {
+        const auto rtu = withCRC(frame);
+        responses.insert(responses.end(), rtu.begin(), rtu.end());
+    }
+
+    for (auto [direction, stream] : {std::make_pair(RtuFramer::Requests, requests),
+                                     std::make_pair(RtuFramer::Responses, responses)}) {
+        RtuFramer framer(direction);
+        std::size_t frames = 0;
+        for (auto byte : stream)
+            framer.feed(&byte, 1, [&](const uint8_t *, std::size_t) { frames++; });
+        EXPECT_EQ(4u, frames);
+        EXPECT_EQ(0u, framer.crcErrors());
+    }
+}
@@ -0,0 +1,72 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "../expectThrow.hpp"
+#include "MB/modbusFrames.hpp"
+#include "MB/modbusFraming.hpp"
+#include "MB/modbusRequest.hpp"
+#include "gtest/gtest.h"
+
+using namespace MB;
+
+namespace {
+// Testing data from https://www.simplymodbus.ca/
+constexpr frames::RequestFrame ExpectedReadHolding = {0x11, 0x03, 0x00, 0x6B,
+                                                      0x00, 0x03, 0x76, 0x87};
+
+constexpr bool sameFrame(const frames::RequestFrame &a, const frames::RequestFrame &b) {
+    for (std::size_t i = 0; i < a.size(); i++)
+        if (a[i] != b[i])
+            return false;
+    return true;
+}
+static_assert(sameFrame(frames::ReadHolding<0x11, 0x006B, 3>, ExpectedReadHolding),
+              "Frame must be built at compile time");
+
+template <std::size_t N>
+std::vector<uint8_t> toVector(const std::array<uint8_t, N> &frame) {
+    return {frame.begin(), frame.end()};
+}
+
+std::vector<uint8_t> toRTU(const ModbusRequest &request) {
+    std::vector<uint8_t> raw;
+    appendRTU(request, raw);
+    return raw;
+}
+} // namespace
+
+TEST(ModbusFrames, ReadFrames) {
+    EXPECT_EQ(toRTU(ModbusRequest(0x11, utils::ReadDiscreteOutputCoils, 0x13, 0x25)),
+              toVector(frames::ReadCoils<0x11, 0x13, 0x25>));
+    EXPECT_EQ(toRTU(ModbusRequest(0x11, utils::ReadDiscreteInputContacts, 0xC4, 0x16)),
+              toVector(frames::ReadDiscreteInputs<0x11, 0xC4, 0x16>));
+    EXPECT_EQ(toRTU(ModbusRequest(0x11, utils::ReadAnalogInputRegisters, 0x08, 1)),
+              toVector(frames::ReadInput<0x11, 0x08, 1>));
+}
+
+TEST(ModbusFrames, WriteSingleFrames) {
+    const auto coil = frames::WriteSingleCoil<0x11, 0xAC, true>;
+    EXPECT_EQ(ModbusRequest::fromRawCRC(toVector(coil)).registerValues()[0].coil(), true);
+    EXPECT_EQ(0xFF, coil[4]);
+
+    const auto reg  = frames::WriteSingleRegister<0x11, 0x01, 0x0003>;
+    const auto request = ModbusRequest::fromRawCRC(toVector(reg));
+    EXPECT_EQ(utils::WriteSingleAnalogOutputRegister, request.functionCode());
+    EXPECT_EQ(0x0003, request.registers()[0]);
+}
+
+TEST(ModbusFunctionTraits, MatchesFunctionCodes) {
+    static_assert(utils::functionType(utils::ReadAnalogInputRegisters) == utils::Read);
+    static_assert(utils::isCoilFunction(utils::WriteMultipleDiscreteOutputCoils));
+    static_assert(utils::isReadFunction(utils::ReadDiscreteInputContacts));
+    static_assert(!utils::isReadFunction(utils::ReadWriteMultipleRegisters));
+    static_assert(!utils::isReadFunction(utils::Undefined));
+    static_assert(!utils::functionTraits(utils::Undefined).defined);
+
+    EXPECT_EQ(utils::WriteMultiple,
+              utils::functionType(utils::WriteMultipleAnalogOutputHoldingRegisters));
+    EXPECT_EQ(utils::InputContacts, utils::functionRegister(utils::ReadDiscreteInputContacts));
+    MB_EXPECT_THROW(utils::functionType(static_cast<utils::MBFunctionCode>(0x42)),
+                    std::runtime_error);
+}
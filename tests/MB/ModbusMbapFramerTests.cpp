@@ -0,0 +1,162 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/TCP/connection.hpp"
+#include "MB/modbusMbapFramer.hpp"
+#include "gtest/gtest.h"
+
+#include <sys/socket.h>
+
+using namespace MB;
+
+namespace {
+using Frame = std::vector<uint8_t>;
+
+Frame tcpFrame(uint16_t transactionID, uint16_t registers) {
+    ModbusRequest request(0x11, utils::ReadAnalogOutputHoldingRegisters, 0x6B, registers);
+    Frame frame;
+    appendTCP(request, transactionID, frame);
+    return frame;
+}
+
+Frame responseFrame(uint16_t transactionID, uint16_t registers) {
+    std::vector<ModbusCell> values(registers, ModbusCell::initReg(0x1234));
+    ModbusResponse response(0x11, utils::ReadAnalogOutputHoldingRegisters, 0, registers,
+                            values);
+    Frame frame;
+    appendTCP(response, transactionID, frame);
+    return frame;
+}
+
+std::vector<Frame> feedInChunks(MbapFramer &framer, const Frame &stream,
+                                std::size_t chunk) {
+    std::vector<Frame> frames;
+    for (std::size_t pos = 0; pos < stream.size();) {
+        pos += framer.feed(stream.data() + pos, std::min(chunk, stream.size() - pos));
+        while (auto frame = framer.next())
+            frames.emplace_back(frame->data, frame->data + frame->size);
+    }
+    return frames;
+}
+} // namespace
+
+TEST(ModbusMbapFramer, SplitAndMergedSegments) {
+    const std::vector<Frame> expected = {tcpFrame(1, 3), responseFrame(2, 125),
+                                         tcpFrame(3, 1), responseFrame(4, 1)};
+    Frame stream;
+    for (const auto &frame : expected)
+        stream.insert(stream.end(), frame.begin(), frame.end());
+
+    for (std::size_t chunk : {std::size_t(1), std::size_t(5), std::size_t(100),
+                              stream.size()}) {
+        MbapFramer framer;
+        EXPECT_EQ(expected, feedInChunks(framer, stream, chunk)) << "chunk " << chunk;
+        EXPECT_EQ(0u, framer.pending());
+        EXPECT_FALSE(framer.invalid());
+    }
+}
+
+TEST(ModbusMbapFramer, FrameView) {
+    const auto raw = tcpFrame(0xBEEF, 3);
+
+    MbapFramer framer;
+    framer.feed(raw.data(), raw.size() - 1);
+    EXPECT_FALSE(framer.next());
+
+    framer.feed(raw.data() + raw.size() - 1, 1);
+    const auto frame = framer.next();
+    ASSERT_TRUE(frame);
+    EXPECT_EQ(0xBEEF, frame->header.transactionID);
+    EXPECT_EQ(raw.size() - MbapHeader::Size, frame->header.length);
+    EXPECT_EQ(raw.size() - MbapHeader::Size, frame->pduSize());
+
+    const auto request = ModbusRequest::tryFromRaw(frame->pdu(), frame->pduSize());
+    ASSERT_TRUE(request);
+    EXPECT_EQ(3, request->numberOfRegisters());
+}
+
+TEST(ModbusMbapFramer, CompactsSmallBuffer) {
+    // Capacity is raised to single maximal frame, leftovers must be moved
+    MbapFramer framer(1);
+    std::size_t frames = 0;
+    for (uint16_t id = 0; id < 100; id++) {
+        const auto raw = responseFrame(id, 1 + id % 125);
+        for (std::size_t pos = 0; pos < raw.size();) {
+            const auto chunk = std::min<std::size_t>(37, raw.size() - pos);
+            pos += framer.feed(raw.data() + pos, chunk);
+            while (auto frame = framer.next()) {
+                EXPECT_EQ(frames, frame->header.transactionID);
+                frames++;
+            }
+        }
+    }
+    EXPECT_EQ(100u, frames);
+}
+
+TEST(ModbusMbapFramer, InvalidHeader) {
+    auto raw = tcpFrame(1, 3);
+    raw[2]   = 0x01; // Protocol id
+
+    MbapFramer framer;
+    framer.feed(raw.data(), raw.size());
+    EXPECT_FALSE(framer.next());
+    EXPECT_TRUE(framer.invalid());
+
+    framer.clear();
+    raw    = tcpFrame(1, 3);
+    raw[4] = 0x01; // Length of 256 + n bytes
+    framer.feed(raw.data(), raw.size());
+    EXPECT_FALSE(framer.next());
+    EXPECT_TRUE(framer.invalid());
+}
+
+TEST(ModbusMbapFramer, TcpCoalescedResponses) {
+    int fds[2];
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    TCP::Connection client(fds[0]);
+
+    // Two responses in one segment, third split in two
+    Frame stream;
+    for (uint16_t id : {0, 1, 2}) {
+        const auto frame = responseFrame(id, 10 + id);
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    }
+    const auto split = stream.size() - 7;
+    ASSERT_EQ(long(split), ::send(fds[1], stream.data(), split, 0));
+
+    for (uint16_t id : {0, 1}) {
+        client.setMessageId(id);
+        const auto response = client.tryAwaitResponse();
+        ASSERT_TRUE(response) << response.error();
+        EXPECT_EQ(10 + id, response->numberOfRegisters());
+    }
+
+    ASSERT_EQ(7, ::send(fds[1], stream.data() + split, 7, 0));
+    client.setMessageId(2);
+    const auto response = client.tryAwaitResponse();
+    ASSERT_TRUE(response) << response.error();
+    EXPECT_EQ(12, response->numberOfRegisters());
+
+    ::close(fds[1]);
+}
+
+TEST(ModbusMbapFramer, HasFrameOnlyWhenComplete) {
+    MbapFramer framer;
+    auto stream       = tcpFrame(1, 2);
+    const auto second = tcpFrame(2, 3);
+    stream.insert(stream.end(), second.begin(), second.end());
+
+    EXPECT_FALSE(framer.hasFrame());
+    framer.feed(stream.data(), 4);
+    EXPECT_FALSE(framer.hasFrame());
+    framer.feed(stream.data() + 4, stream.size() - 4 - 1);
+    EXPECT_TRUE(framer.hasFrame());
+
+    ASSERT_TRUE(framer.next());
+    EXPECT_FALSE(framer.hasFrame()); // Last byte of the second frame is missing
+    framer.feed(stream.data() + stream.size() - 1, 1);
+    EXPECT_TRUE(framer.hasFrame());
+    ASSERT_TRUE(framer.next());
+    EXPECT_FALSE(framer.hasFrame());
+}
@@ -0,0 +1,186 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "../simulatedDevice.hpp"
+#include "MB/TCP/pipelinedClient.hpp"
+#include "gtest/gtest.h"
+
+#include <sys/socket.h>
+#include <thread>
+
+using namespace MB;
+
+namespace {
+struct Pair {
+    TCP::PipelinedClient client;
+    TCP::Connection server;
+};
+
+Pair connect(std::size_t window) {
+    int fds[2];
+    ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    return {TCP::PipelinedClient(TCP::Connection(fds[0]), window),
+            TCP::Connection(fds[1])};
+}
+} // namespace
+
+TEST(ModbusPipelinedClient, OutOfOrderResponses) {
+    auto [client, server] = connect(4);
+
+    std::vector<uint16_t> ids;
+    for (uint16_t address = 0; address < 4; address++) {
+        const auto id = client.send(test::readHolding(address));
+        ASSERT_TRUE(id);
+        ids.push_back(*id);
+    }
+    EXPECT_EQ(4u, client.inFlight());
+    EXPECT_FALSE(client.canSend());
+    EXPECT_FALSE(client.send(test::readHolding(9)));
+
+    // Server answers in reverse order
+    std::vector<std::pair<uint16_t, ModbusRequest>> received;
+    for (int i = 0; i < 4; i++) {
+        auto request = server.tryAwaitRequest();
+        ASSERT_TRUE(request);
+        received.emplace_back(server.getMessageId(), request.value());
+    }
+    for (auto it = received.rbegin(); it != received.rend(); it++) {
+        server.setMessageId(it->first);
+        server.sendResponse(test::answer(it->second));
+    }
+
+    for (int i = 3; i >= 0; i--) {
+        auto completion = client.receive();
+        ASSERT_TRUE(completion) << completion.error();
+        EXPECT_EQ(ids[i], completion->transactionID);
+        ASSERT_TRUE(completion->response);
+        EXPECT_EQ(i, completion->response->registers()[0]);
+    }
+    EXPECT_EQ(0u, client.inFlight());
+}
+
+TEST(ModbusPipelinedClient, ExceptionsAndUnknownTransactions) {
+    auto [client, server] = connect(2);
+
+    const auto id = client.send(test::readHolding(5));
+    ASSERT_TRUE(id);
+    ASSERT_TRUE(server.tryAwaitRequest());
+
+    // Stale response of unknown transaction is dropped
+    server.setMessageId(static_cast<uint16_t>(*id + 100));
+    server.sendResponse(test::answer(test::readHolding(1)));
+    server.setMessageId(*id);
+    server.sendException(ModbusException(utils::IllegalDataAddress, 1,
+                                         utils::ReadAnalogOutputHoldingRegisters));
+
+    auto completion = client.receive();
+    ASSERT_TRUE(completion);
+    EXPECT_EQ(*id, completion->transactionID);
+    ASSERT_FALSE(completion->response);
+    EXPECT_EQ(utils::IllegalDataAddress, completion->response.error());
+
+    // Nothing more arrives, pending transaction stays in flight
+    ASSERT_TRUE(client.send(test::readHolding(6)));
+    const auto timeout = client.receive();
+    ASSERT_FALSE(timeout);
+    EXPECT_EQ(utils::Timeout, timeout.error());
+    EXPECT_EQ(1u, client.inFlight());
+
+    client.reset();
+    EXPECT_EQ(0u, client.inFlight());
+}
+
+TEST(ModbusPipelinedClient, BatchKeepsWindowFull) {
+    auto [client, server] = connect(8);
+
+    std::size_t maxPending = 0;
+    std::thread device([&server = server, &maxPending] {
+        // Collects everything that arrived, answers newest first
+        std::vector<std::pair<uint16_t, ModbusRequest>> pending;
+        std::size_t answered = 0;
+        while (answered < 50) {
+            auto request = server.tryAwaitRequest();
+            if (!request)
+                return;
+            pending.emplace_back(server.getMessageId(), request.value());
+
+            pollfd waiting = {.fd = server.getSockfd(), .events = POLLIN, .revents = 0};
+            if (pending.size() < 8 && answered + pending.size() < 50 &&
+                ::poll(&waiting, 1, 20) > 0)
+                continue;
+
+            maxPending = std::max(maxPending, pending.size());
+            for (auto it = pending.rbegin(); it != pending.rend(); it++) {
+                server.setMessageId(it->first);
+                server.sendResponse(test::answer(it->second));
+            }
+            answered += pending.size();
+            pending.clear();
+        }
+    });
+
+    std::vector<ModbusRequest> requests;
+    for (uint16_t address = 0; address < 50; address++)
+        requests.push_back(test::readHolding(address));
+    const auto results = client.transact(requests);
+    device.join();
+
+    ASSERT_EQ(50u, results.size());
+    for (uint16_t address = 0; address < 50; address++) {
+        ASSERT_TRUE(results[address]) << results[address].error();
+        EXPECT_EQ(address, results[address]->registers()[0]);
+    }
+    EXPECT_EQ(8u, maxPending);
+    EXPECT_EQ(0u, client.inFlight());
+}
+
+TEST(ModbusPipelinedClient, BatchReportsConnectionError) {
+    auto [client, server] = connect(4);
+    std::thread device([&server = server] {
+        auto request = server.tryAwaitRequest();
+        server.sendResponse(test::answer(request.value()));
+        ::shutdown(server.getSockfd(), SHUT_RDWR);
+    });
+
+    const auto results = client.transact(
+        {test::readHolding(1), test::readHolding(2), test::readHolding(3)});
+    device.join();
+
+    ASSERT_EQ(3u, results.size());
+    ASSERT_TRUE(results[0]);
+    EXPECT_EQ(1, results[0]->registers()[0]);
+    EXPECT_EQ(utils::ConnectionClosed, results[1].error());
+    EXPECT_EQ(utils::ConnectionClosed, results[2].error());
+}
+
+TEST(ModbusPipelinedClient, BatchSendFillsWindowWithOneWrite) {
+    auto [client, server] = connect(3);
+    const std::vector<ModbusRequest> requests = {
+        test::readHolding(0), test::readHolding(1), test::readHolding(2),
+        test::readHolding(3)};
+
+    const auto firstID = client.nextTransactionID();
+    EXPECT_EQ(3u, client.send(requests.data(), requests.size()));
+    EXPECT_EQ(0u, client.send(requests.data() + 3, 1));
+    EXPECT_EQ(static_cast<uint16_t>(firstID + 3), client.nextTransactionID());
+
+    // All three requests are in the socket before the server reads anything
+    pollfd waiting = {.fd = server.getSockfd(), .events = POLLIN, .revents = 0};
+    ASSERT_EQ(1, ::poll(&waiting, 1, 100));
+    for (uint16_t i = 0; i < 3; i++) {
+        auto request = server.tryAwaitRequest();
+        ASSERT_TRUE(request);
+        EXPECT_EQ(i, request->registerAddress());
+        EXPECT_EQ(static_cast<uint16_t>(firstID + i), server.getMessageId());
+        if (i < 2) {
+            EXPECT_TRUE(server.hasBufferedFrame());
+        }
+        server.sendResponse(test::answer(request.value()));
+    }
+
+    for (int i = 0; i < 3; i++)
+        ASSERT_TRUE(client.receive());
+    EXPECT_FALSE(client.hasBufferedResponse());
+    EXPECT_EQ(1u, client.send(requests.data() + 3, 1));
+}
@@ -0,0 +1,231 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "../expectThrow.hpp"
+#include "../simulatedDevice.hpp"
+#include "MB/Poll/pollEngine.hpp"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <thread>
+
+using namespace MB;
+using namespace std::chrono_literals;
+using Poll::PollEngine;
+
+namespace {
+//! Answers requests over the connection until the client closes it
+std::thread serve(TCP::Connection &server) {
+    return std::thread([&server] {
+        test::serve(server, test::RegisterBase);
+    });
+}
+
+Poll::Point point(std::string name, uint16_t address, Poll::PointType type = Poll::U16) {
+    Poll::Point point;
+    point.name    = std::move(name);
+    point.address = address;
+    point.type    = type;
+    return point;
+}
+} // namespace
+
+TEST(ModbusPollEngine, DecodesPointsOverTcp) {
+    int fds[2];
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    TCP::Connection client(fds[0]);
+    auto server = std::make_unique<TCP::Connection>(fds[1]);
+    auto device = serve(*server);
+
+    PollEngine engine;
+    const auto connection = engine.addConnection(client);
+
+    auto coil         = point("coil", 3, Poll::Bit);
+    coil.functionCode = utils::ReadDiscreteOutputCoils;
+    auto swapped      = point("swapped", 20, Poll::U32);
+    swapped.order     = utils::CDAB;
+    engine.addGroup(connection, 1h,
+                    {point("u16", 5), point("u32", 20, Poll::U32), swapped, coil});
+
+    // Registers are coalesced into one read, coils are read separately
+    for (int i = 0; i < 2; i++)
+        ASSERT_TRUE(engine.runOnce());
+    EXPECT_FALSE(engine.runOnce());
+
+    const auto snapshot = engine.snapshot();
+    ASSERT_EQ(4u, snapshot.samples.size());
+    EXPECT_EQ(4u, snapshot.version);
+    for (const auto &sample : snapshot.samples)
+        EXPECT_TRUE(sample.valid()) << *sample.error;
+
+    EXPECT_EQ(0x1005, snapshot.samples[0].value);
+    EXPECT_EQ(0x10141015, snapshot.samples[1].value);
+    EXPECT_EQ(0x10151014, snapshot.samples[2].value);
+    EXPECT_EQ(1, snapshot.samples[*engine.find("coil")].value);
+    EXPECT_FALSE(engine.find("missing"));
+
+    const auto stats = engine.stats(0);
+    EXPECT_EQ(1u, stats.cycles);
+    EXPECT_EQ(2u, stats.transactions);
+    EXPECT_EQ(0u, stats.deadlineMisses);
+
+    ::shutdown(fds[0], SHUT_RDWR);
+    device.join();
+}
+
+TEST(ModbusPollEngine, DecodesPointsOverSerial) {
+    const int master = ::posix_openpt(O_RDWR | O_NOCTTY);
+    ASSERT_GE(master, 0);
+    ASSERT_EQ(0, ::grantpt(master));
+    ASSERT_EQ(0, ::unlockpt(master));
+
+    Serial::Connection client(::ptsname(master));
+    client.connect();
+    std::atomic<bool> stop{false};
+    std::thread device([&] {
+        RtuFramer framer(RtuFramer::Requests);
+        std::array<uint8_t, RtuFramer::MaxFrameSize> chunk;
+        std::array<uint8_t, RtuFramer::MaxFrameSize> reply;
+        const auto onFrame = [&](const uint8_t *frame, std::size_t size) {
+            auto request = ModbusRequest::tryFromRaw(frame, size - 2);
+            if (request)
+                std::ignore = ::write(
+                    master, reply.data(),
+                    encodeRTU(test::answer(request.value(), test::RegisterBase),
+                              reply.data(), reply.size()));
+            return true;
+        };
+        while (!stop) {
+            pollfd waiting = {.fd = master, .events = POLLIN, .revents = 0};
+            if (::poll(&waiting, 1, 20) <= 0)
+                continue;
+            const auto size = ::read(master, chunk.data(), chunk.size());
+            if (size <= 0)
+                return;
+            framer.feed(chunk.data(), static_cast<std::size_t>(size), onFrame);
+        }
+    });
+
+    PollEngine engine;
+    engine.addGroup(engine.addConnection(client), 1h,
+                    {point("s16", 7, Poll::S16), point("f32", 0, Poll::F32)});
+    ASSERT_TRUE(engine.runOnce());
+    EXPECT_FALSE(engine.runOnce());
+
+    const auto s16 = engine.sample(0);
+    ASSERT_TRUE(s16.valid()) << *s16.error;
+    EXPECT_EQ(0x1007, s16.value);
+    const auto f32 = engine.sample(1);
+    ASSERT_TRUE(f32.valid()) << *f32.error;
+    uint32_t bits = 0x10001001;
+    float expected;
+    std::memcpy(&expected, &bits, sizeof(expected));
+    EXPECT_FLOAT_EQ(expected, static_cast<float>(f32.value));
+
+    stop = true;
+    device.join();
+    ::close(master);
+}
+
+TEST(ModbusPollEngine, EarliestDeadlineFirstAcrossConnections) {
+    std::vector<std::pair<int, uint16_t>> order;
+    const auto recorder = [&](int connection) {
+        return [&order, connection](const ModbusRequest &request) {
+            order.emplace_back(connection, request.registerAddress());
+            return Result<ModbusResponse>(test::answer(request, test::RegisterBase));
+        };
+    };
+
+    PollEngine engine;
+    const auto slow = engine.addConnection(recorder(0));
+    const auto fast = engine.addConnection(recorder(1));
+    engine.addGroup(slow, 1h, {point("a", 1), point("b", 500)});
+    engine.addGroup(fast, 10min, {point("c", 3)});
+    engine.addGroup(slow, 30min, {point("d", 4)});
+
+    while (engine.runOnce()) {
+    }
+
+    // Released together, 10 min deadline first, then 30 min, then 1 h
+    const std::vector<std::pair<int, uint16_t>> expected = {
+        {1, 3}, {0, 4}, {0, 1}, {0, 500}};
+    EXPECT_EQ(expected, order);
+}
+
+TEST(ModbusPollEngine, ReportsDeadlineMissesAndErrors) {
+    std::atomic<int> calls{0};
+    PollEngine engine;
+    const auto connection = engine.addConnection([&](const ModbusRequest &request) {
+        // Every transaction takes longer than the whole period
+        std::this_thread::sleep_for(15ms);
+        if (calls++ >= 1)
+            return Result<ModbusResponse>(utils::Timeout);
+        return Result<ModbusResponse>(test::answer(request, test::RegisterBase));
+    });
+    // Too far apart to share a read
+    const auto group =
+        engine.addGroup(connection, 10ms, {point("a", 1), point("b", 500)});
+
+    engine.runUntil(Poll::Clock::now() + 100ms);
+
+    const auto stats = engine.stats(group);
+    EXPECT_EQ(0u, stats.cycles);
+    EXPECT_GE(stats.deadlineMisses, 4u);
+    EXPECT_GE(stats.transactions, 4u);
+    EXPECT_EQ(stats.transactions - 1, stats.errors);
+    EXPECT_GE(stats.maxJitter, stats.meanJitter);
+
+    // Values read before the errors are kept
+    const auto sample = engine.sample(0);
+    EXPECT_FALSE(sample.valid());
+    EXPECT_EQ(1u, sample.updates);
+    EXPECT_EQ(0x1001, sample.value);
+    ASSERT_TRUE(sample.error);
+    EXPECT_EQ(utils::Timeout, *sample.error);
+}
+
+TEST(ModbusPollEngine, WorkersPollEveryConnection) {
+    std::atomic<int> transactions[2] = {0, 0};
+    PollEngine engine;
+    for (int i = 0; i < 2; i++) {
+        const auto connection =
+            engine.addConnection([&, i](const ModbusRequest &request) {
+                transactions[i]++;
+                return Result<ModbusResponse>(test::answer(request, test::RegisterBase));
+            });
+        engine.addGroup(connection, 5ms, {point("a", 1), point("b", 2)});
+    }
+
+    engine.start();
+    std::this_thread::sleep_for(60ms);
+    engine.stop();
+
+    for (int i = 0; i < 2; i++) {
+        const auto stats = engine.stats(i);
+        EXPECT_GE(stats.cycles, 5u);
+        EXPECT_EQ(stats.transactions, static_cast<uint64_t>(transactions[i]));
+        EXPECT_LT(stats.maxJitter, 50ms);
+    }
+    EXPECT_TRUE(engine.sample(3).valid());
+}
+
+TEST(ModbusPollEngine, RejectsInvalidGroups) {
+    PollEngine engine;
+    const auto connection = engine.addConnection([](const ModbusRequest &request) {
+        return Result<ModbusResponse>(test::answer(request, test::RegisterBase));
+    });
+
+    auto write         = point("write", 1);
+    write.functionCode = utils::WriteSingleAnalogOutputRegister;
+    MB_EXPECT_THROW(engine.addGroup(connection, 1s, {write}), std::invalid_argument);
+    MB_EXPECT_THROW(engine.addGroup(connection, 1s, {point("bit", 1, Poll::Bit)}),
+                    std::invalid_argument);
+    MB_EXPECT_THROW(engine.addGroup(connection, 0s, {point("a", 1)}),
+                    std::invalid_argument);
+    MB_EXPECT_THROW(engine.addGroup(connection + 1, 1s, {point("a", 1)}),
+                    std::invalid_argument);
+}
@@ -0,0 +1,214 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "../expectThrow.hpp"
+#include "../simulatedDevice.hpp"
+#include "MB/modbusReadCache.hpp"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <future>
+#include <thread>
+
+using namespace MB;
+using namespace std::chrono_literals;
+
+namespace {
+//! Answers every request and counts them
+struct Device {
+    std::atomic<int> transactions{0};
+
+    Result<ModbusResponse> operator()(const ModbusRequest &request) {
+        transactions++;
+        return test::answer(request, test::RegisterBase);
+    }
+};
+} // namespace
+
+TEST(ModbusReadCache, ServesSubrangesOfCachedRanges) {
+    ReadCache cache(1h);
+    Device device;
+
+    ASSERT_TRUE(cache.read("a", test::readHolding(10, 20), std::ref(device)));
+    const auto inner = cache.read("a", test::readHolding(12, 3), std::ref(device));
+    ASSERT_TRUE(inner);
+    EXPECT_EQ(1, device.transactions);
+    ASSERT_EQ(3u, inner->registers().size());
+    EXPECT_EQ(0x100C, inner->registers()[0]);
+    EXPECT_EQ(0x100E, inner->registers()[2]);
+
+    // Ranges reaching outside, of other endpoint, unit or table are not served
+    EXPECT_TRUE(cache.read("a", test::readHolding(25, 10), std::ref(device)));
+    EXPECT_TRUE(cache.read("b", test::readHolding(12, 3), std::ref(device)));
+    EXPECT_TRUE(cache.read("a", test::readHolding(12, 3, 2), std::ref(device)));
+    EXPECT_TRUE(cache.read(
+        "a", ModbusRequest(1, utils::ReadAnalogInputRegisters, 12, 3), std::ref(device)));
+    EXPECT_EQ(5, device.transactions);
+
+    const ModbusRequest coils(1, utils::ReadDiscreteOutputCoils, 0, 16);
+    ASSERT_TRUE(cache.read("a", coils, std::ref(device)));
+    const auto bits = cache.read(
+        "a", ModbusRequest(1, utils::ReadDiscreteOutputCoils, 3, 2), std::ref(device));
+    ASSERT_TRUE(bits);
+    EXPECT_TRUE(bits->coils().test(0));
+    EXPECT_FALSE(bits->coils().test(1));
+    EXPECT_EQ(6, device.transactions);
+
+    const auto stats = cache.stats();
+    EXPECT_EQ(2u, stats.hits);
+    EXPECT_EQ(6u, stats.misses);
+    EXPECT_EQ(0u, stats.shared);
+}
+
+TEST(ModbusReadCache, ExpiresPerTtlClass) {
+    ReadCache cache(1h);
+    const auto fast = cache.addClass(1ms);
+    EXPECT_EQ(1ms, cache.ttl(fast));
+    Device device;
+
+    ASSERT_TRUE(cache.read("a", test::readHolding(0, 4), std::ref(device), fast));
+    std::this_thread::sleep_for(5ms);
+
+    // Too old for the fast class, fresh enough for the default one
+    ASSERT_TRUE(cache.read("a", test::readHolding(0, 4), std::ref(device), fast));
+    EXPECT_EQ(2, device.transactions);
+    ASSERT_TRUE(cache.read("a", test::readHolding(1, 2), std::ref(device)));
+    EXPECT_EQ(2, device.transactions);
+    EXPECT_EQ(1u, cache.size());
+
+    MB_EXPECT_THROW(cache.read("a", test::readHolding(0, 4), std::ref(device), 7),
+                    std::invalid_argument);
+    MB_EXPECT_THROW(cache.setTtl(7, 1s), std::invalid_argument);
+}
+
+TEST(ModbusReadCache, CollapsesConcurrentReads) {
+    ReadCache cache(1h);
+    std::promise<void> started;
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::atomic<int> transactions{0};
+    const auto transact = [&](const ModbusRequest &request) {
+        if (transactions++ == 0) {
+            started.set_value();
+            released.wait();
+        }
+        return Result<ModbusResponse>(test::answer(request, test::RegisterBase));
+    };
+
+    std::vector<std::future<Result<ModbusResponse>>> reads;
+    reads.push_back(std::async(std::launch::async, [&] {
+        return cache.read("a", test::readHolding(0, 10), transact);
+    }));
+    started.get_future().wait();
+    for (uint16_t i = 0; i < 7; i++)
+        reads.push_back(std::async(std::launch::async, [&, i] {
+            return cache.read("a", test::readHolding(i, 3), transact);
+        }));
+    while (cache.stats().shared < 7)
+        std::this_thread::yield();
+    release.set_value();
+
+    for (uint16_t i = 0; i < reads.size(); i++) {
+        const auto result = reads[i].get();
+        ASSERT_TRUE(result);
+        EXPECT_EQ(0x1000 + (i == 0 ? 0 : i - 1), result->registers()[0]);
+    }
+    EXPECT_EQ(1, transactions);
+    EXPECT_EQ(1u, cache.stats().misses);
+}
+
+TEST(ModbusReadCache, DoesNotCacheErrors) {
+    ReadCache cache(1h);
+    int calls          = 0;
+    const auto failing = [&](const ModbusRequest &) {
+        calls++;
+        return Result<ModbusResponse>(utils::Timeout);
+    };
+
+    const auto result = cache.read("a", test::readHolding(0, 2), failing);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(utils::Timeout, result.error());
+    EXPECT_FALSE(cache.read("a", test::readHolding(0, 2), failing));
+    EXPECT_EQ(2, calls);
+    EXPECT_EQ(0u, cache.size());
+
+    // Short responses are not cached either
+    const auto shorter = [&](const ModbusRequest &request) {
+        calls++;
+        const auto first = test::readHolding(request.registerAddress());
+        return Result<ModbusResponse>(test::answer(first, test::RegisterBase));
+    };
+    EXPECT_TRUE(cache.read("a", test::readHolding(0, 2), shorter));
+    EXPECT_EQ(0u, cache.size());
+
+    // Writes are passed through
+    Device device;
+    const ModbusRequest write(1, utils::WriteSingleAnalogOutputRegister, 0, 1);
+    EXPECT_TRUE(cache.read("a", write, std::ref(device)));
+    EXPECT_EQ(1, device.transactions);
+    EXPECT_EQ(0u, cache.size());
+}
+
+TEST(ModbusReadCache, WritesInvalidateOverlappingRanges) {
+    ReadCache cache(1h);
+    Device device;
+    const auto read = [&](uint16_t address, uint16_t count) {
+        return cache.read("a", test::readHolding(address, count), std::ref(device)).ok();
+    };
+
+    ASSERT_TRUE(read(0, 10));
+    ASSERT_TRUE(read(20, 10));
+    ASSERT_TRUE(cache.read("a", ModbusRequest(1, utils::ReadDiscreteOutputCoils, 0, 8),
+                           std::ref(device)));
+    EXPECT_EQ(3u, cache.size());
+
+    // Register write leaves the coils and the other range cached
+    EXPECT_TRUE(cache.write(
+        "a", ModbusRequest(1, utils::WriteMultipleAnalogOutputHoldingRegisters, 8, 4),
+        std::ref(device)));
+    EXPECT_EQ(2u, cache.size());
+    ASSERT_TRUE(read(22, 2));
+    EXPECT_EQ(4, device.transactions);
+    ASSERT_TRUE(read(2, 2));
+    EXPECT_EQ(5, device.transactions);
+
+    cache.invalidate("a", ModbusRequest(1, utils::WriteSingleDiscreteOutputCoil, 7, 1));
+    cache.invalidate("a", ModbusRequest::readWriteMultiple(1, 0, 1, 20, {1, 2}));
+    EXPECT_EQ(1u, cache.size());
+    EXPECT_EQ(3u, cache.stats().invalidations);
+
+    cache.clear();
+    EXPECT_EQ(0u, cache.size());
+}
+
+TEST(ModbusReadCache, DoesNotCacheReadsOverlappingWrites) {
+    ReadCache cache(1h);
+    std::promise<void> started;
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::atomic<int> transactions{0};
+    const auto transact = [&](const ModbusRequest &request) {
+        if (transactions++ == 0) {
+            started.set_value();
+            released.wait();
+        }
+        return Result<ModbusResponse>(test::answer(request, test::RegisterBase));
+    };
+
+    auto before = std::async(std::launch::async, [&] {
+        return cache.read("a", test::readHolding(0, 10), transact);
+    });
+    started.get_future().wait();
+    cache.invalidate("a", 1, utils::ReadAnalogOutputHoldingRegisters, 5, 1);
+
+    // Read after the write does not join the read before it
+    EXPECT_TRUE(cache.read("a", test::readHolding(0, 10), transact));
+    EXPECT_EQ(2, transactions);
+    release.set_value();
+    EXPECT_TRUE(before.get());
+
+    // Only the read started after the write is cached
+    EXPECT_EQ(1u, cache.size());
+    EXPECT_EQ(0u, cache.stats().shared);
+}
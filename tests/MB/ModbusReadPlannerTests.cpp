@@ -0,0 +1,151 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "../expectThrow.hpp"
+#include "../simulatedDevice.hpp"
+#include "MB/modbusReadPlanner.hpp"
+#include "gtest/gtest.h"
+
+using namespace MB;
+
+namespace {
+ReadPoint holding(uint16_t address, uint16_t count = 1, uint8_t unit = 1) {
+    return {unit, utils::ReadAnalogOutputHoldingRegisters, address, count};
+}
+
+} // namespace
+
+TEST(ModbusReadPlanner, MergesAcrossSmallGaps) {
+    ReadLimits limits;
+    limits.registerGap = 4;
+    const ReadPlanner planner(limits);
+
+    // Unordered, overlapping, and one gap too large
+    const auto plan = planner.plan({holding(10, 2), holding(0, 2), holding(6, 2),
+                                    holding(7, 4), holding(17, 2)});
+
+    ASSERT_EQ(2u, plan.reads().size());
+    const auto &first = plan.reads()[0].request;
+    EXPECT_EQ(0, first.registerAddress());
+    EXPECT_EQ(12, first.numberOfRegisters());
+    const auto &second = plan.reads()[1].request;
+    EXPECT_EQ(17, second.registerAddress());
+    EXPECT_EQ(2, second.numberOfRegisters());
+
+    EXPECT_EQ(0u, plan.readOf(0));
+    EXPECT_EQ(10, plan.offsetOf(0));
+    EXPECT_EQ(7, plan.offsetOf(3));
+    EXPECT_EQ(1u, plan.readOf(4));
+    EXPECT_EQ(0, plan.offsetOf(4));
+
+    // Members are ordered by address within their read
+    std::vector<std::size_t> points;
+    for (auto i = plan.reads()[0].firstMember; i < plan.reads()[0].lastMember; i++)
+        points.push_back(plan.members()[i].point);
+    EXPECT_EQ((std::vector<std::size_t>{1, 2, 3, 0}), points);
+}
+
+TEST(ModbusReadPlanner, SplitsAtProtocolAndDeviceLimits) {
+    ReadPlanner planner;
+    ReadLimits small;
+    small.maxRegisters = 10;
+    planner.setLimits(2, small);
+
+    std::vector<ReadPoint> points;
+    for (uint16_t address = 0; address < 300; address += 2) {
+        points.push_back(holding(address, 2, 1));
+        points.push_back(holding(address, 2, 2));
+    }
+    points.push_back({1, utils::ReadDiscreteOutputCoils, 0, 1999});
+    points.push_back({1, utils::ReadDiscreteOutputCoils, 1999, 2});
+
+    const auto plan = planner.plan(points);
+
+    std::size_t unit1 = 0, unit2 = 0, coils = 0;
+    for (const auto &read : plan.reads()) {
+        const auto &request = read.request;
+        if (request.functionCode() == utils::ReadDiscreteOutputCoils) {
+            EXPECT_LE(request.numberOfRegisters(), 2000);
+            coils++;
+        } else if (request.slaveID() == 1) {
+            EXPECT_LE(request.numberOfRegisters(), 125);
+            unit1++;
+        } else {
+            EXPECT_LE(request.numberOfRegisters(), 10);
+            unit2++;
+        }
+    }
+    EXPECT_EQ(3u, unit1);  // 125 + 125 + 50 registers
+    EXPECT_EQ(30u, unit2); // 10 registers each
+    EXPECT_EQ(2u, coils);
+    EXPECT_EQ(plan.reads().size(), plan.requests().size());
+}
+
+TEST(ModbusReadPlanner, CapsDeviceLimitsAtProtocolLimits) {
+    ReadPlanner planner;
+    ReadLimits large;
+    large.maxRegisters = 200;
+    large.maxCoils     = 3000;
+    planner.setLimits(1, large);
+
+    std::vector<ReadPoint> points;
+    for (uint16_t address = 0; address < 300; address += 2)
+        points.push_back(holding(address, 2));
+    points.push_back({1, utils::ReadDiscreteOutputCoils, 0, 2000});
+    points.push_back({1, utils::ReadDiscreteOutputCoils, 2000, 1000});
+    MB_EXPECT_THROW(planner.plan({holding(0, 126)}), std::invalid_argument);
+
+    const auto plan = planner.plan(points);
+    for (const auto &read : plan.reads()) {
+        if (read.request.functionCode() == utils::ReadDiscreteOutputCoils) {
+            EXPECT_LE(read.request.numberOfRegisters(), 2000);
+        } else {
+            EXPECT_LE(read.request.numberOfRegisters(), 125);
+        }
+    }
+    EXPECT_EQ(5u, plan.reads().size()); // 125 + 125 + 50 registers, 2 coil reads
+
+    // Every point maps into its response
+    for (std::size_t i = 0; i + 2 < points.size(); i++) {
+        const auto response   = test::answer(plan.reads()[plan.readOf(i)].request);
+        const auto *registers = plan.registers(i, response);
+        ASSERT_NE(nullptr, registers);
+        EXPECT_EQ(points[i].address, registers[0]);
+    }
+}
+
+TEST(ModbusReadPlanner, MapsResponsesWithoutCopies) {
+    const ReadPlanner planner;
+    const auto plan = planner.plan(
+        {holding(40, 2), holding(30), {1, utils::ReadDiscreteInputContacts, 5, 3}});
+    ASSERT_EQ(2u, plan.reads().size());
+
+    const auto response   = test::answer(plan.reads()[plan.readOf(0)].request);
+    const auto *registers = plan.registers(0, response);
+    ASSERT_NE(nullptr, registers);
+    EXPECT_EQ(response.registers().data() + 10, registers);
+    EXPECT_EQ(40, registers[0]);
+    EXPECT_EQ(41, registers[1]);
+    EXPECT_EQ(30, *plan.registers(1, response));
+
+    // Response shorter than the read is rejected
+    ModbusResponse shorter(1, utils::ReadAnalogOutputHoldingRegisters, 30, 2);
+    EXPECT_EQ(nullptr, plan.registers(0, shorter));
+
+    ModbusResponse coils(1, utils::ReadDiscreteInputContacts, 5, 3);
+    coils.setCoils({false, true, false});
+    EXPECT_TRUE(plan.coil(2, coils, 1));
+    EXPECT_FALSE(plan.coil(2, coils, 2));
+    EXPECT_FALSE(plan.coil(2, coils, 3));
+}
+
+TEST(ModbusReadPlanner, RejectsPointsThatDoNotFit) {
+    const ReadPlanner planner;
+    MB_EXPECT_THROW(planner.plan({holding(0, 0)}), std::invalid_argument);
+    MB_EXPECT_THROW(planner.plan({holding(0, 126)}), std::invalid_argument);
+    MB_EXPECT_THROW(planner.plan({holding(0xFFFF, 2)}), std::invalid_argument);
+    MB_EXPECT_THROW(planner.plan({{1, utils::WriteSingleAnalogOutputRegister, 0, 1}}),
+                    std::invalid_argument);
+    EXPECT_TRUE(planner.plan(std::vector<ReadPoint>()).reads().empty());
+}
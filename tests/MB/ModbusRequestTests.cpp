@@ -2,6 +2,7 @@
 // Copyright (c) 2020 Mateusz Mazur aka Mazurel
 // Licensed under: MIT License <http://opensource.org/licenses/MIT>
 
+#include "MB/modbusFraming.hpp"
 #include "MB/modbusRequest.hpp"
 #include "gtest/gtest.h"
 
@@ -162,3 +163,20 @@ TEST_F(ModBusRequest, ConstructorsCheck) {
     EXPECT_TRUE(com.registerAddress() == com2.registerAddress());
     EXPECT_TRUE(com.numberOfRegisters() == com2.numberOfRegisters());
 }
+
+TEST_F(ModBusRequest, EncodeInto) {
+    std::vector<uint8_t> buffer;
+    for (const auto *data : {&fn1Data, &fn5Data, &fn6Data, &fn15Data, &fn16Data}) {
+        const auto request = ModbusRequest::fromRawCRC(*data);
+
+        uint8_t raw[32];
+        ASSERT_EQ(data->size() - 2, request.encodeInto(raw, sizeof(raw)));
+        EXPECT_TRUE(std::equal(raw, raw + data->size() - 2, data->begin()));
+        EXPECT_EQ(0, request.encodeInto(raw, request.encodedSize() - 1));
+
+        // RTU framing appends CRC in the same pass
+        buffer.clear();
+        appendRTU(request, buffer);
+        EXPECT_EQ(*data, buffer);
+    }
+}
@@ -2,6 +2,7 @@
 // Copyright (c) 2020 Mateusz Mazur aka Mazurel
 // Licensed under: MIT License <http://opensource.org/licenses/MIT>
 
+#include "MB/modbusFraming.hpp"
 #include "MB/modbusRequest.hpp"
 #include "MB/modbusResponse.hpp"
 #include "gtest/gtest.h"
@@ -158,3 +159,22 @@ TEST_F(ModBusResponse, ConstructorsCheck) {
     EXPECT_TRUE(com.slaveID() == com2.slaveID());
     EXPECT_TRUE(com.functionCode() == com2.functionCode());
 }
+
+TEST_F(ModBusResponse, EncodeInto) {
+    std::vector<uint8_t> buffer = {0xAA}; // appendTo must keep existing content
+    const auto response         = ModbusResponse::fromRawCRC(fn3Data);
+    response.appendTo(buffer);
+
+    ASSERT_EQ(fn3Data.size() - 2 + 1, buffer.size());
+    EXPECT_TRUE(std::equal(buffer.begin() + 1, buffer.end(), fn3Data.begin()));
+
+    uint8_t adu[32];
+    ASSERT_EQ(MbapHeader::Size + fn3Data.size() - 2,
+              encodeTCP(response, 0x0102, adu, sizeof(adu)));
+    const auto header = MbapHeader::decode(adu);
+    EXPECT_EQ(0x0102, header.transactionID);
+    EXPECT_EQ(0, header.protocolID);
+    EXPECT_EQ(fn3Data.size() - 2, header.length);
+    EXPECT_TRUE(std::equal(adu + MbapHeader::Size, adu + MbapHeader::Size + 9,
+                           fn3Data.begin()));
+}
@@ -0,0 +1,131 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/TCP/connection.hpp"
+#include "MB/modbusException.hpp"
+#include "MB/modbusRequest.hpp"
+#include "MB/modbusResponse.hpp"
+#include "MB/modbusResult.hpp"
+#include "gtest/gtest.h"
+
+#include <sys/socket.h>
+
+using namespace MB;
+
+namespace {
+// Testing data from https://www.simplymodbus.ca/
+const std::vector<uint8_t> Fn3Response = {0x11, 0x03, 0x06, 0xAE, 0x41, 0x56,
+                                          0x52, 0x43, 0x40, 0x49, 0xAD};
+const std::vector<uint8_t> Fn3Request  = {0x11, 0x03, 0x00, 0x6B, 0x00, 0x03, 0x76, 0x87};
+} // namespace
+
+TEST(ModbusResult, ValueAndError) {
+    Result<int> value(42);
+    ASSERT_TRUE(value.ok());
+    EXPECT_EQ(42, value.value());
+    EXPECT_EQ(42, value.valueOr(0));
+
+    Result<int> error(utils::Timeout);
+    ASSERT_FALSE(error);
+    EXPECT_EQ(utils::Timeout, error.error());
+    EXPECT_EQ(7, error.valueOr(7));
+
+    EXPECT_TRUE(Status().ok());
+    EXPECT_EQ(utils::InvalidCRC, Status(utils::InvalidCRC).error());
+}
+
+TEST(ModbusResult, TryFromRaw) {
+    const auto request = ModbusRequest::tryFromRawCRC(Fn3Request);
+    ASSERT_TRUE(request);
+    EXPECT_EQ(0x006B, request->registerAddress());
+    EXPECT_EQ(3, request->numberOfRegisters());
+
+    const auto response = ModbusResponse::tryFromRawCRC(Fn3Response);
+    ASSERT_TRUE(response);
+    EXPECT_EQ(0x5652, response->registers()[1]);
+
+    auto corrupted = Fn3Response;
+    corrupted[4] ^= 0x01;
+    const auto badCRC = ModbusResponse::tryFromRawCRC(corrupted);
+    ASSERT_FALSE(badCRC);
+    EXPECT_EQ(utils::InvalidCRC, badCRC.error());
+
+    const std::vector<uint8_t> unknownFunction = {0x11, 0x42, 0x00, 0x00, 0x00, 0x00};
+    EXPECT_EQ(utils::InvalidByteOrder,
+              ModbusRequest::tryFromRaw(unknownFunction).error());
+}
+
+TEST(ModbusResult, PartialFrame) {
+    // Frame arriving byte by byte is reported as InvalidByteOrder until complete
+    for (std::size_t size = 0; size < Fn3Response.size(); size++) {
+        const auto partial = ModbusResponseView::tryFromRawCRC(Fn3Response.data(), size);
+        ASSERT_FALSE(partial);
+        EXPECT_EQ(utils::InvalidByteOrder, partial.error());
+    }
+    EXPECT_TRUE(ModbusResponseView::tryFromRawCRC(Fn3Response));
+}
+
+#ifdef MB_EXCEPTIONS
+TEST(ModbusResult, ThrowingApiMatches) {
+    auto corrupted = Fn3Request;
+    corrupted.back() ^= 0x01;
+    try {
+        std::ignore = ModbusRequest::fromRawCRC(corrupted);
+        FAIL() << "Expected ModbusException";
+    } catch (const ModbusException &ex) {
+        EXPECT_EQ(utils::InvalidCRC, ex.getErrorCode());
+        EXPECT_EQ(0x11, ex.slaveID());
+    }
+}
+#endif
+
+TEST(ModbusResult, ExceptionTryFromRaw) {
+    const std::vector<uint8_t> frame = {0x0A, 0x81, 0x02, 0xB0, 0x53};
+
+    const auto exception = ModbusException::tryFromRaw(frame.data(), frame.size(), true);
+    ASSERT_TRUE(exception);
+    EXPECT_EQ(utils::IllegalDataAddress, exception->getErrorCode());
+    EXPECT_EQ(utils::ReadDiscreteOutputCoils, exception->functionCode());
+
+    EXPECT_EQ(utils::InvalidByteOrder,
+              ModbusException::tryFromRaw(frame.data(), 4, true).error());
+    EXPECT_EQ(utils::InvalidByteOrder,
+              ModbusException::tryFromRaw(Fn3Request.data(), 3).error());
+
+    auto corrupted = frame;
+    corrupted[2]   = 0x03;
+    EXPECT_EQ(utils::InvalidCRC,
+              ModbusException::tryFromRaw(corrupted.data(), 5, true).error());
+}
+
+TEST(ModbusResult, TcpTryAwaitResponse) {
+    int fds[2];
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    TCP::Connection client(fds[0]);
+    TCP::Connection server(fds[1]);
+
+    server.sendResponse(ModbusResponse::fromRawCRC(Fn3Response));
+    const auto response = client.tryAwaitResponse();
+    ASSERT_TRUE(response);
+    EXPECT_EQ(3, response->numberOfRegisters());
+
+    const ModbusException exception(utils::IllegalDataAddress, 0x11,
+                                    utils::ReadAnalogOutputHoldingRegisters);
+    server.sendException(exception);
+    const auto failed = client.tryAwaitResponse();
+    ASSERT_FALSE(failed);
+    EXPECT_EQ(utils::IllegalDataAddress, failed.error());
+
+#ifdef MB_EXCEPTIONS
+    server.sendException(exception);
+    try {
+        std::ignore = client.awaitResponse();
+        FAIL() << "Expected ModbusException";
+    } catch (const ModbusException &ex) {
+        EXPECT_EQ(utils::IllegalDataAddress, ex.getErrorCode());
+        EXPECT_EQ(0x11, ex.slaveID());
+        EXPECT_EQ(utils::ReadAnalogOutputHoldingRegisters, ex.functionCode());
+    }
+#endif
+}
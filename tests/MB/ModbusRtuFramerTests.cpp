@@ -0,0 +1,217 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/Serial/connection.hpp"
+#include "MB/modbusRtuFramer.hpp"
+#include "gtest/gtest.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fcntl.h>
+
+using namespace MB;
+
+namespace {
+using Frame = std::vector<uint8_t>;
+
+// Testing data from https://www.simplymodbus.ca/
+const Frame Fn1Response  = {0x11, 0x01, 0x05, 0xCD, 0x6B, 0xB2, 0x0E, 0x1B, 0x45, 0xE6};
+const Frame Fn3Response  = {0x11, 0x03, 0x06, 0xAE, 0x41, 0x56,
+                            0x52, 0x43, 0x40, 0x49, 0xAD};
+const Frame Fn6Response  = {0x11, 0x06, 0x00, 0x01, 0x00, 0x03, 0x9A, 0x9B};
+const Frame Fn16Response = {0x11, 0x10, 0x00, 0x01, 0x00, 0x02, 0x12, 0x98};
+const Frame Exception    = {0x0A, 0x81, 0x02, 0xB0, 0x53};
+
+const Frame Fn3Request  = {0x11, 0x03, 0x00, 0x6B, 0x00, 0x03, 0x76, 0x87};
+const Frame Fn16Request = {0x11, 0x10, 0x00, 0x01, 0x00, 0x02, 0x04,
+                           0x00, 0x0A, 0x01, 0x02, 0xC6, 0xF0};
+
+Frame concat(std::initializer_list<Frame> frames) {
+    Frame stream;
+    for (const auto &frame : frames)
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    return stream;
+}
+
+std::vector<Frame> feedInChunks(RtuFramer &framer, const Frame &stream,
+                                std::size_t chunk) {
+    std::vector<Frame> frames;
+    for (std::size_t pos = 0; pos < stream.size(); pos += chunk) {
+        const auto size = std::min(chunk, stream.size() - pos);
+        framer.feed(stream.data() + pos, size,
+                    [&](const uint8_t *frame, std::size_t len) {
+                        frames.emplace_back(frame, frame + len);
+                    });
+    }
+    return frames;
+}
+} // namespace
+
+TEST(ModbusRtuFramer, PredictFrameSize) {
+    EXPECT_EQ(RtuFramer::NeedMoreData,
+              RtuFramer::predictFrameSize(RtuFramer::Responses, Fn3Response.data(), 2));
+    EXPECT_EQ(Fn3Response.size(),
+              RtuFramer::predictFrameSize(RtuFramer::Responses, Fn3Response.data(), 3));
+    EXPECT_EQ(5u, RtuFramer::predictFrameSize(RtuFramer::Responses, Exception.data(), 2));
+    EXPECT_EQ(8u, RtuFramer::predictFrameSize(RtuFramer::Requests, Fn3Request.data(), 2));
+    EXPECT_EQ(RtuFramer::NeedMoreData,
+              RtuFramer::predictFrameSize(RtuFramer::Requests, Fn16Request.data(), 6));
+    EXPECT_EQ(Fn16Request.size(),
+              RtuFramer::predictFrameSize(RtuFramer::Requests, Fn16Request.data(), 7));
+
+    const Frame unknown = {0x11, 0x42};
+    EXPECT_EQ(RtuFramer::InvalidFrame,
+              RtuFramer::predictFrameSize(RtuFramer::Responses, unknown.data(), 2));
+}
+
+TEST(ModbusRtuFramer, SplitAndMergedReads) {
+    const auto stream =
+        concat({Fn1Response, Fn3Response, Exception, Fn6Response, Fn16Response});
+    const std::vector<Frame> expected = {Fn1Response, Fn3Response, Exception, Fn6Response,
+                                         Fn16Response};
+
+    for (std::size_t chunk : {std::size_t(1), std::size_t(3), std::size_t(7),
+                              stream.size()}) {
+        RtuFramer framer(RtuFramer::Responses);
+        EXPECT_EQ(expected, feedInChunks(framer, stream, chunk)) << "chunk " << chunk;
+        EXPECT_EQ(0u, framer.pending());
+        EXPECT_EQ(0u, framer.crcErrors());
+    }
+}
+
+TEST(ModbusRtuFramer, Requests) {
+    RtuFramer framer(RtuFramer::Requests);
+    const auto frames = feedInChunks(framer, concat({Fn16Request, Fn3Request}), 5);
+    EXPECT_EQ(std::vector<Frame>({Fn16Request, Fn3Request}), frames);
+}
+
+TEST(ModbusRtuFramer, Resynchronizes) {
+    auto corrupted = Fn3Response;
+    corrupted[5] ^= 0xFF;
+
+    // Noise, corrupted frame and valid frames after it
+    const auto stream = concat({{0x00, 0x42}, corrupted, Fn6Response, Exception});
+
+    RtuFramer framer(RtuFramer::Responses);
+    const auto frames = feedInChunks(framer, stream, 4);
+    EXPECT_EQ(std::vector<Frame>({Fn6Response, Exception}), frames);
+    EXPECT_GE(framer.crcErrors(), 1u);
+    EXPECT_GE(framer.discardedBytes(), 2u + corrupted.size());
+}
+
+TEST(ModbusRtuFramer, StopsAfterFrame) {
+    const auto stream = concat({Fn6Response, Fn16Response});
+
+    RtuFramer framer(RtuFramer::Responses);
+    std::size_t count = 0;
+    auto stopAtFirst  = [&](const uint8_t *, std::size_t) {
+        count++;
+        return false;
+    };
+
+    const auto consumed = framer.feed(stream.data(), stream.size(), stopAtFirst);
+    EXPECT_EQ(Fn6Response.size(), consumed);
+    EXPECT_EQ(1u, count);
+
+    framer.feed(stream.data() + consumed, stream.size() - consumed, stopAtFirst);
+    EXPECT_EQ(2u, count);
+}
+
+TEST(ModbusRtuFramer, SerialAwaitResponse) {
+    const int master = ::posix_openpt(O_RDWR | O_NOCTTY);
+    ASSERT_GE(master, 0);
+    ASSERT_EQ(0, ::grantpt(master));
+    ASSERT_EQ(0, ::unlockpt(master));
+
+    Serial::Connection connection(::ptsname(master));
+    connection.connect();
+
+    // First frame split over two writes, second frame arrives with its tail
+    const auto stream = concat({Fn3Response, Exception});
+    ASSERT_EQ(4, ::write(master, stream.data(), 4));
+    const auto tail = stream.size() - 4;
+    ASSERT_EQ(long(tail), ::write(master, stream.data() + 4, tail));
+
+    auto [response, raw] = connection.awaitResponse();
+    EXPECT_EQ(Fn3Response, raw);
+    EXPECT_EQ(0x5652, response.registers()[1]);
+
+    const auto exception = connection.tryAwaitResponse();
+    ASSERT_FALSE(exception);
+    EXPECT_EQ(utils::IllegalDataAddress, exception.error());
+
+    ::close(master);
+}
+
+TEST(ModbusRtuFramer, SerialMoveKeepsBufferedFrames) {
+    auto openMaster = [] {
+        const int master = ::posix_openpt(O_RDWR | O_NOCTTY);
+        ::grantpt(master);
+        ::unlockpt(master);
+        return master;
+    };
+    const int master = openMaster();
+    const int other  = openMaster();
+    ASSERT_GE(master, 0);
+    ASSERT_GE(other, 0);
+
+    Serial::Connection connection(::ptsname(master));
+    connection.connect();
+    connection.setTimeout(250);
+
+    // Both frames are read at once, the second stays buffered in connection
+    const auto stream = concat({Fn3Response, Exception, Fn6Response});
+    ASSERT_EQ(long(stream.size() - 3), ::write(master, stream.data(), stream.size() - 3));
+    EXPECT_EQ(Fn3Response, std::get<1>(connection.awaitResponse()));
+
+    Serial::Connection moved(std::move(connection));
+    EXPECT_EQ(250, moved.getTimeout());
+    const auto exception = moved.tryAwaitResponse();
+    ASSERT_FALSE(exception);
+    EXPECT_EQ(utils::IllegalDataAddress, exception.error());
+
+    // Half of Fn6Response is in the framer, target's own descriptor is closed
+    Serial::Connection target(::ptsname(other));
+    const auto countFds = [] {
+        return std::distance(std::filesystem::directory_iterator("/proc/self/fd"),
+                             std::filesystem::directory_iterator());
+    };
+    const auto fds = countFds();
+    target         = std::move(moved);
+    EXPECT_EQ(fds - 1, countFds());
+    EXPECT_EQ(250, target.getTimeout());
+
+    ASSERT_EQ(3, ::write(master, stream.data() + stream.size() - 3, 3));
+    EXPECT_EQ(Fn6Response, std::get<1>(target.awaitResponse()));
+
+    ::close(master);
+    ::close(other);
+}
+
+TEST(ModbusRtuFramer, SerialTimeoutDropsTruncatedFrame) {
+    const int master = ::posix_openpt(O_RDWR | O_NOCTTY);
+    ASSERT_GE(master, 0);
+    ::grantpt(master);
+    ::unlockpt(master);
+
+    Serial::Connection connection(::ptsname(master));
+    connection.connect();
+    connection.setTimeout(50);
+
+    // Header of the truncated response predicts 122 bytes of registers,
+    // more than the following response has
+    const Frame truncatedHeader = {0x11, 0x03, 0x7A, 0xAE};
+    ASSERT_EQ(4, ::write(master, truncatedHeader.data(), 4));
+    const auto truncated = connection.tryAwaitResponse();
+    ASSERT_FALSE(truncated);
+    EXPECT_EQ(utils::Timeout, truncated.error());
+
+    ASSERT_EQ(long(Fn6Response.size()),
+              ::write(master, Fn6Response.data(), Fn6Response.size()));
+    const auto response = connection.tryAwaitResponse();
+    ASSERT_TRUE(response) << response.error();
+    EXPECT_EQ(Fn6Response, std::get<1>(response.value()));
+
+    ::close(master);
+}
@@ -0,0 +1,78 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/TCP/server.hpp"
+#include "gtest/gtest.h"
+
+#include <netinet/tcp.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace MB;
+
+namespace {
+int option(int sockfd, int level, int name) {
+    int value      = 0;
+    socklen_t size = sizeof(value);
+    ::getsockopt(sockfd, level, name, &value, &size);
+    return value;
+}
+
+int portOf(TCP::Server &server) {
+    sockaddr_in address = {};
+    socklen_t size      = sizeof(address);
+    ::getsockname(server.nativeHandle(), reinterpret_cast<sockaddr *>(&address), &size);
+    return ntohs(address.sin_port);
+}
+} // namespace
+
+TEST(ModbusSocketOptions, DefaultsLeaveSocketsUntouched) {
+    TCP::Server server(0);
+    std::optional<TCP::Connection> accepted;
+    std::thread acceptor([&] { accepted = server.awaitConnection(); });
+    auto client = TCP::Connection::with("127.0.0.1", portOf(server));
+    acceptor.join();
+    ASSERT_TRUE(accepted);
+
+    for (const auto sockfd : {client.getSockfd(), accepted->getSockfd()}) {
+        EXPECT_EQ(0, option(sockfd, IPPROTO_TCP, TCP_NODELAY));
+        EXPECT_EQ(0, option(sockfd, SOL_SOCKET, SO_KEEPALIVE));
+    }
+}
+
+TEST(ModbusSocketOptions, AppliedToClientAndAcceptedConnections) {
+    auto options              = TCP::SocketOptions::throughput();
+    options.keepAliveIdle     = std::chrono::seconds(30);
+    options.keepAliveInterval = std::chrono::seconds(5);
+    options.keepAliveProbes   = 4;
+
+    TCP::Server server(0, options);
+    std::optional<TCP::Connection> accepted;
+    std::thread acceptor([&] { accepted = server.awaitConnection(); });
+    auto client = TCP::Connection::with("127.0.0.1", portOf(server), options);
+    acceptor.join();
+    ASSERT_TRUE(accepted);
+
+    for (const auto sockfd : {client.getSockfd(), accepted->getSockfd()}) {
+        EXPECT_NE(0, option(sockfd, IPPROTO_TCP, TCP_NODELAY));
+        EXPECT_NE(0, option(sockfd, SOL_SOCKET, SO_KEEPALIVE));
+        EXPECT_EQ(30, option(sockfd, IPPROTO_TCP, TCP_KEEPIDLE));
+        EXPECT_EQ(5, option(sockfd, IPPROTO_TCP, TCP_KEEPINTVL));
+        EXPECT_EQ(4, option(sockfd, IPPROTO_TCP, TCP_KEEPCNT));
+        // Kernel doubles requested size for its bookkeeping
+        EXPECT_GE(option(sockfd, SOL_SOCKET, SO_RCVBUF), options.receiveBuffer);
+    }
+}
+
+TEST(ModbusSocketOptions, LowLatencyNeedsNoPrivileges) {
+    const int sockfd   = ::socket(AF_INET, SOCK_STREAM, 0);
+    const int busyPoll = option(sockfd, SOL_SOCKET, SO_BUSY_POLL);
+    const auto options = TCP::SocketOptions::lowLatency();
+
+    EXPECT_TRUE(options.apply(sockfd));
+    EXPECT_EQ(0, options.busyPoll.count());
+    EXPECT_EQ(busyPoll, option(sockfd, SOL_SOCKET, SO_BUSY_POLL));
+    EXPECT_NE(0, option(sockfd, IPPROTO_TCP, TCP_NODELAY));
+    ::close(sockfd);
+}
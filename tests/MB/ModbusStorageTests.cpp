@@ -0,0 +1,121 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "../expectThrow.hpp"
+#include "MB/modbusCellView.hpp"
+#include "MB/modbusCoilBitset.hpp"
+#include "MB/modbusRegisterBlock.hpp"
+#include "MB/modbusRequest.hpp"
+#include "MB/modbusResponse.hpp"
+#include "gtest/gtest.h"
+
+using namespace MB;
+
+TEST(RegisterBlock, Manipulation) {
+    RegisterBlock block = {1, 2, 3};
+    EXPECT_EQ(3, block.size());
+    EXPECT_EQ(2, block[1]);
+
+    block.push_back(4);
+    block.resize(6);
+    EXPECT_EQ(4, block[3]);
+    EXPECT_EQ(0, block[5]);
+    MB_EXPECT_THROW(block.at(6), std::out_of_range);
+
+    MB_EXPECT_THROW(block.resize(RegisterBlock::Capacity + 1), std::length_error);
+    EXPECT_NO_THROW(block.resize(RegisterBlock::Capacity));
+    MB_EXPECT_THROW(block.push_back(0), std::length_error);
+}
+
+TEST(RegisterBlock, BigEndian) {
+    const uint8_t raw[] = {0xAE, 0x41, 0x56, 0x52};
+    RegisterBlock block;
+    block.assignBigEndian(raw, 2);
+    EXPECT_EQ(0xAE41, block[0]);
+    EXPECT_EQ(0x5652, block[1]);
+
+    uint8_t out[4] = {};
+    block.copyBigEndian(out);
+    EXPECT_TRUE(std::equal(raw, raw + 4, out));
+}
+
+TEST(CoilBitset, Manipulation) {
+    CoilBitset coils(10);
+    EXPECT_EQ(10, coils.size());
+    EXPECT_EQ(2, coils.byteSize());
+
+    coils.set(0);
+    coils.set(9);
+    EXPECT_TRUE(coils[0]);
+    EXPECT_FALSE(coils[1]);
+    EXPECT_TRUE(coils[9]);
+    EXPECT_EQ(0x01, coils.data()[0]);
+    EXPECT_EQ(0x02, coils.data()[1]);
+
+    // Shrinking must clear bits, so they do not reappear after growing again
+    coils.resize(9);
+    coils.resize(10);
+    EXPECT_FALSE(coils[9]);
+
+    MB_EXPECT_THROW(coils.resize(CoilBitset::Capacity + 1), std::length_error);
+}
+
+TEST(CoilBitset, Packed) {
+    const uint8_t raw[] = {0xCD, 0xFF};
+    CoilBitset coils;
+    coils.assignPacked(raw, 10);
+    EXPECT_TRUE(coils[0]);
+    EXPECT_FALSE(coils[1]);
+    EXPECT_TRUE(coils[9]);
+    // Bits past size are cleared
+    EXPECT_EQ(0x03, coils.data()[1]);
+}
+
+TEST(ModbusCellView, Compatibility) {
+    ModbusRequest request(1, utils::WriteMultipleDiscreteOutputCoils, 0, 3,
+                          {ModbusCell::initCoil(true), ModbusCell::initReg(0),
+                           ModbusCell::initReg(5)});
+
+    EXPECT_TRUE(request.registerValues().holdsCoils());
+    std::vector<ModbusCell> cells = request.registerValues();
+    ASSERT_EQ(3, cells.size());
+    EXPECT_TRUE(cells[0].isCoil());
+    EXPECT_TRUE(cells[0].coil());
+    EXPECT_FALSE(cells[1].coil());
+    EXPECT_TRUE(cells[2].coil());
+
+    request.setFunctionCode(utils::WriteMultipleAnalogOutputHoldingRegisters);
+    EXPECT_FALSE(request.registerValues().holdsCoils());
+    EXPECT_EQ(1, request.registers()[0]);
+    EXPECT_EQ(0, request.registers()[1]);
+}
+
+TEST(ModbusCellView, IteratorsOutliveView) {
+    const ModbusRequest request(1, utils::WriteMultipleAnalogOutputHoldingRegisters, 0, 3,
+                                {ModbusCell::initReg(7), ModbusCell::initReg(8),
+                                 ModbusCell::initReg(9)});
+
+    // Views are temporaries, iterators refer to the request storage
+    auto it        = request.registerValues().begin();
+    const auto end = request.registerValues().end();
+    ASSERT_EQ(3, end - it);
+    EXPECT_EQ(7, (*it).reg());
+    EXPECT_EQ(9, it[2].reg());
+    std::vector<uint16_t> values;
+    for (; it != end; ++it)
+        values.push_back((*it).reg());
+    EXPECT_EQ((std::vector<uint16_t>{7, 8, 9}), values);
+
+    const ModbusResponse response(1, utils::ReadDiscreteOutputCoils, 0, 2);
+    EXPECT_NE(response.registerValues().begin(), request.registerValues().begin());
+}
+
+TEST(ModbusResponse, OversizedByteCount) {
+    std::vector<uint8_t> raw(3 + 252, 0x00);
+    raw[0] = 0x11;
+    raw[1] = utils::ReadAnalogOutputHoldingRegisters;
+    raw[2] = 252; // 126 registers, one above protocol maximum
+
+    MB_EXPECT_THROW(ModbusResponse::fromRaw(raw), ModbusException);
+}
@@ -0,0 +1,176 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "MB/TCP/connection.hpp"
+#include "MB/modbusFormat.hpp"
+#include "MB/modbusRequest.hpp"
+#include "MB/modbusTrace.hpp"
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <sys/socket.h>
+#include <thread>
+
+using namespace MB;
+
+TEST(ModbusTrace, FormatBufferTruncates) {
+    char buffer[8];
+    utils::FormatBuffer out(buffer, sizeof(buffer));
+    out << "slave " << uint8_t(17) << 12345;
+    EXPECT_EQ("slave 1", out.view());
+    EXPECT_TRUE(out.truncated());
+    EXPECT_EQ('\0', buffer[7]);
+
+    const uint8_t bytes[] = {0x11, 0x03, 0xAB};
+    char hex[16];
+    utils::FormatBuffer hexOut(hex, sizeof(hex));
+    hexOut.hex(bytes, 3);
+    EXPECT_EQ("11 03 AB", hexOut.view());
+}
+
+TEST(ModbusTrace, FormatToMatchesToString) {
+    ModbusRequest request(17, utils::WriteMultipleAnalogOutputHoldingRegisters, 1, 6);
+    request.setRegisters({1, 2, 3, 4, 5, 6});
+
+    char buffer[ModbusRequest::MaxStringSize + 1];
+    const auto size = request.formatTo(buffer, sizeof(buffer));
+    EXPECT_EQ(request.toString(), std::string(buffer, size));
+    EXPECT_EQ("Write to multiple holding registers, from slave 17, starting from "
+              "address 1, on 6 registers\n values = { 1 , 2 , 3 , 4 ,  , ... }",
+              request.toString());
+
+    const ModbusException exception(utils::IllegalDataAddress, 3,
+                                    utils::ReadAnalogInputRegisters);
+    EXPECT_STREQ("Error on slave 3 - Illegal data address ( on function: Read from input "
+                 "registers )",
+                 exception.what());
+    EXPECT_EQ(exception.toString(), exception.what());
+    static_assert(utils::mbFunctionToStrView(utils::MaskWriteRegister) ==
+                  "Mask write register");
+    // Allocating variants keep their std::string interface
+    const std::string function = utils::mbFunctionToStr(utils::MaskWriteRegister);
+    EXPECT_EQ("Mask write register", function);
+    EXPECT_EQ("Error: Timeout", "Error: " + utils::mbErrorCodeToStr(utils::Timeout));
+}
+
+TEST(ModbusTrace, RecordAndFormat) {
+    TraceSink sink;
+    const uint8_t frame[] = {0x11, 0x03, 0x00, 0x6B, 0x00, 0x03, 0x76, 0x87};
+    sink.record(TraceDirection::Tx, frame, sizeof(frame));
+
+    std::vector<TraceRecord> records;
+    const auto count =
+        sink.drain([&](const TraceRecord &record) { records.push_back(record); });
+    EXPECT_EQ(1u, count);
+    ASSERT_EQ(1u, records.size());
+    EXPECT_EQ(TraceDirection::Tx, records[0].direction);
+    EXPECT_EQ(0x11, records[0].slaveId);
+    EXPECT_EQ(0x03, records[0].functionCode);
+    EXPECT_EQ(8, records[0].size);
+
+    auto text = toString(records[0]);
+    text      = text.substr(text.find(' '));
+    EXPECT_EQ(" TX slave 17 Read from output registers [8] 11 03 00 6B 00 03 76 87",
+              text);
+    EXPECT_EQ(0u, sink.drain([](const TraceRecord &) {}));
+}
+
+TEST(ModbusTrace, ThreadRecordsIntoManySinks) {
+    // More sinks than rings remembered by the thread, records must not mix
+    std::vector<std::unique_ptr<TraceSink>> sinks;
+    for (int i = 0; i < 12; i++)
+        sinks.push_back(std::make_unique<TraceSink>());
+
+    for (uint8_t round = 0; round < 3; round++)
+        for (std::size_t i = 0; i < sinks.size(); i++) {
+            const uint8_t frame[] = {static_cast<uint8_t>(i), 0x03, round};
+            sinks[i]->record(TraceDirection::Rx, frame, sizeof(frame));
+        }
+
+    for (std::size_t i = 0; i < sinks.size(); i++) {
+        std::vector<uint8_t> rounds;
+        sinks[i]->drain([&](const TraceRecord &record) {
+            EXPECT_EQ(i, record.slaveId);
+            rounds.push_back(record.data[2]);
+        });
+        EXPECT_EQ((std::vector<uint8_t>{0, 1, 2}), rounds);
+    }
+}
+
+TEST(ModbusTrace, LongFrameIsCut) {
+    TraceRing ring(4);
+    TraceRecord record{};
+    record.size     = 200;
+    record.captured = TraceRecord::MaxCaptured;
+    const auto text = toString(record);
+    EXPECT_EQ(" ...", text.substr(text.size() - 4));
+    EXPECT_LE(text.size(), MaxTraceStringSize);
+
+    EXPECT_EQ(4u, ring.capacity());
+    for (int i = 0; i < 6; i++)
+        ring.push(record);
+    EXPECT_EQ(2u, ring.dropped());
+    EXPECT_EQ(4u, ring.drain([](const TraceRecord &) {}));
+}
+
+// Each thread writes into its own ring while reader drains concurrently
+TEST(ModbusTrace, ConcurrentProducers) {
+    constexpr int Threads = 4;
+    constexpr int Frames  = 20000;
+    TraceSink sink(256);
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t < Threads; t++)
+        producers.emplace_back([&sink, t] {
+            for (int i = 0; i < Frames; i++) {
+                const uint8_t frame[] = {static_cast<uint8_t>(t), 0x03,
+                                         static_cast<uint8_t>(i >> 8),
+                                         static_cast<uint8_t>(i)};
+                sink.record(TraceDirection::Rx, frame, sizeof(frame));
+            }
+        });
+
+    std::vector<int> last(Threads, -1);
+    bool ordered         = true;
+    std::size_t received = 0;
+    auto onRecord        = [&](const TraceRecord &record) {
+        const int index = (record.data[2] << 8) | record.data[3];
+        ordered &= index > last[record.slaveId];
+        last[record.slaveId] = index;
+        received++;
+    };
+    for (int i = 0; i < 1000; i++)
+        sink.drain(onRecord);
+    for (auto &producer : producers)
+        producer.join();
+    sink.drain(onRecord);
+
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(std::size_t(Threads) * Frames, received + sink.dropped());
+}
+
+TEST(ModbusTrace, TcpConnectionRecordsFrames) {
+    int fds[2];
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    TCP::Connection client(fds[0]), server(fds[1]);
+    TraceSink sink;
+    client.setTraceSink(&sink);
+
+    client.sendRequest(
+        ModbusRequest(0x11, utils::ReadAnalogOutputHoldingRegisters, 0, 2));
+    EXPECT_EQ(2, server.awaitRequest().numberOfRegisters());
+    ModbusResponse response(0x11, utils::ReadAnalogOutputHoldingRegisters, 0, 2);
+    response.setRegisters({1, 2});
+    server.sendResponse(response);
+    EXPECT_EQ(2, client.awaitResponse().registers()[1]);
+
+    std::vector<TraceRecord> records;
+    sink.drain([&](const TraceRecord &record) { records.push_back(record); });
+    ASSERT_EQ(2u, records.size());
+    EXPECT_EQ(TraceDirection::Tx, records[0].direction);
+    EXPECT_EQ(6u, records[0].size);
+    EXPECT_EQ(TraceDirection::Rx, records[1].direction);
+    EXPECT_EQ(7u, records[1].size);
+    EXPECT_LE(records[0].timestamp, records[1].timestamp);
+}
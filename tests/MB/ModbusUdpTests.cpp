@@ -0,0 +1,210 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "../simulatedDevice.hpp"
+#include "MB/UDP/client.hpp"
+#include "MB/UDP/server.hpp"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <set>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <poll.h>
+
+using namespace MB;
+
+namespace {
+/**
+ * Device on plain UDP socket, `reply(request)` returns how many copies of
+ * the response to send (0 drops the request). Received requests are
+ * collected and answered in reverse order of arrival.
+ */
+class RawDevice {
+  private:
+    int _sockfd;
+    std::atomic<bool> _stop{false};
+    std::thread _thread;
+
+  public:
+    template <typename Reply> explicit RawDevice(Reply reply) {
+        _sockfd              = ::socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in address  = {};
+        address.sin_family   = AF_INET;
+        address.sin_addr     = {inet_addr("127.0.0.1")};
+        ::bind(_sockfd, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+
+        _thread = std::thread([this, reply] {
+            std::vector<std::pair<std::vector<uint8_t>, sockaddr_in>> replies;
+            while (!_stop) {
+                pollfd waiting = {.fd = _sockfd, .events = POLLIN, .revents = 0};
+                if (::poll(&waiting, 1, 5) <= 0) {
+                    // Quiet socket, answer what was collected
+                    for (auto it = replies.rbegin(); it != replies.rend(); it++)
+                        ::sendto(_sockfd, it->first.data(), it->first.size(), 0,
+                                 reinterpret_cast<sockaddr *>(&it->second),
+                                 sizeof(it->second));
+                    replies.clear();
+                    continue;
+                }
+
+                uint8_t datagram[512];
+                sockaddr_in peer{};
+                socklen_t size  = sizeof(peer);
+                const auto read = ::recvfrom(_sockfd, datagram, sizeof(datagram), 0,
+                                             reinterpret_cast<sockaddr *>(&peer), &size);
+                if (read <= static_cast<ssize_t>(MbapHeader::Size))
+                    continue;
+                const auto header  = MbapHeader::decode(datagram);
+                const auto request = ModbusRequest::tryFromRaw(
+                    datagram + MbapHeader::Size,
+                    static_cast<std::size_t>(read) - MbapHeader::Size);
+                if (!request)
+                    continue;
+
+                std::vector<uint8_t> response;
+                appendTCP(test::answer(request.value(), test::RegisterBase),
+                          header.transactionID, response);
+                for (int copies = reply(request.value()); copies > 0; copies--)
+                    replies.emplace_back(response, peer);
+            }
+        });
+    }
+
+    ~RawDevice() {
+        _stop = true;
+        _thread.join();
+        ::close(_sockfd);
+    }
+
+    [[nodiscard]] int port() const {
+        sockaddr_in address{};
+        socklen_t size = sizeof(address);
+        ::getsockname(_sockfd, reinterpret_cast<sockaddr *>(&address), &size);
+        return ntohs(address.sin_port);
+    }
+};
+} // namespace
+
+TEST(ModbusUdp, TransactsWithServer) {
+    UDP::Server server(0);
+    std::atomic<bool> stop{false};
+    std::thread device([&] {
+        while (!stop)
+            std::ignore = server.serve(
+                [](const ModbusRequest &request) -> Result<ModbusResponse> {
+                    if (request.registerAddress() >= 1000)
+                        return utils::IllegalDataAddress;
+                    return test::answer(request, test::RegisterBase);
+                },
+                5);
+    });
+
+    auto client         = UDP::Client::with("127.0.0.1", server.port());
+    const auto response = client.transact(test::readHolding(7, 2));
+    ASSERT_TRUE(response);
+    ASSERT_EQ(2u, response->registers().size());
+    EXPECT_EQ(0x1007, response->registers()[0]);
+    EXPECT_EQ(0x1008, response->registers()[1]);
+
+    const auto failed = client.transact(test::readHolding(1000));
+    ASSERT_FALSE(failed);
+    EXPECT_EQ(utils::IllegalDataAddress, failed.error());
+
+    // Many requests in few datagram batches
+    std::vector<ModbusRequest> requests;
+    for (uint16_t i = 0; i < 100; i++)
+        requests.push_back(test::readHolding(i * 4, 4));
+    const auto results = client.transact(requests);
+    ASSERT_EQ(requests.size(), results.size());
+    for (uint16_t i = 0; i < 100; i++) {
+        ASSERT_TRUE(results[i]) << i;
+        EXPECT_EQ(0x1000 + i * 4, results[i]->registers()[0]);
+    }
+    EXPECT_EQ(102u, client.stats().sent);
+    EXPECT_EQ(0u, client.stats().retransmits);
+
+    stop = true;
+    device.join();
+}
+
+TEST(ModbusUdp, MatchesResponsesOutOfOrder) {
+    // Every response is sent twice, in reverse order of requests
+    RawDevice device([](const ModbusRequest &) { return 2; });
+    auto client = UDP::Client::with("127.0.0.1", device.port(), 8);
+
+    std::vector<ModbusRequest> requests;
+    for (uint16_t i = 0; i < 20; i++)
+        requests.push_back(test::readHolding(i));
+    std::vector<std::size_t> order;
+    const auto status = client.transact(
+        requests.data(), requests.size(),
+        [&](std::size_t index, Result<ModbusResponse> response) {
+            ASSERT_TRUE(response);
+            EXPECT_EQ(0x1000 + index, response->registers()[0]);
+            order.push_back(index);
+        });
+    ASSERT_TRUE(status);
+
+    ASSERT_EQ(20u, order.size());
+    EXPECT_EQ(7u, order[0]); // Last request of the first window
+    EXPECT_EQ(20u, client.stats().sent);
+    EXPECT_GE(client.stats().dropped, 12u); // Duplicates arriving after completion
+}
+
+TEST(ModbusUdp, RetransmitsLostRequests) {
+    // First copy of every odd request is lost
+    std::set<uint16_t> seen;
+    RawDevice device([&](const ModbusRequest &request) {
+        const auto address = request.registerAddress();
+        return address % 2 == 0 || !seen.insert(address).second ? 1 : 0;
+    });
+    auto client = UDP::Client::with("127.0.0.1", device.port());
+    client.setTimeout(30);
+
+    std::vector<ModbusRequest> requests;
+    for (uint16_t i = 0; i < 10; i++)
+        requests.push_back(test::readHolding(i));
+    const auto results = client.transact(requests);
+    for (uint16_t i = 0; i < 10; i++) {
+        ASSERT_TRUE(results[i]) << i;
+        EXPECT_EQ(0x1000 + i, results[i]->registers()[0]);
+    }
+    EXPECT_EQ(5u, client.stats().retransmits);
+    EXPECT_EQ(15u, client.stats().sent);
+    EXPECT_EQ(0u, client.stats().timeouts);
+}
+
+TEST(ModbusUdp, TimesOutAfterLastRetry) {
+    RawDevice device([](const ModbusRequest &request) {
+        return request.registerAddress() == 0 ? 1 : 0;
+    });
+    auto client = UDP::Client::with("127.0.0.1", device.port());
+    client.setTimeout(10);
+    client.setRetries(1);
+
+    const auto results = client.transact({test::readHolding(0), test::readHolding(1)});
+    EXPECT_TRUE(results[0]);
+    ASSERT_FALSE(results[1]);
+    EXPECT_EQ(utils::Timeout, results[1].error());
+    EXPECT_EQ(3u, client.stats().sent);
+    EXPECT_EQ(1u, client.stats().timeouts);
+}
+
+TEST(ModbusUdp, ReportsUnreachableDevice) {
+    int port;
+    {
+        // Port that was free a moment ago, nothing listens on it now
+        UDP::Server server(0);
+        port = server.port();
+    }
+    auto client = UDP::Client::with("127.0.0.1", port);
+    client.setTimeout(50);
+    client.setRetries(0);
+
+    const auto response = client.transact(test::readHolding(0));
+    ASSERT_FALSE(response);
+    EXPECT_EQ(utils::ConnectionClosed, response.error());
+}
@@ -0,0 +1,79 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+#include "../expectThrow.hpp"
+#include "MB/modbusRequestView.hpp"
+#include "MB/modbusResponseView.hpp"
+#include "gtest/gtest.h"
+
+using namespace MB;
+
+// Testing data from https://www.simplymodbus.ca/
+TEST(ModbusResponseView, Registers) {
+    const std::vector<uint8_t> raw = {0x11, 0x03, 0x06, 0xAE, 0x41, 0x56,
+                                      0x52, 0x43, 0x40, 0x49, 0xAD};
+    auto view = ModbusResponseView::fromRawCRC(raw);
+
+    EXPECT_EQ(0x11, view.slaveID());
+    EXPECT_EQ(utils::ReadAnalogOutputHoldingRegisters, view.functionCode());
+    EXPECT_EQ(3, view.numberOfRegisters());
+    EXPECT_EQ(raw.size(), view.size());
+    EXPECT_EQ(raw.data() + 3, view.payload());
+    EXPECT_EQ(0xAE41, view.registerAt(0));
+    EXPECT_EQ(0x4340, view.registerAt(2));
+}
+
+TEST(ModbusResponseView, WordOrder) {
+    // 1.5f = 0x3FC00000
+    const std::vector<uint8_t> abcd = {0x01, 0x03, 0x04, 0x3F, 0xC0, 0x00, 0x00};
+    const std::vector<uint8_t> cdab = {0x01, 0x03, 0x04, 0x00, 0x00, 0x3F, 0xC0};
+    const std::vector<uint8_t> badc = {0x01, 0x03, 0x04, 0xC0, 0x3F, 0x00, 0x00};
+    const std::vector<uint8_t> dcba = {0x01, 0x03, 0x04, 0x00, 0x00, 0xC0, 0x3F};
+
+    EXPECT_FLOAT_EQ(1.5f, ModbusResponseView::fromRaw(abcd).asFloat32(0));
+    EXPECT_FLOAT_EQ(1.5f, ModbusResponseView::fromRaw(cdab).asFloat32(0, utils::CDAB));
+    EXPECT_FLOAT_EQ(1.5f, ModbusResponseView::fromRaw(badc).asFloat32(0, utils::BADC));
+    EXPECT_FLOAT_EQ(1.5f, ModbusResponseView::fromRaw(dcba).asFloat32(0, utils::DCBA));
+    EXPECT_EQ(0x3FC00000u, ModbusResponseView::fromRaw(abcd).asUint32(0));
+}
+
+TEST(ModbusResponseView, Truncated) {
+    const std::vector<uint8_t> raw = {0x11, 0x03, 0x06, 0xAE, 0x41, 0x56};
+    MB_EXPECT_THROW(ModbusResponseView::fromRaw(raw), ModbusException);
+    MB_EXPECT_THROW(ModbusResponseView::fromRaw(raw.data(), 2), ModbusException);
+
+    const std::vector<uint8_t> badCRC = {0x11, 0x04, 0x02, 0x00, 0x0A, 0xF8, 0xF5};
+#ifdef MB_EXCEPTIONS
+    try {
+        ModbusResponseView::fromRawCRC(badCRC);
+        FAIL();
+    } catch (const ModbusException &ex) {
+        EXPECT_EQ(utils::InvalidCRC, ex.getErrorCode());
+    }
+#else
+    MB_EXPECT_THROW(ModbusResponseView::fromRawCRC(badCRC), ModbusException);
+#endif
+}
+
+TEST(ModbusRequestView, WriteMultiple) {
+    const std::vector<uint8_t> coils = {0x11, 0x0F, 0x00, 0x13, 0x00, 0x0A,
+                                        0x02, 0xCD, 0x01, 0xBF, 0x0B};
+    auto coilView = ModbusRequestView::fromRawCRC(coils);
+    EXPECT_EQ(0x0A, coilView.numberOfRegisters());
+    EXPECT_TRUE(coilView.coilAt(0));
+    EXPECT_FALSE(coilView.coilAt(1));
+    EXPECT_TRUE(coilView.coilAt(8));
+
+    const std::vector<uint8_t> regs = {0x11, 0x10, 0x00, 0x01, 0x00, 0x02, 0x04,
+                                       0x00, 0x0A, 0x01, 0x02, 0xC6, 0xF0};
+    auto regView = ModbusRequestView::fromRawCRC(regs);
+    EXPECT_EQ(0x0001, regView.registerAddress());
+    EXPECT_EQ(0x000A, regView.registerAt(0));
+    EXPECT_EQ(0x0102, regView.registerAt(1));
+
+    // Byte count smaller than register count requires
+    auto invalid = regs;
+    invalid[6]   = 0x02;
+    MB_EXPECT_THROW(ModbusRequestView::fromRaw(invalid), ModbusException);
+}
@@ -0,0 +1,26 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Global operator new instrumentation, lets tests assert that code paths do
+// not touch the heap.
+
+#pragma once
+
+#include <cstdint>
+
+namespace MB::test {
+//! Number of calls to global operator new since program start
+uint64_t allocationCount() noexcept;
+
+//! Counts allocations made since construction
+class AllocationCounter {
+  private:
+    uint64_t _start;
+
+  public:
+    AllocationCounter() noexcept : _start(allocationCount()) {}
+
+    [[nodiscard]] uint64_t count() const noexcept { return allocationCount() - _start; }
+};
+} // namespace MB::test
@@ -0,0 +1,19 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Expectations on errors of the throwing API, valid in both exception modes
+// of the library (see MB_THROW).
+
+#pragma once
+
+#include "MB/modbusUtils.hpp"
+#include "gtest/gtest.h"
+
+#ifdef MB_EXCEPTIONS
+#define MB_EXPECT_THROW(statement, exception) EXPECT_THROW(statement, exception)
+#else
+//! Library built with MODBUS_NO_EXCEPTIONS aborts instead of throwing
+#define MB_EXPECT_THROW(statement, exception)                                           \
+    EXPECT_DEATH(statement, "Modbus: unhandled error")
+#endif
@@ -0,0 +1,55 @@
+// Modbus for c++ <https://github.com/Mazurel/Modbus>
+// Copyright (c) 2020 Mateusz Mazur aka Mazurel
+// Licensed under: MIT License <http://opensource.org/licenses/MIT>
+
+// Simulated slave device shared by client, cache and polling tests: read
+// requests and the responses the device gives to them.
+
+#pragma once
+
+#include <cstdint>
+
+#include "MB/TCP/connection.hpp"
+#include "MB/modbusRequest.hpp"
+#include "MB/modbusResponse.hpp"
+
+namespace MB::test {
+//! Register base that keeps register values apart from their addresses
+constexpr uint16_t RegisterBase = 0x1000;
+
+//! Read of `count` holding registers
+inline ModbusRequest readHolding(uint16_t address, uint16_t count = 1, uint8_t unit = 1) {
+    return ModbusRequest(unit, utils::ReadAnalogOutputHoldingRegisters, address, count);
+}
+
+/**
+ * @brief Response of the device to read request: register at address n
+ * holds `base + n`, coil n is set for odd n.
+ */
+inline ModbusResponse answer(const ModbusRequest &request, uint16_t base = 0) {
+    ModbusResponse response(request.slaveID(), request.functionCode(),
+                            request.registerAddress(), request.numberOfRegisters());
+    if (utils::isCoilFunction(request.functionCode())) {
+        CoilBitset coils(request.numberOfRegisters());
+        for (std::size_t i = 0; i < coils.size(); i++)
+            coils.set(i, (request.registerAddress() + i) % 2 == 1);
+        response.setCoils(coils);
+    } else {
+        RegisterBlock registers(request.numberOfRegisters());
+        for (std::size_t i = 0; i < registers.size(); i++)
+            registers[i] = static_cast<uint16_t>(base + request.registerAddress() + i);
+        response.setRegisters(registers);
+    }
+    return response;
+}
+
+//! Answers requests over the connection until it is closed
+inline void serve(TCP::Connection &connection, uint16_t base = 0) {
+    while (true) {
+        auto request = connection.tryAwaitRequest();
+        if (!request)
+            return;
+        connection.sendResponse(answer(request.value(), base));
+    }
+}
+} // namespace MB::test